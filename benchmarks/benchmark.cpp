@@ -0,0 +1,344 @@
+/// @file benchmark.cpp
+/// @brief Benchmarks of the operations, for all the widths between 8 and 8192 bits.
+/// @details Run `bvlib_bench --benchmark_out=results.json --benchmark_out_format=json`
+/// (or build the `bvlib_bench_json` target) to store the results, and compare
+/// two runs with the `compare.py` script of Google Benchmark.
+
+#include "bvlib/bitvector.hpp"
+#include "bvlib/bitvector_array.hpp"
+#include "bvlib/charconv.hpp"
+#include "bvlib/hash.hpp"
+#include "bvlib/math.hpp"
+#include "bvlib/parallel.hpp"
+#include "bvlib/polynomial.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+/// @brief Generates a random bitvector, with the given number of significant bits.
+template <std::size_t N>
+bvlib::BitVector<N> random_bitvector(std::mt19937_64 &gen, std::size_t bits = N)
+{
+    bvlib::BitVector<N> result;
+    for (std::size_t it = 0; it < result.num_blocks; ++it)
+        result.data[it] = gen();
+    result.data[result.num_blocks - 1] &= result.last_block_mask;
+    return (bits < N) ? (result >> (N - bits)) : result;
+}
+
+/// @brief Fills an array with random bitvectors.
+template <std::size_t N>
+bvlib::BitVectorArray<N> random_array(std::mt19937_64 &gen, std::size_t size)
+{
+    bvlib::BitVectorArray<N> result(size);
+    for (std::size_t it = 0; it < size; ++it)
+        result.set(it, random_bitvector<N>(gen));
+    return result;
+}
+
+// ============================================================================
+// CONSTRUCTION AND CONVERSION
+// ============================================================================
+
+template <std::size_t N>
+void construct_integer(benchmark::State &state)
+{
+    std::uint64_t value = 0x0123456789ABCDEFULL;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value);
+        bvlib::BitVector<N> result(value);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+template <std::size_t N>
+void construct_string(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    const std::string str = random_bitvector<N>(gen).to_string();
+    for (auto _ : state) {
+        bvlib::BitVector<N> result(str);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * N));
+}
+
+template <std::size_t N>
+void to_string(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto value = random_bitvector<N>(gen);
+    for (auto _ : state) {
+        auto result = value.to_string();
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+template <std::size_t N>
+void to_chars_decimal(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto value = random_bitvector<N>(gen);
+    std::string buffer(bvlib::max_chars(N, 10), '0');
+    for (auto _ : state) {
+        char *result = bvlib::to_chars(&buffer[0], &buffer[0] + buffer.size(), value).ptr;
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+template <std::size_t N>
+void to_number(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto value = random_bitvector<N>(gen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value);
+        auto result = value.template to_number<std::uint64_t>();
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+// ============================================================================
+// SHIFTS AND COMPARISONS
+// ============================================================================
+
+template <std::size_t N>
+void shift_left(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto value        = random_bitvector<N>(gen);
+    const std::size_t shift = N / 3 + 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(value << shift);
+    }
+}
+
+template <std::size_t N>
+void shift_right(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto value        = random_bitvector<N>(gen);
+    const std::size_t shift = N / 3 + 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(value >> shift);
+    }
+}
+
+template <std::size_t N>
+void less(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    // Equal up to the last block, which is the slowest case.
+    auto lhs = random_bitvector<N>(gen);
+    auto rhs       = lhs;
+    rhs.flip(0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        benchmark::DoNotOptimize(lhs < rhs);
+    }
+}
+
+template <std::size_t N>
+void equal(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto lhs = random_bitvector<N>(gen), rhs = lhs;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        benchmark::DoNotOptimize(lhs == rhs);
+    }
+}
+
+// ============================================================================
+// ARITHMETIC
+// ============================================================================
+
+template <std::size_t N>
+void sum(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto lhs = random_bitvector<N>(gen), rhs = random_bitvector<N>(gen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        auto result = bvlib::sum(lhs, rhs);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+template <std::size_t N>
+void sub(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto lhs = random_bitvector<N>(gen), rhs = random_bitvector<N>(gen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        auto result = bvlib::sub(lhs, rhs);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+template <std::size_t N>
+void mul(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto lhs = random_bitvector<N>(gen), rhs = random_bitvector<N>(gen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        auto result = bvlib::mul(lhs, rhs);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+template <std::size_t N>
+void div(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    // A divisor half as wide as the dividend.
+    auto lhs = random_bitvector<N>(gen), rhs = random_bitvector<N>(gen, N / 2) | bvlib::BitVector<N>(1U);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        auto result = bvlib::div(lhs, rhs);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+template <std::size_t N>
+void divider(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto lhs = random_bitvector<N>(gen);
+    const bvlib::Divider<N> divider(random_bitvector<N>(gen, N / 2) | bvlib::BitVector<N>(1U));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        auto result = divider.divide(lhs);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+template <std::size_t N>
+void clmul(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto lhs = random_bitvector<N>(gen), rhs = random_bitvector<N>(gen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        auto result = bvlib::clmul(lhs, rhs);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+template <std::size_t N>
+void hash(benchmark::State &state)
+{
+    std::mt19937_64 gen(0);
+    auto value = random_bitvector<N>(gen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value);
+        auto result = bvlib::hash(value);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+// ============================================================================
+// BATCHED AND PARALLEL
+// ============================================================================
+
+/// @brief Returns the number of bitvectors of the arrays, with at most 4 Mbit in total.
+template <std::size_t N>
+constexpr std::size_t array_bitvectors()
+{
+    return (N < 256) ? 16384U : ((std::size_t(1) << 22) / N);
+}
+
+template <std::size_t N>
+void batch_add(benchmark::State &state)
+{
+    constexpr std::size_t array_size = array_bitvectors<N>();
+    std::mt19937_64 gen(0);
+    auto lhs = random_array<N>(gen, array_size), rhs = random_array<N>(gen, array_size), dst = bvlib::BitVectorArray<N>(array_size);
+    for (auto _ : state) {
+        bvlib::add(dst, lhs, rhs);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * array_size));
+}
+
+template <std::size_t N>
+void batch_xor(benchmark::State &state)
+{
+    constexpr std::size_t array_size = array_bitvectors<N>();
+    std::mt19937_64 gen(0);
+    auto lhs = random_array<N>(gen, array_size), rhs = random_array<N>(gen, array_size), dst = bvlib::BitVectorArray<N>(array_size);
+    for (auto _ : state) {
+        bvlib::bitwise_xor(dst, lhs, rhs);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * array_size));
+}
+
+template <std::size_t N>
+void parallel_add(benchmark::State &state)
+{
+    constexpr std::size_t array_size = array_bitvectors<N>();
+    std::mt19937_64 gen(0);
+    auto lhs = random_array<N>(gen, array_size), rhs = random_array<N>(gen, array_size), dst = bvlib::BitVectorArray<N>(array_size);
+    for (auto _ : state) {
+        bvlib::parallel::transform(dst, lhs, rhs, bvlib::parallel::plus());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * array_size));
+}
+
+template <std::size_t N>
+void parallel_popcount(benchmark::State &state)
+{
+    constexpr std::size_t array_size = array_bitvectors<N>();
+    std::mt19937_64 gen(0);
+    auto array = random_array<N>(gen, array_size);
+    for (auto _ : state) {
+        auto result = bvlib::parallel::popcount(array);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * array_size));
+}
+
+/// Registers the benchmark for all the widths.
+#define BVLIB_BENCHMARK_WIDTHS(function)  \
+    BENCHMARK_TEMPLATE(function, 8);      \
+    BENCHMARK_TEMPLATE(function, 64);     \
+    BENCHMARK_TEMPLATE(function, 100);    \
+    BENCHMARK_TEMPLATE(function, 128);    \
+    BENCHMARK_TEMPLATE(function, 256);    \
+    BENCHMARK_TEMPLATE(function, 512);    \
+    BENCHMARK_TEMPLATE(function, 1024);   \
+    BENCHMARK_TEMPLATE(function, 2048);   \
+    BENCHMARK_TEMPLATE(function, 4096);   \
+    BENCHMARK_TEMPLATE(function, 8192)
+
+BVLIB_BENCHMARK_WIDTHS(construct_integer);
+BVLIB_BENCHMARK_WIDTHS(construct_string);
+BVLIB_BENCHMARK_WIDTHS(to_string);
+BVLIB_BENCHMARK_WIDTHS(to_chars_decimal);
+BVLIB_BENCHMARK_WIDTHS(to_number);
+BVLIB_BENCHMARK_WIDTHS(shift_left);
+BVLIB_BENCHMARK_WIDTHS(shift_right);
+BVLIB_BENCHMARK_WIDTHS(less);
+BVLIB_BENCHMARK_WIDTHS(equal);
+BVLIB_BENCHMARK_WIDTHS(sum);
+BVLIB_BENCHMARK_WIDTHS(sub);
+BVLIB_BENCHMARK_WIDTHS(mul);
+BVLIB_BENCHMARK_WIDTHS(div);
+BVLIB_BENCHMARK_WIDTHS(divider);
+BVLIB_BENCHMARK_WIDTHS(clmul);
+BVLIB_BENCHMARK_WIDTHS(hash);
+BVLIB_BENCHMARK_WIDTHS(batch_add);
+BVLIB_BENCHMARK_WIDTHS(batch_xor);
+BVLIB_BENCHMARK_WIDTHS(parallel_add);
+BVLIB_BENCHMARK_WIDTHS(parallel_popcount);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,245 @@
+/// @file arena.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Bump allocator for short-lived blocks.
+/// @details Memory is taken from a list of chunks by bumping an offset, and is
+/// given back all at once by moving the offset back to a previous mark. The
+/// chunks are kept after a release, so once an arena has grown enough to hold
+/// a whole computation, repeating that computation never touches the heap.
+/// Each thread has its own arena, returned by thread_arena(), which is used by
+/// the arithmetic of DynamicBitVector for its intermediate values.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace bvlib
+{
+
+/// @brief Bump allocator, which releases memory by going back to a mark.
+class Arena {
+public:
+    /// @brief A position inside the arena.
+    struct marker {
+        /// The index of the chunk.
+        std::size_t chunk;
+        /// The offset inside the chunk.
+        std::size_t offset;
+    };
+
+    /// The default size of the chunks, in bytes.
+    static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+    /// @brief Construct an empty arena, which allocates nothing until it is used.
+    /// @param chunk_size the minimum size of the chunks, in bytes.
+    explicit Arena(std::size_t chunk_size = default_chunk_size)
+        : _chunks(),
+          _chunk_size(chunk_size),
+          _current(),
+          _offset()
+    {
+    }
+
+    Arena(const Arena &)            = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /// @brief Allocates memory from the arena.
+    /// @param bytes the number of bytes.
+    /// @param alignment the alignment, which must be a power of two.
+    /// @return the allocated memory, which is valid until the arena goes back to a previous mark.
+    inline void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        for (; _current < _chunks.size(); ++_current, _offset = 0) {
+            auto address       = reinterpret_cast<std::uintptr_t>(_chunks[_current].data.get()) + _offset;
+            std::size_t offset = _offset + ((alignment - address % alignment) % alignment);
+            if (offset + bytes <= _chunks[_current].size) {
+                _offset = offset + bytes;
+                return _chunks[_current].data.get() + offset;
+            }
+        }
+        // None of the chunks has enough space left, add a new one.
+        std::size_t size = std::max(_chunk_size, bytes + alignment);
+        _chunks.push_back(chunk_t{ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+        _current = _chunks.size() - 1;
+        _offset  = 0;
+        return this->allocate(bytes, alignment);
+    }
+
+    /// @brief Allocates an uninitialized array of the given type.
+    /// @param size the number of elements.
+    /// @return the allocated array.
+    template <typename T>
+    inline T *allocate(std::size_t size)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "The arena never runs destructors");
+        return static_cast<T *>(this->allocate(size * sizeof(T), alignof(T)));
+    }
+
+    /// @brief Returns the current position, which can be given to release().
+    inline marker mark() const
+    {
+        return marker{ _current, _offset };
+    }
+
+    /// @brief Releases everything allocated after the given mark, keeping the chunks.
+    /// @param position a mark returned by mark().
+    inline void release(marker position)
+    {
+        _current = position.chunk;
+        _offset  = position.offset;
+    }
+
+    /// @brief Releases everything, keeping the chunks.
+    inline void reset()
+    {
+        this->release(marker{ 0, 0 });
+    }
+
+    /// @brief Returns the number of bytes in use, including the ones lost to alignment.
+    inline std::size_t used() const
+    {
+        std::size_t result = _offset;
+        for (std::size_t it = 0; (it < _current) && (it < _chunks.size()); ++it)
+            result += _chunks[it].size;
+        return result;
+    }
+
+    /// @brief Returns the number of bytes owned by the arena.
+    inline std::size_t capacity() const
+    {
+        std::size_t result = 0;
+        for (const auto &chunk : _chunks)
+            result += chunk.size;
+        return result;
+    }
+
+private:
+    /// @brief A block of memory owned by the arena.
+    struct chunk_t {
+        /// The memory.
+        std::unique_ptr<unsigned char[]> data;
+        /// The size of the memory, in bytes.
+        std::size_t size;
+    };
+
+    /// The chunks.
+    std::vector<chunk_t> _chunks;
+    /// The minimum size of the chunks.
+    std::size_t _chunk_size;
+    /// The chunk currently used.
+    std::size_t _current;
+    /// The first free byte inside the current chunk.
+    std::size_t _offset;
+};
+
+/// @brief Returns the arena of the calling thread.
+inline Arena &thread_arena()
+{
+    thread_local Arena arena;
+    return arena;
+}
+
+/// @brief Releases everything allocated from an arena during its lifetime.
+class ArenaScope {
+public:
+    /// @brief Marks the current position of the arena.
+    /// @param arena the arena, by default the one of the calling thread.
+    explicit ArenaScope(Arena &arena = bvlib::thread_arena())
+        : _arena(arena),
+          _mark(arena.mark())
+    {
+    }
+
+    ArenaScope(const ArenaScope &)            = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+    /// @brief Goes back to the marked position.
+    ~ArenaScope()
+    {
+        _arena.release(_mark);
+    }
+
+    /// @brief Returns the arena.
+    inline Arena &arena() const
+    {
+        return _arena;
+    }
+
+private:
+    /// The arena.
+    Arena &_arena;
+    /// The position of the arena when the scope was opened.
+    Arena::marker _mark;
+};
+
+/// @brief Allocator taking memory from an arena, and never giving it back.
+/// @tparam T the type of the allocated elements.
+/// @details The memory is reclaimed when the arena goes back to a mark taken
+/// before the allocation (e.g., at the end of an ArenaScope), so all the
+/// containers using it must be destroyed by then.
+template <typename T>
+class ArenaAllocator {
+public:
+    /// The type of the allocated elements.
+    using value_type = T;
+
+    /// Containers moved or copied around keep pointing to the same arena.
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    /// @brief Builds an allocator using the given arena.
+    /// @param arena the arena, by default the one of the calling thread.
+    ArenaAllocator(Arena &arena = bvlib::thread_arena()) noexcept
+        : _arena(&arena)
+    {
+    }
+
+    /// @brief Builds an allocator using the same arena of the other one.
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+        : _arena(&other.arena())
+    {
+    }
+
+    /// @brief Allocates an array of elements.
+    inline T *allocate(std::size_t size)
+    {
+        return static_cast<T *>(_arena->allocate(size * sizeof(T), alignof(T)));
+    }
+
+    /// @brief Does nothing, the memory is reclaimed by the arena.
+    inline void deallocate(T *, std::size_t) noexcept
+    {
+    }
+
+    /// @brief Returns the arena.
+    inline Arena &arena() const noexcept
+    {
+        return *_arena;
+    }
+
+private:
+    /// The arena.
+    Arena *_arena;
+};
+
+/// @brief Checks if the two allocators use the same arena.
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept
+{
+    return &lhs.arena() == &rhs.arena();
+}
+
+/// @brief Checks if the two allocators use different arenas.
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+} // namespace bvlib
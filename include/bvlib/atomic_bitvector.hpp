@@ -0,0 +1,244 @@
+/// @file atomic_bitvector.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Bitvector which can be modified concurrently, without locks.
+/// @details Each block is a std::atomic, so all the operations on single bits
+/// are atomic, while the operations on whole bitvectors are atomic block by
+/// block, and not as a whole. The blocks can optionally be placed into cache
+/// lines of their own, so threads updating different blocks never contend.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "intrinsics.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace bvlib
+{
+
+/// @brief Bitvector which can be modified concurrently, without locks.
+/// @tparam N the number of bits.
+/// @tparam Block the type used to store the bits.
+/// @tparam Padded if true, each block takes a whole cache line, to avoid false sharing.
+template <std::size_t N, typename Block = std::uint64_t, bool Padded = false>
+class AtomicBitVector {
+public:
+    /// The type of the bitvector which can be loaded and stored.
+    using value_type = BitVector<N, Block>;
+
+    /// The number of bits stored inside a block.
+    static constexpr std::size_t bits_per_block = value_type::bits_per_block;
+
+    /// The number of blocks.
+    static constexpr std::size_t num_blocks = value_type::num_blocks;
+
+    /// The size of a cache line, which is also the alignment of the bitvector.
+    static constexpr std::size_t cache_line = 64;
+
+    /// The value returned by the search functions when no bit is found.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// Whether all the operations are lock-free.
+    static constexpr bool is_always_lock_free = std::atomic<Block>::is_always_lock_free;
+
+    /// @brief Construct a new bitvector, with all bits set to zero.
+    AtomicBitVector() noexcept
+    {
+        this->store(value_type(), std::memory_order_relaxed);
+    }
+
+    /// @brief Construct a new bitvector, with the value of the given one.
+    explicit AtomicBitVector(const value_type &value) noexcept
+    {
+        this->store(value, std::memory_order_relaxed);
+    }
+
+    AtomicBitVector(const AtomicBitVector &)            = delete;
+    AtomicBitVector &operator=(const AtomicBitVector &) = delete;
+
+    /// @brief Returns the size of the bitvector.
+    constexpr inline auto size() const -> std::size_t
+    {
+        return N;
+    }
+
+    /// @brief Reads the bitvector, one block at a time.
+    inline value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept
+    {
+        value_type result;
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            result.data[it] = this->block(it).load(order);
+        return result;
+    }
+
+    /// @brief Writes the bitvector, one block at a time.
+    inline void store(const value_type &value, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            this->block(it).store(value.data[it], order);
+    }
+
+    /// @brief Sets every bit to false.
+    inline void reset(std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        this->store(value_type(), order);
+    }
+
+    /// @brief Returns the bit at the given position.
+    inline bool test(std::size_t position, std::memory_order order = std::memory_order_seq_cst) const
+    {
+        assert(position < N);
+        return (this->block(position / bits_per_block).load(order) & mask(position)) != 0;
+    }
+
+    /// @brief Sets the bit at the given position.
+    /// @return the previous value of the bit.
+    inline bool test_and_set(std::size_t position, std::memory_order order = std::memory_order_seq_cst)
+    {
+        assert(position < N);
+        return bvlib::AtomicBitVector<N, Block, Padded>::bit(this->block(position / bits_per_block).fetch_or(mask(position), order), position);
+    }
+
+    /// @brief Clears the bit at the given position.
+    /// @return the previous value of the bit.
+    inline bool test_and_reset(std::size_t position, std::memory_order order = std::memory_order_seq_cst)
+    {
+        assert(position < N);
+        return bvlib::AtomicBitVector<N, Block, Padded>::bit(this->block(position / bits_per_block).fetch_and(static_cast<Block>(~mask(position)), order), position);
+    }
+
+    /// @brief Flips the bit at the given position.
+    /// @return the previous value of the bit.
+    inline bool test_and_flip(std::size_t position, std::memory_order order = std::memory_order_seq_cst)
+    {
+        assert(position < N);
+        return bvlib::AtomicBitVector<N, Block, Padded>::bit(this->block(position / bits_per_block).fetch_xor(mask(position), order), position);
+    }
+
+    /// @brief Sets the bits which are set in the given bitvector.
+    /// @return the previous value, each block being read when it is modified.
+    inline value_type fetch_or(const value_type &value, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        value_type result;
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            result.data[it] = value.data[it] ? this->block(it).fetch_or(value.data[it], order) : this->block(it).load(order);
+        return result;
+    }
+
+    /// @brief Clears the bits which are not set in the given bitvector.
+    /// @return the previous value, each block being read when it is modified.
+    inline value_type fetch_and(const value_type &value, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        value_type result;
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            result.data[it] = this->block(it).fetch_and(value.data[it], order);
+        return result;
+    }
+
+    /// @brief Flips the bits which are set in the given bitvector.
+    /// @return the previous value, each block being read when it is modified.
+    inline value_type fetch_xor(const value_type &value, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        value_type result;
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            result.data[it] = value.data[it] ? this->block(it).fetch_xor(value.data[it], order) : this->block(it).load(order);
+        return result;
+    }
+
+    /// @brief Finds a bit which is not set, and sets it.
+    /// @return the position of the bit, which no other thread can have claimed, or npos if all the bits are set.
+    inline std::size_t find_first_unset_and_claim(std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        for (std::size_t it = 0; it < num_blocks; ++it) {
+            const Block valid = (it == num_blocks - 1) ? value_type::last_block_mask : static_cast<Block>(~Block(0));
+            Block current     = this->block(it).load(std::memory_order_relaxed);
+            // Retry on the same block until it is full, or one of its bits is ours.
+            while (static_cast<Block>(~current & valid) != 0) {
+                const std::size_t position = bvlib::detail::countr_zero(static_cast<Block>(~current & valid));
+                if (this->block(it).compare_exchange_weak(current, static_cast<Block>(current | (Block(1) << position)), order, std::memory_order_relaxed))
+                    return it * bits_per_block + position;
+            }
+        }
+        return npos;
+    }
+
+    /// @brief Returns the number of bits which are set.
+    /// @details With concurrent modifications, the result is only a snapshot of each block.
+    inline std::size_t count(std::memory_order order = std::memory_order_relaxed) const noexcept
+    {
+        std::size_t result = 0;
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            result += bvlib::detail::popcount(this->block(it).load(order));
+        return result;
+    }
+
+    /// @brief Tests whether all the bits are on.
+    inline bool all(std::memory_order order = std::memory_order_relaxed) const noexcept
+    {
+        return this->count(order) == N;
+    }
+
+    /// @brief Tests whether any of the bits are on.
+    inline bool any(std::memory_order order = std::memory_order_relaxed) const noexcept
+    {
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            if (this->block(it).load(order))
+                return true;
+        return false;
+    }
+
+    /// @brief Tests whether none of the bits are on.
+    inline bool none(std::memory_order order = std::memory_order_relaxed) const noexcept
+    {
+        return !this->any(order);
+    }
+
+private:
+    /// @brief A block taking a whole cache line.
+    struct alignas(cache_line) padded_block {
+        /// The block.
+        std::atomic<Block> value;
+    };
+
+    /// @brief A block packed with its neighbours.
+    struct packed_block {
+        /// The block.
+        std::atomic<Block> value;
+    };
+
+    /// The type of the stored blocks.
+    using storage_t = typename std::conditional<Padded, padded_block, packed_block>::type;
+
+    /// @brief Returns the mask selecting the given bit inside its block.
+    static constexpr inline Block mask(std::size_t position)
+    {
+        return static_cast<Block>(Block(1) << (position % bits_per_block));
+    }
+
+    /// @brief Returns the given bit of the previous value of its block.
+    /// @details The bit is shifted down instead of masked, since GCC 12 at -O1
+    /// turns the masked result of the fetch into a lock bt* instruction and
+    /// then discards its carry flag.
+    static constexpr inline bool bit(Block previous, std::size_t position)
+    {
+        return ((previous >> (position % bits_per_block)) & 1U) != 0;
+    }
+
+    /// @brief Returns the block with the given index.
+    inline std::atomic<Block> &block(std::size_t index) noexcept
+    {
+        return _blocks[index].value;
+    }
+
+    /// @brief Returns the block with the given index.
+    inline const std::atomic<Block> &block(std::size_t index) const noexcept
+    {
+        return _blocks[index].value;
+    }
+
+    /// The blocks, aligned to a cache line so that nothing else shares the first one.
+    alignas(cache_line) storage_t _blocks[num_blocks];
+};
+
+} // namespace bvlib
@@ -0,0 +1,224 @@
+/// @file bitsliced.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Bit-sliced (i.e., transposed) representation of many bitvectors.
+/// @details A BitSliced<N, Lanes> holds Lanes bitvectors of N bits, storing
+/// the bit i of all of them inside the same slice, which is a bitvector of
+/// Lanes bits. A circuit written with the bitwise operators on the slices
+/// thus evaluates all the lanes at once, e.g., the ripple adders below, which
+/// apply add_bits() and sub_bits() to whole slices.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "math.hpp"
+
+#include <cstdint>
+
+namespace bvlib
+{
+
+namespace detail
+{
+
+/// @brief Transposes a 64x64 matrix of bits, in place.
+/// @param rows the rows of the matrix, the bit c of the row r becomes the bit r of the row c.
+/// @details Swaps blocks of 32x32, 16x16, ..., 1x1 bits, working on whole
+/// rows, so each step is a straight loop of shifts and xors that the compiler
+/// can vectorize.
+constexpr inline void transpose64(std::uint64_t *rows)
+{
+    std::uint64_t mask = 0x00000000FFFFFFFFULL;
+    for (std::size_t width = 32; width != 0; width >>= 1, mask ^= (mask << width)) {
+        for (std::size_t it = 0; it < 64; it = ((it | width) + 1) & ~width) {
+            const std::uint64_t swap = ((rows[it] >> width) ^ rows[it | width]) & mask;
+            rows[it] ^= swap << width;
+            rows[it | width] ^= swap;
+        }
+    }
+}
+
+} // namespace detail
+
+/// @brief Lanes bitvectors of N bits, stored bit-sliced.
+/// @tparam N the number of bits of each bitvector.
+/// @tparam Lanes the number of bitvectors.
+template <std::size_t N, std::size_t Lanes = 64>
+class BitSliced {
+public:
+    /// The type of a slice, holding one bit of every lane.
+    using slice_type = BitVector<Lanes, std::uint64_t>;
+
+    /// The type of the bitvector of a lane.
+    using value_type = BitVector<N, std::uint64_t>;
+
+    /// The slices, the one at index i holds the bit i of every lane.
+    slice_type slices[N];
+
+    /// @brief Builds the bit-sliced representation of zeros.
+    constexpr BitSliced()
+        : slices()
+    {
+    }
+
+    /// @brief Builds the bit-sliced representation of the given bitvectors.
+    /// @param values an array of Lanes bitvectors.
+    /// @return the bit-sliced bitvectors.
+    static constexpr inline BitSliced pack(const value_type *values)
+    {
+        BitSliced result;
+        std::uint64_t tile[64] = {};
+        for (std::size_t group = 0; group < slice_type::num_blocks; ++group) {
+            for (std::size_t block = 0; block < value_type::num_blocks; ++block) {
+                // Rows are lanes, columns are bits.
+                for (std::size_t row = 0; row < 64; ++row)
+                    tile[row] = (group * 64 + row < Lanes) ? values[group * 64 + row].data[block] : 0;
+                bvlib::detail::transpose64(tile);
+                for (std::size_t row = 0; (row < 64) && (block * 64 + row < N); ++row)
+                    result.slices[block * 64 + row].data[group] = tile[row];
+            }
+        }
+        return result;
+    }
+
+    /// @brief Extracts the bitvectors from the bit-sliced representation.
+    /// @param values an array of Lanes bitvectors, where the values are stored.
+    constexpr inline void unpack(value_type *values) const
+    {
+        std::uint64_t tile[64] = {};
+        for (std::size_t group = 0; group < slice_type::num_blocks; ++group) {
+            for (std::size_t block = 0; block < value_type::num_blocks; ++block) {
+                // Rows are bits, columns are lanes.
+                for (std::size_t row = 0; row < 64; ++row)
+                    tile[row] = (block * 64 + row < N) ? slices[block * 64 + row].data[group] : 0;
+                bvlib::detail::transpose64(tile);
+                for (std::size_t row = 0; (row < 64) && (group * 64 + row < Lanes); ++row)
+                    values[group * 64 + row].data[block] = tile[row];
+            }
+        }
+    }
+
+    /// @brief Returns the bitvector of the given lane, gathering it one bit at a time.
+    constexpr inline value_type get(std::size_t lane) const
+    {
+        value_type result;
+        for (std::size_t it = 0; it < N; ++it)
+            result[it] = slices[it][lane];
+        return result;
+    }
+
+    /// @brief Sets the bitvector of the given lane, scattering it one bit at a time.
+    constexpr inline void set(std::size_t lane, const value_type &value)
+    {
+        for (std::size_t it = 0; it < N; ++it)
+            slices[it][lane] = value[it];
+    }
+
+    /// @brief Returns the slice holding the given bit of every lane.
+    constexpr inline slice_type &operator[](std::size_t position)
+    {
+        assert(position < N);
+        return slices[position];
+    }
+
+    /// @brief Returns the slice holding the given bit of every lane.
+    constexpr inline const slice_type &operator[](std::size_t position) const
+    {
+        assert(position < N);
+        return slices[position];
+    }
+};
+
+/// @brief Computes the bitwise and of every lane.
+template <std::size_t N, std::size_t Lanes>
+constexpr inline BitSliced<N, Lanes> operator&(const BitSliced<N, Lanes> &lhs, const BitSliced<N, Lanes> &rhs)
+{
+    BitSliced<N, Lanes> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result.slices[it] = lhs.slices[it] & rhs.slices[it];
+    return result;
+}
+
+/// @brief Computes the bitwise or of every lane.
+template <std::size_t N, std::size_t Lanes>
+constexpr inline BitSliced<N, Lanes> operator|(const BitSliced<N, Lanes> &lhs, const BitSliced<N, Lanes> &rhs)
+{
+    BitSliced<N, Lanes> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result.slices[it] = lhs.slices[it] | rhs.slices[it];
+    return result;
+}
+
+/// @brief Computes the bitwise xor of every lane.
+template <std::size_t N, std::size_t Lanes>
+constexpr inline BitSliced<N, Lanes> operator^(const BitSliced<N, Lanes> &lhs, const BitSliced<N, Lanes> &rhs)
+{
+    BitSliced<N, Lanes> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result.slices[it] = lhs.slices[it] ^ rhs.slices[it];
+    return result;
+}
+
+/// @brief Computes the bitwise not of every lane.
+template <std::size_t N, std::size_t Lanes>
+constexpr inline BitSliced<N, Lanes> operator~(const BitSliced<N, Lanes> &bitsliced)
+{
+    BitSliced<N, Lanes> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result.slices[it] = ~bitsliced.slices[it];
+    return result;
+}
+
+/// @brief Sums every lane, with a ripple-carry adder working on whole slices.
+template <std::size_t N, std::size_t Lanes>
+constexpr inline BitSliced<N, Lanes> operator+(const BitSliced<N, Lanes> &lhs, const BitSliced<N, Lanes> &rhs)
+{
+    BitSliced<N, Lanes> result;
+    typename BitSliced<N, Lanes>::slice_type carry;
+    for (std::size_t it = 0; it < N; ++it)
+        result.slices[it] = bvlib::add_bits(lhs.slices[it], rhs.slices[it], carry);
+    return result;
+}
+
+/// @brief Subtracts every lane, with a ripple-borrow subtractor working on whole slices.
+template <std::size_t N, std::size_t Lanes>
+constexpr inline BitSliced<N, Lanes> operator-(const BitSliced<N, Lanes> &lhs, const BitSliced<N, Lanes> &rhs)
+{
+    BitSliced<N, Lanes> result;
+    typename BitSliced<N, Lanes>::slice_type borrow;
+    for (std::size_t it = 0; it < N; ++it)
+        result.slices[it] = bvlib::sub_bits(lhs.slices[it], rhs.slices[it], borrow);
+    return result;
+}
+
+/// @brief Compares every lane for equality.
+/// @return a slice with the bit of each lane set if the two bitvectors of that lane are equal.
+template <std::size_t N, std::size_t Lanes>
+constexpr inline typename BitSliced<N, Lanes>::slice_type equal(const BitSliced<N, Lanes> &lhs, const BitSliced<N, Lanes> &rhs)
+{
+    typename BitSliced<N, Lanes>::slice_type differ;
+    for (std::size_t it = 0; it < N; ++it)
+        differ |= lhs.slices[it] ^ rhs.slices[it];
+    return ~differ;
+}
+
+/// @brief Compares every lane, checking if the first bitvector is smaller than the second.
+/// @return a slice with the bit of each lane set if the bitvector of lhs is smaller than the one of rhs.
+/// @details The result is the borrow going out of the subtraction lhs - rhs.
+template <std::size_t N, std::size_t Lanes>
+constexpr inline typename BitSliced<N, Lanes>::slice_type less(const BitSliced<N, Lanes> &lhs, const BitSliced<N, Lanes> &rhs)
+{
+    typename BitSliced<N, Lanes>::slice_type borrow;
+    for (std::size_t it = 0; it < N; ++it)
+        bvlib::sub_bits(lhs.slices[it], rhs.slices[it], borrow);
+    return borrow;
+}
+
+/// @brief Compares every lane, checking if the first bitvector is greater than the second.
+/// @return a slice with the bit of each lane set if the bitvector of lhs is greater than the one of rhs.
+template <std::size_t N, std::size_t Lanes>
+constexpr inline typename BitSliced<N, Lanes>::slice_type greater(const BitSliced<N, Lanes> &lhs, const BitSliced<N, Lanes> &rhs)
+{
+    return bvlib::less(rhs, lhs);
+}
+
+} // namespace bvlib
@@ -4,273 +4,545 @@
 
 #pragma once
 
+#include "intrinsics.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include <string>
-#include <cmath>
+#include <type_traits>
 
 namespace bvlib
 {
 
 /// @brief Class which reproduces the behaviour of bit-vector.
 /// @tparam N Lenght of the bit-vector
-template <std::size_t N>
+/// @tparam Block The unsigned integer type used to store the bits.
+/// @details The bits are packed inside an array of blocks, where the bit at
+/// position `i` is stored inside `data[i / bits_per_block]`, at position
+/// `i % bits_per_block`. The unused bits of the last block are always zero.
+/// The class contains nothing but the blocks: it is trivially copyable, has a
+/// standard layout and no padding, so it can be copied with memcpy, or shared
+/// between processes.
+template <std::size_t N, typename Block = std::uint64_t>
 class BitVector {
+    static_assert(N > 0, "A bitvector must have at least one bit");
+    static_assert(std::is_unsigned<Block>::value && !std::is_same<Block, bool>::value,
+                  "The block type must be an unsigned integer type");
+
 public:
-    /// Internal vector of bits.
-    bool bits[N];
+    /// The type used to store the bits.
+    using block_type = Block;
+
+    /// The number of bits stored inside a block.
+    static constexpr std::size_t bits_per_block = static_cast<std::size_t>(std::numeric_limits<Block>::digits);
+
+    /// The number of blocks required to store N bits.
+    static constexpr std::size_t num_blocks = (N + bits_per_block - 1) / bits_per_block;
+
+    /// The value returned by the search functions when no bit is found.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// The mask of the bits of the last block which are actually used.
+    static constexpr Block last_block_mask = (N % bits_per_block) ? static_cast<Block>((Block(1) << (N % bits_per_block)) - 1U) : static_cast<Block>(~Block(0));
+
+    /// @brief Proxy which allows to access a single bit as if it was a bool.
+    class reference {
+    public:
+        /// @brief Builds a reference to the bits selected by mask inside block.
+        constexpr reference(Block &block, Block mask)
+            : _block(&block),
+              _mask(mask)
+        {
+        }
+
+        /// @brief Copies the reference, not the referenced bit.
+        constexpr reference(const reference &) = default;
+
+        /// @brief Sets the referenced bit.
+        constexpr inline reference &operator=(bool value)
+        {
+            if (value)
+                *_block = static_cast<Block>(*_block | _mask);
+            else
+                *_block = static_cast<Block>(*_block & ~_mask);
+            return *this;
+        }
+
+        /// @brief Copies the value of another referenced bit.
+        constexpr inline reference &operator=(const reference &other)
+        {
+            return this->operator=(static_cast<bool>(other));
+        }
+
+        /// @brief Returns the value of the referenced bit.
+        constexpr inline operator bool() const
+        {
+            return (*_block & _mask) != 0;
+        }
+
+        /// @brief Returns the negated value of the referenced bit.
+        constexpr inline bool operator~() const
+        {
+            return (*_block & _mask) == 0;
+        }
+
+        /// @brief Flips the referenced bit.
+        constexpr inline reference &flip()
+        {
+            *_block = static_cast<Block>(*_block ^ _mask);
+            return *this;
+        }
+
+    private:
+        /// The block containing the bit.
+        Block *_block;
+        /// The mask selecting the bit inside the block.
+        Block _mask;
+    };
+
+    /// Internal vector of blocks.
+    Block data[num_blocks];
 
     /// @brief Construct a new bitvector.
-    explicit BitVector()
-        : bits()
+    constexpr explicit BitVector()
+        : data()
     {
-        for (std::size_t it = 0; it < N; ++it)
-            bits[it] = false;
     }
 
     /// @brief Construct a new bitvector and intializes it with the given value.
     /// @param value the initial value.
     template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-    explicit BitVector(T value)
-        : bits()
+    constexpr explicit BitVector(T value)
+        : data()
     {
-        for (std::size_t it = 0; it < N; ++it) {
-            this->at(it) = value % 2;
-            value /= 2;
+        // Negative values are stored in two-complement, like they are converted to unsigned.
+        using unsigned_t = typename std::make_unsigned<typename std::conditional<std::is_same<T, bool>::value, unsigned char, T>::type>::type;
+        auto bits        = static_cast<unsigned_t>(value);
+        for (std::size_t it = 0; it < num_blocks; ++it) {
+            data[it] = static_cast<Block>(bits);
+            if constexpr (detail::digits<unsigned_t>() > bits_per_block)
+                bits = static_cast<unsigned_t>(bits >> bits_per_block);
+            else
+                break;
         }
+        data[num_blocks - 1] &= last_block_mask;
     }
 
     /// @brief Construct a new bitvector based on the given string (e.g. "1010111").
     /// @param str the input string.
     explicit BitVector(const std::string &str)
-        : bits()
+        : data()
     {
+        if (str.length() > N)
+            throw std::out_of_range("accessing values outside bitvector");
         for (std::string::size_type it = 0, len = str.length(); it < len; ++it)
-            this->at(it) = (str[len - 1 - it] == '1');
+            if (str[len - 1 - it] == '1')
+                data[it / bits_per_block] |= static_cast<Block>(Block(1) << (it % bits_per_block));
     }
 
     /// @brief Copies the other bitvector into this one.
     /// @param other the other bitvector.
     template <std::size_t N2>
-    explicit BitVector(BitVector<N2> const &other)
-        : bits()
+    constexpr explicit BitVector(BitVector<N2, Block> const &other)
+        : data()
     {
-        std::size_t min_size = std::min(N, N2);
-        for (std::size_t it = 0; it < min_size; ++it)
-            this->at(it) = other[it];
+        this->assign(other);
     }
 
-    virtual ~BitVector() = default;
-
     /// @brief Returns a bitvector of all ones.
-    static inline BitVector<N> ones()
+    static constexpr inline BitVector<N, Block> ones()
     {
-        return BitVector<N>().flip();
+        return BitVector<N, Block>().flip();
     }
 
     /// @brief Returns a bitvector of all zeros.
-    static inline BitVector<N> zeros()
+    static constexpr inline BitVector<N, Block> zeros()
     {
-        return BitVector<N>();
+        return BitVector<N, Block>();
     }
 
     /// @brief Sets every bit to false.
-    inline BitVector<N> &reset()
+    constexpr inline BitVector<N, Block> &reset()
     {
-        for (std::size_t it = 0; it < N; ++it)
-            bits[it] = false;
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            data[it] = 0;
         return (*this);
     }
 
     /// @brief Sets the given bit to false.
-    inline BitVector<N> &reset(std::size_t position)
+    constexpr inline BitVector<N, Block> &reset(std::size_t position)
     {
         this->at(position) = false;
         return (*this);
     }
 
     /// @brief Flips every bit.
-    inline BitVector<N> &flip()
+    constexpr inline BitVector<N, Block> &flip()
     {
-        for (std::size_t it = 0; it < N; ++it)
-            bits[it] = !bits[it];
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            data[it] = static_cast<Block>(~data[it]);
+        data[num_blocks - 1] &= last_block_mask;
         return (*this);
     }
 
     /// @brief Flips a given bit.
-    inline BitVector<N> &flip(std::size_t position)
+    constexpr inline BitVector<N, Block> &flip(std::size_t position)
     {
-        this->at(position) = !this->at(position);
+        this->at(position).flip();
         return (*this);
     }
 
     /// @brief Returns the size of the bit-vector.
-    inline auto size() const -> std::size_t
+    constexpr inline auto size() const -> std::size_t
     {
         return N;
     }
 
     /// @brief Returns the number of bits which are set.
-    inline auto count() const -> std::size_t
+    constexpr inline auto count() const -> std::size_t
     {
         std::size_t result = 0;
-        for (std::size_t it = 0; it < N; ++it)
-            result += bits[it];
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            result += detail::popcount(data[it]);
         return result;
     }
 
     /// @brief Tests whether all the bits are on.
-    inline auto all() const -> bool
+    constexpr inline auto all() const -> bool
     {
-        for (std::size_t it = 0; it < N; ++it)
-            if (!bits[it])
+        for (std::size_t it = 0; it < num_blocks - 1; ++it)
+            if (data[it] != static_cast<Block>(~Block(0)))
                 return false;
-        return true;
+        return data[num_blocks - 1] == last_block_mask;
     }
 
     /// @brief Tests whether any of the bits are on.
-    inline auto any() const -> bool
+    constexpr inline auto any() const -> bool
     {
-        for (std::size_t it = 0; it < N; ++it)
-            if (bits[it])
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            if (data[it])
                 return true;
         return false;
     }
 
     /// @brief Tests whether none of the bits are on.
-    inline auto none() const -> bool
+    constexpr inline auto none() const -> bool
     {
-        for (std::size_t it = 0; it < N; ++it)
-            if (bits[it])
-                return false;
-        return true;
+        return !this->any();
+    }
+
+    /// @brief Returns the number of consecutive zeros, starting from the most significant bit.
+    /// @return the number of leading zeros, which is N if no bit is set.
+    constexpr inline auto countl_zero() const -> std::size_t
+    {
+        // The unused bits of the last block are always zero, and must be discarded.
+        constexpr std::size_t unused = num_blocks * bits_per_block - N;
+        for (std::size_t it = num_blocks; it > 0; --it)
+            if (data[it - 1])
+                return (num_blocks - it) * bits_per_block + detail::countl_zero(data[it - 1]) - unused;
+        return N;
+    }
+
+    /// @brief Returns the number of consecutive zeros, starting from the least significant bit.
+    /// @return the number of trailing zeros, which is N if no bit is set.
+    constexpr inline auto countr_zero() const -> std::size_t
+    {
+        for (std::size_t it = 0; it < num_blocks; ++it)
+            if (data[it])
+                return it * bits_per_block + detail::countr_zero(data[it]);
+        return N;
+    }
+
+    /// @brief Returns the position of the least significant bit which is set.
+    /// @return the position of the bit, or npos if no bit is set.
+    constexpr inline auto find_first() const -> std::size_t
+    {
+        const std::size_t position = this->countr_zero();
+        return (position == N) ? npos : position;
+    }
+
+    /// @brief Returns the position of the most significant bit which is set.
+    /// @return the position of the bit, or npos if no bit is set.
+    constexpr inline auto find_last() const -> std::size_t
+    {
+        const std::size_t zeros = this->countl_zero();
+        return (zeros == N) ? npos : (N - 1 - zeros);
     }
 
-    /// @brief Tests whether the sign bit is on.
-    inline auto sign() const -> bool
+    /// @brief Tests whether the sign bit (i.e., the most significant bit) is on.
+    constexpr inline auto sign() const -> bool
     {
-        return bits[0];
+        return (*this)[N - 1];
     }
 
     /// @brief Performs two-complement.
-    inline BitVector<N> &two_complement()
+    constexpr inline BitVector<N, Block> &two_complement()
     {
         return this->flip() += 1;
     }
 
     /// @brief Swaps the bits from 'start' to 'end'.
-    inline BitVector<N> &swap(std::size_t start = 0, std::size_t end = N - 1)
+    constexpr inline BitVector<N, Block> &swap(std::size_t start = 0, std::size_t end = N - 1)
     {
-        do std::swap(bits[start], bits[end]);
-        while (start++ < end--);
+        if ((start < end) && (end >= N))
+            throw std::out_of_range("accessing values outside bitvector");
+        for (; start < end; ++start, --end) {
+            bool tmp       = (*this)[start];
+            (*this)[start] = (*this)[end];
+            (*this)[end]   = tmp;
+        }
         return (*this);
     }
 
     /// @brief Copies rhs into this BitVector.
     template <std::size_t N2>
-    inline BitVector<N> &assign(BitVector<N2> const &rhs)
+    constexpr inline BitVector<N, Block> &assign(BitVector<N2, Block> const &rhs)
     {
-        std::size_t min_size = std::min(N, N2);
-        this->reset();
-        for (std::size_t it = 0; it < min_size; ++it)
-            this->at(it) = rhs[it];
+        constexpr std::size_t min_blocks = std::min(num_blocks, BitVector<N2, Block>::num_blocks);
+        std::size_t it                   = 0;
+        for (; it < min_blocks; ++it)
+            data[it] = rhs.data[it];
+        for (; it < num_blocks; ++it)
+            data[it] = 0;
+        data[num_blocks - 1] &= last_block_mask;
         return (*this);
     }
 
     /// @brief Copies rhs into this BitVector, iterating from left to right.
     template <std::size_t N2>
-    inline BitVector<N> &rassign(BitVector<N2> const &rhs)
+    constexpr inline BitVector<N, Block> &rassign(BitVector<N2, Block> const &rhs)
     {
         std::size_t min_size = std::min(N, N2);
         this->reset();
         for (std::size_t it = 0; it < min_size; ++it)
-            this->at(N - it - 1) = rhs[N2 - it - 1];
+            (*this)[N - it - 1] = rhs[N2 - it - 1];
         return (*this);
     }
 
     /// @brief Copies rhs into this BitVector.
     template <std::size_t N2>
-    inline BitVector<N> &operator=(const BitVector<N2> &rhs)
+    constexpr inline BitVector<N, Block> &operator=(const BitVector<N2, Block> &rhs)
     {
-        std::size_t min_size = std::min(N, N2);
-        this->reset();
-        for (std::size_t it = 0; it < min_size; ++it)
-            this->at(it) = rhs[it];
-        return (*this);
+        return this->assign(rhs);
     }
 
     /// @brief Transforms rhs into a BitVector.
-    inline BitVector<N> &operator=(std::size_t rhs)
+    constexpr inline BitVector<N, Block> &operator=(std::size_t rhs)
     {
-        this->reset();
-        for (std::size_t it = 0; it < N; ++it) {
-            this->at(it) = rhs % 2;
-            rhs /= 2;
-        }
-        return *this;
+        return (*this) = BitVector<N, Block>(rhs);
     }
 
     /// @brief Transforms rhs into a BitVector.
-    inline BitVector<N> &operator=(const std::string &str)
+    inline BitVector<N, Block> &operator=(const std::string &str)
     {
         this->reset();
-        for (std::string::size_type it = 0, len = str.length(); it < len; ++it)
-            bits[N - 1 - it] = (str[len - 1 - it] == '1');
+        for (std::string::size_type it = 0, len = std::min<std::string::size_type>(str.length(), N); it < len; ++it)
+            if (str[str.length() - 1 - it] == '1')
+                data[it / bits_per_block] |= static_cast<Block>(Block(1) << (it % bits_per_block));
         return *this;
     }
 
     /// @brief Returns a reference to the bit at the given position.
-    inline bool &at(std::size_t position)
+    constexpr inline reference at(std::size_t position)
     {
         if (position >= N)
             throw std::out_of_range("accessing values outside bitvector");
-        return bits[N - position - 1];
+        return reference(data[position / bits_per_block], static_cast<Block>(Block(1) << (position % bits_per_block)));
     }
 
     /// @brief Returns the bit at the given position.
-    inline const bool &at(std::size_t position) const
+    constexpr inline bool at(std::size_t position) const
     {
         if (position >= N)
             throw std::out_of_range("accessing values outside bitvector");
-        return bits[N - position - 1];
+        return (data[position / bits_per_block] >> (position % bits_per_block)) & 1U;
     }
 
-    /// @brief Returns a reference to the bit at the given position.
-    inline bool &operator[](std::size_t position)
+    /// @brief Returns a reference to the bit at the given position, without checking it.
+    /// @details The position is only asserted, unless BVLIB_CHECKED is defined,
+    /// in which case it throws like at().
+    constexpr inline reference operator[](std::size_t position)
     {
+#if defined(BVLIB_CHECKED)
         if (position >= N)
             throw std::out_of_range("accessing values outside bitvector");
-        return bits[N - position - 1];
+#else
+        assert(position < N);
+#endif
+        return reference(data[position / bits_per_block], static_cast<Block>(Block(1) << (position % bits_per_block)));
     }
 
-    /// @brief Returns the bit at the given position.
-    inline const bool &operator[](std::size_t position) const
+    /// @brief Returns the bit at the given position, without checking it.
+    /// @details The position is only asserted, unless BVLIB_CHECKED is defined,
+    /// in which case it throws like at().
+    constexpr inline bool operator[](std::size_t position) const
     {
+#if defined(BVLIB_CHECKED)
         if (position >= N)
             throw std::out_of_range("accessing values outside bitvector");
-        return bits[N - position - 1];
+#else
+        assert(position < N);
+#endif
+        return (data[position / bits_per_block] >> (position % bits_per_block)) & 1U;
     }
 
     /// @brief Transforms this BitVector to string.
     inline std::string to_string() const
     {
-        std::string str;
+        std::string str(N, '0');
         for (std::size_t it = 0; it < N; ++it)
-            str.push_back(bits[it] ? '1' : '0');
+            str[N - 1 - it] = static_cast<char>('0' + ((data[it / bits_per_block] >> (it % bits_per_block)) & 1U));
         return str;
     }
 
     /// @brief Transforms this BitVector to number.
+    /// @details Integral types are filled block by block, and the bits which do not fit are discarded.
     template <typename T>
     constexpr inline T to_number() const
     {
-        T result = 0;
-        for (std::size_t it = 0; it < N; ++it) {
-            if (bits[it]) {
-                result += static_cast<T>(std::pow(2, N - it - 1));
-            }
+        if constexpr (std::is_integral<T>::value) {
+            using unsigned_t      = typename std::make_unsigned<typename std::conditional<std::is_same<T, bool>::value, unsigned char, T>::type>::type;
+            constexpr auto digits = detail::digits<unsigned_t>();
+            unsigned_t result     = 0;
+            for (std::size_t it = 0; (it < num_blocks) && (it * bits_per_block < digits); ++it)
+                result = static_cast<unsigned_t>(result | static_cast<unsigned_t>(static_cast<unsigned_t>(data[it]) << (it * bits_per_block)));
+            return static_cast<T>(result);
+        } else {
+            // Horner's scheme, from the most significant block.
+            T result = 0;
+            for (std::size_t it = num_blocks; it > 0; --it)
+                result = result * static_cast<T>(Block(1) << (bits_per_block - 1)) * 2 + static_cast<T>(data[it - 1]);
+            return result;
         }
+    }
+
+    /// @brief Transforms this BitVector to number, checking that it fits.
+    /// @details Unlike to_number(), it throws std::overflow_error when the
+    /// bitvector has bits set which do not fit the integral type.
+    template <typename T>
+    constexpr inline T to_number_checked() const
+    {
+        static_assert(std::is_integral<T>::value, "The checked conversion requires an integral type");
+        constexpr auto digits = static_cast<std::size_t>(std::numeric_limits<T>::digits);
+        if ((N > digits) && (N - this->countl_zero() > digits))
+            throw std::overflow_error("bitvector does not fit the integer type");
+        return this->template to_number<T>();
+    }
+
+    /// @brief Returns the lowest 64 bits.
+    constexpr inline std::uint64_t to_uint64() const
+    {
+        // With 64-bit blocks, the first block is already the value.
+        if constexpr (bits_per_block == 64)
+            return static_cast<std::uint64_t>(data[0]);
+        else
+            return this->template to_number<std::uint64_t>();
+    }
+
+#if defined(BVLIB_HAS_INT128)
+    /// @brief Returns the lowest 128 bits.
+    /// @details The 128-bit type is not integral in strict ISO mode, hence it
+    /// requires its own conversion.
+    constexpr inline detail::uint128_t to_u128() const
+    {
+        detail::uint128_t result = 0;
+        for (std::size_t it = 0; (it < num_blocks) && (it * bits_per_block < 128); ++it)
+            result |= static_cast<detail::uint128_t>(data[it]) << (it * bits_per_block);
+        return result;
+    }
+#endif
+
+    /// @brief Builds a bitvector from 64-bit words, least significant first.
+    /// @param words the words.
+    /// @param count the number of words, the bits which do not fit are discarded.
+    static constexpr inline BitVector<N, Block> from_words(const std::uint64_t *words, std::size_t count)
+    {
+        static_assert(bits_per_block <= 64, "The blocks cannot be wider than the words");
+        constexpr std::size_t blocks_per_word = 64 / bits_per_block;
+        BitVector<N, Block> result;
+        for (std::size_t it = 0; (it < num_blocks) && (it / blocks_per_word < count); ++it)
+            result.data[it] = static_cast<Block>(words[it / blocks_per_word] >> ((it % blocks_per_word) * bits_per_block));
+        result.data[num_blocks - 1] &= last_block_mask;
         return result;
     }
 };
 
+namespace detail
+{
+
+/// @brief Returns the number of characters of the prefix of a bitvector literal (i.e., 0b or 0x).
+constexpr inline std::size_t literal_prefix(const char *str, std::size_t length)
+{
+    return ((length > 2) && (str[0] == '0') && ((str[1] == 'b') || (str[1] == 'B') || (str[1] == 'x') || (str[1] == 'X'))) ? 2 : 0;
+}
+
+/// @brief Returns the number of bits encoded by a single digit of a bitvector literal.
+constexpr inline std::size_t literal_digit_bits(const char *str, std::size_t length)
+{
+    return ((literal_prefix(str, length) == 2) && ((str[1] == 'x') || (str[1] == 'X'))) ? 4 : 1;
+}
+
+/// @brief Returns the value of a digit of a bitvector literal, or -1 if it is not valid.
+constexpr inline int literal_digit(char c, std::size_t digit_bits)
+{
+    if ((c >= '0') && (c <= '1'))
+        return c - '0';
+    if (digit_bits == 1)
+        return -1;
+    if ((c >= '2') && (c <= '9'))
+        return c - '0';
+    if ((c >= 'a') && (c <= 'f'))
+        return c - 'a' + 10;
+    if ((c >= 'A') && (c <= 'F'))
+        return c - 'A' + 10;
+    return -1;
+}
+
+/// @brief Returns the number of bits of a bitvector literal, or 0 if it contains invalid digits.
+constexpr inline std::size_t literal_size(const char *str, std::size_t length)
+{
+    const std::size_t digit_bits = literal_digit_bits(str, length);
+    std::size_t result           = 0;
+    for (std::size_t it = literal_prefix(str, length); it < length; ++it) {
+        if (str[it] == '\'')
+            continue;
+        if (literal_digit(str[it], digit_bits) < 0)
+            return 0;
+        result += digit_bits;
+    }
+    return result;
+}
+
+} // namespace detail
+
+namespace literals
+{
+
+/// @brief Builds a bitvector from a binary (e.g., 1011_bv or 0b1011_bv) or hexadecimal
+/// (e.g., 0xFF_bv) literal, with one bit for each binary digit, and four for each
+/// hexadecimal digit.
+template <char... Chars>
+constexpr inline auto operator""_bv()
+{
+    constexpr char str[]         = { Chars... };
+    constexpr std::size_t length = sizeof...(Chars);
+    constexpr std::size_t size   = detail::literal_size(str, length);
+    static_assert(size > 0, "Invalid digit inside the bitvector literal");
+    constexpr std::size_t digit_bits = detail::literal_digit_bits(str, length);
+    BitVector<size> result;
+    std::size_t position = 0;
+    for (std::size_t it = length; it > detail::literal_prefix(str, length); --it) {
+        if (str[it - 1] == '\'')
+            continue;
+        const int digit = detail::literal_digit(str[it - 1], digit_bits);
+        for (std::size_t bit = 0; bit < digit_bits; ++bit, ++position)
+            result[position] = ((digit >> bit) & 1) != 0;
+    }
+    return result;
+}
+
+} // namespace literals
+
 } // namespace bvlib
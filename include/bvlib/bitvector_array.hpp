@@ -0,0 +1,435 @@
+/// @file bitvector_array.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Array of bitvectors of the same width, stored as a struct of arrays.
+/// @details The blocks are stored limb by limb: first the block 0 of every
+/// bitvector, then the block 1 of every bitvector, and so on. Each of these
+/// planes is contiguous and aligned, so the batched kernels below walk them
+/// with unit stride and vectorize across the bitvectors, instead of across the
+/// blocks of a single one. All the kernels accept a range of indices, and touch
+/// nothing outside of it, so disjoint ranges can be processed concurrently
+/// (e.g., by dividing the indices into chunks and giving them to
+/// std::for_each with std::execution::par_unseq).
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace bvlib
+{
+
+namespace detail
+{
+
+/// @brief Allocator returning memory with the given alignment.
+template <typename T, std::size_t Alignment>
+struct aligned_allocator {
+    /// The type of the allocated elements.
+    using value_type = T;
+
+    /// @brief Rebinds the allocator to another type.
+    template <typename U>
+    struct rebind {
+        /// The rebound allocator.
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() noexcept = default;
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment> &) noexcept
+    {
+    }
+
+    /// @brief Allocates an array of elements.
+    inline T *allocate(std::size_t size)
+    {
+        return static_cast<T *>(::operator new(size * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    /// @brief Releases an array of elements.
+    inline void deallocate(T *ptr, std::size_t) noexcept
+    {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+
+    inline bool operator==(const aligned_allocator &) const noexcept
+    {
+        return true;
+    }
+
+    inline bool operator!=(const aligned_allocator &) const noexcept
+    {
+        return false;
+    }
+};
+
+} // namespace detail
+
+/// @brief Array of bitvectors of the same width, stored as a struct of arrays.
+/// @tparam N the number of bits of each bitvector.
+/// @tparam Block the type used to store the bits.
+template <std::size_t N, typename Block = std::uint64_t>
+class BitVectorArray {
+public:
+    /// The type of the elements.
+    using value_type = BitVector<N, Block>;
+
+    /// The type used to store the bits.
+    using block_type = Block;
+
+    /// The number of bits stored inside a block.
+    static constexpr std::size_t bits_per_block = value_type::bits_per_block;
+
+    /// The number of blocks of each bitvector, and thus the number of planes.
+    static constexpr std::size_t num_blocks = value_type::num_blocks;
+
+    /// The alignment of each plane, in bytes.
+    static constexpr std::size_t alignment = 64;
+
+    /// The value used to select all the bitvectors up to the end of the array.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// @brief Proxy acting like a reference to one of the bitvectors.
+    class reference {
+    public:
+        /// @brief Refers to the bitvector with the given index.
+        reference(BitVectorArray &array, std::size_t index)
+            : _array(&array),
+              _index(index)
+        {
+        }
+
+        /// @brief Copies the reference, not the referenced bitvector.
+        reference(const reference &) = default;
+
+        /// @brief Returns a copy of the referenced bitvector.
+        inline operator value_type() const
+        {
+            return _array->get(_index);
+        }
+
+        /// @brief Sets the referenced bitvector.
+        inline reference &operator=(const value_type &value)
+        {
+            _array->set(_index, value);
+            return *this;
+        }
+
+        /// @brief Copies the value of another referenced bitvector.
+        inline reference &operator=(const reference &other)
+        {
+            return this->operator=(static_cast<value_type>(other));
+        }
+
+        /// @brief Returns a reference to the bit at the given position.
+        inline typename value_type::reference operator[](std::size_t position) const
+        {
+            assert(position < N);
+            return typename value_type::reference(_array->plane(position / bits_per_block)[_index], static_cast<Block>(Block(1) << (position % bits_per_block)));
+        }
+
+        /// @brief Returns the bit at the given position.
+        inline bool test(std::size_t position) const
+        {
+            assert(position < N);
+            return (_array->plane(position / bits_per_block)[_index] >> (position % bits_per_block)) & 1U;
+        }
+
+    private:
+        /// The array.
+        BitVectorArray *_array;
+        /// The index of the bitvector.
+        std::size_t _index;
+    };
+
+    /// @brief Builds an empty array.
+    BitVectorArray()
+        : _size(),
+          _stride(),
+          _data()
+    {
+    }
+
+    /// @brief Builds an array of the given number of bitvectors, all set to zero.
+    explicit BitVectorArray(std::size_t size)
+        : _size(size),
+          _stride(BitVectorArray::stride_for(size)),
+          _data(num_blocks * _stride, Block(0))
+    {
+    }
+
+    /// @brief Builds an array of the given number of copies of the given bitvector.
+    BitVectorArray(std::size_t size, const value_type &value)
+        : BitVectorArray(size)
+    {
+        for (std::size_t limb = 0; limb < num_blocks; ++limb)
+            std::fill(this->plane(limb), this->plane(limb) + _size, value.data[limb]);
+    }
+
+    /// @brief Returns the number of bitvectors.
+    inline std::size_t size() const
+    {
+        return _size;
+    }
+
+    /// @brief Returns the distance, in blocks, between two consecutive planes.
+    inline std::size_t stride() const
+    {
+        return _stride;
+    }
+
+    /// @brief Changes the number of bitvectors, the new ones are set to zero.
+    inline void resize(std::size_t size)
+    {
+        const std::size_t stride = BitVectorArray::stride_for(size);
+        std::vector<Block, detail::aligned_allocator<Block, alignment>> data(num_blocks * stride, Block(0));
+        for (std::size_t limb = 0; limb < num_blocks; ++limb)
+            std::copy(this->plane(limb), this->plane(limb) + std::min(size, _size), data.data() + limb * stride);
+        _data.swap(data);
+        _size   = size;
+        _stride = stride;
+    }
+
+    /// @brief Sets all the bitvectors to zero.
+    inline void reset()
+    {
+        std::fill(_data.begin(), _data.end(), Block(0));
+    }
+
+    /// @brief Returns the given block of all the bitvectors.
+    /// @param limb the index of the block.
+    /// @return an aligned array of size() blocks.
+    inline Block *plane(std::size_t limb)
+    {
+        return _data.data() + limb * _stride;
+    }
+
+    /// @brief Returns the given block of all the bitvectors.
+    /// @param limb the index of the block.
+    /// @return an aligned array of size() blocks.
+    inline const Block *plane(std::size_t limb) const
+    {
+        return _data.data() + limb * _stride;
+    }
+
+    /// @brief Returns a copy of the bitvector with the given index.
+    inline value_type get(std::size_t index) const
+    {
+        assert(index < _size);
+        value_type result;
+        for (std::size_t limb = 0; limb < num_blocks; ++limb)
+            result.data[limb] = this->plane(limb)[index];
+        return result;
+    }
+
+    /// @brief Sets the bitvector with the given index.
+    inline void set(std::size_t index, const value_type &value)
+    {
+        assert(index < _size);
+        for (std::size_t limb = 0; limb < num_blocks; ++limb)
+            this->plane(limb)[index] = value.data[limb];
+    }
+
+    /// @brief Returns a reference to the bitvector with the given index.
+    inline reference operator[](std::size_t index)
+    {
+        assert(index < _size);
+        return reference(*this, index);
+    }
+
+    /// @brief Returns a copy of the bitvector with the given index.
+    inline value_type operator[](std::size_t index) const
+    {
+        return this->get(index);
+    }
+
+    /// @brief Returns a reference to the bitvector with the given index.
+    inline reference at(std::size_t index)
+    {
+        if (index >= _size)
+            throw std::out_of_range("accessing values outside bitvector array");
+        return reference(*this, index);
+    }
+
+    /// @brief Returns a copy of the bitvector with the given index.
+    inline value_type at(std::size_t index) const
+    {
+        if (index >= _size)
+            throw std::out_of_range("accessing values outside bitvector array");
+        return this->get(index);
+    }
+
+private:
+    /// @brief Returns the stride keeping all the planes aligned.
+    static inline std::size_t stride_for(std::size_t size)
+    {
+        constexpr std::size_t step = (alignment > sizeof(Block)) ? alignment / sizeof(Block) : 1;
+        return (size + step - 1) / step * step;
+    }
+
+    /// The number of bitvectors.
+    std::size_t _size;
+    /// The distance between two consecutive planes.
+    std::size_t _stride;
+    /// The planes.
+    std::vector<Block, detail::aligned_allocator<Block, alignment>> _data;
+};
+
+namespace detail
+{
+
+/// The number of bitvectors processed together by the batched kernels.
+constexpr std::size_t batch_tile = 256;
+
+/// @brief Clamps the range of a batched kernel, and checks that the arrays match.
+/// @return the end of the range.
+template <std::size_t N, typename Block>
+inline std::size_t batch_range(const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first, std::size_t last)
+{
+    if (lhs.size() != rhs.size())
+        throw std::invalid_argument("the arrays have different sizes");
+    last = std::min(last, lhs.size());
+    if (first > last)
+        throw std::out_of_range("accessing values outside bitvector array");
+    return last;
+}
+
+/// @brief Sums, or subtracts, the bitvectors of two arrays.
+template <bool Sub, std::size_t N, typename Block>
+inline void batch_add_sub(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first, std::size_t last)
+{
+    last = bvlib::detail::batch_range(dst, lhs, first, last);
+    last = bvlib::detail::batch_range(lhs, rhs, first, last);
+    for (std::size_t base = first; base < last; base += batch_tile) {
+        const std::size_t length = std::min(batch_tile, last - base);
+        // The carries of the bitvectors of the tile, moving from one plane to the next.
+        Block carry[batch_tile] = {};
+        for (std::size_t limb = 0; limb < dst.num_blocks; ++limb) {
+            const Block *a = lhs.plane(limb) + base, *b = rhs.plane(limb) + base;
+            Block *d       = dst.plane(limb) + base;
+            const Block mask = (limb == dst.num_blocks - 1) ? BitVector<N, Block>::last_block_mask : static_cast<Block>(~Block(0));
+            // Written without branches, so that the compiler can vectorize it.
+            for (std::size_t it = 0; it < length; ++it) {
+                if constexpr (Sub) {
+                    const Block partial = static_cast<Block>(a[it] - b[it]);
+                    const Block result  = static_cast<Block>(partial - carry[it]);
+                    carry[it]           = static_cast<Block>((a[it] < b[it]) | (partial < carry[it]));
+                    d[it]               = static_cast<Block>(result & mask);
+                } else {
+                    const Block partial = static_cast<Block>(a[it] + b[it]);
+                    const Block result  = static_cast<Block>(partial + carry[it]);
+                    carry[it]           = static_cast<Block>((partial < a[it]) | (result < partial));
+                    d[it]               = static_cast<Block>(result & mask);
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+/// @brief Sums the bitvectors of two arrays, element by element.
+/// @param dst where the sums are stored, it can be one of the operands.
+/// @param lhs the first array.
+/// @param rhs the second array.
+/// @param first the index of the first bitvector to process.
+/// @param last the index after the last bitvector to process.
+template <std::size_t N, typename Block>
+inline void add(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first = 0, std::size_t last = bvlib::BitVectorArray<N, Block>::npos)
+{
+    bvlib::detail::batch_add_sub<false>(dst, lhs, rhs, first, last);
+}
+
+/// @brief Subtracts the bitvectors of two arrays, element by element.
+/// @param dst where the differences are stored, it can be one of the operands.
+/// @param lhs the first array.
+/// @param rhs the second array.
+/// @param first the index of the first bitvector to process.
+/// @param last the index after the last bitvector to process.
+template <std::size_t N, typename Block>
+inline void sub(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first = 0, std::size_t last = bvlib::BitVectorArray<N, Block>::npos)
+{
+    bvlib::detail::batch_add_sub<true>(dst, lhs, rhs, first, last);
+}
+
+/// @brief Applies a bitwise operation to the bitvectors of two arrays, element by element.
+/// @param dst where the results are stored, it can be one of the operands.
+/// @param lhs the first array.
+/// @param rhs the second array.
+/// @param first the index of the first bitvector to process.
+/// @param last the index after the last bitvector to process.
+template <bvlib::simd::bitwise_op Op, std::size_t N, typename Block>
+inline void bitwise(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first = 0, std::size_t last = bvlib::BitVectorArray<N, Block>::npos)
+{
+    last = bvlib::detail::batch_range(dst, lhs, first, last);
+    last = bvlib::detail::batch_range(lhs, rhs, first, last);
+    for (std::size_t limb = 0; limb < dst.num_blocks; ++limb)
+        bvlib::simd::bitwise<Op>(dst.plane(limb) + first, lhs.plane(limb) + first, rhs.plane(limb) + first, last - first);
+}
+
+/// @brief Computes the bitwise and of the bitvectors of two arrays, element by element.
+template <std::size_t N, typename Block>
+inline void bitwise_and(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first = 0, std::size_t last = bvlib::BitVectorArray<N, Block>::npos)
+{
+    bvlib::bitwise<bvlib::simd::bitwise_op::op_and>(dst, lhs, rhs, first, last);
+}
+
+/// @brief Computes the bitwise or of the bitvectors of two arrays, element by element.
+template <std::size_t N, typename Block>
+inline void bitwise_or(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first = 0, std::size_t last = bvlib::BitVectorArray<N, Block>::npos)
+{
+    bvlib::bitwise<bvlib::simd::bitwise_op::op_or>(dst, lhs, rhs, first, last);
+}
+
+/// @brief Computes the bitwise xor of the bitvectors of two arrays, element by element.
+template <std::size_t N, typename Block>
+inline void bitwise_xor(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first = 0, std::size_t last = bvlib::BitVectorArray<N, Block>::npos)
+{
+    bvlib::bitwise<bvlib::simd::bitwise_op::op_xor>(dst, lhs, rhs, first, last);
+}
+
+/// @brief Compares the bitvectors of two arrays, element by element.
+/// @param result where the results are stored, it must hold (last - first)
+/// values, each one negative, zero or positive, if the bitvector of lhs is
+/// smaller, equal or greater than the one of rhs.
+/// @param lhs the first array.
+/// @param rhs the second array.
+/// @param first the index of the first bitvector to process.
+/// @param last the index after the last bitvector to process.
+template <std::size_t N, typename Block>
+inline void compare(int *result, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first = 0, std::size_t last = bvlib::BitVectorArray<N, Block>::npos)
+{
+    last = bvlib::detail::batch_range(lhs, rhs, first, last);
+    std::fill(result, result + (last - first), 0);
+    // From the most significant plane, the first one which differs decides.
+    for (std::size_t limb = lhs.num_blocks; limb > 0; --limb) {
+        const Block *a = lhs.plane(limb - 1) + first, *b = rhs.plane(limb - 1) + first;
+        for (std::size_t it = 0; it < last - first; ++it)
+            result[it] = result[it] ? result[it] : (static_cast<int>(a[it] > b[it]) - static_cast<int>(a[it] < b[it]));
+    }
+}
+
+/// @brief Counts the bits which are set in each bitvector of an array.
+/// @param result where the counts are stored, it must hold (last - first) values.
+/// @param array the array.
+/// @param first the index of the first bitvector to process.
+/// @param last the index after the last bitvector to process.
+template <std::size_t N, typename Block>
+inline void popcount(std::size_t *result, const bvlib::BitVectorArray<N, Block> &array, std::size_t first = 0, std::size_t last = bvlib::BitVectorArray<N, Block>::npos)
+{
+    last = bvlib::detail::batch_range(array, array, first, last);
+    std::fill(result, result + (last - first), std::size_t(0));
+    for (std::size_t limb = 0; limb < array.num_blocks; ++limb) {
+        const Block *a = array.plane(limb) + first;
+        for (std::size_t it = 0; it < last - first; ++it)
+            result[it] += bvlib::detail::popcount(a[it]);
+    }
+}
+
+} // namespace bvlib
@@ -0,0 +1,434 @@
+/// @file charconv.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Conversion of bitvectors from and to characters, in bases 2, 8, 10 and 16.
+/// @details The functions follow std::to_chars and std::from_chars: they
+/// write into, and read from, buffers provided by the caller, without
+/// allocating, without prefixes and signs, and report errors with std::errc.
+/// Bases 2, 8 and 16 move whole bytes at a time, while base 10 splits wide
+/// values by powers of 10^19 (divide and conquer), so that the divisions are
+/// between numbers of similar size.
+
+#pragma once
+
+#include "arena.hpp"
+#include "bitvector.hpp"
+#include "dynamic_bitvector.hpp"
+#include "intrinsics.hpp"
+#include "math.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+/// @brief Number of 64-bit blocks up to which the decimal conversion divides
+/// by 10^19 repeatedly, instead of splitting the value in two halves. It can be
+/// tuned by defining it before including this header.
+#ifndef BVLIB_DECIMAL_THRESHOLD
+#define BVLIB_DECIMAL_THRESHOLD 16
+#endif
+
+namespace bvlib
+{
+
+/// @brief The result of to_chars.
+struct to_chars_result {
+    /// One past the last character written, or last on error.
+    char *ptr;
+    /// The error, which is value-initialized on success.
+    std::errc ec;
+};
+
+/// @brief The result of from_chars.
+struct from_chars_result {
+    /// One past the last character parsed.
+    const char *ptr;
+    /// The error, which is value-initialized on success.
+    std::errc ec;
+};
+
+/// @brief Returns the largest number of characters written by to_chars.
+/// @param bits the number of bits of the bitvector.
+/// @param base the base, i.e., 2, 8, 10 or 16.
+/// @return the number of characters.
+constexpr inline std::size_t max_chars(std::size_t bits, int base)
+{
+    if (bits == 0)
+        return 1;
+    if (base == 10)
+        return bits * 30103 / 100000 + 1;
+    const std::size_t digit_bits = (base == 2) ? 1 : ((base == 8) ? 3 : 4);
+    return (bits + digit_bits - 1) / digit_bits;
+}
+
+namespace detail
+{
+
+/// The decimal digits of the numbers from 00 to 99.
+constexpr char decimal_pairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+/// The hexadecimal digits of the numbers from 00 to ff.
+constexpr char hexadecimal_pairs[] = "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9fa0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebfc0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedfe0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+/// @brief Returns the value of a digit, or 255 if the character is not a digit of the base.
+constexpr inline unsigned digit_value(char c, unsigned base)
+{
+    const unsigned value = (c >= '0' && c <= '9') ? unsigned(c - '0') : ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') ? unsigned((c | 0x20) - 'a' + 10) : 255U;
+    return (value < base) ? value : 255U;
+}
+
+/// @brief Returns the number of bits up to the most significant one.
+template <typename Block>
+constexpr inline std::size_t significant_bits(const Block *data, std::size_t num_blocks)
+{
+    const std::size_t size = bvlib::detail::significant_blocks(data, num_blocks);
+    return size ? (size * bvlib::detail::digits<Block>() - bvlib::detail::countl_zero(data[size - 1])) : 0;
+}
+
+/// @brief Extracts up to 8 bits, starting at the given position.
+template <typename Block>
+constexpr inline unsigned extract_bits(const Block *data, std::size_t num_blocks, std::size_t position, std::size_t count)
+{
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    const std::size_t block = position / bits_per_block, offset = position % bits_per_block;
+    std::uint64_t value     = static_cast<std::uint64_t>(data[block]) >> offset;
+    if ((offset + count > bits_per_block) && (block + 1 < num_blocks))
+        value |= static_cast<std::uint64_t>(data[block + 1]) << (bits_per_block - offset);
+    return static_cast<unsigned>(value & ((1U << count) - 1U));
+}
+
+/// @brief Turns a byte into its eight binary digits, the most significant one first in memory.
+/// @details Each byte of the result receives a copy of the input, masked with
+/// a different bit, and the addition moves the bit into the top of the byte.
+constexpr inline void expand_byte(char *dst, unsigned byte)
+{
+    std::uint64_t value = (byte * 0x0101010101010101ULL) & 0x0102040810204080ULL;
+    value               = (((value + 0x7F7F7F7F7F7F7F7FULL) >> 7U) & 0x0101010101010101ULL) | 0x3030303030303030ULL;
+    for (std::size_t it = 0; it < 8; ++it)
+        dst[it] = static_cast<char>(value >> (8 * it));
+}
+
+/// @brief Writes a number with a base which is a power of two.
+template <typename Block>
+inline to_chars_result to_chars_power2(char *first, char *last, const Block *data, std::size_t num_blocks, std::size_t digit_bits)
+{
+    const std::size_t bits   = bvlib::detail::significant_bits(data, num_blocks);
+    const std::size_t digits = bits ? (bits + digit_bits - 1) / digit_bits : 1;
+    if (static_cast<std::size_t>(last - first) < digits)
+        return { last, std::errc::value_too_large };
+    // Digits are counted from the least significant one, at the end of the output.
+    char *end      = first + digits;
+    std::size_t it = 0;
+    if (digit_bits == 4) {
+        for (; it + 2 <= digits; it += 2)
+            std::memcpy(end - it - 2, hexadecimal_pairs + 2 * bvlib::detail::extract_bits(data, num_blocks, 4 * it, 8), 2);
+    } else if (digit_bits == 1) {
+        for (; it + 8 <= digits; it += 8)
+            bvlib::detail::expand_byte(end - it - 8, bvlib::detail::extract_bits(data, num_blocks, it, 8));
+    }
+    for (; it < digits; ++it)
+        end[-1 - static_cast<std::ptrdiff_t>(it)] = hexadecimal_pairs[2 * bvlib::detail::extract_bits(data, num_blocks, digit_bits * it, digit_bits) + 1];
+    return { end, std::errc() };
+}
+
+/// @brief Parses a number with a base which is a power of two.
+template <typename Block>
+inline from_chars_result from_chars_power2(const char *first, const char *last, Block *data, std::size_t num_blocks, std::size_t size, std::size_t digit_bits)
+{
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    const unsigned base                  = 1U << digit_bits;
+    const char *end = first, *begin = first;
+    for (; (end != last) && (bvlib::detail::digit_value(*end, base) != 255U); ++end) {}
+    if (end == first)
+        return { first, std::errc::invalid_argument };
+    for (; (begin + 1 < end) && (*begin == '0'); ++begin) {}
+    const std::size_t bits = static_cast<std::size_t>(end - begin - 1) * digit_bits + (bvlib::detail::digits<unsigned>() - bvlib::detail::countl_zero(bvlib::detail::digit_value(*begin, base)));
+    if (bits > size)
+        return { end, std::errc::result_out_of_range };
+    for (std::size_t it = 0; it < num_blocks; ++it)
+        data[it] = 0;
+    for (std::size_t it = 0, position = 0; it < static_cast<std::size_t>(end - begin); ++it, position += digit_bits) {
+        const std::uint64_t value = bvlib::detail::digit_value(end[-1 - static_cast<std::ptrdiff_t>(it)], base);
+        data[position / bits_per_block] |= static_cast<Block>(value << (position % bits_per_block));
+        if ((position % bits_per_block + digit_bits > bits_per_block) && (position / bits_per_block + 1 < num_blocks))
+            data[position / bits_per_block + 1] |= static_cast<Block>(value >> (bits_per_block - position % bits_per_block));
+    }
+    return { end, std::errc() };
+}
+
+/// @brief Copies blocks into 64-bit blocks.
+template <typename Block>
+inline void load_limbs(std::uint64_t *limbs, std::size_t num_limbs, const Block *data, std::size_t num_blocks)
+{
+    static_assert(64 % bvlib::detail::digits<Block>() == 0, "Blocks wider than 64 bits are not supported");
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    for (std::size_t it = 0; it < num_limbs; ++it)
+        limbs[it] = 0;
+    for (std::size_t it = 0; it < num_blocks; ++it)
+        limbs[it * bits_per_block / 64] |= static_cast<std::uint64_t>(data[it]) << (it * bits_per_block % 64);
+}
+
+/// @brief Copies 64-bit blocks into blocks.
+template <typename Block>
+inline void store_limbs(Block *data, std::size_t num_blocks, const std::uint64_t *limbs, std::size_t num_limbs)
+{
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    for (std::size_t it = 0; it < num_blocks; ++it)
+        data[it] = (it * bits_per_block / 64 < num_limbs) ? static_cast<Block>(limbs[it * bits_per_block / 64] >> (it * bits_per_block % 64)) : Block(0);
+}
+
+/// The largest power of 10 which fits in 64 bits, i.e., 10^19.
+constexpr std::uint64_t decimal_base = 10000000000000000000ULL;
+
+/// The number of decimal digits held by a block divided by decimal_base.
+constexpr std::size_t decimal_base_digits = 19;
+
+/// @brief A power of 10^19, prepared for divmod_prepared.
+struct decimal_power {
+    /// The blocks of the power, shifted left until the most significant bit is set.
+    const std::uint64_t *normalized;
+    /// The number of blocks of the power.
+    std::size_t size;
+    /// The number of bits of the normalization.
+    std::size_t shift;
+    /// The reciprocal of the most significant normalized block.
+    std::uint64_t reciprocal;
+    /// The exponent of the power, i.e., the number of digits it splits.
+    std::size_t digits;
+};
+
+/// @brief Writes exactly count digits of a value, ending at end.
+constexpr inline void write_digits(char *end, std::uint64_t value, std::size_t count)
+{
+    for (; count >= 2; count -= 2, value /= 100) {
+        end -= 2;
+        end[0] = decimal_pairs[2 * (value % 100)];
+        end[1] = decimal_pairs[2 * (value % 100) + 1];
+    }
+    if (count)
+        end[-1] = static_cast<char>('0' + value % 10);
+}
+
+/// @brief Writes exactly width digits of a value, dividing it by 10^19 repeatedly.
+inline void write_decimal_small(const std::uint64_t *value, std::size_t size, char *out, std::size_t width, Arena &arena)
+{
+    // 10^19 has its most significant bit set, so it needs no normalization.
+    static const std::uint64_t reciprocal = bvlib::detail::reciprocal_2by1(decimal_base);
+    ArenaScope scope(arena);
+    std::uint64_t *quotient = arena.allocate<std::uint64_t>(size);
+    std::memcpy(quotient, value, size * sizeof(std::uint64_t));
+    for (char *end = out + width; width;) {
+        if (size == 0) {
+            std::memset(out, '0', width);
+            return;
+        }
+        std::uint64_t remainder = 0;
+        for (std::size_t it = size; it-- > 0;)
+            quotient[it] = bvlib::detail::div_2by1(remainder, quotient[it], decimal_base, reciprocal, remainder);
+        size                    = bvlib::detail::significant_blocks(quotient, size);
+        const std::size_t count = std::min(width, decimal_base_digits);
+        bvlib::detail::write_digits(end, remainder, count);
+        end -= count, width -= count;
+    }
+}
+
+/// @brief Writes exactly width digits of a value, splitting it in two halves by a power of 10^19.
+/// @param value the blocks of the value, which is smaller than 10^width.
+/// @param size the number of blocks of the value.
+/// @param out where the digits are written.
+/// @param width the number of digits.
+/// @param powers the powers 10^19, 10^38, 10^76, and so on.
+/// @param levels the number of powers.
+/// @param arena where the temporaries are allocated.
+inline void write_decimal(const std::uint64_t *value, std::size_t size, char *out, std::size_t width, const decimal_power *powers, std::size_t levels, Arena &arena)
+{
+    size = bvlib::detail::significant_blocks(value, size);
+    // The largest power with fewer digits than the value, so the low part has at least half of them.
+    for (; (levels > 0) && (powers[levels - 1].digits >= width); --levels) {}
+    if ((size <= BVLIB_DECIMAL_THRESHOLD) || (levels == 0)) {
+        bvlib::detail::write_decimal_small(value, size, out, width, arena);
+        return;
+    }
+    const decimal_power &power = powers[levels - 1];
+    ArenaScope scope(arena);
+    std::uint64_t *quotient  = arena.allocate<std::uint64_t>(size);
+    std::uint64_t *remainder = arena.allocate<std::uint64_t>(size);
+    std::uint64_t *scratch   = arena.allocate<std::uint64_t>(size + 1);
+    bvlib::detail::divmod_prepared(quotient, remainder, value, size, power.normalized, power.size, power.shift, power.reciprocal, scratch);
+    bvlib::detail::write_decimal(quotient, size, out, width - power.digits, powers, levels, arena);
+    bvlib::detail::write_decimal(remainder, std::min(size, power.size), out + width - power.digits, power.digits, powers, levels, arena);
+}
+
+/// @brief Writes a number in base 10.
+template <typename Block>
+inline to_chars_result to_chars_decimal(char *first, char *last, const Block *data, std::size_t num_blocks)
+{
+    ArenaScope scope;
+    Arena &arena                = scope.arena();
+    const std::size_t num_limbs = (num_blocks * bvlib::detail::digits<Block>() + 63) / 64;
+    std::uint64_t *limbs        = arena.allocate<std::uint64_t>(num_limbs);
+    bvlib::detail::load_limbs(limbs, num_limbs, data, num_blocks);
+    const std::size_t size = bvlib::detail::significant_blocks(limbs, num_limbs);
+    if (size <= 1) {
+        const std::uint64_t value = size ? limbs[0] : 0;
+        std::size_t digits        = 1;
+        for (std::uint64_t it = value; it >= 10; it /= 10)
+            ++digits;
+        if (static_cast<std::size_t>(last - first) < digits)
+            return { last, std::errc::value_too_large };
+        bvlib::detail::write_digits(first + digits, value, digits);
+        return { first + digits, std::errc() };
+    }
+    const std::size_t width = bvlib::max_chars(bvlib::detail::significant_bits(limbs, size), 10);
+    decimal_power *powers   = nullptr;
+    std::size_t levels      = 0;
+    if (size > BVLIB_DECIMAL_THRESHOLD) {
+        // Prepare the powers 10^(19 * 2^k) which have fewer digits than the value.
+        powers                   = arena.allocate<decimal_power>(bvlib::detail::digits<std::size_t>());
+        std::uint64_t *current   = arena.allocate<std::uint64_t>(1);
+        std::size_t current_size = 1;
+        current[0]               = decimal_base;
+        for (std::size_t exponent = decimal_base_digits; exponent < width; exponent *= 2) {
+            std::uint64_t *normalized = arena.allocate<std::uint64_t>(current_size);
+            const std::size_t shift   = bvlib::detail::countl_zero(current[current_size - 1]);
+            bvlib::detail::shift_left_bits(normalized, current, current_size, shift);
+            powers[levels++] = { normalized, current_size, shift, bvlib::detail::reciprocal_2by1(normalized[current_size - 1]), exponent };
+            if (2 * exponent >= width)
+                break;
+            std::uint64_t *square  = arena.allocate<std::uint64_t>(2 * current_size);
+            std::uint64_t *scratch = arena.allocate<std::uint64_t>(bvlib::detail::karatsuba_scratch_size(current_size) + 1);
+            bvlib::detail::mul_blocks(square, current, current, current_size, scratch);
+            current      = square;
+            current_size = bvlib::detail::significant_blocks(square, 2 * current_size);
+        }
+    }
+    char *buffer = arena.allocate<char>(width);
+    bvlib::detail::write_decimal(limbs, size, buffer, width, powers, levels, arena);
+    const char *begin = buffer;
+    for (; (begin + 1 < buffer + width) && (*begin == '0'); ++begin) {}
+    const std::size_t digits = static_cast<std::size_t>(buffer + width - begin);
+    if (static_cast<std::size_t>(last - first) < digits)
+        return { last, std::errc::value_too_large };
+    std::memcpy(first, begin, digits);
+    return { first + digits, std::errc() };
+}
+
+/// @brief Parses a number in base 10.
+template <typename Block>
+inline from_chars_result from_chars_decimal(const char *first, const char *last, Block *data, std::size_t num_blocks, std::size_t size)
+{
+    static constexpr std::uint64_t powers[] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL };
+    const char *end = first, *begin = first;
+    for (; (end != last) && (*end >= '0') && (*end <= '9'); ++end) {}
+    if (end == first)
+        return { first, std::errc::invalid_argument };
+    for (; (begin + 1 < end) && (*begin == '0'); ++begin) {}
+    ArenaScope scope;
+    const std::size_t num_limbs = (size + 63) / 64 + 1;
+    std::uint64_t *limbs        = scope.arena().allocate<std::uint64_t>(num_limbs);
+    std::size_t used            = 0;
+    // Multiply by 10^19 and add the next 19 digits, the first group taking the leftover digits.
+    for (std::size_t group = (static_cast<std::size_t>(end - begin) - 1) % decimal_base_digits + 1; begin != end; begin += group, group = decimal_base_digits) {
+        std::uint64_t carry = 0;
+        for (const char *it = begin; it != begin + group; ++it)
+            carry = carry * 10 + static_cast<std::uint64_t>(*it - '0');
+        for (std::size_t it = 0; it < used; ++it) {
+            std::uint64_t high = 0;
+            limbs[it]          = bvlib::detail::mul_wide(limbs[it], powers[group], high);
+            high += bvlib::detail::addcarry(limbs[it], carry, false, limbs[it]);
+            carry = high;
+        }
+        if (carry) {
+            if (used == num_limbs)
+                return { end, std::errc::result_out_of_range };
+            limbs[used++] = carry;
+        }
+    }
+    if (bvlib::detail::significant_bits(limbs, used) > size)
+        return { end, std::errc::result_out_of_range };
+    bvlib::detail::store_limbs(data, num_blocks, limbs, used);
+    return { end, std::errc() };
+}
+
+/// @brief Writes a number in the given base.
+template <typename Block>
+inline to_chars_result to_chars(char *first, char *last, const Block *data, std::size_t num_blocks, int base)
+{
+    if (base == 10)
+        return bvlib::detail::to_chars_decimal(first, last, data, num_blocks);
+    if ((base == 2) || (base == 8) || (base == 16))
+        return bvlib::detail::to_chars_power2(first, last, data, num_blocks, (base == 2) ? 1 : ((base == 8) ? 3 : 4));
+    return { last, std::errc::invalid_argument };
+}
+
+/// @brief Parses a number in the given base.
+template <typename Block>
+inline from_chars_result from_chars(const char *first, const char *last, Block *data, std::size_t num_blocks, std::size_t size, int base)
+{
+    if (base == 10)
+        return bvlib::detail::from_chars_decimal(first, last, data, num_blocks, size);
+    if ((base == 2) || (base == 8) || (base == 16))
+        return bvlib::detail::from_chars_power2(first, last, data, num_blocks, size, (base == 2) ? 1 : ((base == 8) ? 3 : 4));
+    return { first, std::errc::invalid_argument };
+}
+
+} // namespace detail
+
+/// @brief Writes the unsigned value of a bitvector into a buffer.
+/// @param first the beginning of the buffer.
+/// @param last the end of the buffer.
+/// @param value the bitvector.
+/// @param base the base, i.e., 2, 8, 10 or 16.
+/// @return the end of the written characters, or last and std::errc::value_too_large if the buffer is too small.
+template <std::size_t N, typename Block>
+inline to_chars_result to_chars(char *first, char *last, const BitVector<N, Block> &value, int base = 10)
+{
+    return bvlib::detail::to_chars(first, last, value.data, BitVector<N, Block>::num_blocks, base);
+}
+
+/// @brief Writes the unsigned value of a bitvector into a buffer.
+/// @param first the beginning of the buffer.
+/// @param last the end of the buffer.
+/// @param value the bitvector.
+/// @param base the base, i.e., 2, 8, 10 or 16.
+/// @return the end of the written characters, or last and std::errc::value_too_large if the buffer is too small.
+template <typename Block, typename Allocator>
+inline to_chars_result to_chars(char *first, char *last, const DynamicBitVector<Block, Allocator> &value, int base = 10)
+{
+    return bvlib::detail::to_chars(first, last, value.data(), value.num_blocks(), base);
+}
+
+/// @brief Parses the unsigned value of a bitvector from a buffer.
+/// @param first the beginning of the buffer.
+/// @param last the end of the buffer.
+/// @param value the bitvector, which is modified only on success.
+/// @param base the base, i.e., 2, 8, 10 or 16.
+/// @return the end of the digits, with std::errc::invalid_argument if there are none, and
+/// std::errc::result_out_of_range if the value does not fit inside the bitvector.
+template <std::size_t N, typename Block>
+inline from_chars_result from_chars(const char *first, const char *last, BitVector<N, Block> &value, int base = 10)
+{
+    BitVector<N, Block> result;
+    const from_chars_result outcome = bvlib::detail::from_chars(first, last, result.data, BitVector<N, Block>::num_blocks, N, base);
+    if (outcome.ec == std::errc())
+        value = result;
+    return outcome;
+}
+
+/// @brief Parses the unsigned value of a bitvector from a buffer, keeping its size.
+/// @param first the beginning of the buffer.
+/// @param last the end of the buffer.
+/// @param value the bitvector, which is modified only on success.
+/// @param base the base, i.e., 2, 8, 10 or 16.
+/// @return the end of the digits, with std::errc::invalid_argument if there are none, and
+/// std::errc::result_out_of_range if the value does not fit inside the bitvector.
+template <typename Block, typename Allocator>
+inline from_chars_result from_chars(const char *first, const char *last, DynamicBitVector<Block, Allocator> &value, int base = 10)
+{
+    DynamicBitVector<Block, Allocator> result(value.size(), value.get_allocator());
+    const from_chars_result outcome = bvlib::detail::from_chars(first, last, result.data(), result.num_blocks(), result.size(), base);
+    if (outcome.ec == std::errc())
+        value = std::move(result);
+    return outcome;
+}
+
+} // namespace bvlib
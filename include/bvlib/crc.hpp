@@ -0,0 +1,216 @@
+/// @file crc.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Table-driven cyclic redundancy checks, of up to 64 bits.
+/// @details The CRC is defined by its width, polynomial, initial value, bit
+/// order and final xor, like in the catalogue of parametrised CRC algorithms.
+/// It processes 64 bits at a time with eight tables (slicing-by-8), so each
+/// word costs eight lookups instead of 64 conditional xors. The bitvectors
+/// are read as their (N + 7) / 8 bytes, least significant first, which is also
+/// their binary serialization.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "dynamic_bitvector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace bvlib
+{
+
+/// @brief A cyclic redundancy check.
+class Crc {
+public:
+    /// @brief Prepares the tables of the CRC.
+    /// @param width the number of bits of the CRC, from 1 to 64.
+    /// @param polynomial the polynomial, without the x^width term, most significant bit first.
+    /// @param init the initial value of the register.
+    /// @param reflected whether the bytes, and the result, are processed least significant bit first.
+    /// @param xor_out the value which is xored with the final register.
+    Crc(std::size_t width, std::uint64_t polynomial, std::uint64_t init, bool reflected, std::uint64_t xor_out)
+        : _width(width),
+          _mask((width < 64) ? ((std::uint64_t(1) << width) - 1U) : ~std::uint64_t(0)),
+          _start(),
+          _reflected(reflected),
+          _xor_out(xor_out & _mask),
+          _tables()
+    {
+        if ((width == 0) || (width > 64))
+            throw std::invalid_argument("the width of the CRC must be between 1 and 64");
+        polynomial &= _mask;
+        init &= _mask;
+        // The reflected register is aligned to the least significant bit, the other one to the most significant bit.
+        const std::uint64_t feedback = reflected ? Crc::reflect(polynomial, width) : (polynomial << (64 - width));
+        for (std::uint64_t byte = 0; byte < 256; ++byte) {
+            std::uint64_t value = reflected ? byte : (byte << 56);
+            for (std::size_t it = 0; it < 8; ++it) {
+                if (reflected)
+                    value = (value >> 1) ^ ((value & 1U) ? feedback : 0U);
+                else
+                    value = (value << 1) ^ ((value >> 63) ? feedback : 0U);
+            }
+            _tables[0][byte] = value;
+        }
+        // The byte followed by one more zero byte, for each table.
+        for (std::size_t table = 1; table < 8; ++table)
+            for (std::size_t byte = 0; byte < 256; ++byte)
+                _tables[table][byte] = this->shift_byte(_tables[table - 1][byte], 0);
+        _start = reflected ? Crc::reflect(init, width) : (init << (64 - width));
+    }
+
+    /// @brief Returns the CRC-32 of zlib, PNG and Ethernet.
+    static inline Crc crc32()
+    {
+        return Crc(32, 0x04C11DB7U, 0xFFFFFFFFU, true, 0xFFFFFFFFU);
+    }
+
+    /// @brief Returns the CRC-32C (Castagnoli) of iSCSI and ext4.
+    static inline Crc crc32c()
+    {
+        return Crc(32, 0x1EDC6F41U, 0xFFFFFFFFU, true, 0xFFFFFFFFU);
+    }
+
+    /// @brief Returns the CRC-64 of xz.
+    static inline Crc crc64_xz()
+    {
+        return Crc(64, 0x42F0E1EBA9EA3693ULL, ~std::uint64_t(0), true, ~std::uint64_t(0));
+    }
+
+    /// @brief Returns the number of bits of the CRC.
+    inline std::size_t width() const
+    {
+        return _width;
+    }
+
+    /// @brief Returns the CRC of the empty message, which starts a computation in steps.
+    inline std::uint64_t initial() const
+    {
+        return this->from_register(_start);
+    }
+
+    /// @brief Updates the CRC with more bytes.
+    /// @param crc the CRC of the previous bytes, or initial().
+    /// @param data the bytes.
+    /// @param size the number of bytes.
+    /// @return the CRC of the previous bytes followed by the given ones.
+    inline std::uint64_t update(std::uint64_t crc, const void *data, std::size_t size) const
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        std::uint64_t value        = this->to_register(crc);
+        for (; size >= 8; size -= 8, bytes += 8) {
+            std::uint64_t word = 0;
+            for (std::size_t it = 0; it < 8; ++it)
+                word |= static_cast<std::uint64_t>(bytes[it]) << (_reflected ? (8 * it) : (56 - 8 * it));
+            word ^= value;
+            value = 0;
+            // The first byte travels through all the tables, the last one through one.
+            for (std::size_t it = 0; it < 8; ++it)
+                value ^= _tables[7 - it][(word >> (_reflected ? (8 * it) : (56 - 8 * it))) & 0xFFU];
+        }
+        for (; size > 0; --size, ++bytes)
+            value = this->shift_byte(value, *bytes);
+        return this->from_register(value);
+    }
+
+    /// @brief Computes the CRC of the bytes.
+    inline std::uint64_t compute(const void *data, std::size_t size) const
+    {
+        return this->update(this->initial(), data, size);
+    }
+
+    /// @brief Updates the CRC with the bytes of the bitvector.
+    template <std::size_t N, typename Block>
+    inline std::uint64_t update(std::uint64_t crc, const BitVector<N, Block> &bitvector) const
+    {
+        return this->update_blocks(crc, bitvector.data, (N + 7) / 8);
+    }
+
+    /// @brief Updates the CRC with the bytes of the bitvector.
+    template <typename Block, typename Allocator>
+    inline std::uint64_t update(std::uint64_t crc, const DynamicBitVector<Block, Allocator> &bitvector) const
+    {
+        return this->update_blocks(crc, bitvector.data(), (bitvector.size() + 7) / 8);
+    }
+
+    /// @brief Computes the CRC of the bytes of the bitvector.
+    template <std::size_t N, typename Block>
+    inline std::uint64_t compute(const BitVector<N, Block> &bitvector) const
+    {
+        return this->update(this->initial(), bitvector);
+    }
+
+    /// @brief Computes the CRC of the bytes of the bitvector.
+    template <typename Block, typename Allocator>
+    inline std::uint64_t compute(const DynamicBitVector<Block, Allocator> &bitvector) const
+    {
+        return this->update(this->initial(), bitvector);
+    }
+
+private:
+    /// @brief Reverses the lowest bits of the value.
+    static inline std::uint64_t reflect(std::uint64_t value, std::size_t width)
+    {
+        std::uint64_t result = 0;
+        for (std::size_t it = 0; it < width; ++it, value >>= 1)
+            result = (result << 1) | (value & 1U);
+        return result;
+    }
+
+    /// @brief Processes one byte.
+    inline std::uint64_t shift_byte(std::uint64_t value, unsigned char byte) const
+    {
+        if (_reflected)
+            return (value >> 8) ^ _tables[0][(value ^ byte) & 0xFFU];
+        return (value << 8) ^ _tables[0][(value >> 56) ^ byte];
+    }
+
+    /// @brief Converts a CRC to the content of the register.
+    inline std::uint64_t to_register(std::uint64_t crc) const
+    {
+        // The reflected register already holds the reflected CRC.
+        crc = (crc ^ _xor_out) & _mask;
+        return _reflected ? crc : (crc << (64 - _width));
+    }
+
+    /// @brief Converts the content of the register to a CRC.
+    inline std::uint64_t from_register(std::uint64_t value) const
+    {
+        return (_reflected ? value : (value >> (64 - _width))) ^ _xor_out;
+    }
+
+    /// @brief Updates the CRC with the first bytes of the blocks, in chunks.
+    template <typename Block>
+    inline std::uint64_t update_blocks(std::uint64_t crc, const Block *data, std::size_t size) const
+    {
+        constexpr std::size_t bytes_per_block = sizeof(Block);
+        unsigned char buffer[256];
+        for (std::size_t offset = 0; offset < size; offset += sizeof(buffer)) {
+            const std::size_t count = std::min(sizeof(buffer), size - offset);
+            for (std::size_t it = 0; it < count; ++it) {
+                const std::size_t byte = offset + it;
+                buffer[it]             = static_cast<unsigned char>(data[byte / bytes_per_block] >> (8 * (byte % bytes_per_block)));
+            }
+            crc = this->update(crc, buffer, count);
+        }
+        return crc;
+    }
+
+    /// The number of bits of the CRC.
+    std::size_t _width;
+    /// The mask of the bits of the CRC.
+    std::uint64_t _mask;
+    /// The initial content of the register.
+    std::uint64_t _start;
+    /// Whether the bits are processed least significant first.
+    bool _reflected;
+    /// The value xored with the final register.
+    std::uint64_t _xor_out;
+    /// The tables of the bytes followed by 0 to 7 zero bytes.
+    std::array<std::array<std::uint64_t, 256>, 8> _tables;
+};
+
+} // namespace bvlib
@@ -0,0 +1,1222 @@
+/// @file dynamic_bitvector.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Bitvector whose size is chosen at runtime.
+
+#pragma once
+
+#include "arena.hpp"
+#include "bitvector.hpp"
+#include "math.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#endif
+
+namespace bvlib
+{
+
+/// @brief Bitvector whose number of bits is chosen at runtime.
+/// @tparam Block The unsigned integer type used to store the bits.
+/// @tparam Allocator The allocator used when the bits do not fit inside the object.
+/// @details The bits are packed exactly like inside BitVector, and the same
+/// block kernels are used to operate on them. Up to inline_bits bits are stored
+/// inside the object itself, so small bitvectors never allocate. The
+/// intermediate values of multiplications and divisions are taken from the
+/// arena of the calling thread, so only their results use the Allocator.
+template <typename Block = std::uint64_t, typename Allocator = std::allocator<Block>>
+class DynamicBitVector {
+    static_assert(std::is_unsigned<Block>::value && !std::is_same<Block, bool>::value,
+                  "The block type must be an unsigned integer type");
+    static_assert(std::is_same<typename std::allocator_traits<Allocator>::value_type, Block>::value,
+                  "The allocator must allocate blocks");
+
+    /// The traits of the allocator.
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+public:
+    /// The type used to store the bits.
+    using block_type = Block;
+
+    /// The type of the allocator.
+    using allocator_type = Allocator;
+
+    /// Proxy which allows to access a single bit as if it was a bool.
+    using reference = typename BitVector<1, Block>::reference;
+
+    /// The number of bits stored inside a block.
+    static constexpr std::size_t bits_per_block = static_cast<std::size_t>(std::numeric_limits<Block>::digits);
+
+    /// The number of bits which are stored inside the object, without allocating.
+    static constexpr std::size_t inline_bits = 128;
+
+    /// The number of blocks which are stored inside the object, without allocating.
+    static constexpr std::size_t inline_blocks = (inline_bits + bits_per_block - 1) / bits_per_block;
+
+    /// The value returned by the search functions when no bit is found.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// @brief Construct an empty bitvector.
+    /// @param allocator the allocator.
+    explicit DynamicBitVector(const Allocator &allocator = Allocator()) noexcept
+        : _size(),
+          _capacity(inline_blocks),
+          _storage(),
+          _allocator(allocator)
+    {
+    }
+
+    /// @brief Construct a new bitvector of the given size, with all bits set to zero.
+    /// @param size the number of bits.
+    /// @param allocator the allocator.
+    explicit DynamicBitVector(std::size_t size, const Allocator &allocator = Allocator())
+        : DynamicBitVector(allocator)
+    {
+        this->resize(size);
+    }
+
+    /// @brief Construct a new bitvector of the given size, and intializes it with the given value.
+    /// @param size the number of bits.
+    /// @param value the initial value.
+    /// @param allocator the allocator.
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    DynamicBitVector(std::size_t size, T value, const Allocator &allocator = Allocator())
+        : DynamicBitVector(size, allocator)
+    {
+        const BitVector<bvlib::detail::digits<T>() + std::is_signed<T>::value, Block> bits(value);
+        this->assign_blocks(bits.data, bits.num_blocks);
+    }
+
+    /// @brief Construct a new bitvector based on the given string (e.g. "1010111"),
+    /// with one bit for each character.
+    /// @param str the input string.
+    /// @param allocator the allocator.
+    explicit DynamicBitVector(const std::string &str, const Allocator &allocator = Allocator())
+        : DynamicBitVector(str.length(), allocator)
+    {
+        Block *blocks = this->data();
+        for (std::string::size_type it = 0, len = str.length(); it < len; ++it)
+            if (str[len - 1 - it] == '1')
+                blocks[it / bits_per_block] |= static_cast<Block>(Block(1) << (it % bits_per_block));
+    }
+
+    /// @brief Copies the given bitvector, of size N, into this one.
+    /// @param other the other bitvector.
+    /// @param allocator the allocator.
+    template <std::size_t N>
+    explicit DynamicBitVector(const BitVector<N, Block> &other, const Allocator &allocator = Allocator())
+        : DynamicBitVector(N, allocator)
+    {
+        this->assign_blocks(other.data, other.num_blocks);
+    }
+
+    /// @brief Copies the other bitvector.
+    DynamicBitVector(const DynamicBitVector &other)
+        : DynamicBitVector(other, allocator_traits::select_on_container_copy_construction(other._allocator))
+    {
+    }
+
+    /// @brief Copies the other bitvector, using the given allocator.
+    DynamicBitVector(const DynamicBitVector &other, const Allocator &allocator)
+        : DynamicBitVector(other._size, allocator)
+    {
+        this->assign_blocks(other.data(), other.num_blocks());
+    }
+
+    /// @brief Moves the other bitvector, which is left empty.
+    DynamicBitVector(DynamicBitVector &&other) noexcept
+        : DynamicBitVector(other._allocator)
+    {
+        this->steal(other);
+    }
+
+    ~DynamicBitVector()
+    {
+        this->release();
+    }
+
+    /// @brief Copies the other bitvector, including its size.
+    DynamicBitVector &operator=(const DynamicBitVector &other)
+    {
+        if (this != &other) {
+            if constexpr (allocator_traits::propagate_on_container_copy_assignment::value) {
+                if (_allocator != other._allocator) {
+                    this->release();
+                    _allocator = other._allocator;
+                }
+            }
+            this->resize(0);
+            this->resize(other._size);
+            this->assign_blocks(other.data(), other.num_blocks());
+        }
+        return *this;
+    }
+
+    /// @brief Moves the other bitvector, including its size.
+    DynamicBitVector &operator=(DynamicBitVector &&other) noexcept(allocator_traits::propagate_on_container_move_assignment::value || allocator_traits::is_always_equal::value)
+    {
+        if (this != &other) {
+            if constexpr (allocator_traits::propagate_on_container_move_assignment::value) {
+                this->release();
+                _allocator = std::move(other._allocator);
+            } else if (_allocator != other._allocator) {
+                // The storage cannot be stolen, copy the blocks instead.
+                return this->operator=(static_cast<const DynamicBitVector &>(other));
+            } else {
+                this->release();
+            }
+            this->steal(other);
+        }
+        return *this;
+    }
+
+    /// @brief Copies rhs into this bitvector, keeping the current size.
+    template <std::size_t N2>
+    inline DynamicBitVector &operator=(const BitVector<N2, Block> &rhs)
+    {
+        return this->assign(rhs);
+    }
+
+    /// @brief Transforms rhs into a bitvector, keeping the current size.
+    inline DynamicBitVector &operator=(std::size_t rhs)
+    {
+        const BitVector<bvlib::detail::digits<std::size_t>(), Block> bits(rhs);
+        return this->assign_blocks(bits.data, bits.num_blocks);
+    }
+
+    /// @brief Transforms rhs into a bitvector, keeping the current size.
+    inline DynamicBitVector &operator=(const std::string &str)
+    {
+        this->reset();
+        Block *blocks = this->data();
+        for (std::string::size_type it = 0, len = std::min<std::string::size_type>(str.length(), _size); it < len; ++it)
+            if (str[str.length() - 1 - it] == '1')
+                blocks[it / bits_per_block] |= static_cast<Block>(Block(1) << (it % bits_per_block));
+        return *this;
+    }
+
+    /// @brief Converts this bitvector to one of size N, discarding the bits which do not fit.
+    template <std::size_t N>
+    explicit operator BitVector<N, Block>() const
+    {
+        BitVector<N, Block> result;
+        const std::size_t min_blocks = std::min(result.num_blocks, this->num_blocks());
+        for (std::size_t it = 0; it < min_blocks; ++it)
+            result.data[it] = this->data()[it];
+        result.data[result.num_blocks - 1] &= result.last_block_mask;
+        return result;
+    }
+
+    /// @brief Returns a bitvector of all ones.
+    static inline DynamicBitVector ones(std::size_t size, const Allocator &allocator = Allocator())
+    {
+        return std::move(DynamicBitVector(size, allocator).flip());
+    }
+
+    /// @brief Returns a bitvector of all zeros.
+    static inline DynamicBitVector zeros(std::size_t size, const Allocator &allocator = Allocator())
+    {
+        return DynamicBitVector(size, allocator);
+    }
+
+    /// @brief Returns the allocator.
+    inline allocator_type get_allocator() const
+    {
+        return _allocator;
+    }
+
+    /// @brief Returns the size of the bit-vector.
+    inline auto size() const -> std::size_t
+    {
+        return _size;
+    }
+
+    /// @brief Tests whether the bitvector has no bits.
+    inline auto empty() const -> bool
+    {
+        return _size == 0;
+    }
+
+    /// @brief Returns the number of blocks used to store the bits.
+    inline auto num_blocks() const -> std::size_t
+    {
+        return (_size + bits_per_block - 1) / bits_per_block;
+    }
+
+    /// @brief Returns the mask of the bits of the last block which are actually used.
+    inline auto last_block_mask() const -> Block
+    {
+        return (_size % bits_per_block) ? static_cast<Block>((Block(1) << (_size % bits_per_block)) - 1U) : static_cast<Block>(~Block(0));
+    }
+
+    /// @brief Returns the blocks storing the bits.
+    inline Block *data()
+    {
+        return (_capacity > inline_blocks) ? _storage.heap : _storage.local;
+    }
+
+    /// @brief Returns the blocks storing the bits.
+    inline const Block *data() const
+    {
+        return (_capacity > inline_blocks) ? _storage.heap : _storage.local;
+    }
+
+    /// @brief Changes the number of bits, the new bits are set to zero.
+    /// @param size the new number of bits.
+    inline DynamicBitVector &resize(std::size_t size)
+    {
+        const std::size_t old_blocks = this->num_blocks(), new_blocks = (size + bits_per_block - 1) / bits_per_block;
+        if (new_blocks > _capacity) {
+            Block *blocks = allocator_traits::allocate(_allocator, new_blocks);
+            for (std::size_t it = 0; it < new_blocks; ++it)
+                blocks[it] = (it < old_blocks) ? this->data()[it] : Block(0);
+            this->release();
+            _storage.heap = blocks;
+            _capacity     = new_blocks;
+        } else {
+            for (std::size_t it = old_blocks; it < new_blocks; ++it)
+                this->data()[it] = 0;
+        }
+        _size = size;
+        return this->trim();
+    }
+
+    /// @brief Sets every bit to false.
+    inline DynamicBitVector &reset()
+    {
+        for (std::size_t it = 0; it < this->num_blocks(); ++it)
+            this->data()[it] = 0;
+        return (*this);
+    }
+
+    /// @brief Sets the given bit to false.
+    inline DynamicBitVector &reset(std::size_t position)
+    {
+        this->at(position) = false;
+        return (*this);
+    }
+
+    /// @brief Flips every bit.
+    inline DynamicBitVector &flip()
+    {
+        bvlib::simd::bitwise_not(this->data(), this->data(), this->num_blocks());
+        return this->trim();
+    }
+
+    /// @brief Flips a given bit.
+    inline DynamicBitVector &flip(std::size_t position)
+    {
+        this->at(position).flip();
+        return (*this);
+    }
+
+    /// @brief Returns the number of bits which are set.
+    inline auto count() const -> std::size_t
+    {
+        std::size_t result = 0;
+        for (std::size_t it = 0; it < this->num_blocks(); ++it)
+            result += bvlib::detail::popcount(this->data()[it]);
+        return result;
+    }
+
+    /// @brief Tests whether all the bits are on.
+    inline auto all() const -> bool
+    {
+        return this->count() == _size;
+    }
+
+    /// @brief Tests whether any of the bits are on.
+    inline auto any() const -> bool
+    {
+        return bvlib::detail::significant_blocks(this->data(), this->num_blocks()) != 0;
+    }
+
+    /// @brief Tests whether none of the bits are on.
+    inline auto none() const -> bool
+    {
+        return !this->any();
+    }
+
+    /// @brief Returns the number of consecutive zeros, starting from the most significant bit.
+    /// @return the number of leading zeros, which is size() if no bit is set.
+    inline auto countl_zero() const -> std::size_t
+    {
+        const std::size_t blocks = bvlib::detail::significant_blocks(this->data(), this->num_blocks());
+        if (blocks == 0)
+            return _size;
+        // The unused bits of the last block are always zero, and must be discarded.
+        return (this->num_blocks() - blocks) * bits_per_block + bvlib::detail::countl_zero(this->data()[blocks - 1]) - (this->num_blocks() * bits_per_block - _size);
+    }
+
+    /// @brief Returns the number of consecutive zeros, starting from the least significant bit.
+    /// @return the number of trailing zeros, which is size() if no bit is set.
+    inline auto countr_zero() const -> std::size_t
+    {
+        for (std::size_t it = 0; it < this->num_blocks(); ++it)
+            if (this->data()[it])
+                return it * bits_per_block + bvlib::detail::countr_zero(this->data()[it]);
+        return _size;
+    }
+
+    /// @brief Returns the position of the least significant bit which is set.
+    /// @return the position of the bit, or npos if no bit is set.
+    inline auto find_first() const -> std::size_t
+    {
+        const std::size_t position = this->countr_zero();
+        return (position == _size) ? npos : position;
+    }
+
+    /// @brief Returns the position of the most significant bit which is set.
+    /// @return the position of the bit, or npos if no bit is set.
+    inline auto find_last() const -> std::size_t
+    {
+        const std::size_t zeros = this->countl_zero();
+        return (zeros == _size) ? npos : (_size - 1 - zeros);
+    }
+
+    /// @brief Tests whether the sign bit (i.e., the most significant bit) is on.
+    inline auto sign() const -> bool
+    {
+        return this->at(_size - 1);
+    }
+
+    /// @brief Performs two-complement.
+    inline DynamicBitVector &two_complement()
+    {
+        this->flip();
+        bvlib::detail::add_integer(this->data(), this->num_blocks(), 1U);
+        return this->trim();
+    }
+
+    /// @brief Swaps the bits from 'start' to 'end'.
+    inline DynamicBitVector &swap(std::size_t start = 0, std::size_t end = npos)
+    {
+        end = std::min(end, _size - 1);
+        for (; (start < end) && (end < _size); ++start, --end) {
+            bool tmp       = (*this)[start];
+            (*this)[start] = (*this)[end];
+            (*this)[end]   = tmp;
+        }
+        return (*this);
+    }
+
+    /// @brief Copies rhs into this bitvector, keeping the current size.
+    template <std::size_t N2>
+    inline DynamicBitVector &assign(const BitVector<N2, Block> &rhs)
+    {
+        return this->assign_blocks(rhs.data, rhs.num_blocks);
+    }
+
+    /// @brief Copies rhs into this bitvector, keeping the current size.
+    template <typename Allocator2>
+    inline DynamicBitVector &assign(const DynamicBitVector<Block, Allocator2> &rhs)
+    {
+        return this->assign_blocks(rhs.data(), rhs.num_blocks());
+    }
+
+    /// @brief Returns a reference to the bit at the given position.
+    inline reference at(std::size_t position)
+    {
+        if (position >= _size)
+            throw std::out_of_range("accessing values outside bitvector");
+        return (*this)[position];
+    }
+
+    /// @brief Returns the bit at the given position.
+    inline bool at(std::size_t position) const
+    {
+        if (position >= _size)
+            throw std::out_of_range("accessing values outside bitvector");
+        return (*this)[position];
+    }
+
+    /// @brief Returns a reference to the bit at the given position, without checking it.
+    /// @details The position is only asserted, unless BVLIB_CHECKED is defined,
+    /// in which case it throws like at().
+    inline reference operator[](std::size_t position)
+    {
+#if defined(BVLIB_CHECKED)
+        if (position >= _size)
+            throw std::out_of_range("accessing values outside bitvector");
+#else
+        assert(position < _size);
+#endif
+        return reference(this->data()[position / bits_per_block], static_cast<Block>(Block(1) << (position % bits_per_block)));
+    }
+
+    /// @brief Returns the bit at the given position, without checking it.
+    /// @details The position is only asserted, unless BVLIB_CHECKED is defined,
+    /// in which case it throws like at().
+    inline bool operator[](std::size_t position) const
+    {
+#if defined(BVLIB_CHECKED)
+        if (position >= _size)
+            throw std::out_of_range("accessing values outside bitvector");
+#else
+        assert(position < _size);
+#endif
+        return (this->data()[position / bits_per_block] >> (position % bits_per_block)) & 1U;
+    }
+
+    /// @brief Transforms this bitvector to string.
+    inline std::string to_string() const
+    {
+        std::string str(_size, '0');
+        const Block *blocks = this->data();
+        for (std::size_t it = 0; it < _size; ++it)
+            str[_size - 1 - it] = static_cast<char>('0' + ((blocks[it / bits_per_block] >> (it % bits_per_block)) & 1U));
+        return str;
+    }
+
+    /// @brief Transforms this bitvector to number.
+    /// @details Integral types are filled block by block, and the bits which do not fit are discarded.
+    template <typename T>
+    inline T to_number() const
+    {
+        if constexpr (std::is_integral<T>::value) {
+            // Convert through a bitvector as wide as T.
+            using unsigned_t = typename std::make_unsigned<typename std::conditional<std::is_same<T, bool>::value, unsigned char, T>::type>::type;
+            return static_cast<BitVector<bvlib::detail::digits<unsigned_t>(), Block>>(*this).template to_number<T>();
+        } else {
+            // Horner's scheme, from the most significant block.
+            T result = 0;
+            for (std::size_t it = this->num_blocks(); it > 0; --it)
+                result = result * static_cast<T>(Block(1) << (bits_per_block - 1)) * 2 + static_cast<T>(this->data()[it - 1]);
+            return result;
+        }
+    }
+
+    /// @brief Clears the unused bits of the last block.
+    inline DynamicBitVector &trim()
+    {
+        if (_size > 0)
+            this->data()[this->num_blocks() - 1] &= this->last_block_mask();
+        return *this;
+    }
+
+private:
+    /// @brief Copies the given blocks, keeping the current size.
+    inline DynamicBitVector &assign_blocks(const Block *blocks, std::size_t size)
+    {
+        Block *dst = this->data();
+        for (std::size_t it = 0; it < this->num_blocks(); ++it)
+            dst[it] = (it < size) ? blocks[it] : Block(0);
+        return this->trim();
+    }
+
+    /// @brief Releases the allocated blocks, if any, going back to the inline storage.
+    inline void release() noexcept
+    {
+        if (_capacity > inline_blocks)
+            allocator_traits::deallocate(_allocator, _storage.heap, _capacity);
+        _capacity = inline_blocks;
+        _size     = 0;
+    }
+
+    /// @brief Takes the content of the other bitvector, which is left empty.
+    /// @details This bitvector must not own allocated blocks.
+    inline void steal(DynamicBitVector &other) noexcept
+    {
+        _size     = other._size;
+        _capacity = other._capacity;
+        _storage  = other._storage;
+        // The other bitvector goes back to its inline storage.
+        other._capacity = inline_blocks;
+        other._size     = 0;
+    }
+
+    /// The number of bits.
+    std::size_t _size;
+    /// The number of blocks which can be used without allocating.
+    std::size_t _capacity;
+    /// The blocks, stored inside the object when they fit.
+    union storage_t {
+        /// The inline blocks.
+        Block local[inline_blocks];
+        /// The allocated blocks.
+        Block *heap;
+    } _storage;
+    /// The allocator.
+    Allocator _allocator;
+};
+
+/// @brief Bitvector whose number of bits is chosen at runtime, allocated from an arena.
+/// @details Useful for the values of a computation which are all released at
+/// once, together with the ArenaScope enclosing it.
+template <typename Block = std::uint64_t>
+using ArenaBitVector = bvlib::DynamicBitVector<Block, bvlib::ArenaAllocator<Block>>;
+
+#if defined(__cpp_lib_memory_resource)
+namespace pmr
+{
+/// @brief Bitvector whose number of bits is chosen at runtime, using a memory resource.
+template <typename Block = std::uint64_t>
+using DynamicBitVector = bvlib::DynamicBitVector<Block, std::pmr::polymorphic_allocator<Block>>;
+} // namespace pmr
+#endif
+
+namespace detail
+{
+
+/// @brief Builds a bitvector of the given size, using the allocator of the given bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> make_dynamic(std::size_t size, const bvlib::DynamicBitVector<Block, Allocator> &like)
+{
+    return bvlib::DynamicBitVector<Block, Allocator>(size, like.get_allocator());
+}
+
+/// @brief Copies the given blocks inside the arena, extending them with zeros.
+/// @param arena the arena.
+/// @param src the blocks.
+/// @param src_size the number of blocks.
+/// @param size the number of blocks of the copy, which must not be smaller than src_size.
+/// @return the copy.
+template <typename Block>
+inline Block *arena_copy(bvlib::Arena &arena, const Block *src, std::size_t src_size, std::size_t size)
+{
+    Block *dst = arena.allocate<Block>(size);
+    for (std::size_t it = 0; it < size; ++it)
+        dst[it] = (it < src_size) ? src[it] : Block(0);
+    return dst;
+}
+
+/// @brief Applies a bitwise operation between two bitvectors of possibly different size.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return a bitvector of size std::max(lhs.size(), rhs.size()) containing the result.
+template <bvlib::simd::bitwise_op Op, typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> bitwise(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    const bvlib::DynamicBitVector<Block, Allocator> &widest = (lhs.size() >= rhs.size()) ? lhs : rhs;
+    const std::size_t min_blocks                            = std::min(lhs.num_blocks(), rhs.num_blocks());
+    bvlib::DynamicBitVector<Block, Allocator> result(widest);
+    bvlib::simd::bitwise<Op>(result.data(), lhs.data(), rhs.data(), min_blocks);
+    // With and, the blocks missing from the narrowest operand are zero.
+    if constexpr (Op == bvlib::simd::bitwise_op::op_and) {
+        for (std::size_t it = min_blocks; it < result.num_blocks(); ++it)
+            result.data()[it] = 0;
+    }
+    BVLIB_INSTRUMENT_DYNAMIC_END((Op == bvlib::simd::bitwise_op::op_and) ? "dynamic_and" : (Op == bvlib::simd::bitwise_op::op_or) ? "dynamic_or" : "dynamic_xor", result.size());
+    BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(result.size(), 1);
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return result;
+}
+
+/// @brief Applies a bitwise operation between two bitvectors, saving the result inside the first.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector, which must not be larger than the first.
+/// @return the first bitvector.
+template <bvlib::simd::bitwise_op Op, typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &bitwise_assign(bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    if (rhs.size() > lhs.size())
+        throw std::invalid_argument("RHS has more bits than LHS");
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::simd::bitwise<Op>(lhs.data(), lhs.data(), rhs.data(), rhs.num_blocks());
+    // With and, the blocks missing from the rhs clear the lhs.
+    if constexpr (Op == bvlib::simd::bitwise_op::op_and) {
+        for (std::size_t it = rhs.num_blocks(); it < lhs.num_blocks(); ++it)
+            lhs.data()[it] = 0;
+    }
+    BVLIB_INSTRUMENT_DYNAMIC_END((Op == bvlib::simd::bitwise_op::op_and) ? "dynamic_and_assign" : (Op == bvlib::simd::bitwise_op::op_or) ? "dynamic_or_assign" : "dynamic_xor_assign", lhs.size());
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return lhs;
+}
+
+} // namespace detail
+
+/// @brief Returns the position of the most significant bit inside the given bitvector.
+/// @param bitvector the input bitvector.
+/// @return position of the most significant bit, or 0 if no bit is set.
+template <typename Block, typename Allocator>
+inline std::size_t most_significant_bit(const bvlib::DynamicBitVector<Block, Allocator> &bitvector)
+{
+    const std::size_t position = bitvector.find_last();
+    return (position == bitvector.npos) ? std::size_t(0) : position;
+}
+
+// ============================================================================
+// SHIFT
+// ============================================================================
+
+/// @brief Left-shifts the input bitvector by the given number of bits.
+/// @param bitvector the bitvector.
+/// @param shift the amount to shift, shifting by size() or more bits clears the bitvector.
+/// @return the shifted bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> shift_left(const bvlib::DynamicBitVector<Block, Allocator> &bitvector, std::size_t shift)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    auto result = bvlib::detail::make_dynamic(bitvector.size(), bitvector);
+    if (shift < bitvector.size()) {
+        bvlib::detail::shift_left_blocks(result.data(), bitvector.data(), result.num_blocks(), shift);
+        result.trim();
+    }
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_shift_left", result.size());
+    BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(result.size(), 1);
+    return result;
+}
+
+/// @brief Right-shifts the input bitvector by the given number of bits.
+/// @param bitvector the bitvector.
+/// @param shift the amount to shift, shifting by size() or more bits clears the bitvector.
+/// @return the shifted bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> shift_right(const bvlib::DynamicBitVector<Block, Allocator> &bitvector, std::size_t shift)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    auto result = bvlib::detail::make_dynamic(bitvector.size(), bitvector);
+    if (shift < bitvector.size())
+        bvlib::detail::shift_right_blocks(result.data(), bitvector.data(), result.num_blocks(), shift);
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_shift_right", result.size());
+    BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(result.size(), 1);
+    return result;
+}
+
+/// @brief Rotates the input bitvector to the left by the given number of bits, modifying it.
+/// @param bitvector the bitvector.
+/// @param shift the amount to rotate, taken modulo size().
+/// @return the input bitvector, rotated.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &rotl(bvlib::DynamicBitVector<Block, Allocator> &bitvector, std::size_t shift)
+{
+    if (bitvector.empty())
+        return bitvector;
+    shift %= bitvector.size();
+    if (shift > 0) {
+        // The bits going out from the top come back in from the bottom.
+        auto wrapped = bvlib::shift_right(bitvector, bitvector.size() - shift);
+        bvlib::detail::shift_left_blocks(bitvector.data(), bitvector.data(), bitvector.num_blocks(), shift);
+        bvlib::simd::bitwise<bvlib::simd::bitwise_op::op_or>(bitvector.data(), bitvector.data(), wrapped.data(), bitvector.num_blocks());
+        bitvector.trim();
+    }
+    return bitvector;
+}
+
+/// @brief Rotates the input bitvector to the right by the given number of bits, modifying it.
+/// @param bitvector the bitvector.
+/// @param shift the amount to rotate, taken modulo size().
+/// @return the input bitvector, rotated.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &rotr(bvlib::DynamicBitVector<Block, Allocator> &bitvector, std::size_t shift)
+{
+    if (bitvector.empty())
+        return bitvector;
+    shift %= bitvector.size();
+    return (shift > 0) ? bvlib::rotl(bitvector, bitvector.size() - shift) : bitvector;
+}
+
+/// @brief Left-shifts the input bitvector by the given number of bits.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator<<(const bvlib::DynamicBitVector<Block, Allocator> &bitvector, std::size_t shift)
+{
+    return bvlib::shift_left(bitvector, shift);
+}
+
+/// @brief Left-shifts the input bitvector by the given number of bits, modifying it.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator<<=(bvlib::DynamicBitVector<Block, Allocator> &bitvector, std::size_t shift)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    if (shift >= bitvector.size()) {
+        bitvector.reset();
+    } else {
+        bvlib::detail::shift_left_blocks(bitvector.data(), bitvector.data(), bitvector.num_blocks(), shift);
+        bitvector.trim();
+    }
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_shift_left_assign", bitvector.size());
+    return bitvector;
+}
+
+/// @brief Right-shifts the input bitvector by the given number of bits.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator>>(const bvlib::DynamicBitVector<Block, Allocator> &bitvector, std::size_t shift)
+{
+    return bvlib::shift_right(bitvector, shift);
+}
+
+/// @brief Right-shifts the input bitvector by the given number of bits, modifying it.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator>>=(bvlib::DynamicBitVector<Block, Allocator> &bitvector, std::size_t shift)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    if (shift >= bitvector.size())
+        bitvector.reset();
+    else
+        bvlib::detail::shift_right_blocks(bitvector.data(), bitvector.data(), bitvector.num_blocks(), shift);
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_shift_right_assign", bitvector.size());
+    return bitvector;
+}
+
+// ============================================================================
+// BITWISE
+// ============================================================================
+
+/// @brief Computes the bitwise and between the first and second bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator&(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_and>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise and between a bitvector and an integer value.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator&(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_and>(lhs, bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator()));
+}
+
+/// @brief Computes the bitwise and between an integer value and a bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator&(T lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return rhs & lhs;
+}
+
+/// @brief Computes the bitwise and between the first and second bitvector, saving the result inside the first.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator&=(bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_and>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise and between the bitvector and an integer value, saving the result inside the bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator&=(bvlib::DynamicBitVector<Block, Allocator> &lhs, std::size_t rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_and>(lhs, bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator()));
+}
+
+/// @brief Computes the bitwise or between the first and second bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator|(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_or>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise or between a bitvector and an integer value.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator|(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_or>(lhs, bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator()));
+}
+
+/// @brief Computes the bitwise or between an integer value and a bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator|(T lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return rhs | lhs;
+}
+
+/// @brief Computes the bitwise or between the first and second bitvector, saving the result inside the first.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator|=(bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_or>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise or between the bitvector and an integer value, saving the result inside the bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator|=(bvlib::DynamicBitVector<Block, Allocator> &lhs, std::size_t rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_or>(lhs, bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator()));
+}
+
+/// @brief Computes the bitwise xor between the first and second bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator^(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_xor>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise xor between a bitvector and an integer value.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator^(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_xor>(lhs, bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator()));
+}
+
+/// @brief Computes the bitwise xor between an integer value and a bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator^(T lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return rhs ^ lhs;
+}
+
+/// @brief Computes the bitwise xor between the first and second bitvector, saving the result inside the first.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator^=(bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_xor>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise xor between the bitvector and an integer value, saving the result inside the bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator^=(bvlib::DynamicBitVector<Block, Allocator> &lhs, std::size_t rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_xor>(lhs, bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator()));
+}
+
+/// @brief Computes the bitwise not of the bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator~(const bvlib::DynamicBitVector<Block, Allocator> &bitvector)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::DynamicBitVector<Block, Allocator> result(bitvector);
+    result.flip();
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_not", result.size());
+    BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(result.size(), 1);
+    return result;
+}
+
+// ============================================================================
+// COMPARISON
+// ============================================================================
+
+/// @brief Checks if the two bitvectors have the same value.
+template <typename Block, typename Allocator>
+inline bool operator==(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    const bool result = bvlib::detail::compare_blocks(lhs.data(), lhs.num_blocks(), rhs.data(), rhs.num_blocks()) == 0;
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_compare", std::max(lhs.size(), rhs.size()));
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return result;
+}
+
+/// @brief Checks if the first bitvector is smaller than the second one.
+template <typename Block, typename Allocator>
+inline bool operator<(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    const bool result = bvlib::detail::compare_blocks(lhs.data(), lhs.num_blocks(), rhs.data(), rhs.num_blocks()) < 0;
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_compare", std::max(lhs.size(), rhs.size()));
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return result;
+}
+
+/// @brief Checks if the two bitvectors have different values.
+template <typename Block, typename Allocator>
+inline bool operator!=(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return !(lhs == rhs);
+}
+
+/// @brief Checks if the first bitvector is smaller than or equal to the second one.
+template <typename Block, typename Allocator>
+inline bool operator<=(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return !(rhs < lhs);
+}
+
+/// @brief Checks if the first bitvector is greater than the second one.
+template <typename Block, typename Allocator>
+inline bool operator>(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return rhs < lhs;
+}
+
+/// @brief Checks if the first bitvector is greater than or equal to the second one.
+template <typename Block, typename Allocator>
+inline bool operator>=(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return !(lhs < rhs);
+}
+
+/// @brief Checks if the bitvector has the same value of the integer, truncated to the size of the bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bool operator==(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return lhs == bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator());
+}
+
+/// @brief Checks if the bitvector has the same value of the integer, truncated to the size of the bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bool operator==(T lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return rhs == lhs;
+}
+
+/// @brief Checks if the bitvector has a different value from the integer, truncated to the size of the bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bool operator!=(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return !(lhs == rhs);
+}
+
+/// @brief Checks if the bitvector has a different value from the integer, truncated to the size of the bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bool operator!=(T lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return !(rhs == lhs);
+}
+
+/// @brief Checks if the bitvector is smaller than the integer, truncated to the size of the bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bool operator<(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return lhs < bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator());
+}
+
+/// @brief Checks if the bitvector is greater than the integer, truncated to the size of the bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bool operator>(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator()) < lhs;
+}
+
+/// @brief Checks if the bitvector is smaller than or equal to the integer, truncated to the size of the bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bool operator<=(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return !(lhs > rhs);
+}
+
+/// @brief Checks if the bitvector is greater than or equal to the integer, truncated to the size of the bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bool operator>=(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return !(lhs < rhs);
+}
+
+// ============================================================================
+// SUM AND SUB
+// ============================================================================
+
+/// @brief Sums two bitvectors.
+/// @return a bitvector of size std::max(lhs.size(), rhs.size()), containing the sum.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator+(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    auto result = bvlib::detail::make_dynamic(std::max(lhs.size(), rhs.size()), lhs);
+    bvlib::detail::add_blocks(result.data(), result.num_blocks(), lhs.data(), lhs.num_blocks(), rhs.data(), rhs.num_blocks());
+    result.trim();
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_sum", result.size());
+    BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(result.size(), 1);
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return result;
+}
+
+/// @brief Sums a bitvector and an integer value.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator+(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return lhs + bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator());
+}
+
+/// @brief Sums an integer value and a bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator+(T lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return rhs + lhs;
+}
+
+/// @brief Adds the second bitvector to the first one.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator+=(bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    if (rhs.size() > lhs.size())
+        throw std::invalid_argument("RHS has more bits than LHS");
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::detail::add_blocks(lhs.data(), lhs.num_blocks(), lhs.data(), lhs.num_blocks(), rhs.data(), rhs.num_blocks());
+    lhs.trim();
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_sum_assign", lhs.size());
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return lhs;
+}
+
+/// @brief Adds the integer value to the bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator+=(bvlib::DynamicBitVector<Block, Allocator> &lhs, std::size_t rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::detail::add_integer(lhs.data(), lhs.num_blocks(), rhs);
+    lhs.trim();
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_sum_assign", lhs.size());
+    return lhs;
+}
+
+/// @brief Increments the bitvector by one.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator++(bvlib::DynamicBitVector<Block, Allocator> &lhs)
+{
+    return lhs += 1U;
+}
+
+/// @brief Increments the bitvector by one.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator++(bvlib::DynamicBitVector<Block, Allocator> &lhs, int)
+{
+    return lhs += 1U;
+}
+
+/// @brief Subtracts two bitvectors.
+/// @return a bitvector of size std::max(lhs.size(), rhs.size()), containing the difference.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator-(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    auto result = bvlib::detail::make_dynamic(std::max(lhs.size(), rhs.size()), lhs);
+    bvlib::detail::sub_blocks(result.data(), result.num_blocks(), lhs.data(), lhs.num_blocks(), rhs.data(), rhs.num_blocks());
+    result.trim();
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_sub", result.size());
+    BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(result.size(), 1);
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return result;
+}
+
+/// @brief Subtracts an integer value from a bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator-(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return lhs - bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator());
+}
+
+/// @brief Subtracts a bitvector from an integer value.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator-(T lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::DynamicBitVector<Block, Allocator>(rhs.size(), lhs, rhs.get_allocator()) - rhs;
+}
+
+/// @brief Subtracts the second bitvector from the first one.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator-=(bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    if (rhs.size() > lhs.size())
+        throw std::invalid_argument("RHS has more bits than LHS");
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::detail::sub_blocks(lhs.data(), lhs.num_blocks(), lhs.data(), lhs.num_blocks(), rhs.data(), rhs.num_blocks());
+    lhs.trim();
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_sub_assign", lhs.size());
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return lhs;
+}
+
+/// @brief Subtracts the integer value from the bitvector.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> &operator-=(bvlib::DynamicBitVector<Block, Allocator> &lhs, std::size_t rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::detail::sub_integer(lhs.data(), lhs.num_blocks(), rhs);
+    lhs.trim();
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_sub_assign", lhs.size());
+    return lhs;
+}
+
+// ============================================================================
+// MUL
+// ============================================================================
+
+/// @brief Multiplies two bitvectors.
+/// @return a bitvector of size (std::max(lhs.size(), rhs.size()) * 2), containing the product.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> mul(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    const std::size_t max  = std::max(lhs.size(), rhs.size());
+    const std::size_t size = std::max(lhs.num_blocks(), rhs.num_blocks());
+    // The result is allocated before opening the scope, since it might come from the same arena.
+    auto result = bvlib::detail::make_dynamic(2 * size * lhs.bits_per_block, lhs);
+    bvlib::ArenaScope scope;
+    // Both operands are extended to the same number of blocks.
+    const Block *_lhs = bvlib::detail::arena_copy(scope.arena(), lhs.data(), lhs.num_blocks(), size);
+    const Block *_rhs = bvlib::detail::arena_copy(scope.arena(), rhs.data(), rhs.num_blocks(), size);
+    Block *scratch    = scope.arena().allocate<Block>(bvlib::detail::karatsuba_scratch_size(size) + 1);
+    bvlib::detail::mul_blocks(result.data(), _lhs, _rhs, size, scratch);
+    // The product always fits inside the result, which might have fewer blocks.
+    result.resize(2 * max);
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_mul", max);
+    BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(2 * max, 1);
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return result;
+}
+
+/// @brief Multiplies two bitvectors.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator*(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::mul(lhs, rhs);
+}
+
+/// @brief Multiplies a bitvector and an integer value.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator*(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return bvlib::mul(lhs, bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator()));
+}
+
+/// @brief Multiplies an integer value and a bitvector.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator*(T lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return rhs * lhs;
+}
+
+// ============================================================================
+// DIV
+// ============================================================================
+
+/// @brief Performs the division between two bitvectors.
+/// @return two bitvectors of size std::max(lhs.size(), rhs.size()), the first
+/// contains the quotient and the second contains the reminder.
+template <typename Block, typename Allocator>
+inline std::pair<bvlib::DynamicBitVector<Block, Allocator>, bvlib::DynamicBitVector<Block, Allocator>> div(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    if (rhs.none())
+        throw std::domain_error("division by zero undefined");
+    BVLIB_INSTRUMENT_BEGIN();
+    const std::size_t max = std::max(lhs.size(), rhs.size());
+    // The results are allocated before opening the scope, since they might come from the same arena.
+    auto qotient   = bvlib::detail::make_dynamic(max, lhs);
+    auto remainder = bvlib::detail::make_dynamic(max, lhs);
+    const std::size_t size = qotient.num_blocks();
+    bvlib::ArenaScope scope;
+    // Both operands are extended to the same number of blocks.
+    const Block *_lhs = bvlib::detail::arena_copy(scope.arena(), lhs.data(), lhs.num_blocks(), size);
+    const Block *_rhs = bvlib::detail::arena_copy(scope.arena(), rhs.data(), rhs.num_blocks(), size);
+    Block *scratch    = scope.arena().allocate<Block>(2 * size + 1);
+    bvlib::detail::divmod_blocks(qotient.data(), remainder.data(), _lhs, _rhs, size, scratch);
+    BVLIB_INSTRUMENT_DYNAMIC_END("dynamic_div", max);
+    BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(max, 2);
+    BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs.size(), rhs.size());
+    return std::make_pair(std::move(qotient), std::move(remainder));
+}
+
+/// @brief Performs the division between two bitvectors.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator/(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::div(lhs, rhs).first;
+}
+
+/// @brief Performs the division between a bitvector and an integer value.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator/(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return bvlib::div(lhs, bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator())).first;
+}
+
+/// @brief Computes the remainder of the division between two bitvectors.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> operator%(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    return bvlib::div(lhs, rhs).second;
+}
+
+/// @brief Computes the remainder of the division between a bitvector and an integer value.
+template <typename Block, typename Allocator, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+inline bvlib::DynamicBitVector<Block, Allocator> operator%(const bvlib::DynamicBitVector<Block, Allocator> &lhs, T rhs)
+{
+    return bvlib::div(lhs, bvlib::DynamicBitVector<Block, Allocator>(lhs.size(), rhs, lhs.get_allocator())).second;
+}
+
+} // namespace bvlib
@@ -0,0 +1,452 @@
+/// @file expression.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Expression templates, fusing chains of operations into a single pass.
+/// @details Wrapping a bitvector with bvlib::expr::lazy() turns the operators
+/// applied to it into nodes of an expression tree, instead of bitvectors. The
+/// tree is evaluated when it is converted to a bitvector, or given to
+/// evaluate() or assign(), computing each block of the result from the blocks
+/// of the operands, from the least significant to the most significant one,
+/// without building any intermediate bitvector. The width of each node is the
+/// one of the corresponding eager operator (e.g., std::max(N1, N2) for a sum),
+/// so the result is exactly the one computed by math.hpp. The tree only stores
+/// pointers to its operands, which must outlive it.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "intrinsics.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace bvlib
+{
+
+namespace expr
+{
+
+/// @brief The binary operations which can be fused.
+enum class operation {
+    op_and, ///< Bitwise and.
+    op_or,  ///< Bitwise or.
+    op_xor, ///< Bitwise xor.
+    op_add, ///< Sum.
+    op_sub  ///< Difference.
+};
+
+/// @brief Common base of the nodes of an expression.
+/// @tparam Derived the node.
+/// @tparam Block the type used to store the bits.
+/// @tparam N the width of the result.
+template <typename Derived, typename Block, std::size_t N>
+class node {
+public:
+    /// @brief Evaluates the expression into a bitvector of the same width.
+    constexpr operator BitVector<N, Block>() const
+    {
+        BitVector<N, Block> result;
+        Derived expression(static_cast<const Derived &>(*this));
+        expression.reset();
+        for (std::size_t it = 0; it < result.num_blocks; ++it)
+            result.data[it] = expression.block(it);
+        return result;
+    }
+};
+
+/// @brief Masks a block of the result of a node with the given width.
+/// @param index the index of the block.
+/// @param value the value of the block.
+/// @return the value, without the bits outside the width.
+template <std::size_t N, typename Block>
+constexpr inline Block mask_block(std::size_t index, Block value)
+{
+    if (index >= BitVector<N, Block>::num_blocks)
+        return 0;
+    if (index == BitVector<N, Block>::num_blocks - 1)
+        return static_cast<Block>(value & BitVector<N, Block>::last_block_mask);
+    return value;
+}
+
+/// @brief Leaf of an expression, referring to a bitvector.
+template <std::size_t N, typename Block>
+class terminal : public node<terminal<N, Block>, Block, N> {
+public:
+    /// The type used to store the bits.
+    using block_type = Block;
+
+    /// The width of the result.
+    static constexpr std::size_t size = N;
+
+    /// Whether the blocks can be computed in any order.
+    static constexpr bool random_access = true;
+
+    /// @brief Refers to the given bitvector.
+    constexpr explicit terminal(const BitVector<N, Block> &bitvector)
+        : _bitvector(&bitvector)
+    {
+    }
+
+    /// @brief Prepares the node for a new evaluation.
+    constexpr inline void reset()
+    {
+    }
+
+    /// @brief Returns the block with the given index.
+    constexpr inline Block block(std::size_t index) const
+    {
+        return (index < BitVector<N, Block>::num_blocks) ? _bitvector->data[index] : Block(0);
+    }
+
+    /// @brief Checks if the given bitvector is used by the expression.
+    constexpr inline bool uses(const void *bitvector) const
+    {
+        return _bitvector == bitvector;
+    }
+
+private:
+    /// The bitvector.
+    const BitVector<N, Block> *_bitvector;
+};
+
+/// @brief Node applying a binary operation.
+/// @details The sum and the difference carry from one block to the next, so
+/// their blocks must be computed in ascending order, once each.
+template <operation Op, typename Lhs, typename Rhs>
+class binary : public node<binary<Op, Lhs, Rhs>, typename Lhs::block_type, std::max(Lhs::size, Rhs::size)> {
+    static_assert(std::is_same<typename Lhs::block_type, typename Rhs::block_type>::value, "The operands must use the same block type");
+
+public:
+    /// The type used to store the bits.
+    using block_type = typename Lhs::block_type;
+
+    /// The width of the result.
+    static constexpr std::size_t size = std::max(Lhs::size, Rhs::size);
+
+    /// Whether the blocks can be computed in any order.
+    static constexpr bool random_access = (Op != operation::op_add) && (Op != operation::op_sub) && Lhs::random_access && Rhs::random_access;
+
+    /// @brief Applies the operation to the given operands.
+    constexpr binary(const Lhs &lhs, const Rhs &rhs)
+        : _lhs(lhs),
+          _rhs(rhs),
+          _carry()
+    {
+    }
+
+    /// @brief Prepares the node for a new evaluation.
+    constexpr inline void reset()
+    {
+        _lhs.reset();
+        _rhs.reset();
+        _carry = false;
+    }
+
+    /// @brief Returns the block with the given index.
+    constexpr inline block_type block(std::size_t index)
+    {
+        const block_type lhs = _lhs.block(index), rhs = _rhs.block(index);
+        block_type result    = 0;
+        if constexpr (Op == operation::op_and)
+            result = static_cast<block_type>(lhs & rhs);
+        else if constexpr (Op == operation::op_or)
+            result = static_cast<block_type>(lhs | rhs);
+        else if constexpr (Op == operation::op_xor)
+            result = static_cast<block_type>(lhs ^ rhs);
+        else if constexpr (Op == operation::op_add)
+            _carry = bvlib::detail::addcarry(lhs, rhs, _carry, result);
+        else
+            _carry = bvlib::detail::subborrow(lhs, rhs, _carry, result);
+        return bvlib::expr::mask_block<size>(index, result);
+    }
+
+    /// @brief Checks if the given bitvector is used by the expression.
+    constexpr inline bool uses(const void *bitvector) const
+    {
+        return _lhs.uses(bitvector) || _rhs.uses(bitvector);
+    }
+
+private:
+    /// The first operand.
+    Lhs _lhs;
+    /// The second operand.
+    Rhs _rhs;
+    /// The carry, or the borrow, going into the next block.
+    bool _carry;
+};
+
+/// @brief Node computing the bitwise not.
+template <typename Operand>
+class complement : public node<complement<Operand>, typename Operand::block_type, Operand::size> {
+public:
+    /// The type used to store the bits.
+    using block_type = typename Operand::block_type;
+
+    /// The width of the result.
+    static constexpr std::size_t size = Operand::size;
+
+    /// Whether the blocks can be computed in any order.
+    static constexpr bool random_access = Operand::random_access;
+
+    /// @brief Applies the bitwise not to the given operand.
+    constexpr explicit complement(const Operand &operand)
+        : _operand(operand)
+    {
+    }
+
+    /// @brief Prepares the node for a new evaluation.
+    constexpr inline void reset()
+    {
+        _operand.reset();
+    }
+
+    /// @brief Returns the block with the given index.
+    constexpr inline block_type block(std::size_t index)
+    {
+        return bvlib::expr::mask_block<size>(index, static_cast<block_type>(~_operand.block(index)));
+    }
+
+    /// @brief Checks if the given bitvector is used by the expression.
+    constexpr inline bool uses(const void *bitvector) const
+    {
+        return _operand.uses(bitvector);
+    }
+
+private:
+    /// The operand.
+    Operand _operand;
+};
+
+/// @brief Node shifting its operand, by any amount.
+/// @details Each block of the result combines two blocks of the operand. When
+/// those cannot be computed in any order (e.g., the operand is a sum), the
+/// operand is evaluated once into a buffer when the evaluation starts.
+template <typename Operand, bool Left>
+class shift : public node<shift<Operand, Left>, typename Operand::block_type, Operand::size> {
+public:
+    /// The type used to store the bits.
+    using block_type = typename Operand::block_type;
+
+    /// The width of the result.
+    static constexpr std::size_t size = Operand::size;
+
+    /// Whether the blocks can be computed in any order.
+    static constexpr bool random_access = true;
+
+    /// @brief Shifts the given operand.
+    /// @param operand the operand.
+    /// @param amount the amount to shift, shifting by size or more bits gives zero.
+    constexpr shift(const Operand &operand, std::size_t amount)
+        : _operand(operand),
+          _amount(amount),
+          _buffer()
+    {
+    }
+
+    /// @brief Prepares the node for a new evaluation.
+    constexpr inline void reset()
+    {
+        _operand.reset();
+        if constexpr (!Operand::random_access) {
+            for (std::size_t it = 0; it < num_blocks; ++it)
+                _buffer[it] = _operand.block(it);
+        }
+    }
+
+    /// @brief Returns the block with the given index.
+    constexpr inline block_type block(std::size_t index)
+    {
+        if (_amount >= size)
+            return 0;
+        const std::size_t blocks = _amount / bits_per_block, bits = _amount % bits_per_block;
+        block_type result        = 0;
+        if constexpr (Left) {
+            if (index >= blocks)
+                result = static_cast<block_type>(this->source(index - blocks) << bits);
+            if ((bits > 0) && (index > blocks))
+                result = static_cast<block_type>(result | (this->source(index - blocks - 1) >> (bits_per_block - bits)));
+        } else {
+            result = static_cast<block_type>(this->source(index + blocks) >> bits);
+            if (bits > 0)
+                result = static_cast<block_type>(result | (this->source(index + blocks + 1) << (bits_per_block - bits)));
+        }
+        return bvlib::expr::mask_block<size>(index, result);
+    }
+
+    /// @brief Checks if the given bitvector is used by the expression.
+    constexpr inline bool uses(const void *bitvector) const
+    {
+        return _operand.uses(bitvector);
+    }
+
+private:
+    /// The number of bits of a block.
+    static constexpr std::size_t bits_per_block = bvlib::detail::digits<block_type>();
+
+    /// The number of blocks of the operand.
+    static constexpr std::size_t num_blocks = BitVector<size, block_type>::num_blocks;
+
+    /// @brief Returns the block of the operand with the given index.
+    constexpr inline block_type source(std::size_t index)
+    {
+        if constexpr (Operand::random_access)
+            return _operand.block(index);
+        else
+            return (index < num_blocks) ? _buffer[index] : block_type(0);
+    }
+
+    /// The operand.
+    Operand _operand;
+    /// The amount to shift.
+    std::size_t _amount;
+    /// The blocks of the operand, when they must be computed in order.
+    block_type _buffer[Operand::random_access ? 1 : num_blocks];
+};
+
+/// @brief Checks if the given type is a node of an expression.
+template <typename T>
+struct is_expression : std::false_type {
+};
+
+template <std::size_t N, typename Block>
+struct is_expression<terminal<N, Block>> : std::true_type {
+};
+
+template <operation Op, typename Lhs, typename Rhs>
+struct is_expression<binary<Op, Lhs, Rhs>> : std::true_type {
+};
+
+template <typename Operand>
+struct is_expression<complement<Operand>> : std::true_type {
+};
+
+template <typename Operand, bool Left>
+struct is_expression<shift<Operand, Left>> : std::true_type {
+};
+
+/// @brief Turns the operands of the operators into nodes.
+template <typename T>
+struct operand {
+    /// The node.
+    using type = T;
+
+    /// @brief Returns the node.
+    static constexpr inline const T &get(const T &value)
+    {
+        return value;
+    }
+};
+
+template <std::size_t N, typename Block>
+struct operand<BitVector<N, Block>> {
+    /// The node.
+    using type = terminal<N, Block>;
+
+    /// @brief Returns a leaf referring to the bitvector.
+    static constexpr inline type get(const BitVector<N, Block> &value)
+    {
+        return type(value);
+    }
+};
+
+/// @brief Checks if the given types can be combined by the operators, which
+/// requires at least one of them to be a node.
+template <typename Lhs, typename Rhs>
+struct are_operands : std::integral_constant<bool, (is_expression<Lhs>::value || is_expression<Rhs>::value) && is_expression<typename operand<Lhs>::type>::value && is_expression<typename operand<Rhs>::type>::value> {
+};
+
+/// @brief Starts an expression from the given bitvector.
+/// @param bitvector the bitvector, which must outlive the expression.
+/// @return a leaf referring to the bitvector.
+template <std::size_t N, typename Block>
+constexpr inline terminal<N, Block> lazy(const BitVector<N, Block> &bitvector)
+{
+    return terminal<N, Block>(bitvector);
+}
+
+/// @brief Evaluates the expression.
+/// @param expression the expression.
+/// @return a bitvector, with the width of the expression, containing the result.
+template <typename Expression, typename = typename std::enable_if<is_expression<Expression>::value>::type>
+constexpr inline BitVector<Expression::size, typename Expression::block_type> evaluate(const Expression &expression)
+{
+    return expression;
+}
+
+/// @brief Evaluates the expression directly into the given bitvector.
+/// @param bitvector where the result is stored, the bits which do not fit are discarded.
+/// @param expression the expression.
+/// @return the given bitvector.
+/// @details When the bitvector is also an operand of the expression, the result
+/// is computed into a temporary first.
+template <std::size_t N, typename Block, typename Expression, typename = typename std::enable_if<is_expression<Expression>::value>::type>
+constexpr inline BitVector<N, Block> &assign(BitVector<N, Block> &bitvector, const Expression &expression)
+{
+    if (expression.uses(&bitvector))
+        return bitvector.assign(bvlib::expr::evaluate(expression));
+    Expression copy(expression);
+    copy.reset();
+    for (std::size_t it = 0; it < bitvector.num_blocks; ++it)
+        bitvector.data[it] = copy.block(it);
+    bitvector.data[bitvector.num_blocks - 1] &= bitvector.last_block_mask;
+    return bitvector;
+}
+
+/// @brief Computes the bitwise and of the operands.
+template <typename Lhs, typename Rhs, typename = typename std::enable_if<are_operands<Lhs, Rhs>::value>::type>
+constexpr inline auto operator&(const Lhs &lhs, const Rhs &rhs)
+{
+    return binary<operation::op_and, typename operand<Lhs>::type, typename operand<Rhs>::type>(operand<Lhs>::get(lhs), operand<Rhs>::get(rhs));
+}
+
+/// @brief Computes the bitwise or of the operands.
+template <typename Lhs, typename Rhs, typename = typename std::enable_if<are_operands<Lhs, Rhs>::value>::type>
+constexpr inline auto operator|(const Lhs &lhs, const Rhs &rhs)
+{
+    return binary<operation::op_or, typename operand<Lhs>::type, typename operand<Rhs>::type>(operand<Lhs>::get(lhs), operand<Rhs>::get(rhs));
+}
+
+/// @brief Computes the bitwise xor of the operands.
+template <typename Lhs, typename Rhs, typename = typename std::enable_if<are_operands<Lhs, Rhs>::value>::type>
+constexpr inline auto operator^(const Lhs &lhs, const Rhs &rhs)
+{
+    return binary<operation::op_xor, typename operand<Lhs>::type, typename operand<Rhs>::type>(operand<Lhs>::get(lhs), operand<Rhs>::get(rhs));
+}
+
+/// @brief Computes the sum of the operands.
+template <typename Lhs, typename Rhs, typename = typename std::enable_if<are_operands<Lhs, Rhs>::value>::type>
+constexpr inline auto operator+(const Lhs &lhs, const Rhs &rhs)
+{
+    return binary<operation::op_add, typename operand<Lhs>::type, typename operand<Rhs>::type>(operand<Lhs>::get(lhs), operand<Rhs>::get(rhs));
+}
+
+/// @brief Computes the difference of the operands.
+template <typename Lhs, typename Rhs, typename = typename std::enable_if<are_operands<Lhs, Rhs>::value>::type>
+constexpr inline auto operator-(const Lhs &lhs, const Rhs &rhs)
+{
+    return binary<operation::op_sub, typename operand<Lhs>::type, typename operand<Rhs>::type>(operand<Lhs>::get(lhs), operand<Rhs>::get(rhs));
+}
+
+/// @brief Computes the bitwise not of the operand.
+template <typename Operand, typename = typename std::enable_if<is_expression<Operand>::value>::type>
+constexpr inline auto operator~(const Operand &value)
+{
+    return complement<Operand>(value);
+}
+
+/// @brief Left-shifts the operand by the given number of bits.
+template <typename Operand, typename = typename std::enable_if<is_expression<Operand>::value>::type>
+constexpr inline auto operator<<(const Operand &value, std::size_t amount)
+{
+    return shift<Operand, true>(value, amount);
+}
+
+/// @brief Right-shifts the operand by the given number of bits.
+template <typename Operand, typename = typename std::enable_if<is_expression<Operand>::value>::type>
+constexpr inline auto operator>>(const Operand &value, std::size_t amount)
+{
+    return shift<Operand, false>(value, amount);
+}
+
+} // namespace expr
+
+} // namespace bvlib
@@ -0,0 +1,203 @@
+/// @file hash.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Hashing of bitvectors, and specializations of std::hash.
+/// @details The bits are read as 64-bit words, least significant first, and
+/// each word is mixed with its index using the multiply-and-fold function of
+/// wyhash. The mixed words are added together, and the sum is mixed again with
+/// the number of bits. Since the words are mixed independently of each other,
+/// the multiplications of a wide bitvector run in parallel, and changing some
+/// words only requires to subtract their old contribution and to add the new
+/// one, which is what IncrementalHash does. The hash does not depend on the
+/// type of the blocks.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "dynamic_bitvector.hpp"
+#include "intrinsics.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace bvlib
+{
+
+namespace detail
+{
+
+/// The secrets of the hash, taken from wyhash.
+constexpr std::uint64_t hash_secret[4] = { 0xA0761D6478BD642FULL, 0xE7037ED1A0B428DBULL, 0x8EBC6AF09C88C6E3ULL, 0x589965CC75374CC3ULL };
+
+/// @brief Multiplies two values, and folds the 128-bit product.
+constexpr inline std::uint64_t hash_mix(std::uint64_t lhs, std::uint64_t rhs)
+{
+    std::uint64_t high      = 0;
+    const std::uint64_t low = bvlib::detail::mul_wide(lhs, rhs, high);
+    return low ^ high;
+}
+
+/// @brief Returns the contribution of the word with the given index to the hash.
+constexpr inline std::uint64_t hash_word(std::uint64_t word, std::size_t index, std::uint64_t seed)
+{
+    const std::uint64_t key = seed ^ (static_cast<std::uint64_t>(index) * hash_secret[0]);
+    // The multiplier is odd, so it is never zero.
+    return bvlib::detail::hash_mix(word ^ key ^ hash_secret[1], (key ^ hash_secret[2]) | 1U);
+}
+
+/// @brief Mixes the sum of the contributions of the words with the number of bits.
+constexpr inline std::uint64_t hash_finalize(std::uint64_t sum, std::size_t size, std::uint64_t seed)
+{
+    return bvlib::detail::hash_mix(sum ^ hash_secret[3], static_cast<std::uint64_t>(size) ^ seed ^ hash_secret[1]);
+}
+
+/// @brief Returns the 64-bit word with the given index.
+template <typename Block>
+constexpr inline std::uint64_t load_word(const Block *data, std::size_t num_blocks, std::size_t index)
+{
+    static_assert(bvlib::detail::digits<Block>() <= 64, "The blocks cannot be wider than the words");
+    constexpr std::size_t blocks_per_word = 64 / bvlib::detail::digits<Block>();
+    std::uint64_t word                    = 0;
+    for (std::size_t it = 0; (it < blocks_per_word) && (index * blocks_per_word + it < num_blocks); ++it)
+        word |= static_cast<std::uint64_t>(data[index * blocks_per_word + it]) << (it * bvlib::detail::digits<Block>());
+    return word;
+}
+
+/// @brief Returns the sum of the contributions of all the words.
+template <typename Block>
+constexpr inline std::uint64_t hash_sum(const Block *data, std::size_t num_blocks, std::size_t size, std::uint64_t seed)
+{
+    std::uint64_t sum = 0;
+    for (std::size_t it = 0, words = (size + 63) / 64; it < words; ++it)
+        sum += bvlib::detail::hash_word(bvlib::detail::load_word(data, num_blocks, it), it, seed);
+    return sum;
+}
+
+} // namespace detail
+
+/// @brief Returns the hash of the bitvector.
+/// @param bitvector the bitvector.
+/// @param seed the seed, which selects a different hash function.
+template <std::size_t N, typename Block>
+constexpr inline std::uint64_t hash(const BitVector<N, Block> &bitvector, std::uint64_t seed = 0)
+{
+    return bvlib::detail::hash_finalize(bvlib::detail::hash_sum(bitvector.data, BitVector<N, Block>::num_blocks, N, seed), N, seed);
+}
+
+/// @brief Returns the hash of the bitvector, which is the one of a BitVector with the same bits.
+/// @param bitvector the bitvector.
+/// @param seed the seed, which selects a different hash function.
+template <typename Block, typename Allocator>
+inline std::uint64_t hash(const DynamicBitVector<Block, Allocator> &bitvector, std::uint64_t seed = 0)
+{
+    return bvlib::detail::hash_finalize(bvlib::detail::hash_sum(bitvector.data(), bitvector.num_blocks(), bitvector.size(), seed), bitvector.size(), seed);
+}
+
+/// @brief Hash of a bitvector, which is updated as its bits change.
+/// @details Updating the hash costs one mix for each 64-bit word which changed,
+/// instead of hashing the whole bitvector again.
+/// @tparam N the number of bits.
+/// @tparam Block the type used to store the bits.
+template <std::size_t N, typename Block = std::uint64_t>
+class IncrementalHash {
+public:
+    /// The type of the hashed bitvectors.
+    using value_type = BitVector<N, Block>;
+
+    /// The number of 64-bit words of the bitvectors.
+    static constexpr std::size_t num_words = (N + 63) / 64;
+
+    /// @brief Computes the hash of the given bitvector.
+    /// @param bitvector the bitvector.
+    /// @param seed the seed, which selects a different hash function.
+    constexpr explicit IncrementalHash(const value_type &bitvector, std::uint64_t seed = 0)
+        : _sum(bvlib::detail::hash_sum(bitvector.data, value_type::num_blocks, N, seed)),
+          _seed(seed)
+    {
+    }
+
+    /// @brief Returns the hash, which is the one returned by bvlib::hash().
+    constexpr inline std::uint64_t value() const
+    {
+        return bvlib::detail::hash_finalize(_sum, N, _seed);
+    }
+
+    /// @brief Updates the hash after a change of one of the 64-bit words.
+    /// @param index the index of the word.
+    /// @param previous the previous value of the word.
+    /// @param current the current value of the word.
+    constexpr inline void update(std::size_t index, std::uint64_t previous, std::uint64_t current)
+    {
+        assert(index < num_words);
+        if (previous != current)
+            _sum += bvlib::detail::hash_word(current, index, _seed) - bvlib::detail::hash_word(previous, index, _seed);
+    }
+
+    /// @brief Updates the hash after a change of the bitvector.
+    /// @details The words are all compared, but only those which changed are mixed.
+    /// @param previous the previous value of the bitvector.
+    /// @param current the current value of the bitvector.
+    constexpr inline void update(const value_type &previous, const value_type &current)
+    {
+        for (std::size_t it = 0; it < num_words; ++it)
+            this->update(it, this->word(previous, it), this->word(current, it));
+    }
+
+    /// @brief Sets a bit of the bitvector, and updates the hash.
+    /// @param bitvector the hashed bitvector.
+    /// @param position the position of the bit.
+    /// @param value the value of the bit.
+    constexpr inline void set(value_type &bitvector, std::size_t position, bool value = true)
+    {
+        const std::uint64_t previous = this->word(bitvector, position / 64);
+        bitvector[position]          = value;
+        this->update(position / 64, previous, this->word(bitvector, position / 64));
+    }
+
+    /// @brief Flips a bit of the bitvector, and updates the hash.
+    /// @param bitvector the hashed bitvector.
+    /// @param position the position of the bit.
+    constexpr inline void flip(value_type &bitvector, std::size_t position)
+    {
+        const std::uint64_t previous = this->word(bitvector, position / 64);
+        bitvector[position].flip();
+        this->update(position / 64, previous, previous ^ (std::uint64_t(1) << (position % 64)));
+    }
+
+private:
+    /// @brief Returns the 64-bit word with the given index.
+    static constexpr inline std::uint64_t word(const value_type &bitvector, std::size_t index)
+    {
+        return bvlib::detail::load_word(bitvector.data, value_type::num_blocks, index);
+    }
+
+    /// The sum of the contributions of the words.
+    std::uint64_t _sum;
+    /// The seed.
+    std::uint64_t _seed;
+};
+
+} // namespace bvlib
+
+namespace std
+{
+
+/// @brief Hash of the bitvectors, to use them as keys of unordered containers.
+template <std::size_t N, typename Block>
+struct hash<bvlib::BitVector<N, Block>> {
+    inline std::size_t operator()(const bvlib::BitVector<N, Block> &bitvector) const noexcept
+    {
+        return static_cast<std::size_t>(bvlib::hash(bitvector));
+    }
+};
+
+/// @brief Hash of the bitvectors, to use them as keys of unordered containers.
+template <typename Block, typename Allocator>
+struct hash<bvlib::DynamicBitVector<Block, Allocator>> {
+    inline std::size_t operator()(const bvlib::DynamicBitVector<Block, Allocator> &bitvector) const noexcept
+    {
+        return static_cast<std::size_t>(bvlib::hash(bitvector));
+    }
+};
+
+} // namespace std
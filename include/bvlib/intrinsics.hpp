@@ -0,0 +1,516 @@
+/// @file intrinsics.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Portable wrappers around the bit-manipulation instructions.
+/// @details Every function works on a single unsigned block and falls back to
+/// a portable implementation when the compiler does not provide a builtin.
+/// Every function is constexpr: during constant evaluation the intrinsics which
+/// are not constexpr are replaced by the portable implementation.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#endif
+
+#if defined(__SIZEOF_INT128__)
+#define BVLIB_HAS_INT128
+#endif
+
+/// @brief The carry-less multiplication instruction, PCLMULQDQ on x86 (which
+/// every CPU with AVX has) and PMULL on ARMv8 with the crypto extension.
+#if (defined(__PCLMUL__) && defined(__x86_64__)) || (defined(_MSC_VER) && !defined(__clang__) && defined(__AVX__) && defined(_M_X64))
+#include <wmmintrin.h>
+#define BVLIB_HAS_CLMUL_X86
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#include <arm_neon.h>
+#define BVLIB_HAS_CLMUL_NEON
+#endif
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_addcll) && __has_builtin(__builtin_subcll)
+#define BVLIB_HAS_BUILTIN_ADDC
+#endif
+#endif
+
+/// @brief Tests whether the code is being evaluated at compile time. When the
+/// compiler cannot tell, it always answers true, so that the portable code is used.
+#if !defined(BVLIB_IS_CONSTANT_EVALUATED) && defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define BVLIB_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+#if !defined(BVLIB_IS_CONSTANT_EVALUATED)
+#if (defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 9)) || (defined(_MSC_VER) && (_MSC_VER >= 1925))
+#define BVLIB_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define BVLIB_IS_CONSTANT_EVALUATED() true
+#endif
+#endif
+
+namespace bvlib
+{
+
+namespace detail
+{
+
+#if defined(BVLIB_HAS_INT128)
+/// Unsigned 128-bit integer, available on most 64-bit GCC and Clang targets.
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+/// @brief Returns the number of bits of the given unsigned type.
+template <typename T>
+constexpr inline std::size_t digits()
+{
+    return static_cast<std::size_t>(std::numeric_limits<T>::digits);
+}
+
+/// @brief Counts the number of bits set inside the value.
+/// @param value the input value.
+/// @return the number of bits set.
+template <typename T>
+constexpr inline std::size_t popcount(T value)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(T) <= sizeof(unsigned int))
+        return static_cast<std::size_t>(__builtin_popcount(value));
+    else if constexpr (sizeof(T) <= sizeof(unsigned long))
+        return static_cast<std::size_t>(__builtin_popcountl(value));
+    else
+        return static_cast<std::size_t>(__builtin_popcountll(value));
+#else
+#if defined(_MSC_VER) && defined(__AVX__) && (defined(_M_X64) || defined(_M_IX86))
+    if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+        if constexpr (sizeof(T) <= sizeof(unsigned int))
+            return static_cast<std::size_t>(__popcnt(value));
+#if defined(_M_X64)
+        else
+            return static_cast<std::size_t>(__popcnt64(value));
+#else
+        else
+            return static_cast<std::size_t>(__popcnt(static_cast<unsigned int>(value)) + __popcnt(static_cast<unsigned int>(value >> 32)));
+#endif
+    }
+#endif
+    std::size_t result = 0;
+    for (; value; ++result)
+        value = static_cast<T>(value & (value - 1U));
+    return result;
+#endif
+}
+
+/// @brief Counts the number of consecutive zero bits, starting from the most significant one.
+/// @param value the input value.
+/// @return the number of leading zeros, which is the number of digits of T if value is zero.
+template <typename T>
+constexpr inline std::size_t countl_zero(T value)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+    if (value == 0)
+        return digits<T>();
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(T) <= sizeof(unsigned int))
+        return static_cast<std::size_t>(__builtin_clz(value)) - (digits<unsigned int>() - digits<T>());
+    else if constexpr (sizeof(T) <= sizeof(unsigned long))
+        return static_cast<std::size_t>(__builtin_clzl(value)) - (digits<unsigned long>() - digits<T>());
+    else
+        return static_cast<std::size_t>(__builtin_clzll(value)) - (digits<unsigned long long>() - digits<T>());
+#else
+#if defined(_MSC_VER)
+    if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+        unsigned long index = 0;
+        if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+            _BitScanReverse(&index, static_cast<unsigned long>(value));
+            return digits<T>() - 1 - index;
+        }
+#if defined(_M_X64) || defined(_M_ARM64)
+        else {
+            _BitScanReverse64(&index, static_cast<unsigned long long>(value));
+            return digits<T>() - 1 - index;
+        }
+#else
+        else {
+            if (_BitScanReverse(&index, static_cast<unsigned long>(value >> 32)))
+                return 31 - index;
+            _BitScanReverse(&index, static_cast<unsigned long>(value));
+            return 63 - index;
+        }
+#endif
+    }
+#endif
+    std::size_t result = 0;
+    for (T mask = static_cast<T>(T(1) << (digits<T>() - 1)); !(value & mask); mask >>= 1)
+        ++result;
+    return result;
+#endif
+}
+
+/// @brief Counts the number of consecutive zero bits, starting from the least significant one.
+/// @param value the input value.
+/// @return the number of trailing zeros, which is the number of digits of T if value is zero.
+template <typename T>
+constexpr inline std::size_t countr_zero(T value)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+    if (value == 0)
+        return digits<T>();
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(T) <= sizeof(unsigned int))
+        return static_cast<std::size_t>(__builtin_ctz(value));
+    else if constexpr (sizeof(T) <= sizeof(unsigned long))
+        return static_cast<std::size_t>(__builtin_ctzl(value));
+    else
+        return static_cast<std::size_t>(__builtin_ctzll(value));
+#else
+#if defined(_MSC_VER)
+    if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+        unsigned long index = 0;
+        if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+            _BitScanForward(&index, static_cast<unsigned long>(value));
+            return index;
+        }
+#if defined(_M_X64) || defined(_M_ARM64)
+        else {
+            _BitScanForward64(&index, static_cast<unsigned long long>(value));
+            return index;
+        }
+#else
+        else {
+            if (_BitScanForward(&index, static_cast<unsigned long>(value)))
+                return index;
+            _BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+            return 32 + index;
+        }
+#endif
+    }
+#endif
+    std::size_t result = 0;
+    for (; !(value & 1U); value >>= 1)
+        ++result;
+    return result;
+#endif
+}
+
+/// @brief Finds the position of the k-th bit set, starting from the least significant one.
+/// @param value the input value.
+/// @param rank the number of set bits to skip, which must be smaller than popcount(value).
+/// @return the position of the bit.
+template <typename T>
+constexpr inline std::size_t select_one(T value, std::size_t rank)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+#if defined(__BMI2__) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    if constexpr (sizeof(T) == sizeof(unsigned long long)) {
+        if (!BVLIB_IS_CONSTANT_EVALUATED())
+            return countr_zero(static_cast<T>(_pdep_u64(1ULL << rank, value)));
+    }
+#endif
+    // Skip whole bytes, then clear the lowest bits of the remaining byte.
+    std::size_t offset = 0;
+    for (std::size_t count = popcount(static_cast<std::uint8_t>(value)); rank >= count; count = popcount(static_cast<std::uint8_t>(value))) {
+        rank -= count;
+        value = static_cast<T>(value >> 8U);
+        offset += 8;
+    }
+    for (; rank; --rank)
+        value = static_cast<T>(value & (value - 1U));
+    return offset + countr_zero(value);
+}
+
+/// @brief Adds two blocks and the incoming carry.
+/// @param lhs the first block.
+/// @param rhs the second block.
+/// @param carry the incoming carry.
+/// @param result where the sum is stored.
+/// @return the outgoing carry.
+template <typename T>
+constexpr inline bool addcarry(T lhs, T rhs, bool carry, T &result)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+    if constexpr (sizeof(T) < sizeof(std::uint64_t)) {
+        // Use a wider type, and extract the carry from the upper half.
+        using wide_t = typename std::conditional<(sizeof(T) < sizeof(std::uint32_t)), std::uint32_t, std::uint64_t>::type;
+        const wide_t sum = static_cast<wide_t>(static_cast<wide_t>(lhs) + rhs + carry);
+        result           = static_cast<T>(sum);
+        return (sum >> digits<T>()) != 0;
+    } else {
+#if (defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)) || (defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__))
+        if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+            unsigned long long sum = 0;
+            const bool carry_out   = _addcarry_u64(static_cast<unsigned char>(carry), lhs, rhs, &sum) != 0;
+            result                 = static_cast<T>(sum);
+            return carry_out;
+        }
+#elif defined(BVLIB_HAS_BUILTIN_ADDC)
+        if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+            unsigned long long carry_out = 0;
+            result                       = static_cast<T>(__builtin_addcll(lhs, rhs, carry, &carry_out));
+            return carry_out != 0;
+        }
+#endif
+#if defined(BVLIB_HAS_INT128)
+        const uint128_t sum = static_cast<uint128_t>(lhs) + rhs + carry;
+        result              = static_cast<T>(sum);
+        return (sum >> 64) != 0;
+#else
+        const T partial = static_cast<T>(lhs + rhs);
+        result          = static_cast<T>(partial + carry);
+        return (partial < lhs) || (result < partial);
+#endif
+    }
+}
+
+/// @brief Subtracts the second block and the incoming borrow from the first block.
+/// @param lhs the first block.
+/// @param rhs the second block.
+/// @param borrow the incoming borrow.
+/// @param result where the difference is stored.
+/// @return the outgoing borrow.
+template <typename T>
+constexpr inline bool subborrow(T lhs, T rhs, bool borrow, T &result)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+    if constexpr (sizeof(T) < sizeof(std::uint64_t)) {
+        // Use a wider type, the borrow wraps around and sets the upper half.
+        using wide_t = typename std::conditional<(sizeof(T) < sizeof(std::uint32_t)), std::uint32_t, std::uint64_t>::type;
+        const wide_t diff = static_cast<wide_t>(static_cast<wide_t>(lhs) - rhs - borrow);
+        result            = static_cast<T>(diff);
+        return (diff >> digits<T>()) != 0;
+    } else {
+#if (defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)) || (defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__))
+        if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+            unsigned long long diff = 0;
+            const bool borrow_out   = _subborrow_u64(static_cast<unsigned char>(borrow), lhs, rhs, &diff) != 0;
+            result                  = static_cast<T>(diff);
+            return borrow_out;
+        }
+#elif defined(BVLIB_HAS_BUILTIN_ADDC)
+        if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+            unsigned long long borrow_out = 0;
+            result                        = static_cast<T>(__builtin_subcll(lhs, rhs, borrow, &borrow_out));
+            return borrow_out != 0;
+        }
+#endif
+#if defined(BVLIB_HAS_INT128)
+        const uint128_t diff = static_cast<uint128_t>(lhs) - rhs - borrow;
+        result               = static_cast<T>(diff);
+        return (diff >> 64) != 0;
+#else
+        const T partial = static_cast<T>(lhs - rhs);
+        result          = static_cast<T>(partial - borrow);
+        return (lhs < rhs) || (partial < static_cast<T>(borrow));
+#endif
+    }
+}
+
+/// @brief Multiplies two blocks, producing a result twice as wide.
+/// @param lhs the first block.
+/// @param rhs the second block.
+/// @param high where the most significant half of the product is stored.
+/// @return the least significant half of the product.
+template <typename T>
+constexpr inline T mul_wide(T lhs, T rhs, T &high)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+    if constexpr (sizeof(T) < sizeof(std::uint64_t)) {
+        using wide_t          = typename std::conditional<(sizeof(T) < sizeof(std::uint32_t)), std::uint32_t, std::uint64_t>::type;
+        const wide_t product = static_cast<wide_t>(static_cast<wide_t>(lhs) * rhs);
+        high                 = static_cast<T>(product >> digits<T>());
+        return static_cast<T>(product);
+    } else {
+#if defined(BVLIB_HAS_INT128)
+        const uint128_t product = static_cast<uint128_t>(lhs) * rhs;
+        high                    = static_cast<T>(product >> 64);
+        return static_cast<T>(product);
+#else
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+        if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+            unsigned long long product_high      = 0;
+            const unsigned long long product_low = _umul128(lhs, rhs, &product_high);
+            high                                 = static_cast<T>(product_high);
+            return static_cast<T>(product_low);
+        }
+#endif
+        // Split the operands in 32-bit halves, and combine the partial products.
+        const std::uint64_t a_lo = lhs & 0xFFFFFFFFU, a_hi = lhs >> 32;
+        const std::uint64_t b_lo = rhs & 0xFFFFFFFFU, b_hi = rhs >> 32;
+        const std::uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+        const std::uint64_t middle = (p0 >> 32) + (p1 & 0xFFFFFFFFU) + (p2 & 0xFFFFFFFFU);
+        high                       = static_cast<T>(p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32));
+        return static_cast<T>((middle << 32) | (p0 & 0xFFFFFFFFU));
+#endif
+    }
+}
+
+/// @brief Multiplies two blocks as polynomials over GF(2), i.e., with xor instead of addition.
+/// @param lhs the first block.
+/// @param rhs the second block.
+/// @param high where the most significant half of the product is stored.
+/// @return the least significant half of the product.
+template <typename T>
+constexpr inline T clmul_wide(T lhs, T rhs, T &high)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+    if constexpr (sizeof(T) == sizeof(std::uint64_t)) {
+#if defined(BVLIB_HAS_CLMUL_X86)
+        if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+            const __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(lhs)), _mm_cvtsi64_si128(static_cast<long long>(rhs)), 0x00);
+            high                  = static_cast<T>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(product, product)));
+            return static_cast<T>(_mm_cvtsi128_si64(product));
+        }
+#elif defined(BVLIB_HAS_CLMUL_NEON)
+        if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+            const uint64x2_t product = vreinterpretq_u64_p128(vmull_p64(static_cast<poly64_t>(lhs), static_cast<poly64_t>(rhs)));
+            high                     = static_cast<T>(vgetq_lane_u64(product, 1));
+            return static_cast<T>(vgetq_lane_u64(product, 0));
+        }
+#endif
+    }
+    // Shift-and-xor, with masks instead of branches.
+    T low = 0;
+    high  = 0;
+    for (std::size_t it = 0; it < digits<T>(); ++it) {
+        const T mask = static_cast<T>(0U - static_cast<T>((rhs >> it) & 1U));
+        low          = static_cast<T>(low ^ (static_cast<T>(lhs << it) & mask));
+        if (it > 0)
+            high = static_cast<T>(high ^ (static_cast<T>(lhs >> (digits<T>() - it)) & mask));
+    }
+    return low;
+}
+
+/// @brief Shifts the concatenation of two values to the left, and returns its most significant half.
+/// @param high the most significant value.
+/// @param low the least significant value, whose top bits are shifted into high.
+/// @param shift the number of bits, smaller than the bits of T.
+/// @return the most significant half of (high:low) << shift.
+template <typename T>
+constexpr inline T funnel_shift_left(T high, T low, std::size_t shift)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    if constexpr (sizeof(T) == sizeof(std::uint64_t))
+        if (!BVLIB_IS_CONSTANT_EVALUATED())
+            return static_cast<T>(__shiftleft128(low, high, static_cast<unsigned char>(shift)));
+#elif defined(BVLIB_HAS_INT128)
+    if constexpr (sizeof(T) == sizeof(std::uint64_t))
+        return static_cast<T>((((static_cast<uint128_t>(high) << 64) | low) << shift) >> 64);
+#endif
+    // Splitting the right shift keeps it defined when shift is zero.
+    return static_cast<T>((high << shift) | ((low >> 1U) >> (digits<T>() - 1 - shift)));
+}
+
+/// @brief Shifts the concatenation of two values to the right, and returns its least significant half.
+/// @param high the most significant value, whose bottom bits are shifted into low.
+/// @param low the least significant value.
+/// @param shift the number of bits, smaller than the bits of T.
+/// @return the least significant half of (high:low) >> shift.
+template <typename T>
+constexpr inline T funnel_shift_right(T high, T low, std::size_t shift)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    if constexpr (sizeof(T) == sizeof(std::uint64_t))
+        if (!BVLIB_IS_CONSTANT_EVALUATED())
+            return static_cast<T>(__shiftright128(low, high, static_cast<unsigned char>(shift)));
+#elif defined(BVLIB_HAS_INT128)
+    if constexpr (sizeof(T) == sizeof(std::uint64_t))
+        return static_cast<T>(((static_cast<uint128_t>(high) << 64) | low) >> shift);
+#endif
+    return static_cast<T>((low >> shift) | ((high << 1U) << (digits<T>() - 1 - shift)));
+}
+
+/// @brief Divides a number twice as wide as a block by a block.
+/// @param high the most significant half of the dividend, which must be smaller than divisor.
+/// @param low the least significant half of the dividend.
+/// @param divisor the divisor.
+/// @param remainder where the remainder is stored.
+/// @return the quotient.
+template <typename T>
+constexpr inline T div_wide(T high, T low, T divisor, T &remainder)
+{
+    static_assert(std::is_unsigned<T>::value, "Only unsigned types are supported");
+    if constexpr (sizeof(T) < sizeof(std::uint64_t)) {
+        using wide_t           = typename std::conditional<(sizeof(T) < sizeof(std::uint32_t)), std::uint32_t, std::uint64_t>::type;
+        const wide_t dividend = static_cast<wide_t>((static_cast<wide_t>(high) << digits<T>()) | low);
+        remainder             = static_cast<T>(dividend % divisor);
+        return static_cast<T>(dividend / divisor);
+    } else {
+#if defined(BVLIB_HAS_INT128)
+        const uint128_t dividend = (static_cast<uint128_t>(high) << 64) | low;
+        remainder                = static_cast<T>(dividend % divisor);
+        return static_cast<T>(dividend / divisor);
+#else
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64) && (_MSC_VER >= 1920)
+        if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+            unsigned long long rem            = 0;
+            const unsigned long long quotient = _udiv128(high, low, divisor, &rem);
+            remainder                         = static_cast<T>(rem);
+            return static_cast<T>(quotient);
+        }
+#endif
+        // Restoring division, one bit at a time.
+        T quotient = 0;
+        for (std::size_t it = 0; it < 64; ++it) {
+            const bool overflow = (high >> 63) != 0;
+            high                = static_cast<T>((high << 1) | (low >> 63));
+            low                 = static_cast<T>(low << 1);
+            quotient            = static_cast<T>(quotient << 1);
+            if (overflow || (high >= divisor)) {
+                high = static_cast<T>(high - divisor);
+                quotient |= 1U;
+            }
+        }
+        remainder = high;
+        return quotient;
+#endif
+    }
+}
+
+/// @brief Computes the reciprocal of a normalized divisor, used by div_2by1.
+/// @param divisor the divisor, whose most significant bit must be set.
+/// @return the reciprocal, i.e., floor((B^2 - 1) / divisor) - B, where B = 2^digits.
+template <typename T>
+constexpr inline T reciprocal_2by1(T divisor)
+{
+    T remainder = 0;
+    return div_wide(static_cast<T>(~divisor), static_cast<T>(~T(0)), divisor, remainder);
+}
+
+/// @brief Divides a number twice as wide as a block by a normalized block, through its reciprocal.
+/// @param high the most significant half of the dividend, which must be smaller than divisor.
+/// @param low the least significant half of the dividend.
+/// @param divisor the divisor, whose most significant bit must be set.
+/// @param reciprocal the reciprocal of the divisor, computed by reciprocal_2by1.
+/// @param remainder where the remainder is stored.
+/// @return the quotient.
+/// @details This is Algorithm 4 from "Improved division by invariant integers",
+/// by N. Moller and T. Granlund, which replaces the division with two multiplications.
+template <typename T>
+constexpr inline T div_2by1(T high, T low, T divisor, T reciprocal, T &remainder)
+{
+    T quotient_high = 0, quotient_low = mul_wide(reciprocal, high, quotient_high);
+    const bool carry = addcarry(quotient_low, low, false, quotient_low);
+    quotient_high    = static_cast<T>(quotient_high + high + carry + 1U);
+    remainder        = static_cast<T>(low - static_cast<T>(quotient_high * divisor));
+    if (remainder > quotient_low) {
+        quotient_high = static_cast<T>(quotient_high - 1U);
+        remainder     = static_cast<T>(remainder + divisor);
+    }
+    if (remainder >= divisor) {
+        quotient_high = static_cast<T>(quotient_high + 1U);
+        remainder     = static_cast<T>(remainder - divisor);
+    }
+    return quotient_high;
+}
+
+} // namespace detail
+
+} // namespace bvlib
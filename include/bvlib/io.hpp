@@ -1,41 +1,507 @@
 /// @file io.hpp
 /// @author Enrico Fraccaroli (enry.frak@gmail.com)
-/// @brief Input and output stream operators.
+/// @brief Input and output stream operators, and binary serialization.
+/// @details The stream operators read and write the decimal value of the
+/// bitvectors, with all their bits, and the signed ones have a leading minus
+/// when they are negative. The binary format is meant for large
+/// amounts of bitvectors: a header of 24 bytes, holding the characters "BVLB",
+/// the version, the byte order, the number of bits of each bitvector, and the
+/// number of bitvectors (the last two as 64-bit little-endian integers), which
+/// is followed by the bitvectors, each one as its (N + 7) / 8 bytes, least
+/// significant first. The format does not depend on the type of the blocks,
+/// and on little-endian machines it is a plain copy of the blocks.
 
 #pragma once
 
+#include "bitvector.hpp"
+#include "bitvector_array.hpp"
+#include "charconv.hpp"
+#include "signed_bitvector.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
-#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <system_error>
+#include <unistd.h>
+#define BVLIB_IO_POSIX
+#endif
+
+#if (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)) || defined(_MSC_VER)
+#define BVLIB_IO_LITTLE_ENDIAN
+#endif
+
+/// @brief The size, in bytes, of the buffer used to read and write binary
+/// streams. It can be tuned by defining it before including this header.
+#ifndef BVLIB_IO_BUFFER_SIZE
+#define BVLIB_IO_BUFFER_SIZE (1024 * 1024)
+#endif
+
+template <std::size_t N, typename Block>
+std::ostream &operator<<(std::ostream &lhs, const bvlib::BitVector<N, Block> &rhs)
+{
+    std::string buffer(bvlib::max_chars(N, 10), '0');
+    buffer.resize(static_cast<std::size_t>(bvlib::to_chars(&buffer[0], &buffer[0] + buffer.size(), rhs).ptr - &buffer[0]));
+    lhs << buffer;
+    return lhs;
+}
+
+template <std::size_t N, typename Block>
+std::stringstream &operator<<(std::stringstream &lhs, const bvlib::BitVector<N, Block> &rhs)
+{
+    static_cast<std::ostream &>(lhs) << rhs;
+    return lhs;
+}
 
-template <std::size_t N>
-std::ostream &operator<<(std::ostream &lhs, const bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block>
+std::istream &operator>>(std::istream &lhs, bvlib::BitVector<N, Block> &rhs)
 {
-    lhs << rhs.template to_number<long>();
+    std::string buffer;
+    if (lhs >> buffer) {
+        const auto result = bvlib::from_chars(buffer.data(), buffer.data() + buffer.size(), rhs);
+        if ((result.ec != std::errc()) || (result.ptr != buffer.data() + buffer.size()))
+            lhs.setstate(std::ios_base::failbit);
+    }
     return lhs;
 }
 
-template <std::size_t N>
-std::stringstream &operator<<(std::stringstream &lhs, const bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block>
+std::ifstream &operator>>(std::ifstream &lhs, bvlib::BitVector<N, Block> &rhs)
 {
-    lhs << rhs.template to_number<long>();
+    static_cast<std::istream &>(lhs) >> rhs;
     return lhs;
 }
 
-template <std::size_t N>
-std::ifstream &operator>>(std::ifstream &lhs, bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block>
+std::stringstream &operator>>(std::stringstream &lhs, bvlib::BitVector<N, Block> &rhs)
 {
-    long value;
-    lhs >> value;
-    rhs = value;
+    static_cast<std::istream &>(lhs) >> rhs;
     return lhs;
 }
 
-template <std::size_t N>
-std::stringstream &operator>>(std::stringstream &lhs, bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block>
+std::ostream &operator<<(std::ostream &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
 {
-    long value;
-    lhs >> value;
-    rhs = value;
+    if (rhs.is_negative())
+        lhs << '-';
+    lhs << rhs.abs();
     return lhs;
 }
+
+template <std::size_t N, typename Block>
+std::istream &operator>>(std::istream &lhs, bvlib::SignedBitVector<N, Block> &rhs)
+{
+    std::string buffer;
+    if (lhs >> buffer) {
+        const bool negative = !buffer.empty() && (buffer[0] == '-');
+        const char *first   = buffer.data() + (negative ? 1 : 0);
+        bvlib::BitVector<N, Block> magnitude;
+        const auto result = bvlib::from_chars(first, buffer.data() + buffer.size(), magnitude);
+        // The magnitude of a negative value can reach 2^(N-1), the one of a positive value cannot.
+        const bool overflow = magnitude.sign() && (!negative || (magnitude != bvlib::SignedBitVector<N, Block>::min().bits));
+        if ((result.ec != std::errc()) || (result.ptr != buffer.data() + buffer.size()) || overflow)
+            lhs.setstate(std::ios_base::failbit);
+        else
+            rhs = negative ? -bvlib::SignedBitVector<N, Block>(magnitude) : bvlib::SignedBitVector<N, Block>(magnitude);
+    }
+    return lhs;
+}
+
+namespace bvlib
+{
+
+#if defined(BVLIB_IO_POSIX)
+/// @brief Wraps a POSIX file descriptor, to read and write binary streams with it.
+struct file_descriptor {
+    /// The file descriptor.
+    int fd;
+};
+#endif
+
+namespace detail
+{
+
+/// The size of the header of binary streams.
+constexpr std::size_t binary_header_size = 24;
+
+/// The version of the binary format.
+constexpr unsigned char binary_version = 1;
+
+/// The byte order of the binary format, which is little-endian.
+constexpr unsigned char binary_little_endian = 0;
+
+/// @brief The content of the header of a binary stream.
+struct binary_header {
+    /// The number of bits of each bitvector.
+    std::uint64_t width;
+    /// The number of bitvectors.
+    std::uint64_t count;
+};
+
+/// @brief Writes binary data to an output stream.
+struct ostream_sink {
+    std::ostream *stream;
+
+    inline void write(const char *data, std::size_t size) const
+    {
+        if (!stream->write(data, static_cast<std::streamsize>(size)))
+            throw std::runtime_error("error writing bitvector stream");
+    }
+};
+
+/// @brief Reads binary data from an input stream.
+struct istream_source {
+    std::istream *stream;
+
+    inline void read(char *data, std::size_t size) const
+    {
+        if (!stream->read(data, static_cast<std::streamsize>(size)))
+            throw std::runtime_error("unexpected end of bitvector stream");
+    }
+};
+
+/// @brief Writes binary data to a C file.
+struct file_sink {
+    std::FILE *file;
+
+    inline void write(const char *data, std::size_t size) const
+    {
+        if (std::fwrite(data, 1, size, file) != size)
+            throw std::runtime_error("error writing bitvector stream");
+    }
+};
+
+/// @brief Reads binary data from a C file.
+struct file_source {
+    std::FILE *file;
+
+    inline void read(char *data, std::size_t size) const
+    {
+        if (std::fread(data, 1, size, file) != size)
+            throw std::runtime_error("unexpected end of bitvector stream");
+    }
+};
+
+#if defined(BVLIB_IO_POSIX)
+/// @brief Writes binary data to a file descriptor.
+struct fd_sink {
+    int fd;
+
+    inline void write(const char *data, std::size_t size) const
+    {
+        while (size) {
+            const ::ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "error writing bitvector stream");
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
+};
+
+/// @brief Reads binary data from a file descriptor.
+struct fd_source {
+    int fd;
+
+    inline void read(char *data, std::size_t size) const
+    {
+        while (size) {
+            const ::ssize_t read = ::read(fd, data, size);
+            if (read < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "error reading bitvector stream");
+            }
+            if (read == 0)
+                throw std::runtime_error("unexpected end of bitvector stream");
+            data += read;
+            size -= static_cast<std::size_t>(read);
+        }
+    }
+};
+#endif
+
+inline ostream_sink make_sink(std::ostream &stream)
+{
+    return ostream_sink{ &stream };
+}
+
+inline istream_source make_source(std::istream &stream)
+{
+    return istream_source{ &stream };
+}
+
+inline file_sink make_sink(std::FILE *file)
+{
+    return file_sink{ file };
+}
+
+inline file_source make_source(std::FILE *file)
+{
+    return file_source{ file };
+}
+
+#if defined(BVLIB_IO_POSIX)
+inline fd_sink make_sink(file_descriptor descriptor)
+{
+    return fd_sink{ descriptor.fd };
+}
+
+inline fd_source make_source(file_descriptor descriptor)
+{
+    return fd_source{ descriptor.fd };
+}
+#endif
+
+/// @brief Writes the lowest bytes of the blocks, least significant first.
+template <typename Block>
+inline void store_bytes(const Block *data, std::size_t bytes, char *out)
+{
+#if defined(BVLIB_IO_LITTLE_ENDIAN)
+    std::memcpy(out, data, bytes);
+#else
+    for (std::size_t it = 0; it < bytes; ++it)
+        out[it] = static_cast<char>(static_cast<unsigned char>(data[it / sizeof(Block)] >> (8 * (it % sizeof(Block)))));
+#endif
+}
+
+/// @brief Reads the lowest bytes of the blocks, least significant first, and clears the others.
+template <typename Block>
+inline void load_bytes(Block *data, std::size_t num_blocks, const char *in, std::size_t bytes)
+{
+#if defined(BVLIB_IO_LITTLE_ENDIAN)
+    std::memcpy(data, in, bytes);
+    std::memset(reinterpret_cast<char *>(data) + bytes, 0, num_blocks * sizeof(Block) - bytes);
+#else
+    std::fill(data, data + num_blocks, Block(0));
+    for (std::size_t it = 0; it < bytes; ++it)
+        data[it / sizeof(Block)] = static_cast<Block>(data[it / sizeof(Block)] | (static_cast<Block>(static_cast<unsigned char>(in[it])) << (8 * (it % sizeof(Block)))));
+#endif
+}
+
+/// @brief Returns the size of the buffer used to transfer the given number of values.
+inline std::size_t binary_buffer_size(std::size_t bytes, std::size_t count)
+{
+    return std::max(bytes, std::min(static_cast<std::size_t>(BVLIB_IO_BUFFER_SIZE) / bytes * bytes, bytes * count));
+}
+
+template <typename Sink>
+inline void write_binary_header(const Sink &sink, std::uint64_t width, std::uint64_t count)
+{
+    char header[binary_header_size] = { 'B', 'V', 'L', 'B', static_cast<char>(binary_version), static_cast<char>(binary_little_endian) };
+    for (std::size_t it = 0; it < 8; ++it) {
+        header[8 + it]  = static_cast<char>(static_cast<unsigned char>(width >> (8 * it)));
+        header[16 + it] = static_cast<char>(static_cast<unsigned char>(count >> (8 * it)));
+    }
+    sink.write(header, binary_header_size);
+}
+
+template <typename Source>
+inline binary_header read_binary_header(const Source &source, std::size_t width)
+{
+    char header[binary_header_size];
+    source.read(header, binary_header_size);
+    if ((std::memcmp(header, "BVLB", 4) != 0) || (static_cast<unsigned char>(header[4]) != binary_version))
+        throw std::runtime_error("invalid bitvector stream");
+    if (static_cast<unsigned char>(header[5]) != binary_little_endian)
+        throw std::runtime_error("unsupported byte order of bitvector stream");
+    binary_header result{ 0, 0 };
+    for (std::size_t it = 0; it < 8; ++it) {
+        result.width |= static_cast<std::uint64_t>(static_cast<unsigned char>(header[8 + it])) << (8 * it);
+        result.count |= static_cast<std::uint64_t>(static_cast<unsigned char>(header[16 + it])) << (8 * it);
+    }
+    if (result.width != width)
+        throw std::invalid_argument("bitvector stream has a different width");
+    if (static_cast<std::uint64_t>(static_cast<std::size_t>(result.count)) != result.count)
+        throw std::length_error("bitvector stream is too large");
+    return result;
+}
+
+/// @brief Writes the header and the bitvectors, through a buffer.
+/// @param get returns the bitvector with the given index.
+template <std::size_t N, typename Block, typename Sink, typename Function>
+inline void write_binary_values(const Sink &sink, std::size_t count, Function &&get)
+{
+    constexpr std::size_t bytes = (N + 7) / 8;
+    bvlib::detail::write_binary_header(sink, N, count);
+    std::vector<char> buffer(bvlib::detail::binary_buffer_size(bytes, count));
+    std::size_t used = 0;
+    for (std::size_t it = 0; it < count; ++it) {
+        if (used + bytes > buffer.size()) {
+            sink.write(buffer.data(), used);
+            used = 0;
+        }
+        const BitVector<N, Block> &value = get(it);
+        bvlib::detail::store_bytes(value.data, bytes, buffer.data() + used);
+        used += bytes;
+    }
+    if (used)
+        sink.write(buffer.data(), used);
+}
+
+/// @brief Reads the bitvectors following the header, through a buffer.
+/// @param set receives the index and the value of each bitvector.
+template <std::size_t N, typename Block, typename Source, typename Function>
+inline void read_binary_values(const Source &source, std::size_t count, Function &&set)
+{
+    constexpr std::size_t bytes = (N + 7) / 8;
+    std::vector<char> buffer(bvlib::detail::binary_buffer_size(bytes, count));
+    BitVector<N, Block> value;
+    for (std::size_t it = 0; it < count;) {
+        const std::size_t chunk = std::min(count - it, buffer.size() / bytes);
+        source.read(buffer.data(), chunk * bytes);
+        for (std::size_t offset = 0; offset < chunk; ++offset, ++it) {
+            bvlib::detail::load_bytes(value.data, BitVector<N, Block>::num_blocks, buffer.data() + offset * bytes, bytes);
+            value.data[BitVector<N, Block>::num_blocks - 1] &= BitVector<N, Block>::last_block_mask;
+            set(it, value);
+        }
+    }
+}
+
+/// @brief Writes the header and an array of bitvectors.
+template <typename Sink, std::size_t N, typename Block>
+inline void write_binary_array(const Sink &sink, const BitVector<N, Block> *values, std::size_t count)
+{
+#if defined(BVLIB_IO_LITTLE_ENDIAN)
+    // Without unused bytes, the bitvectors are already in the binary format.
+    if ((N + 7) / 8 == sizeof(BitVector<N, Block>)) {
+        bvlib::detail::write_binary_header(sink, N, count);
+        if (count)
+            sink.write(reinterpret_cast<const char *>(values), count * sizeof(BitVector<N, Block>));
+        return;
+    }
+#endif
+    bvlib::detail::write_binary_values<N, Block>(sink, count, [values](std::size_t index) -> const BitVector<N, Block> & { return values[index]; });
+}
+
+/// @brief Reads an array of bitvectors following the header.
+template <typename Source, std::size_t N, typename Block>
+inline void read_binary_array(const Source &source, BitVector<N, Block> *values, std::size_t count)
+{
+#if defined(BVLIB_IO_LITTLE_ENDIAN)
+    // Without unused bytes, the stream is copied into the bitvectors.
+    if ((N + 7) / 8 == sizeof(BitVector<N, Block>)) {
+        if (count)
+            source.read(reinterpret_cast<char *>(values), count * sizeof(BitVector<N, Block>));
+        for (std::size_t it = 0; it < count; ++it)
+            values[it].data[BitVector<N, Block>::num_blocks - 1] &= BitVector<N, Block>::last_block_mask;
+        return;
+    }
+#endif
+    bvlib::detail::read_binary_values<N, Block>(source, count, [values](std::size_t index, const BitVector<N, Block> &value) { values[index] = value; });
+}
+
+} // namespace detail
+
+/// @brief Writes an array of bitvectors in the binary format.
+/// @param stream a std::ostream, a FILE *, or a file_descriptor.
+/// @param values the bitvectors.
+/// @param count the number of bitvectors.
+template <typename Stream, std::size_t N, typename Block>
+inline void write_binary(Stream &&stream, const BitVector<N, Block> *values, std::size_t count)
+{
+    bvlib::detail::write_binary_array(bvlib::detail::make_sink(stream), values, count);
+}
+
+/// @brief Writes a bitvector in the binary format.
+/// @param stream a std::ostream, a FILE *, or a file_descriptor.
+/// @param value the bitvector.
+template <typename Stream, std::size_t N, typename Block>
+inline void write_binary(Stream &&stream, const BitVector<N, Block> &value)
+{
+    bvlib::write_binary(stream, &value, 1);
+}
+
+/// @brief Writes a vector of bitvectors in the binary format.
+/// @param stream a std::ostream, a FILE *, or a file_descriptor.
+/// @param values the bitvectors.
+template <typename Stream, std::size_t N, typename Block, typename Allocator>
+inline void write_binary(Stream &&stream, const std::vector<BitVector<N, Block>, Allocator> &values)
+{
+    bvlib::write_binary(stream, values.data(), values.size());
+}
+
+/// @brief Writes the bitvectors of an array in the binary format.
+/// @param stream a std::ostream, a FILE *, or a file_descriptor.
+/// @param array the array.
+template <typename Stream, std::size_t N, typename Block>
+inline void write_binary(Stream &&stream, const BitVectorArray<N, Block> &array)
+{
+    bvlib::detail::write_binary_values<N, Block>(bvlib::detail::make_sink(stream), array.size(), [&array](std::size_t index) { return array.get(index); });
+}
+
+/// @brief Reads an array of bitvectors written in the binary format.
+/// @param stream a std::istream, a FILE *, or a file_descriptor.
+/// @param values where the bitvectors are stored.
+/// @param count the number of bitvectors, which must be the one of the stream.
+template <typename Stream, std::size_t N, typename Block>
+inline void read_binary(Stream &&stream, BitVector<N, Block> *values, std::size_t count)
+{
+    const auto source = bvlib::detail::make_source(stream);
+    if (bvlib::detail::read_binary_header(source, N).count != count)
+        throw std::invalid_argument("bitvector stream has a different number of bitvectors");
+    bvlib::detail::read_binary_array(source, values, count);
+}
+
+/// @brief Reads a bitvector written in the binary format.
+/// @param stream a std::istream, a FILE *, or a file_descriptor.
+/// @param value where the bitvector is stored.
+template <typename Stream, std::size_t N, typename Block>
+inline void read_binary(Stream &&stream, BitVector<N, Block> &value)
+{
+    bvlib::read_binary(stream, &value, 1);
+}
+
+/// @brief Reads a vector of bitvectors written in the binary format.
+/// @param stream a std::istream, a FILE *, or a file_descriptor.
+/// @param values where the bitvectors are stored, resized to the number of bitvectors of the stream.
+/// @details The number of bitvectors of the header is not trusted, the
+/// vector grows one buffer at a time, as the bitvectors are read.
+template <typename Stream, std::size_t N, typename Block, typename Allocator>
+inline void read_binary(Stream &&stream, std::vector<BitVector<N, Block>, Allocator> &values)
+{
+    const auto source       = bvlib::detail::make_source(stream);
+    const std::size_t count = static_cast<std::size_t>(bvlib::detail::read_binary_header(source, N).count);
+    const std::size_t chunk = bvlib::detail::binary_buffer_size((N + 7) / 8, count) / ((N + 7) / 8);
+    values.clear();
+    for (std::size_t it = 0; it < count; it += chunk) {
+        const std::size_t size = std::min(chunk, count - it);
+        values.resize(it + size);
+        bvlib::detail::read_binary_array(source, values.data() + it, size);
+    }
+}
+
+/// @brief Reads the bitvectors of an array written in the binary format.
+/// @param stream a std::istream, a FILE *, or a file_descriptor.
+/// @param array where the bitvectors are stored, resized to the number of bitvectors of the stream.
+/// @details The number of bitvectors of the header is not trusted, the
+/// array doubles its size when it is full, as the bitvectors are read.
+template <typename Stream, std::size_t N, typename Block>
+inline void read_binary(Stream &&stream, BitVectorArray<N, Block> &array)
+{
+    const auto source       = bvlib::detail::make_source(stream);
+    const std::size_t count = static_cast<std::size_t>(bvlib::detail::read_binary_header(source, N).count);
+    const std::size_t chunk = bvlib::detail::binary_buffer_size((N + 7) / 8, count) / ((N + 7) / 8);
+    array.resize(0);
+    for (std::size_t it = 0; it < count; it += chunk) {
+        const std::size_t size = std::min(chunk, count - it);
+        if (it + size > array.size())
+            array.resize(std::max(it + size, std::min(count, 2 * array.size())));
+        bvlib::detail::read_binary_values<N, Block>(source, size, [&array, it](std::size_t index, const BitVector<N, Block> &value) { array.set(it + index, value); });
+    }
+    array.resize(count);
+}
+
+} // namespace bvlib
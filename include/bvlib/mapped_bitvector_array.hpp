@@ -0,0 +1,326 @@
+/// @file mapped_bitvector_array.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Read-only array of bitvectors mapped from a file in the binary format.
+/// @details The file, written by write_binary, is mapped in memory with `mmap`
+/// (or `MapViewOfFile` on Windows), and its pages are only read when they are
+/// accessed. When N is a multiple of the bits of the blocks, on little-endian
+/// machines the bitvectors of the file have the same layout they have in
+/// memory, and they are accessed in place, without parsing or copying them.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "io.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bvlib
+{
+
+/// @brief How the bitvectors of a mapping are going to be accessed.
+enum class map_advice {
+    /// No particular order.
+    normal,
+    /// In increasing order, so the following pages can be read ahead.
+    sequential,
+    /// In random order, so the pages should not be read ahead.
+    random,
+    /// Soon, so the pages can be read in advance.
+    will_need,
+};
+
+/// @brief Read-only array of bitvectors mapped from a file in the binary format.
+/// @tparam N the number of bits of each bitvector.
+/// @tparam Block the type used to store the bits.
+template <std::size_t N, typename Block = std::uint64_t>
+class MappedBitVectorArray {
+public:
+    /// The type of the elements.
+    using value_type = BitVector<N, Block>;
+
+    /// The type of the iterators, only available when zero_copy is true.
+    using const_iterator = const value_type *;
+
+    /// The number of bytes of each bitvector inside the file.
+    static constexpr std::size_t value_bytes = (N + 7) / 8;
+
+    /// Whether the bitvectors are accessed in place, without copying them.
+#if defined(BVLIB_IO_LITTLE_ENDIAN)
+    static constexpr bool zero_copy = (N % value_type::bits_per_block == 0) && (alignof(value_type) <= 8);
+#else
+    static constexpr bool zero_copy = false;
+#endif
+
+    /// The value used to select all the bitvectors up to the end of the array.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// @brief Builds an empty array, not mapped to any file.
+    MappedBitVectorArray() noexcept
+        : _mapping(nullptr),
+          _length(0),
+          _size(0)
+    {
+    }
+
+    /// @brief Maps the given file.
+    /// @param path the path of a file written by write_binary, with bitvectors of N bits.
+    /// @param advice how the bitvectors are going to be accessed.
+    explicit MappedBitVectorArray(const std::string &path, map_advice advice = map_advice::normal)
+        : MappedBitVectorArray()
+    {
+        this->open(path);
+        try {
+            const bvlib::detail::binary_header header = bvlib::detail::read_binary_header(source{ _mapping, _length }, N);
+            if ((_length - bvlib::detail::binary_header_size) / value_bytes < header.count)
+                throw std::runtime_error("unexpected end of bitvector stream");
+            _size = static_cast<std::size_t>(header.count);
+        } catch (...) {
+            this->close();
+            throw;
+        }
+        this->advise(advice);
+    }
+
+    MappedBitVectorArray(const MappedBitVectorArray &)            = delete;
+    MappedBitVectorArray &operator=(const MappedBitVectorArray &) = delete;
+
+    /// @brief Takes the mapping of another array, which becomes empty.
+    MappedBitVectorArray(MappedBitVectorArray &&other) noexcept
+        : _mapping(std::exchange(other._mapping, nullptr)),
+          _length(std::exchange(other._length, 0)),
+          _size(std::exchange(other._size, 0))
+    {
+    }
+
+    /// @brief Takes the mapping of another array, which becomes empty.
+    MappedBitVectorArray &operator=(MappedBitVectorArray &&other) noexcept
+    {
+        if (this != &other) {
+            this->close();
+            _mapping = std::exchange(other._mapping, nullptr);
+            _length  = std::exchange(other._length, 0);
+            _size    = std::exchange(other._size, 0);
+        }
+        return *this;
+    }
+
+    /// @brief Unmaps the file.
+    ~MappedBitVectorArray()
+    {
+        this->close();
+    }
+
+    /// @brief Returns the number of bitvectors.
+    inline std::size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /// @brief Tests whether there are no bitvectors.
+    inline bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    /// @brief Tests whether a file is mapped.
+    inline bool is_open() const noexcept
+    {
+        return _mapping != nullptr;
+    }
+
+    /// @brief Returns the bitvectors, which point inside the mapping.
+    inline const value_type *data() const noexcept
+    {
+        static_assert(zero_copy && (N > 0), "The bitvectors cannot be accessed in place, use get()");
+        return reinterpret_cast<const value_type *>(this->values());
+    }
+
+    /// @brief Returns an iterator to the first bitvector.
+    inline const_iterator begin() const noexcept
+    {
+        return this->data();
+    }
+
+    /// @brief Returns an iterator past the last bitvector.
+    inline const_iterator end() const noexcept
+    {
+        return this->data() + _size;
+    }
+
+    /// @brief Returns the bitvector with the given index, which points inside the mapping.
+    inline const value_type &operator[](std::size_t index) const
+    {
+#if defined(BVLIB_CHECKED)
+        return this->at(index);
+#else
+        assert(index < _size);
+        return this->data()[index];
+#endif
+    }
+
+    /// @brief Returns the bitvector with the given index, which points inside the mapping.
+    inline const value_type &at(std::size_t index) const
+    {
+        if (index >= _size)
+            throw std::out_of_range("accessing values outside bitvector array");
+        return this->data()[index];
+    }
+
+    /// @brief Returns a copy of the bitvector with the given index.
+    /// @details Unlike the other accessors, it is available for any N.
+    inline value_type get(std::size_t index) const
+    {
+        assert(index < _size);
+        value_type result;
+        bvlib::detail::load_bytes(result.data, value_type::num_blocks, this->values() + index * value_bytes, value_bytes);
+        result.data[value_type::num_blocks - 1] &= value_type::last_block_mask;
+        return result;
+    }
+
+    /// @brief Tells the system how a range of bitvectors is going to be accessed.
+    /// @param advice the expected access pattern.
+    /// @param first the index of the first bitvector of the range.
+    /// @param count the number of bitvectors of the range, up to the end by default.
+    inline void advise(map_advice advice, std::size_t first = 0, std::size_t count = npos) const noexcept
+    {
+        if (!_mapping || (first >= _size))
+            return;
+        count             = std::min(count, _size - first);
+        const char *begin = this->values() + first * value_bytes;
+        const char *end   = begin + count * value_bytes;
+#if defined(_WIN32)
+        // Windows only supports reading the pages in advance, since Windows 8.
+#if defined(_WIN32_WINNT) && (_WIN32_WINNT >= 0x0602)
+        if (advice == map_advice::will_need) {
+            WIN32_MEMORY_RANGE_ENTRY range{ const_cast<char *>(begin), static_cast<SIZE_T>(end - begin) };
+            ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+        }
+#else
+        static_cast<void>(advice);
+        static_cast<void>(end);
+#endif
+#else
+        // The range must start at the beginning of a page.
+        const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        begin                  = _mapping + static_cast<std::size_t>(begin - _mapping) / page * page;
+        int flag               = MADV_NORMAL;
+        if (advice == map_advice::sequential)
+            flag = MADV_SEQUENTIAL;
+        else if (advice == map_advice::random)
+            flag = MADV_RANDOM;
+        else if (advice == map_advice::will_need)
+            flag = MADV_WILLNEED;
+        // The advice is only a hint, its failure is not an error.
+        static_cast<void>(::madvise(const_cast<char *>(begin), static_cast<std::size_t>(end - begin), flag));
+#endif
+    }
+
+    /// @brief Unmaps the file, leaving the array empty.
+    inline void close() noexcept
+    {
+        if (_mapping) {
+#if defined(_WIN32)
+            ::UnmapViewOfFile(_mapping);
+#else
+            ::munmap(const_cast<char *>(_mapping), _length);
+#endif
+        }
+        _mapping = nullptr;
+        _length  = 0;
+        _size    = 0;
+    }
+
+private:
+    /// @brief Reads the header from the mapping.
+    struct source {
+        const char *data;
+        std::size_t size;
+
+        inline void read(char *out, std::size_t count) const
+        {
+            if (count > size)
+                throw std::runtime_error("unexpected end of bitvector stream");
+            std::memcpy(out, data, count);
+        }
+    };
+
+    /// @brief Returns the first byte of the bitvectors.
+    inline const char *values() const noexcept
+    {
+        return _mapping + bvlib::detail::binary_header_size;
+    }
+
+    /// @brief Maps the whole file, read-only.
+    inline void open(const std::string &path)
+    {
+#if defined(_WIN32)
+        HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(), "cannot open " + path);
+        LARGE_INTEGER length;
+        if (!::GetFileSizeEx(file, &length) || (static_cast<std::uint64_t>(length.QuadPart) < bvlib::detail::binary_header_size)) {
+            ::CloseHandle(file);
+            throw std::runtime_error("invalid bitvector stream");
+        }
+        // The view keeps the mapping alive, so both handles can be closed.
+        HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const DWORD error = ::GetLastError();
+        ::CloseHandle(file);
+        if (!mapping)
+            throw std::system_error(static_cast<int>(error), std::system_category(), "cannot map " + path);
+        _mapping = static_cast<const char *>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        const DWORD view_error = ::GetLastError();
+        ::CloseHandle(mapping);
+        if (!_mapping)
+            throw std::system_error(static_cast<int>(view_error), std::system_category(), "cannot map " + path);
+        _length = static_cast<std::size_t>(length.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+        struct stat status;
+        if ((::fstat(fd, &status) != 0) || (static_cast<std::uint64_t>(status.st_size) < bvlib::detail::binary_header_size)) {
+            ::close(fd);
+            throw std::runtime_error("invalid bitvector stream");
+        }
+        // The mapping stays valid after the file is closed.
+        void *mapping = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            throw std::system_error(error, std::generic_category(), "cannot map " + path);
+        _mapping = static_cast<const char *>(mapping);
+        _length  = static_cast<std::size_t>(status.st_size);
+#endif
+    }
+
+    /// The first byte of the mapping.
+    const char *_mapping;
+    /// The number of bytes of the mapping.
+    std::size_t _length;
+    /// The number of bitvectors.
+    std::size_t _size;
+};
+
+} // namespace bvlib
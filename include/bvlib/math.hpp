@@ -1,12 +1,25 @@
 /// @file math.hpp
 /// @author Enrico Fraccaroli (enry.frak@gmail.com)
 /// @brief Mathematical operations among bitvectors.
+/// @details Every operation is constexpr, and can be used to compute constants
+/// at compile time.
 
 #pragma once
 
 #include "bitvector.hpp"
+#include "simd.hpp"
+#include "stats.hpp"
 
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
+
+/// @brief Number of blocks above which the multiplication switches from the
+/// schoolbook algorithm to Karatsuba. It can be tuned by defining it before
+/// including this header, and it must be at least 4.
+#ifndef BVLIB_KARATSUBA_THRESHOLD
+#define BVLIB_KARATSUBA_THRESHOLD 32
+#endif
 
 namespace bvlib
 {
@@ -20,10 +33,15 @@ namespace bvlib
 /// @param b2 second bit.
 /// @param carry the carry from the operation.
 /// @return the sum of the two bits.
-inline bool add_bits(bool b1, bool b2, bool &carry)
+/// @details Besides bool, T can be any type providing the bitwise operators
+/// (e.g., an unsigned integer, or a bitvector), in which case each bit position
+/// is an independent full adder.
+template <typename T>
+constexpr inline T add_bits(const T &b1, const T &b2, T &carry)
 {
-    bool sum = (b1 ^ b2) ^ carry;
-    carry    = (b1 && b2) || (b1 && carry) || (b2 && carry);
+    const T half = static_cast<T>(b1 ^ b2);
+    const T sum  = static_cast<T>(half ^ carry);
+    carry        = static_cast<T>((b1 & b2) | (half & carry));
     return sum;
 }
 
@@ -32,25 +50,518 @@ inline bool add_bits(bool b1, bool b2, bool &carry)
 /// @param b2 second bit.
 /// @param borrow the borrow from the operation.
 /// @return the difference between the two bits.
-inline bool sub_bits(bool b1, bool b2, bool &borrow)
+/// @details Besides bool, T can be any type providing the bitwise operators
+/// (e.g., an unsigned integer, or a bitvector), in which case each bit position
+/// is an independent full subtractor.
+template <typename T>
+constexpr inline T sub_bits(const T &b1, const T &b2, T &borrow)
 {
-    bool difference = borrow ? !(b1 ^ b2) : b1 ^ b2;
-    borrow          = borrow ? !b1 || b2 : !b1 && b2;
+    const T difference = static_cast<T>((b1 ^ b2) ^ borrow);
+    // There is a borrow when b1 is zero and either b2 or the borrow is set, or
+    // when both are set; (b1 ^ subtrahend) & subtrahend is !b1 && subtrahend.
+    const T subtrahend = static_cast<T>(b2 | borrow);
+    borrow             = static_cast<T>((b2 & borrow) | ((b1 ^ subtrahend) & subtrahend));
     return difference;
 }
 
-/// @brief Returns the position of the most significant bit inside the given bitvector.
-/// @param bitvector the input bitvector.
-/// @return position of the most significant bit.
-template <std::size_t N>
-inline std::size_t most_significant_bit(const bvlib::BitVector<N> &bitvector)
+namespace detail
+{
+
+/// @brief Compares two numbers stored as arrays of blocks, least significant block first.
+/// @param lhs the blocks of the first number.
+/// @param lhs_size the number of blocks of the first number.
+/// @param rhs the blocks of the second number.
+/// @param rhs_size the number of blocks of the second number.
+/// @return a negative value if lhs < rhs, zero if they are equal, a positive value otherwise.
+template <typename Block>
+constexpr inline int compare_blocks(const Block *lhs, std::size_t lhs_size, const Block *rhs, std::size_t rhs_size)
+{
+    for (std::size_t it = std::max(lhs_size, rhs_size); it > 0; --it) {
+        const Block a = (it <= lhs_size) ? lhs[it - 1] : Block(0);
+        const Block b = (it <= rhs_size) ? rhs[it - 1] : Block(0);
+        if (a != b)
+            return (a < b) ? -1 : 1;
+    }
+    return 0;
+}
+
+/// @brief Adds two numbers stored as arrays of blocks, least significant block first.
+/// @param dst the output blocks, it can alias lhs or rhs.
+/// @param size the number of output blocks.
+/// @param lhs the blocks of the first number.
+/// @param lhs_size the number of blocks of the first number (at most size).
+/// @param rhs the blocks of the second number.
+/// @param rhs_size the number of blocks of the second number (at most size).
+/// @param carry the incoming carry.
+/// @return the outgoing carry.
+template <typename Block>
+constexpr inline bool add_blocks(Block *dst, std::size_t size, const Block *lhs, std::size_t lhs_size, const Block *rhs, std::size_t rhs_size, bool carry = false)
+{
+    const std::size_t min_size = std::min(lhs_size, rhs_size);
+    std::size_t it             = 0;
+    for (; it < min_size; ++it)
+        carry = bvlib::detail::addcarry(lhs[it], rhs[it], carry, dst[it]);
+    for (; it < lhs_size; ++it)
+        carry = bvlib::detail::addcarry(lhs[it], Block(0), carry, dst[it]);
+    for (; it < rhs_size; ++it)
+        carry = bvlib::detail::addcarry(Block(0), rhs[it], carry, dst[it]);
+    for (; it < size; ++it) {
+        dst[it] = static_cast<Block>(carry);
+        carry   = false;
+    }
+    return carry;
+}
+
+/// @brief Subtracts two numbers stored as arrays of blocks, least significant block first.
+/// @param dst the output blocks, it can alias lhs or rhs.
+/// @param size the number of output blocks.
+/// @param lhs the blocks of the first number.
+/// @param lhs_size the number of blocks of the first number (at most size).
+/// @param rhs the blocks of the second number.
+/// @param rhs_size the number of blocks of the second number (at most size).
+/// @param borrow the incoming borrow.
+/// @return the outgoing borrow.
+template <typename Block>
+constexpr inline bool sub_blocks(Block *dst, std::size_t size, const Block *lhs, std::size_t lhs_size, const Block *rhs, std::size_t rhs_size, bool borrow = false)
+{
+    const std::size_t min_size = std::min(lhs_size, rhs_size);
+    std::size_t it             = 0;
+    for (; it < min_size; ++it)
+        borrow = bvlib::detail::subborrow(lhs[it], rhs[it], borrow, dst[it]);
+    for (; it < lhs_size; ++it)
+        borrow = bvlib::detail::subborrow(lhs[it], Block(0), borrow, dst[it]);
+    for (; it < rhs_size; ++it)
+        borrow = bvlib::detail::subborrow(Block(0), rhs[it], borrow, dst[it]);
+    for (; it < size; ++it)
+        borrow = bvlib::detail::subborrow(Block(0), Block(0), borrow, dst[it]);
+    return borrow;
+}
+
+/// @brief Adds an unsigned integer to a number stored as an array of blocks, in place.
+/// @param dst the blocks of the number.
+/// @param size the number of blocks.
+/// @param value the value to add.
+/// @return the outgoing carry.
+/// @details The loop stops as soon as there is nothing left to propagate.
+template <typename Block, typename T>
+constexpr inline bool add_integer(Block *dst, std::size_t size, T value)
+{
+    bool carry = false;
+    for (std::size_t it = 0; (it < size) && (value || carry); ++it) {
+        carry = bvlib::detail::addcarry(dst[it], static_cast<Block>(value), carry, dst[it]);
+        if constexpr (bvlib::detail::digits<T>() > bvlib::detail::digits<Block>())
+            value = static_cast<T>(value >> bvlib::detail::digits<Block>());
+        else
+            value = 0;
+    }
+    return carry;
+}
+
+/// @brief Subtracts an unsigned integer from a number stored as an array of blocks, in place.
+/// @param dst the blocks of the number.
+/// @param size the number of blocks.
+/// @param value the value to subtract.
+/// @return the outgoing borrow.
+/// @details The loop stops as soon as there is nothing left to propagate.
+template <typename Block, typename T>
+constexpr inline bool sub_integer(Block *dst, std::size_t size, T value)
+{
+    bool borrow = false;
+    for (std::size_t it = 0; (it < size) && (value || borrow); ++it) {
+        borrow = bvlib::detail::subborrow(dst[it], static_cast<Block>(value), borrow, dst[it]);
+        if constexpr (bvlib::detail::digits<T>() > bvlib::detail::digits<Block>())
+            value = static_cast<T>(value >> bvlib::detail::digits<Block>());
+        else
+            value = 0;
+    }
+    return borrow;
+}
+
+/// @brief Returns the number of blocks, discarding the most significant blocks which are zero.
+/// @param data the blocks of the number.
+/// @param size the number of blocks.
+/// @return the number of significant blocks.
+template <typename Block>
+constexpr inline std::size_t significant_blocks(const Block *data, std::size_t size)
+{
+    while ((size > 0) && (data[size - 1] == 0))
+        --size;
+    return size;
+}
+
+/// @brief Multiplies src by a single block, and adds the product to dst, in place.
+/// @param dst the accumulator blocks.
+/// @param src the blocks of the number to multiply.
+/// @param size the number of blocks of both dst and src.
+/// @param multiplier the multiplier.
+/// @return the most significant block of the result, which does not fit inside dst.
+template <typename Block>
+constexpr inline Block mul_add_block(Block *dst, const Block *src, std::size_t size, Block multiplier)
+{
+    Block carry = 0, high = 0, low = 0;
+    for (std::size_t it = 0; it < size; ++it) {
+        low = bvlib::detail::mul_wide(src[it], multiplier, high);
+        // Neither addition can overflow the high part: (B-1)^2 + 2(B-1) < B^2.
+        high += bvlib::detail::addcarry(low, carry, false, low);
+        high += bvlib::detail::addcarry(dst[it], low, false, dst[it]);
+        carry = high;
+    }
+    return carry;
+}
+
+/// @brief Multiplies two numbers with the schoolbook algorithm.
+/// @param dst the output blocks, of size (lhs_size + rhs_size), must not alias the inputs.
+/// @param lhs the blocks of the first number.
+/// @param lhs_size the number of blocks of the first number.
+/// @param rhs the blocks of the second number.
+/// @param rhs_size the number of blocks of the second number.
+template <typename Block>
+constexpr inline void mul_schoolbook(Block *dst, const Block *lhs, std::size_t lhs_size, const Block *rhs, std::size_t rhs_size)
+{
+    for (std::size_t it = 0; it < (lhs_size + rhs_size); ++it)
+        dst[it] = 0;
+    for (std::size_t it = 0; it < lhs_size; ++it)
+        if (lhs[it])
+            dst[it + rhs_size] = bvlib::detail::mul_add_block(dst + it, rhs, rhs_size, lhs[it]);
+}
+
+/// @brief Returns the number of scratch blocks required by mul_karatsuba.
+/// @param size the number of blocks of the operands.
+/// @return the number of scratch blocks.
+constexpr inline std::size_t karatsuba_scratch_size(std::size_t size)
+{
+    return (size < BVLIB_KARATSUBA_THRESHOLD) ? 0 : 4 * (size - size / 2 + 1) + karatsuba_scratch_size(size - size / 2 + 1);
+}
+
+/// @brief Multiplies two numbers of the same size with the Karatsuba algorithm.
+/// @param dst the output blocks, of size (2 * size), must not alias the inputs.
+/// @param lhs the blocks of the first number.
+/// @param rhs the blocks of the second number.
+/// @param size the number of blocks of the operands.
+/// @param scratch temporary storage of at least karatsuba_scratch_size(size) blocks.
+/// @details Below BVLIB_KARATSUBA_THRESHOLD blocks it falls back to mul_schoolbook.
+template <typename Block>
+constexpr inline void mul_karatsuba(Block *dst, const Block *lhs, const Block *rhs, std::size_t size, Block *scratch)
+{
+    if (size < BVLIB_KARATSUBA_THRESHOLD) {
+        bvlib::detail::mul_schoolbook(dst, lhs, size, rhs, size);
+        return;
+    }
+    // Split the operands as lhs = lhs_hi * B^low + lhs_lo, with lhs_hi being the widest half.
+    const std::size_t low = size / 2, high = size - low;
+    Block *lhs_sum = scratch, *rhs_sum = scratch + (high + 1), *middle = scratch + 2 * (high + 1);
+    // z0 = lhs_lo * rhs_lo, and z2 = lhs_hi * rhs_hi, directly inside the output.
+    bvlib::detail::mul_karatsuba(dst, lhs, rhs, low, scratch);
+    bvlib::detail::mul_karatsuba(dst + 2 * low, lhs + low, rhs + low, high, scratch);
+    // z1 = (lhs_lo + lhs_hi) * (rhs_lo + rhs_hi) - z0 - z2.
+    bvlib::detail::add_blocks(lhs_sum, high + 1, lhs + low, high, lhs, low);
+    bvlib::detail::add_blocks(rhs_sum, high + 1, rhs + low, high, rhs, low);
+    bvlib::detail::mul_karatsuba(middle, lhs_sum, rhs_sum, high + 1, scratch + 4 * (high + 1));
+    bvlib::detail::sub_blocks(middle, 2 * (high + 1), middle, 2 * (high + 1), dst, 2 * low);
+    bvlib::detail::sub_blocks(middle, 2 * (high + 1), middle, 2 * (high + 1), dst + 2 * low, 2 * high);
+    // Add z1 * B^low to the output; z1 is smaller than B^(2 * high + 1).
+    bvlib::detail::add_blocks(dst + low, 2 * size - low, dst + low, 2 * size - low, middle, std::min(2 * high + 1, 2 * size - low));
+}
+
+/// @brief Multiplies two numbers, choosing the algorithm depending on their size.
+/// @param dst the output blocks, of size (2 * size), must not alias the inputs.
+/// @param lhs the blocks of the first number.
+/// @param rhs the blocks of the second number.
+/// @param size the number of blocks of both operands.
+/// @param scratch temporary storage of at least karatsuba_scratch_size(size) blocks.
+template <typename Block>
+constexpr inline void mul_blocks(Block *dst, const Block *lhs, const Block *rhs, std::size_t size, Block *scratch)
+{
+    // Leading zero blocks do not contribute to the product.
+    const std::size_t lhs_size = bvlib::detail::significant_blocks(lhs, size);
+    const std::size_t rhs_size = bvlib::detail::significant_blocks(rhs, size);
+    const std::size_t max_size = std::max(lhs_size, rhs_size);
+    if (std::min(lhs_size, rhs_size) < BVLIB_KARATSUBA_THRESHOLD) {
+        bvlib::detail::mul_schoolbook(dst, lhs, lhs_size, rhs, rhs_size);
+        for (std::size_t it = lhs_size + rhs_size; it < 2 * size; ++it)
+            dst[it] = 0;
+        return;
+    }
+    bvlib::detail::mul_karatsuba(dst, lhs, rhs, max_size, scratch);
+    for (std::size_t it = 2 * max_size; it < 2 * size; ++it)
+        dst[it] = 0;
+}
+
+/// @brief Shifts a number to the left by less than a block.
+/// @param dst the output blocks (it can alias src).
+/// @param src the blocks of the number.
+/// @param size the number of blocks of both dst and src.
+/// @param shift the number of bits, smaller than the bits of a block.
+/// @return the bits shifted out of the most significant block.
+template <typename Block>
+constexpr inline Block shift_left_bits(Block *dst, const Block *src, std::size_t size, std::size_t shift)
 {
-    for (std::size_t i = N - 1; i > 0; i--) {
-        if (bitvector[i]) {
-            return i;
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    Block carry                          = 0;
+    for (std::size_t it = 0; it < size; ++it) {
+        const Block value = src[it];
+        dst[it]           = static_cast<Block>((value << shift) | carry);
+        carry             = shift ? static_cast<Block>(value >> (bits_per_block - shift)) : Block(0);
+    }
+    return carry;
+}
+
+/// @brief Shifts a number to the right by less than a block.
+/// @param dst the output blocks (it can alias src).
+/// @param src the blocks of the number.
+/// @param size the number of blocks of both dst and src.
+/// @param shift the number of bits, smaller than the bits of a block.
+/// @return the bits shifted out of the least significant block, in its most significant bits.
+template <typename Block>
+constexpr inline Block shift_right_bits(Block *dst, const Block *src, std::size_t size, std::size_t shift)
+{
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    Block carry                          = 0;
+    for (std::size_t it = size; it-- > 0;) {
+        const Block value = src[it];
+        dst[it]           = static_cast<Block>((value >> shift) | carry);
+        carry             = shift ? static_cast<Block>(value << (bits_per_block - shift)) : Block(0);
+    }
+    return carry;
+}
+
+/// @brief Shifts a number to the left, moving whole blocks and combining the neighbouring ones.
+/// @param dst the output blocks (it can alias src).
+/// @param src the blocks of the number.
+/// @param size the number of blocks of both dst and src.
+/// @param shift the number of bits.
+template <typename Block>
+constexpr inline void shift_left_blocks(Block *dst, const Block *src, std::size_t size, std::size_t shift)
+{
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    const std::size_t block_shift = shift / bits_per_block, bit_shift = shift % bits_per_block;
+    if (block_shift >= size) {
+        for (std::size_t it = 0; it < size; ++it)
+            dst[it] = 0;
+        return;
+    }
+    // Go from the most significant block, so that dst can alias src.
+    for (std::size_t it = size - 1; it > block_shift; --it)
+        dst[it] = bvlib::detail::funnel_shift_left(src[it - block_shift], src[it - block_shift - 1], bit_shift);
+    dst[block_shift] = static_cast<Block>(src[0] << bit_shift);
+    for (std::size_t it = 0; it < block_shift; ++it)
+        dst[it] = 0;
+}
+
+/// @brief Shifts a number to the right, moving whole blocks and combining the neighbouring ones.
+/// @param dst the output blocks (it can alias src).
+/// @param src the blocks of the number.
+/// @param size the number of blocks of both dst and src.
+/// @param shift the number of bits.
+template <typename Block>
+constexpr inline void shift_right_blocks(Block *dst, const Block *src, std::size_t size, std::size_t shift)
+{
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    const std::size_t block_shift = shift / bits_per_block, bit_shift = shift % bits_per_block;
+    if (block_shift >= size) {
+        for (std::size_t it = 0; it < size; ++it)
+            dst[it] = 0;
+        return;
+    }
+    // Go from the least significant block, so that dst can alias src.
+    for (std::size_t it = 0; it + block_shift + 1 < size; ++it)
+        dst[it] = bvlib::detail::funnel_shift_right(src[it + block_shift + 1], src[it + block_shift], bit_shift);
+    dst[size - block_shift - 1] = static_cast<Block>(src[size - 1] >> bit_shift);
+    for (std::size_t it = size - block_shift; it < size; ++it)
+        dst[it] = 0;
+}
+
+/// @brief Multiplies src by a single block, and subtracts the product from dst, in place.
+/// @param dst the blocks of the minuend.
+/// @param src the blocks of the number to multiply.
+/// @param size the number of blocks of both dst and src.
+/// @param multiplier the multiplier.
+/// @return the most significant block of the product (plus the borrow), still to be
+/// subtracted from the block following dst.
+template <typename Block>
+constexpr inline Block mul_sub_block(Block *dst, const Block *src, std::size_t size, Block multiplier)
+{
+    Block carry = 0, high = 0, low = 0;
+    for (std::size_t it = 0; it < size; ++it) {
+        low = bvlib::detail::mul_wide(src[it], multiplier, high);
+        // Neither correction can overflow the high part: (B-1)^2 + (B-1) <= B(B-1).
+        high += bvlib::detail::addcarry(low, carry, false, low);
+        high += bvlib::detail::subborrow(dst[it], low, false, dst[it]);
+        carry = high;
+    }
+    return carry;
+}
+
+/// @brief Divides a number by a normalized divisor, with Knuth's Algorithm D.
+/// @param quotient the output blocks, of size (size - divisor_size + 1).
+/// @param dividend the blocks of the dividend, of size (size + 1), it is replaced by the remainder.
+/// @param size the number of blocks of the dividend, without the extra block.
+/// @param divisor the blocks of the divisor, whose most significant bit must be set.
+/// @param divisor_size the number of blocks of the divisor, not greater than size.
+/// @param reciprocal the reciprocal of the most significant block of the divisor.
+/// @details The digits of the quotient are estimated with div_2by1, so that the
+/// divisions are replaced by multiplications.
+template <typename Block>
+constexpr inline void divmod_normalized(Block *quotient, Block *dividend, std::size_t size, const Block *divisor, std::size_t divisor_size, Block reciprocal)
+{
+    const Block high = divisor[divisor_size - 1];
+    // With a single block, each digit of the quotient is exact.
+    if (divisor_size == 1) {
+        Block remainder = dividend[size];
+        for (std::size_t it = size; it-- > 0;)
+            quotient[it] = bvlib::detail::div_2by1(remainder, dividend[it], high, reciprocal, remainder);
+        dividend[0] = remainder;
+        return;
+    }
+    const Block next = divisor[divisor_size - 2];
+    for (std::size_t it = size - divisor_size + 1; it-- > 0;) {
+        Block *window = dividend + it;
+        // Estimate the digit from the two most significant blocks of the window.
+        Block digit = 0, remainder = 0;
+        bool overflow = false;
+        if (window[divisor_size] >= high) {
+            digit    = static_cast<Block>(~Block(0));
+            overflow = bvlib::detail::addcarry(window[divisor_size - 1], high, false, remainder);
+        } else {
+            digit = bvlib::detail::div_2by1(window[divisor_size], window[divisor_size - 1], high, reciprocal, remainder);
+        }
+        // Refine it with the next block, then it is at most one unit too large.
+        while (!overflow) {
+            Block product_high = 0, product_low = bvlib::detail::mul_wide(digit, next, product_high);
+            if ((product_high < remainder) || ((product_high == remainder) && (product_low <= window[divisor_size - 2])))
+                break;
+            --digit;
+            overflow = bvlib::detail::addcarry(remainder, high, false, remainder);
+        }
+        // Multiply and subtract, adding back the divisor when the digit was too large.
+        const Block carry = bvlib::detail::mul_sub_block(window, divisor, divisor_size, digit);
+        if (bvlib::detail::subborrow(window[divisor_size], carry, false, window[divisor_size])) {
+            --digit;
+            window[divisor_size] = static_cast<Block>(window[divisor_size] + bvlib::detail::add_blocks(window, divisor_size, window, divisor_size, divisor, divisor_size));
         }
+        quotient[it] = digit;
+    }
+}
+
+/// @brief Divides a number by a divisor which has already been normalized.
+/// @param quotient the output blocks, of size size.
+/// @param remainder the output blocks, of size size.
+/// @param dividend the blocks of the dividend, of size size.
+/// @param size the number of blocks of the dividend.
+/// @param divisor the normalized blocks of the divisor, i.e., shifted left by shift bits.
+/// @param divisor_size the number of significant blocks of the divisor.
+/// @param shift the number of bits used to normalize the divisor.
+/// @param reciprocal the reciprocal of the most significant block of the normalized divisor.
+/// @param scratch temporary storage of at least (size + 1) blocks.
+template <typename Block>
+constexpr inline void divmod_prepared(Block *quotient, Block *remainder, const Block *dividend, std::size_t size, const Block *divisor, std::size_t divisor_size, std::size_t shift, Block reciprocal, Block *scratch)
+{
+    const std::size_t dividend_size = bvlib::detail::significant_blocks(dividend, size);
+    for (std::size_t it = 0; it < size; ++it)
+        quotient[it] = 0;
+    if (dividend_size < divisor_size) {
+        for (std::size_t it = 0; it < size; ++it)
+            remainder[it] = dividend[it];
+        return;
     }
-    return std::size_t(0);
+    scratch[dividend_size] = bvlib::detail::shift_left_bits(scratch, dividend, dividend_size, shift);
+    bvlib::detail::divmod_normalized(quotient, scratch, dividend_size, divisor, divisor_size, reciprocal);
+    bvlib::detail::shift_right_bits(remainder, scratch, divisor_size, shift);
+    for (std::size_t it = divisor_size; it < size; ++it)
+        remainder[it] = 0;
+}
+
+/// @brief Divides two numbers of the same size.
+/// @param quotient the output blocks, of size size.
+/// @param remainder the output blocks, of size size.
+/// @param dividend the blocks of the dividend.
+/// @param divisor the blocks of the divisor, which must not be zero.
+/// @param size the number of blocks of all the operands.
+/// @param scratch temporary storage of at least (2 * size + 1) blocks.
+template <typename Block>
+constexpr inline void divmod_blocks(Block *quotient, Block *remainder, const Block *dividend, const Block *divisor, std::size_t size, Block *scratch)
+{
+    const std::size_t divisor_size = bvlib::detail::significant_blocks(divisor, size);
+    const std::size_t shift        = bvlib::detail::countl_zero(divisor[divisor_size - 1]);
+    Block *normalized              = scratch + size + 1;
+    bvlib::detail::shift_left_bits(normalized, divisor, divisor_size, shift);
+    const Block reciprocal = bvlib::detail::reciprocal_2by1(normalized[divisor_size - 1]);
+    bvlib::detail::divmod_prepared(quotient, remainder, dividend, size, normalized, divisor_size, shift, reciprocal, scratch);
+}
+
+/// @brief Applies a bitwise operation between two bitvectors of possibly different size.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return a bitvector of size std::max(N1, N2) containing the result.
+template <bvlib::simd::bitwise_op Op, std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> bitwise(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    constexpr std::size_t min_blocks = std::min(bvlib::BitVector<N1, Block>::num_blocks, bvlib::BitVector<N2, Block>::num_blocks);
+    bvlib::BitVector<std::max(N1, N2), Block> result;
+    bvlib::simd::bitwise<Op>(result.data, lhs.data, rhs.data, min_blocks);
+    // With and, the blocks missing from the narrowest operand are zero.
+    if constexpr (Op != bvlib::simd::bitwise_op::op_and) {
+        for (std::size_t it = min_blocks; it < result.num_blocks; ++it) {
+            if constexpr (N1 > N2)
+                result.data[it] = lhs.data[it];
+            else
+                result.data[it] = rhs.data[it];
+        }
+    }
+    BVLIB_INSTRUMENT_END((Op == bvlib::simd::bitwise_op::op_and) ? "and" : (Op == bvlib::simd::bitwise_op::op_or) ? "or" : "xor", std::max(N1, N2));
+    BVLIB_INSTRUMENT_TEMPORARY(std::max(N1, N2), 1);
+    BVLIB_INSTRUMENT_PROMOTION(N1, N2);
+    return result;
+}
+
+/// @brief Applies a bitwise operation between two bitvectors, saving the result inside the first.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return the first bitvector.
+template <bvlib::simd::bitwise_op Op, std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<N1, Block> &bitwise_assign(bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    static_assert(N1 >= N2, "RHS has more bits than LHS");
+    BVLIB_INSTRUMENT_BEGIN();
+    constexpr std::size_t min_blocks = bvlib::BitVector<N2, Block>::num_blocks;
+    bvlib::simd::bitwise<Op>(lhs.data, lhs.data, rhs.data, min_blocks);
+    // With and, the blocks missing from the rhs clear the lhs.
+    if constexpr (Op == bvlib::simd::bitwise_op::op_and) {
+        for (std::size_t it = min_blocks; it < lhs.num_blocks; ++it)
+            lhs.data[it] = 0;
+    }
+    BVLIB_INSTRUMENT_END((Op == bvlib::simd::bitwise_op::op_and) ? "and_assign" : (Op == bvlib::simd::bitwise_op::op_or) ? "or_assign" : "xor_assign", N1);
+    BVLIB_INSTRUMENT_PROMOTION(N1, N2);
+    return lhs;
+}
+
+/// @brief Compares two bitvectors of possibly different size.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return a negative value, zero, or a positive value, if the first is smaller, equal or greater.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline int compare(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    const int result = bvlib::detail::compare_blocks(lhs.data, lhs.num_blocks, rhs.data, rhs.num_blocks);
+    BVLIB_INSTRUMENT_END("compare", std::max(N1, N2));
+    BVLIB_INSTRUMENT_PROMOTION(N1, N2);
+    return result;
+}
+
+} // namespace detail
+
+/// @brief Returns the position of the most significant bit inside the given bitvector.
+/// @param bitvector the input bitvector.
+/// @return position of the most significant bit, or 0 if no bit is set.
+/// @details Use BitVector::find_last() to distinguish between an empty bitvector
+/// and a bitvector where only the first bit is set.
+template <std::size_t N, typename Block>
+constexpr inline std::size_t most_significant_bit(const bvlib::BitVector<N, Block> &bitvector)
+{
+    const std::size_t position = bitvector.find_last();
+    return (position == bitvector.npos) ? std::size_t(0) : position;
 }
 
 // ============================================================================
@@ -59,39 +570,68 @@ inline std::size_t most_significant_bit(const bvlib::BitVector<N> &bitvector)
 
 /// @brief Left-shifts the input bitvector by the given number of bits.
 /// @param bitvector the bitvector.
-/// @param shift the amount to shift.
+/// @param shift the amount to shift, shifting by N or more bits clears the bitvector.
 /// @return the shifted bitvector.
-template <std::size_t N>
-inline bvlib::BitVector<N> shift_left(bvlib::BitVector<N> bitvector, std::size_t shift)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> shift_left(const bvlib::BitVector<N, Block> &bitvector, std::size_t shift)
 {
-    std::size_t it = 0;
-    shift          = std::min(N, shift);
-    if (shift > 0) {
-        for (; it < (N - shift); ++it)
-            bitvector.bits[it] = bitvector.bits[it + shift];
-        for (; it < N; ++it)
-            bitvector.bits[it] = false;
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::BitVector<N, Block> result;
+    if (shift < N) {
+        bvlib::detail::shift_left_blocks(result.data, bitvector.data, result.num_blocks, shift);
+        result.data[result.num_blocks - 1] &= result.last_block_mask;
     }
-    return bitvector;
+    BVLIB_INSTRUMENT_END("shift_left", N);
+    BVLIB_INSTRUMENT_TEMPORARY(N, 1);
+    return result;
 }
 
 /// @brief Right-shifts the input bitvector by the given number of bits.
 /// @param bitvector the bitvector.
-/// @param shift the amount to shift.
+/// @param shift the amount to shift, shifting by N or more bits clears the bitvector.
 /// @return the shifted bitvector.
-template <std::size_t N>
-inline bvlib::BitVector<N> shift_right(bvlib::BitVector<N> bitvector, std::size_t shift)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> shift_right(const bvlib::BitVector<N, Block> &bitvector, std::size_t shift)
 {
-    std::size_t it;
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::BitVector<N, Block> result;
+    if (shift < N)
+        bvlib::detail::shift_right_blocks(result.data, bitvector.data, result.num_blocks, shift);
+    BVLIB_INSTRUMENT_END("shift_right", N);
+    BVLIB_INSTRUMENT_TEMPORARY(N, 1);
+    return result;
+}
+
+/// @brief Rotates the input bitvector to the left by the given number of bits, modifying it.
+/// @param bitvector the bitvector.
+/// @param shift the amount to rotate, taken modulo N.
+/// @return the input bitvector, rotated.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &rotl(bvlib::BitVector<N, Block> &bitvector, std::size_t shift)
+{
+    shift %= N;
     if (shift > 0) {
-        for (it = N - 1; it >= shift; --it)
-            bitvector.bits[it] = bitvector.bits[it - shift];
-        for (it = 0; it < shift; ++it)
-            bitvector.bits[it] = false;
+        // The bits going out from the top come back in from the bottom.
+        Block wrapped[bvlib::BitVector<N, Block>::num_blocks] = {};
+        bvlib::detail::shift_right_blocks(wrapped, bitvector.data, bitvector.num_blocks, N - shift);
+        bvlib::detail::shift_left_blocks(bitvector.data, bitvector.data, bitvector.num_blocks, shift);
+        bvlib::simd::bitwise<bvlib::simd::bitwise_op::op_or>(bitvector.data, bitvector.data, wrapped, bitvector.num_blocks);
+        bitvector.data[bitvector.num_blocks - 1] &= bitvector.last_block_mask;
     }
     return bitvector;
 }
 
+/// @brief Rotates the input bitvector to the right by the given number of bits, modifying it.
+/// @param bitvector the bitvector.
+/// @param shift the amount to rotate, taken modulo N.
+/// @return the input bitvector, rotated.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &rotr(bvlib::BitVector<N, Block> &bitvector, std::size_t shift)
+{
+    shift %= N;
+    return (shift > 0) ? bvlib::rotl(bitvector, N - shift) : bitvector;
+}
+
 // ============================================================================
 // OPERATOR(<<)
 // ============================================================================
@@ -100,8 +640,8 @@ inline bvlib::BitVector<N> shift_right(bvlib::BitVector<N> bitvector, std::size_
 /// @param bitvector the bitvector.
 /// @param shift the amount to shift.
 /// @return the shifted bitvector.
-template <std::size_t N>
-inline bvlib::BitVector<N> operator<<(const bvlib::BitVector<N> &bitvector, std::size_t shift)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> operator<<(const bvlib::BitVector<N, Block> &bitvector, std::size_t shift)
 {
     return bvlib::shift_left(bitvector, shift);
 }
@@ -112,18 +652,19 @@ inline bvlib::BitVector<N> operator<<(const bvlib::BitVector<N> &bitvector, std:
 
 /// @brief Left-shifts the input bitvector by the given number of bits, modifying it.
 /// @param bitvector the bitvector.
-/// @param shift the amount to shift.
+/// @param shift the amount to shift, shifting by N or more bits clears the bitvector.
 /// @return the input bitvector, shifted.
-template <std::size_t N>
-inline bvlib::BitVector<N> &operator<<=(bvlib::BitVector<N> &bitvector, std::size_t shift)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &operator<<=(bvlib::BitVector<N, Block> &bitvector, std::size_t shift)
 {
-    std::size_t it = 0;
-    if (shift > 0) {
-        for (; it < (N - shift); ++it)
-            bitvector.bits[it] = bitvector.bits[it + shift];
-        for (; it < N; ++it)
-            bitvector.bits[it] = false;
+    BVLIB_INSTRUMENT_BEGIN();
+    if (shift >= N) {
+        bitvector.reset();
+    } else {
+        bvlib::detail::shift_left_blocks(bitvector.data, bitvector.data, bitvector.num_blocks, shift);
+        bitvector.data[bitvector.num_blocks - 1] &= bitvector.last_block_mask;
     }
+    BVLIB_INSTRUMENT_END("shift_left_assign", N);
     return bitvector;
 }
 
@@ -135,33 +676,213 @@ inline bvlib::BitVector<N> &operator<<=(bvlib::BitVector<N> &bitvector, std::siz
 /// @param bitvector the bitvector.
 /// @param shift the amount to shift.
 /// @return the shifted bitvector.
-template <std::size_t N>
-inline bvlib::BitVector<N> operator>>(const bvlib::BitVector<N> &bitvector, std::size_t shift)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> operator>>(const bvlib::BitVector<N, Block> &bitvector, std::size_t shift)
 {
     return bvlib::shift_right(bitvector, shift);
 }
 
 // ============================================================================
-// OPERATOR(>>)
+// OPERATOR(>>=)
 // ============================================================================
 
 /// @brief Right-shifts the input bitvector by the given number of bits, modifying it.
 /// @param bitvector the bitvector.
-/// @param shift the amount to shift.
+/// @param shift the amount to shift, shifting by N or more bits clears the bitvector.
 /// @return the input bitvector, shifted.
-template <std::size_t N>
-inline bvlib::BitVector<N> &operator>>=(bvlib::BitVector<N> &bitvector, std::size_t shift)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &operator>>=(bvlib::BitVector<N, Block> &bitvector, std::size_t shift)
 {
-    std::size_t it = 0;
-    if (shift > 0) {
-        for (it = N - 1; it >= shift; --it)
-            bitvector.bits[it] = bitvector.bits[it - shift];
-        for (it = 0; it < shift; ++it)
-            bitvector.bits[it] = false;
-    }
+    BVLIB_INSTRUMENT_BEGIN();
+    if (shift >= N)
+        bitvector.reset();
+    else
+        bvlib::detail::shift_right_blocks(bitvector.data, bitvector.data, bitvector.num_blocks, shift);
+    BVLIB_INSTRUMENT_END("shift_right_assign", N);
     return bitvector;
 }
 
+// ============================================================================
+// OPERATOR(&)
+// ============================================================================
+
+/// @brief Computes the bitwise and between the first and second bitvector.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return a bitvector of size std::max(N1, N2), containing the result.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> operator&(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_and>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise and between a bitvector and an integer value.
+/// @param lhs the bitvector.
+/// @param rhs the integer value.
+/// @return the result of the operation.
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator&(const bvlib::BitVector<N, Block> &lhs, T rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_and>(lhs, bvlib::BitVector<N, Block>(rhs));
+}
+
+/// @brief Computes the bitwise and between an integer value and a bitvector.
+/// @param lhs the integer value.
+/// @param rhs the bitvector.
+/// @return the result of the operation.
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator&(T lhs, const bvlib::BitVector<N, Block> &rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_and>(bvlib::BitVector<N, Block>(lhs), rhs);
+}
+
+/// @brief Computes the bitwise and between the first and second bitvector, saving the result inside the first.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return the first bitvector.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<N1, Block> &operator&=(bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_and>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise and between a bitvector and an integer value, saving the result inside the bitvector.
+/// @param lhs the bitvector.
+/// @param rhs the integer value.
+/// @return the bitvector.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &operator&=(bvlib::BitVector<N, Block> &lhs, std::size_t rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_and>(lhs, bvlib::BitVector<N, Block>(rhs));
+}
+
+// ============================================================================
+// OPERATOR(|)
+// ============================================================================
+
+/// @brief Computes the bitwise or between the first and second bitvector.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return a bitvector of size std::max(N1, N2), containing the result.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> operator|(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_or>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise or between a bitvector and an integer value.
+/// @param lhs the bitvector.
+/// @param rhs the integer value.
+/// @return the result of the operation.
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator|(const bvlib::BitVector<N, Block> &lhs, T rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_or>(lhs, bvlib::BitVector<N, Block>(rhs));
+}
+
+/// @brief Computes the bitwise or between an integer value and a bitvector.
+/// @param lhs the integer value.
+/// @param rhs the bitvector.
+/// @return the result of the operation.
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator|(T lhs, const bvlib::BitVector<N, Block> &rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_or>(bvlib::BitVector<N, Block>(lhs), rhs);
+}
+
+/// @brief Computes the bitwise or between the first and second bitvector, saving the result inside the first.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return the first bitvector.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<N1, Block> &operator|=(bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_or>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise or between a bitvector and an integer value, saving the result inside the bitvector.
+/// @param lhs the bitvector.
+/// @param rhs the integer value.
+/// @return the bitvector.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &operator|=(bvlib::BitVector<N, Block> &lhs, std::size_t rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_or>(lhs, bvlib::BitVector<N, Block>(rhs));
+}
+
+// ============================================================================
+// OPERATOR(^)
+// ============================================================================
+
+/// @brief Computes the bitwise exclusive or between the first and second bitvector.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return a bitvector of size std::max(N1, N2), containing the result.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> operator^(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_xor>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise exclusive or between a bitvector and an integer value.
+/// @param lhs the bitvector.
+/// @param rhs the integer value.
+/// @return the result of the operation.
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator^(const bvlib::BitVector<N, Block> &lhs, T rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_xor>(lhs, bvlib::BitVector<N, Block>(rhs));
+}
+
+/// @brief Computes the bitwise exclusive or between an integer value and a bitvector.
+/// @param lhs the integer value.
+/// @param rhs the bitvector.
+/// @return the result of the operation.
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator^(T lhs, const bvlib::BitVector<N, Block> &rhs)
+{
+    return bvlib::detail::bitwise<bvlib::simd::bitwise_op::op_xor>(bvlib::BitVector<N, Block>(lhs), rhs);
+}
+
+/// @brief Computes the bitwise exclusive or between the first and second bitvector, saving the result inside the first.
+/// @param lhs the first bitvector.
+/// @param rhs the second bitvector.
+/// @return the first bitvector.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<N1, Block> &operator^=(bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_xor>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise exclusive or between a bitvector and an integer value, saving the result inside the bitvector.
+/// @param lhs the bitvector.
+/// @param rhs the integer value.
+/// @return the bitvector.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &operator^=(bvlib::BitVector<N, Block> &lhs, std::size_t rhs)
+{
+    return bvlib::detail::bitwise_assign<bvlib::simd::bitwise_op::op_xor>(lhs, bvlib::BitVector<N, Block>(rhs));
+}
+
+// ============================================================================
+// OPERATOR(~)
+// ============================================================================
+
+/// @brief Computes the bitwise negation of the bitvector.
+/// @param bitvector the bitvector.
+/// @return the negated bitvector.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> operator~(const bvlib::BitVector<N, Block> &bitvector)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::BitVector<N, Block> result;
+    bvlib::simd::bitwise_not(result.data, bitvector.data, result.num_blocks);
+    result.data[result.num_blocks - 1] &= result.last_block_mask;
+    BVLIB_INSTRUMENT_END("not", N);
+    BVLIB_INSTRUMENT_TEMPORARY(N, 1);
+    return result;
+}
+
 // ============================================================================
 // BOOL(==)
 // ============================================================================
@@ -170,45 +891,30 @@ inline bvlib::BitVector<N> &operator>>=(bvlib::BitVector<N> &bitvector, std::siz
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return if they are equal.
-template <std::size_t N1, std::size_t N2>
-inline bool operator==(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
-{
-    constexpr std::size_t min = std::min(N1, N2);
-    std::size_t it;
-    if constexpr (N1 > N2) {
-        for (it = N1; it > min; --it)
-            if (lhs[it - 1])
-                return false;
-    } else {
-        for (it = N2; it > min; --it)
-            if (rhs[it - 1])
-                return false;
-    }
-    for (; it > 0; --it) {
-        if (lhs[it - 1] != rhs[it - 1])
-            return false;
-    }
-    return true;
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bool operator==(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::compare(lhs, rhs) == 0;
 }
 
 /// @brief Checks equality between a bitvector and an integer value.
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return if they are equal.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator==(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator==(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return lhs == bvlib::BitVector<N>(rhs);
+    return lhs == bvlib::BitVector<N, Block>(rhs);
 }
 
 /// @brief Checks equality between a bitvector and an integer value.
 /// @param lhs the integer value.
 /// @param rhs the bitvector.
 /// @return if they are equal.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator==(T lhs, const bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator==(T lhs, const bvlib::BitVector<N, Block> &rhs)
 {
-    return bvlib::BitVector<N>(lhs) == rhs;
+    return bvlib::BitVector<N, Block>(lhs) == rhs;
 }
 
 // ============================================================================
@@ -219,45 +925,30 @@ inline bool operator==(T lhs, const bvlib::BitVector<N> &rhs)
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return if they are equal.
-template <std::size_t N1, std::size_t N2>
-inline bool operator!=(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
-{
-    constexpr std::size_t min = std::min(N1, N2);
-    std::size_t it;
-    if constexpr (N1 > N2) {
-        for (it = N1; it > min; --it)
-            if (lhs[it - 1])
-                return true;
-    } else {
-        for (it = N2; it > min; --it)
-            if (rhs[it - 1])
-                return true;
-    }
-    for (; it > 0; --it) {
-        if (lhs[it - 1] != rhs[it - 1])
-            return true;
-    }
-    return false;
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bool operator!=(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::compare(lhs, rhs) != 0;
 }
 
 /// @brief Checks inequality between a bitvector and an integer value.
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return if they are equal.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator!=(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator!=(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return lhs != bvlib::BitVector<N>(rhs);
+    return lhs != bvlib::BitVector<N, Block>(rhs);
 }
 
 /// @brief Checks inequality between a bitvector and an integer value.
 /// @param lhs the integer value.
 /// @param rhs the bitvector.
 /// @return if they are equal.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator!=(T lhs, const bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator!=(T lhs, const bvlib::BitVector<N, Block> &rhs)
 {
-    return bvlib::BitVector<N>(lhs) != rhs;
+    return bvlib::BitVector<N, Block>(lhs) != rhs;
 }
 
 // ============================================================================
@@ -268,48 +959,30 @@ inline bool operator!=(T lhs, const bvlib::BitVector<N> &rhs)
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return if first value is smaller than the second value.
-template <std::size_t N1, std::size_t N2>
-inline bool operator<(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
-{
-    constexpr std::size_t min = std::min(N1, N2);
-    std::size_t it;
-    if constexpr (N1 > N2) {
-        for (it = N1; it > min; --it)
-            if (lhs[it - 1])
-                return false;
-    } else {
-        for (it = N2; it > min; --it)
-            if (rhs[it - 1])
-                return true;
-    }
-    for (; it > 0; --it) {
-        const bool a = lhs[it - 1], b = rhs[it - 1];
-        if (a && !b)
-            return false;
-        if (!a && b)
-            return true;
-    }
-    return false;
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bool operator<(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::compare(lhs, rhs) < 0;
 }
 
 /// @brief Checks if the bitvector is smaller than the integer value.
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return if first value is smaller than the second value.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator<(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator<(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return lhs < bvlib::BitVector<N>(rhs);
+    return lhs < bvlib::BitVector<N, Block>(rhs);
 }
 
 /// @brief Checks if the integer value is smaller than the bitvector.
 /// @param lhs the integer value.
 /// @param rhs the bitvector.
 /// @return if first value is smaller than the second value.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator<(T lhs, const bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator<(T lhs, const bvlib::BitVector<N, Block> &rhs)
 {
-    return bvlib::BitVector<N>(lhs) < rhs;
+    return bvlib::BitVector<N, Block>(lhs) < rhs;
 }
 
 // ============================================================================
@@ -320,48 +993,30 @@ inline bool operator<(T lhs, const bvlib::BitVector<N> &rhs)
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return if first value is smaller than or equal to the second value.
-template <std::size_t N1, std::size_t N2>
-inline bool operator<=(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
-{
-    constexpr std::size_t min = std::min(N1, N2);
-    std::size_t it;
-    if constexpr (N1 > N2) {
-        for (it = N1; it > min; --it)
-            if (lhs[it - 1])
-                return false;
-    } else {
-        for (it = N2; it > min; --it)
-            if (rhs[it - 1])
-                return true;
-    }
-    for (; it > 0; --it) {
-        const bool a = lhs[it - 1], b = rhs[it - 1];
-        if (a && !b)
-            return false;
-        if (!a && b)
-            return true;
-    }
-    return true;
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bool operator<=(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::compare(lhs, rhs) <= 0;
 }
 
 /// @brief Checks if the bitvector is smaller than or equal to the integer value.
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return if first value is smaller than or equal to the second value.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator<=(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator<=(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return lhs <= bvlib::BitVector<N>(rhs);
+    return lhs <= bvlib::BitVector<N, Block>(rhs);
 }
 
 /// @brief Checks if the integer value is smaller than or equal to the bitvector.
 /// @param lhs the integer value.
 /// @param rhs the bitvector.
 /// @return if first value is smaller than or equal to the second value.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator<=(T lhs, const bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator<=(T lhs, const bvlib::BitVector<N, Block> &rhs)
 {
-    return bvlib::BitVector<N>(lhs) <= rhs;
+    return bvlib::BitVector<N, Block>(lhs) <= rhs;
 }
 
 // ============================================================================
@@ -372,48 +1027,30 @@ inline bool operator<=(T lhs, const bvlib::BitVector<N> &rhs)
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return if first value is greather than the second value.
-template <std::size_t N1, std::size_t N2>
-inline bool operator>(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
-{
-    constexpr std::size_t min = std::min(N1, N2);
-    std::size_t it;
-    if constexpr (N1 > N2) {
-        for (it = N1; it > min; --it)
-            if (lhs[it - 1])
-                return true;
-    } else {
-        for (it = N2; it > min; --it)
-            if (rhs[it - 1])
-                return false;
-    }
-    for (; it > 0; --it) {
-        const bool a = lhs[it - 1], b = rhs[it - 1];
-        if (a && !b)
-            return true;
-        if (!a && b)
-            return false;
-    }
-    return false;
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bool operator>(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::compare(lhs, rhs) > 0;
 }
 
 /// @brief Checks if the bitvector is greather than the integer value.
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return if first value is greather than the second value.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator>(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator>(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return lhs > bvlib::BitVector<N>(rhs);
+    return lhs > bvlib::BitVector<N, Block>(rhs);
 }
 
 /// @brief Checks if the integer value is greather than the bitvector.
 /// @param lhs the integer value.
 /// @param rhs the bitvector.
 /// @return if first value is greather than the second value.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator>(T lhs, const bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator>(T lhs, const bvlib::BitVector<N, Block> &rhs)
 {
-    return bvlib::BitVector<N>(lhs) > rhs;
+    return bvlib::BitVector<N, Block>(lhs) > rhs;
 }
 
 // ============================================================================
@@ -424,48 +1061,30 @@ inline bool operator>(T lhs, const bvlib::BitVector<N> &rhs)
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return if first value is greather than or equal to the second value.
-template <std::size_t N1, std::size_t N2>
-inline bool operator>=(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
-{
-    constexpr std::size_t min = std::min(N1, N2);
-    std::size_t it;
-    if constexpr (N1 > N2) {
-        for (it = N1; it > min; --it)
-            if (lhs[it - 1])
-                return true;
-    } else {
-        for (it = N2; it > min; --it)
-            if (rhs[it - 1])
-                return false;
-    }
-    for (; it > 0; --it) {
-        const bool a = lhs[it - 1], b = rhs[it - 1];
-        if (a && !b)
-            return true;
-        if (!a && b)
-            return false;
-    }
-    return true;
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bool operator>=(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::detail::compare(lhs, rhs) >= 0;
 }
 
 /// @brief Checks if the bitvector is greather than or equal to the integer value.
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return if first value is greather than or equal to the second value.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator>=(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator>=(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return lhs >= bvlib::BitVector<N>(rhs);
+    return lhs >= bvlib::BitVector<N, Block>(rhs);
 }
 
 /// @brief Checks if the integer value is greather than or equal to the bitvector.
 /// @param lhs the integer value.
 /// @param rhs the bitvector.
 /// @return if first value is greather than or equal to the second value.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bool operator>=(T lhs, const bvlib::BitVector<N> &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bool operator>=(T lhs, const bvlib::BitVector<N, Block> &rhs)
 {
-    return bvlib::BitVector<N>(lhs) >= rhs;
+    return bvlib::BitVector<N, Block>(lhs) >= rhs;
 }
 
 // ============================================================================
@@ -476,15 +1095,16 @@ inline bool operator>=(T lhs, const bvlib::BitVector<N> &rhs)
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return the sum between the two values.
-template <std::size_t N1, std::size_t N2>
-inline bvlib::BitVector<std::max(N1, N2)> sum(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> sum(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
 {
-    constexpr std::size_t max = std::max(N1, N2);
-    bvlib::BitVector<max> result;
-    bool carry = false;
-    for (std::size_t it = 0; it < max; ++it) {
-        result[it] = bvlib::add_bits((it < N1) ? lhs[it] : false, (it < N2) ? rhs[it] : false, carry);
-    }
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::BitVector<std::max(N1, N2), Block> result;
+    bvlib::detail::add_blocks(result.data, result.num_blocks, lhs.data, lhs.num_blocks, rhs.data, rhs.num_blocks);
+    result.data[result.num_blocks - 1] &= result.last_block_mask;
+    BVLIB_INSTRUMENT_END("sum", std::max(N1, N2));
+    BVLIB_INSTRUMENT_TEMPORARY(std::max(N1, N2), 1);
+    BVLIB_INSTRUMENT_PROMOTION(N1, N2);
     return result;
 }
 
@@ -492,8 +1112,8 @@ inline bvlib::BitVector<std::max(N1, N2)> sum(const bvlib::BitVector<N1> &lhs, c
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return the sum between the two values.
-template <std::size_t N1, std::size_t N2>
-inline bvlib::BitVector<std::max(N1, N2)> operator+(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> operator+(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
 {
     return bvlib::sum<N1, N2>(lhs, rhs);
 }
@@ -502,34 +1122,35 @@ inline bvlib::BitVector<std::max(N1, N2)> operator+(const bvlib::BitVector<N1> &
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return the sum between the two values.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bvlib::BitVector<N> operator+(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator+(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return bvlib::sum<N, N>(lhs, BitVector<N>(rhs));
+    return bvlib::sum<N, N>(lhs, BitVector<N, Block>(rhs));
 }
 
 /// @brief Computes the sum between an integer value and a bitvector.
 /// @param lhs the integer value.
 /// @param rhs the bitvector.
 /// @return the sum between the two values.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bvlib::BitVector<N> operator+(T lhs, BitVector<N> const &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator+(T lhs, BitVector<N, Block> const &rhs)
 {
-    return bvlib::sum<N, N>(bvlib::BitVector<N>(lhs), rhs);
+    return bvlib::sum<N, N>(bvlib::BitVector<N, Block>(lhs), rhs);
 }
 
 /// @brief Computes the sum between the first and second bitvector, saving the result inside the first.
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return the sum between the two values.
-template <std::size_t N1, std::size_t N2>
-inline bvlib::BitVector<N1> &operator+=(bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<N1, Block> &operator+=(bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
 {
     static_assert(N1 >= N2, "RHS has more bits than LHS");
-    bool carry = false;
-    for (std::size_t it = 0; it < N1; ++it) {
-        lhs[it] = add_bits(lhs[it], (it < N2) ? rhs[it] : false, carry);
-    }
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::detail::add_blocks(lhs.data, lhs.num_blocks, lhs.data, lhs.num_blocks, rhs.data, rhs.num_blocks);
+    lhs.data[lhs.num_blocks - 1] &= lhs.last_block_mask;
+    BVLIB_INSTRUMENT_END("sum_assign", N1);
+    BVLIB_INSTRUMENT_PROMOTION(N1, N2);
     return lhs;
 }
 
@@ -537,38 +1158,32 @@ inline bvlib::BitVector<N1> &operator+=(bvlib::BitVector<N1> &lhs, const bvlib::
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return the sum between the two values.
-template <std::size_t N>
-inline bvlib::BitVector<N> &operator+=(bvlib::BitVector<N> &lhs, std::size_t rhs)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &operator+=(bvlib::BitVector<N, Block> &lhs, std::size_t rhs)
 {
-    return (lhs += BitVector<N>(rhs));
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::detail::add_integer(lhs.data, lhs.num_blocks, rhs);
+    lhs.data[lhs.num_blocks - 1] &= lhs.last_block_mask;
+    BVLIB_INSTRUMENT_END("sum_assign", N);
+    return lhs;
 }
 
 /// @brief Increments the bitvector value.
 /// @param lhs the bitvector.
 /// @return the bitvector incremented.
-template <std::size_t N>
-inline bvlib::BitVector<N> &operator++(bvlib::BitVector<N> &lhs)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &operator++(bvlib::BitVector<N, Block> &lhs)
 {
-    static const BitVector<N> one(1);
-    bool carry = false;
-    for (std::size_t it = 0; it < N; ++it) {
-        lhs[it] = add_bits(lhs[it], one[it], carry);
-    }
-    return lhs;
+    return (lhs += 1U);
 }
 
 /// @brief Increments the bitvector value.
 /// @param lhs the bitvector.
 /// @return the bitvector incremented.
-template <std::size_t N>
-inline bvlib::BitVector<N> &operator++(bvlib::BitVector<N> &lhs, int)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &operator++(bvlib::BitVector<N, Block> &lhs, int)
 {
-    static const BitVector<N> one(1);
-    bool carry = false;
-    for (std::size_t it = 0; it < N; ++it) {
-        lhs[it] = add_bits(lhs[it], one[it], carry);
-    }
-    return lhs;
+    return (lhs += 1U);
 }
 
 // ============================================================================
@@ -579,14 +1194,16 @@ inline bvlib::BitVector<N> &operator++(bvlib::BitVector<N> &lhs, int)
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return the difference between the two values.
-template <std::size_t N1, std::size_t N2>
-inline bvlib::BitVector<std::max(N1, N2)> sub(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> sub(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
 {
-    constexpr std::size_t max = std::max(N1, N2);
-    bvlib::BitVector<max> result;
-    bool borrow = false;
-    for (std::size_t it = 0; it < max; ++it)
-        result[it] = bvlib::sub_bits((it < N1) ? lhs[it] : false, (it < N2) ? rhs[it] : false, borrow);
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::BitVector<std::max(N1, N2), Block> result;
+    bvlib::detail::sub_blocks(result.data, result.num_blocks, lhs.data, lhs.num_blocks, rhs.data, rhs.num_blocks);
+    result.data[result.num_blocks - 1] &= result.last_block_mask;
+    BVLIB_INSTRUMENT_END("sub", std::max(N1, N2));
+    BVLIB_INSTRUMENT_TEMPORARY(std::max(N1, N2), 1);
+    BVLIB_INSTRUMENT_PROMOTION(N1, N2);
     return result;
 }
 
@@ -594,8 +1211,8 @@ inline bvlib::BitVector<std::max(N1, N2)> sub(const bvlib::BitVector<N1> &lhs, c
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return the difference between the two values.
-template <std::size_t N1, std::size_t N2>
-inline bvlib::BitVector<std::max(N1, N2)> operator-(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> operator-(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
 {
     return bvlib::sub<N1, N2>(lhs, rhs);
 }
@@ -604,34 +1221,35 @@ inline bvlib::BitVector<std::max(N1, N2)> operator-(const bvlib::BitVector<N1> &
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return the difference between the two values.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bvlib::BitVector<N> operator-(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator-(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return bvlib::sub<N, N>(lhs, bvlib::BitVector<N>(rhs));
+    return bvlib::sub<N, N>(lhs, bvlib::BitVector<N, Block>(rhs));
 }
 
 /// @brief Computes the difference between an integer value and a bitvector.
 /// @param lhs the integer value.
 /// @param rhs the bitvector.
 /// @return the difference between the two values.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bvlib::BitVector<N> operator-(T lhs, bvlib::BitVector<N> const &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator-(T lhs, bvlib::BitVector<N, Block> const &rhs)
 {
-    return bvlib::sub<N, N>(bvlib::BitVector<N>(lhs), rhs);
+    return bvlib::sub<N, N>(bvlib::BitVector<N, Block>(lhs), rhs);
 }
 
 /// @brief Computes the difference between the first and second bitvector, saving the result inside the first.
 /// @param lhs the first bitvector.
 /// @param rhs the second bitvector.
 /// @return the difference between the two values.
-template <std::size_t N1, std::size_t N2>
-inline bvlib::BitVector<std::max(N1, N2)> &operator-=(bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> &operator-=(bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
 {
     static_assert(N1 >= N2, "RHS has more bits than LHS");
-    bool borrow = false;
-    for (std::size_t it = 0; it < N1; ++it) {
-        lhs[it] = sub_bits(lhs[it], (it < N2) ? rhs[it] : false, borrow);
-    }
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::detail::sub_blocks(lhs.data, lhs.num_blocks, lhs.data, lhs.num_blocks, rhs.data, rhs.num_blocks);
+    lhs.data[lhs.num_blocks - 1] &= lhs.last_block_mask;
+    BVLIB_INSTRUMENT_END("sub_assign", N1);
+    BVLIB_INSTRUMENT_PROMOTION(N1, N2);
     return lhs;
 }
 
@@ -639,10 +1257,14 @@ inline bvlib::BitVector<std::max(N1, N2)> &operator-=(bvlib::BitVector<N1> &lhs,
 /// @param lhs the bitvector.
 /// @param rhs the integer value.
 /// @return the difference between the two values.
-template <std::size_t N>
-inline bvlib::BitVector<N> &operator-=(bvlib::BitVector<N> &lhs, std::size_t rhs)
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> &operator-=(bvlib::BitVector<N, Block> &lhs, std::size_t rhs)
 {
-    return (lhs -= bvlib::BitVector<N>(rhs));
+    BVLIB_INSTRUMENT_BEGIN();
+    bvlib::detail::sub_integer(lhs.data, lhs.num_blocks, rhs);
+    lhs.data[lhs.num_blocks - 1] &= lhs.last_block_mask;
+    BVLIB_INSTRUMENT_END("sub_assign", N);
+    return lhs;
 }
 
 // ============================================================================
@@ -653,24 +1275,23 @@ inline bvlib::BitVector<N> &operator-=(bvlib::BitVector<N> &lhs, std::size_t rhs
 /// @param lhs the first bitvector of size N1.
 /// @param rhs the second bitvector of size N2.
 /// @return a bitvector of size (std::max(N1, N2)*2), containing the multiplication result.
-template <std::size_t N1, std::size_t N2>
-inline bvlib::BitVector<std::max(N1, N2) * 2> mul(bvlib::BitVector<N1> const &lhs, bvlib::BitVector<N2> const &rhs)
-{
-    constexpr std::size_t max = std::max(N1, N2);
-    std::size_t it            = 0;
-    bvlib::BitVector<max * 2> result;
-    // Perform the multiplication.
-    if (lhs.count() < rhs.count()) {
-        bvlib::BitVector<max * 2> _rhs(rhs);
-        for (; it < N1; ++it)
-            if (lhs[it])
-                result += bvlib::shift_left(_rhs, it);
-    } else {
-        bvlib::BitVector<max * 2> _lhs(lhs);
-        for (; it < N2; ++it)
-            if (rhs[it])
-                result += bvlib::shift_left(_lhs, it);
-    }
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2) * 2, Block> mul(bvlib::BitVector<N1, Block> const &lhs, bvlib::BitVector<N2, Block> const &rhs)
+{
+    BVLIB_INSTRUMENT_BEGIN();
+    constexpr std::size_t size = bvlib::BitVector<std::max(N1, N2), Block>::num_blocks;
+    // Both operands are extended to the same number of blocks.
+    bvlib::BitVector<std::max(N1, N2), Block> _lhs(lhs), _rhs(rhs);
+    Block product[2 * size]                                              = {};
+    Block scratch[bvlib::detail::karatsuba_scratch_size(size) + 1] = {};
+    bvlib::detail::mul_blocks(product, _lhs.data, _rhs.data, size, scratch);
+    // The product always fits inside the result, which might have fewer blocks.
+    bvlib::BitVector<std::max(N1, N2) * 2, Block> result;
+    for (std::size_t it = 0; it < result.num_blocks; ++it)
+        result.data[it] = product[it];
+    BVLIB_INSTRUMENT_END("mul", std::max(N1, N2));
+    BVLIB_INSTRUMENT_TEMPORARY(std::max(N1, N2) * 2, 1);
+    BVLIB_INSTRUMENT_PROMOTION(N1, N2);
     return result;
 }
 
@@ -678,8 +1299,8 @@ inline bvlib::BitVector<std::max(N1, N2) * 2> mul(bvlib::BitVector<N1> const &lh
 /// @param lhs the first bitvector of size N1.
 /// @param rhs the second bitvector of size N2.
 /// @return a bitvector of size (std::max(N1, N2)*2), containing the multiplication result.
-template <std::size_t N1, std::size_t N2>
-inline bvlib::BitVector<std::max(N1, N2) * 2> operator*(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2) * 2, Block> operator*(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
 {
     return bvlib::mul<N1, N2>(lhs, rhs);
 }
@@ -688,20 +1309,20 @@ inline bvlib::BitVector<std::max(N1, N2) * 2> operator*(const bvlib::BitVector<N
 /// @param lhs the bitvector of size N.
 /// @param rhs the integer value.
 /// @return a bitvector of size (N*2), containing the multiplication result.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bvlib::BitVector<N * 2> operator*(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N * 2, Block> operator*(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return bvlib::mul<N, N>(lhs, bvlib::BitVector<N>(rhs));
+    return bvlib::mul<N, N>(lhs, bvlib::BitVector<N, Block>(rhs));
 }
 
 /// @brief Multiplies an integer value and a  bitvector.
 /// @param lhs the integer value.
 /// @param rhs the bitvector of size N.
 /// @return a bitvector of size (N*2), containing the multiplication result.
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bvlib::BitVector<N * 2> operator*(T lhs, bvlib::BitVector<N> const &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N * 2, Block> operator*(T lhs, bvlib::BitVector<N, Block> const &rhs)
 {
-    return bvlib::mul<N, N>(bvlib::BitVector<N>(lhs), rhs);
+    return bvlib::mul<N, N>(bvlib::BitVector<N, Block>(lhs), rhs);
 }
 
 // ============================================================================
@@ -713,45 +1334,23 @@ inline bvlib::BitVector<N * 2> operator*(T lhs, bvlib::BitVector<N> const &rhs)
 /// @param rhs the second bitvector of size N2.
 /// @return two bitvectors of size std::max(N1, N2), the first contains the quotient
 /// and the second contains the reminder.
-/// @details Original version available in: "C++ Cookbook - By D. Ryan Stephens,
-/// Ryan Stephens, Christopher Diggins, Jeff Cogswell, Jonathan Turkanis"
-template <std::size_t N1, std::size_t N2>
-inline std::pair<bvlib::BitVector<std::max(N1, N2)>, bvlib::BitVector<std::max(N1, N2)>> div(bvlib::BitVector<N1> const &lhs, bvlib::BitVector<N2> const &rhs)
+/// @details Uses Knuth's Algorithm D on whole blocks, with a fast path for
+/// single-block divisors.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline std::pair<bvlib::BitVector<std::max(N1, N2), Block>, bvlib::BitVector<std::max(N1, N2), Block>> div(bvlib::BitVector<N1, Block> const &lhs, bvlib::BitVector<N2, Block> const &rhs)
 {
-    constexpr std::size_t max = std::max(N1, N2);
-    bvlib::BitVector<max> qotient, remainder, support;
+    constexpr std::size_t max  = std::max(N1, N2);
+    constexpr std::size_t size = bvlib::BitVector<max, Block>::num_blocks;
     if (rhs.none())
         throw std::domain_error("division by zero undefined");
-    if (lhs.none())
-        return std::make_pair(qotient, remainder);
-    if (lhs == rhs) {
-        qotient[0] = true;
-        return std::make_pair(qotient, remainder);
-    }
-    if (lhs < rhs)
-        return std::make_pair(qotient, remainder);
-    // Initialize the remainder and the support vector.
-    remainder = lhs;
-    support   = rhs;
-    // Count significant digits in lhs and rhs and dividend.
-    std::size_t sig_lhs = most_significant_bit(lhs);
-    std::size_t sig_rhs = most_significant_bit(rhs);
-    // Align the y with the dividend.
-    std::size_t n = (sig_lhs - sig_rhs);
-    support <<= n;
-    // Make sure the loop executes the right number of times.
-    n += 1;
-    // Long division algorithm, shift, and subtract.
-    while (n--) {
-        // Shift the quotient to the left.
-        if (support <= remainder) {
-            // Add a new digit to quotient.
-            qotient[n] = true;
-            remainder -= support;
-        }
-        // Shift the y to the right.
-        support >>= 1;
-    }
+    BVLIB_INSTRUMENT_BEGIN();
+    // Both operands are extended to the same number of blocks.
+    bvlib::BitVector<max, Block> _lhs(lhs), _rhs(rhs), qotient, remainder;
+    Block scratch[2 * size + 1] = {};
+    bvlib::detail::divmod_blocks(qotient.data, remainder.data, _lhs.data, _rhs.data, size, scratch);
+    BVLIB_INSTRUMENT_END("div", max);
+    BVLIB_INSTRUMENT_TEMPORARY(max, 2);
+    BVLIB_INSTRUMENT_PROMOTION(N1, N2);
     return std::make_pair(qotient, remainder);
 }
 
@@ -760,10 +1359,8 @@ inline std::pair<bvlib::BitVector<std::max(N1, N2)>, bvlib::BitVector<std::max(N
 /// @param rhs the second bitvector of size N2.
 /// @return two bitvectors of size std::max(N1, N2), the first contains the quotient
 /// and the second contains the reminder.
-/// @details Original version available in: "C++ Cookbook - By D. Ryan Stephens,
-/// Ryan Stephens, Christopher Diggins, Jeff Cogswell, Jonathan Turkanis"
-template <std::size_t N1, std::size_t N2>
-inline bvlib::BitVector<std::max(N1, N2)> operator/(const bvlib::BitVector<N1> &lhs, const bvlib::BitVector<N2> &rhs)
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> operator/(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
 {
     return bvlib::div<N1, N2>(lhs, rhs).first;
 }
@@ -773,12 +1370,10 @@ inline bvlib::BitVector<std::max(N1, N2)> operator/(const bvlib::BitVector<N1> &
 /// @param rhs the integer value.
 /// @return two bitvectors of size N, the first contains the quotient and the
 /// second contains the reminder.
-/// @details Original version available in: "C++ Cookbook - By D. Ryan Stephens,
-/// Ryan Stephens, Christopher Diggins, Jeff Cogswell, Jonathan Turkanis"
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bvlib::BitVector<N> operator/(const bvlib::BitVector<N> &lhs, T rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator/(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return bvlib::div<N, N>(lhs, bvlib::BitVector<N>(rhs)).first;
+    return bvlib::div<N, N>(lhs, bvlib::BitVector<N, Block>(rhs)).first;
 }
 
 /// @brief Performs the division between an integer value and a bitvector.
@@ -786,12 +1381,119 @@ inline bvlib::BitVector<N> operator/(const bvlib::BitVector<N> &lhs, T rhs)
 /// @param rhs the bitvector of size N.
 /// @return two bitvectors of size N, the first contains the quotient and the
 /// second contains the reminder.
-/// @details Original version available in: "C++ Cookbook - By D. Ryan Stephens,
-/// Ryan Stephens, Christopher Diggins, Jeff Cogswell, Jonathan Turkanis"
-template <std::size_t N, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
-inline bvlib::BitVector<N> operator/(T lhs, bvlib::BitVector<N> const &rhs)
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator/(T lhs, bvlib::BitVector<N, Block> const &rhs)
+{
+    return bvlib::div<N, N>(bvlib::BitVector<N, Block>(lhs), rhs).first;
+}
+
+/// @brief Computes the remainder of the division between two bitvectors.
+/// @param lhs the first bitvector of size N1.
+/// @param rhs the second bitvector of size N2.
+/// @return a bitvector of size std::max(N1, N2), containing the reminder.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> operator%(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::div<N1, N2>(lhs, rhs).second;
+}
+
+/// @brief Computes the remainder of the division between a bitvector and an integer value.
+/// @param lhs the bitvector of size N.
+/// @param rhs the integer value.
+/// @return a bitvector of size N, containing the reminder.
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator%(const bvlib::BitVector<N, Block> &lhs, T rhs)
 {
-    return bvlib::div<N, N>(bvlib::BitVector<N>(lhs), rhs).first;
+    return bvlib::div<N, N>(lhs, bvlib::BitVector<N, Block>(rhs)).second;
 }
 
+/// @brief Computes the remainder of the division between an integer value and a bitvector.
+/// @param lhs the integer value.
+/// @param rhs the bitvector of size N.
+/// @return a bitvector of size N, containing the reminder.
+template <std::size_t N, typename Block, typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+constexpr inline bvlib::BitVector<N, Block> operator%(T lhs, bvlib::BitVector<N, Block> const &rhs)
+{
+    return bvlib::div<N, N>(bvlib::BitVector<N, Block>(lhs), rhs).second;
+}
+
+/// @brief Divides many bitvectors by the same divisor.
+/// @details The divisor is normalized, and the reciprocal of its most significant
+/// block is computed, only once at construction. Afterwards, each division only
+/// requires multiplications and shifts.
+template <std::size_t N, typename Block = std::uint64_t>
+class Divider {
+public:
+    /// @brief Prepares the division by the given divisor.
+    /// @param divisor the divisor, which must not be zero.
+    constexpr explicit Divider(const bvlib::BitVector<N, Block> &divisor)
+        : _divisor(divisor),
+          _normalized(),
+          _size(bvlib::detail::significant_blocks(divisor.data, divisor.num_blocks)),
+          _shift(),
+          _reciprocal()
+    {
+        if (_size == 0)
+            throw std::domain_error("division by zero undefined");
+        _shift = bvlib::detail::countl_zero(divisor.data[_size - 1]);
+        bvlib::detail::shift_left_bits(_normalized, divisor.data, _size, _shift);
+        _reciprocal = bvlib::detail::reciprocal_2by1(_normalized[_size - 1]);
+    }
+
+    /// @brief Returns the divisor.
+    constexpr const bvlib::BitVector<N, Block> &divisor() const
+    {
+        return _divisor;
+    }
+
+    /// @brief Divides the given bitvector by the divisor.
+    /// @param lhs the dividend of size N2.
+    /// @return two bitvectors of size std::max(N, N2), the first contains the quotient
+    /// and the second contains the reminder.
+    template <std::size_t N2>
+    constexpr std::pair<bvlib::BitVector<std::max(N, N2), Block>, bvlib::BitVector<std::max(N, N2), Block>> divide(const bvlib::BitVector<N2, Block> &lhs) const
+    {
+        BVLIB_INSTRUMENT_BEGIN();
+        constexpr std::size_t max  = std::max(N, N2);
+        constexpr std::size_t size = bvlib::BitVector<max, Block>::num_blocks;
+        bvlib::BitVector<max, Block> _lhs(lhs), qotient, remainder;
+        Block scratch[size + 1] = {};
+        bvlib::detail::divmod_prepared(qotient.data, remainder.data, _lhs.data, size, _normalized, _size, _shift, _reciprocal, scratch);
+        BVLIB_INSTRUMENT_END("divider", max);
+        BVLIB_INSTRUMENT_TEMPORARY(max, 2);
+        BVLIB_INSTRUMENT_PROMOTION(N, N2);
+        return std::make_pair(qotient, remainder);
+    }
+
+    /// @brief Divides the given bitvector by the divisor.
+    /// @param lhs the dividend of size N2.
+    /// @return a bitvector of size std::max(N, N2), containing the quotient.
+    template <std::size_t N2>
+    constexpr bvlib::BitVector<std::max(N, N2), Block> quotient(const bvlib::BitVector<N2, Block> &lhs) const
+    {
+        return this->divide(lhs).first;
+    }
+
+    /// @brief Computes the remainder of the division of the given bitvector by the divisor.
+    /// @param lhs the dividend of size N2.
+    /// @return a bitvector of size std::max(N, N2), containing the reminder.
+    template <std::size_t N2>
+    constexpr bvlib::BitVector<std::max(N, N2), Block> remainder(const bvlib::BitVector<N2, Block> &lhs) const
+    {
+        return this->divide(lhs).second;
+    }
+
+private:
+    /// The original divisor.
+    bvlib::BitVector<N, Block> _divisor;
+    /// The blocks of the divisor, shifted so that its most significant bit is set.
+    Block _normalized[bvlib::BitVector<N, Block>::num_blocks];
+    /// The number of significant blocks of the divisor.
+    std::size_t _size;
+    /// The number of bits used to normalize the divisor.
+    std::size_t _shift;
+    /// The reciprocal of the most significant block of the normalized divisor.
+    Block _reciprocal;
+};
+
 } // namespace bvlib
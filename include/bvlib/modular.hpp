@@ -0,0 +1,305 @@
+/// @file modular.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Modular arithmetic with Montgomery multiplication.
+/// @details The values are multiplied in Montgomery form, i.e., as a * R mod m
+/// with R = 2^(bits of the significant blocks of m), so the product is reduced
+/// with the interleaved (CIOS) algorithm, which only needs multiplications by
+/// a block, instead of a division. It requires an odd modulus. On values
+/// which are already reduced, the operations do not branch on the values, and
+/// the final subtractions are selected with masks, apart from powmod and
+/// invmod, which have the constant-time variants powmod_ct and invmod_ct.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "intrinsics.hpp"
+#include "math.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace bvlib
+{
+
+namespace detail
+{
+
+/// @brief Computes -1 / value modulo the size of the blocks, with Newton's iteration.
+/// @param value an odd block.
+template <typename Block>
+constexpr inline Block montgomery_inverse(Block value)
+{
+    // Each iteration doubles the correct bits, and value is its own inverse modulo 8.
+    Block inverse = value;
+    for (std::size_t bits = 3; bits < bvlib::detail::digits<Block>(); bits *= 2)
+        inverse = static_cast<Block>(inverse * static_cast<Block>(2U - static_cast<Block>(value * inverse)));
+    return static_cast<Block>(0U - inverse);
+}
+
+/// @brief Computes lhs * rhs / R modulo the modulus, with R = 2^(bits of size blocks).
+/// @param dst the output blocks, of the given capacity, which can alias the inputs.
+/// @param lhs the first operand, smaller than R.
+/// @param rhs the second operand, smaller than the modulus.
+/// @param modulus the odd modulus.
+/// @param size the number of blocks of the operands and of the modulus.
+/// @param capacity the number of blocks of dst, at least size, the ones above size are cleared.
+/// @param inverse the value -1 / modulus modulo the size of the blocks.
+/// @param scratch 2 * capacity + 2 + capacity blocks of temporary storage.
+/// @details The running sum is never larger than twice the modulus, and the
+/// final subtraction is done with masks, so the time does not depend on the
+/// values. The difference is kept after the 2 * capacity + 2 blocks of the sum,
+/// and both the difference and dst are written up to capacity, so that their
+/// bounds do not depend on the runtime size.
+template <typename Block>
+constexpr inline void montgomery_mul(Block *dst, const Block *lhs, const Block *rhs, const Block *modulus, std::size_t size, std::size_t capacity, Block inverse, Block *scratch)
+{
+    for (std::size_t it = 0; it < 2 * size + 2; ++it)
+        scratch[it] = 0;
+    // Instead of shifting the sum by one block at each step, it moves its base.
+    Block *sum = scratch;
+    for (std::size_t it = 0; it < size; ++it, ++sum) {
+        Block carry = bvlib::detail::mul_add_block(sum, lhs, size, rhs[it]);
+        sum[size + 1] = static_cast<Block>(bvlib::detail::addcarry(sum[size], carry, false, sum[size]));
+        // Adds the multiple of the modulus which clears the lowest block.
+        carry = bvlib::detail::mul_add_block(sum, modulus, size, static_cast<Block>(sum[0] * inverse));
+        sum[size + 1] = static_cast<Block>(sum[size + 1] + bvlib::detail::addcarry(sum[size], carry, false, sum[size]));
+    }
+    // The borrow goes through the blocks above size unchanged.
+    Block *difference = scratch + 2 * capacity + 2;
+    const bool borrow = bvlib::detail::sub_blocks(difference, capacity, sum, size, modulus, size);
+    const Block mask  = static_cast<Block>(0U - static_cast<Block>((sum[size] != 0) | !borrow));
+    for (std::size_t it = 0; it < capacity; ++it)
+        dst[it] = (it < size) ? static_cast<Block>((difference[it] & mask) | (sum[it] & static_cast<Block>(~mask))) : Block(0);
+}
+
+} // namespace detail
+
+/// @brief Modular arithmetic modulo a fixed odd modulus.
+/// @tparam N the number of bits of the values and of the modulus.
+/// @tparam Block the type used to store the bits.
+template <std::size_t N, typename Block = std::uint64_t>
+class ModContext {
+public:
+    /// The type of the values.
+    using value_type = BitVector<N, Block>;
+
+    /// The number of bits stored inside a block.
+    static constexpr std::size_t bits_per_block = value_type::bits_per_block;
+
+    /// The number of blocks of the values.
+    static constexpr std::size_t num_blocks = value_type::num_blocks;
+
+    /// @brief Prepares the arithmetic modulo the given modulus.
+    /// @param modulus the modulus, which must be odd.
+    constexpr explicit ModContext(const value_type &modulus)
+        : _modulus(modulus),
+          _divider(modulus),
+          _size(bvlib::detail::significant_blocks(modulus.data, num_blocks)),
+          _inverse(),
+          _r2(),
+          _one()
+    {
+        if (!modulus[0])
+            throw std::domain_error("montgomery multiplication requires an odd modulus");
+        _inverse = bvlib::detail::montgomery_inverse(modulus.data[0]);
+        // R^2 mod m converts to the Montgomery form, R mod m is the form of one.
+        BitVector<2 * num_blocks * bits_per_block + 1, Block> power;
+        power[2 * _size * bits_per_block] = true;
+        _r2  = value_type(_divider.remainder(power));
+        _one = this->montgomery_mul(_r2, value_type(1U));
+    }
+
+    /// @brief Returns the modulus.
+    constexpr inline const value_type &modulus() const
+    {
+        return _modulus;
+    }
+
+    /// @brief Returns the value modulo the modulus.
+    /// @details The check subtracts the modulus from every block, and only
+    /// the values which are not reduced take the branch with the division.
+    constexpr inline value_type reduce(const value_type &value) const
+    {
+        value_type difference;
+        if (!bvlib::detail::sub_blocks(difference.data, num_blocks, value.data, num_blocks, _modulus.data, num_blocks))
+            return value_type(_divider.remainder(value));
+        return value;
+    }
+
+    /// @brief Converts a value to the Montgomery form.
+    constexpr inline value_type to_montgomery(const value_type &value) const
+    {
+        return this->montgomery_mul(this->reduce(value), _r2);
+    }
+
+    /// @brief Converts a value from the Montgomery form.
+    constexpr inline value_type from_montgomery(const value_type &value) const
+    {
+        return this->montgomery_mul(value, value_type(1U));
+    }
+
+    /// @brief Multiplies two values in Montgomery form.
+    /// @details This is the fastest way to chain many multiplications, since
+    /// the values are converted only once.
+    constexpr inline value_type montgomery_mul(const value_type &lhs, const value_type &rhs) const
+    {
+        value_type result;
+        Block scratch[3 * num_blocks + 2] = {};
+        bvlib::detail::montgomery_mul(result.data, lhs.data, rhs.data, _modulus.data, _size, num_blocks, _inverse, scratch);
+        return result;
+    }
+
+    /// @brief Computes lhs + rhs modulo the modulus, both values being reduced.
+    constexpr inline value_type addmod(const value_type &lhs, const value_type &rhs) const
+    {
+        // The sum has one more bit, and it keeps the difference unless the subtraction borrows.
+        BitVector<N + 1, Block> sum = BitVector<N + 1, Block>(lhs) + BitVector<N + 1, Block>(rhs), difference;
+        const bool borrow           = bvlib::detail::sub_blocks(difference.data, difference.num_blocks, sum.data, sum.num_blocks, _modulus.data, num_blocks);
+        return value_type(ModContext::select(borrow, sum, difference));
+    }
+
+    /// @brief Computes lhs - rhs modulo the modulus, both values being reduced.
+    constexpr inline value_type submod(const value_type &lhs, const value_type &rhs) const
+    {
+        // When the subtraction borrows, adding the modulus brings the difference back.
+        value_type difference;
+        const bool borrow       = bvlib::detail::sub_blocks(difference.data, num_blocks, lhs.data, num_blocks, rhs.data, num_blocks);
+        const value_type addend = ModContext::select(borrow, _modulus, value_type());
+        bvlib::detail::add_blocks(difference.data, num_blocks, difference.data, num_blocks, addend.data, num_blocks);
+        return difference;
+    }
+
+    /// @brief Computes lhs * rhs modulo the modulus.
+    constexpr inline value_type mulmod(const value_type &lhs, const value_type &rhs) const
+    {
+        // (lhs * rhs / R) * R^2 / R.
+        return this->montgomery_mul(this->montgomery_mul(this->reduce(lhs), this->reduce(rhs)), _r2);
+    }
+
+    /// @brief Computes base^exponent modulo the modulus, with a sliding window.
+    /// @details The time depends on the exponent, see powmod_ct.
+    template <std::size_t N2>
+    constexpr inline value_type powmod(const value_type &base, const BitVector<N2, Block> &exponent) const
+    {
+        const std::size_t bits = N2 - exponent.countl_zero();
+        // The window which minimizes the multiplications, for the size of the exponent.
+        const std::size_t window = (bits > 671) ? 6 : (bits > 239) ? 5 : (bits > 79) ? 4 : (bits > 23) ? 3 : (bits > 7) ? 2 : 1;
+        // The odd powers of the base, up to 2^window - 1.
+        value_type table[32];
+        table[0]                 = this->to_montgomery(base);
+        const value_type squared = this->montgomery_mul(table[0], table[0]);
+        for (std::size_t it = 1; it < (std::size_t(1) << (window - 1)); ++it)
+            table[it] = this->montgomery_mul(table[it - 1], squared);
+        value_type result = _one;
+        for (std::size_t position = bits; position > 0;) {
+            if (!exponent[position - 1]) {
+                result = this->montgomery_mul(result, result);
+                --position;
+                continue;
+            }
+            // The longest window ending with a one.
+            std::size_t low = (position > window) ? position - window : 0;
+            while (!exponent[low])
+                ++low;
+            std::size_t value = 0;
+            for (std::size_t it = position; it > low; --it) {
+                result = this->montgomery_mul(result, result);
+                value  = (value << 1) | exponent[it - 1];
+            }
+            result   = this->montgomery_mul(result, table[value / 2]);
+            position = low;
+        }
+        return this->from_montgomery(result);
+    }
+
+    /// @brief Computes base^exponent modulo the modulus, in constant time.
+    /// @details The multiplications only depend on N2, and the powers of the
+    /// base are read all together, selecting the right one with masks. The
+    /// base must be reduced, otherwise its reduction takes a division.
+    template <std::size_t N2>
+    constexpr inline value_type powmod_ct(const value_type &base, const BitVector<N2, Block> &exponent) const
+    {
+        constexpr std::size_t window = 4;
+        value_type table[std::size_t(1) << window];
+        table[0] = _one;
+        table[1] = this->to_montgomery(base);
+        for (std::size_t it = 2; it < (std::size_t(1) << window); ++it)
+            table[it] = this->montgomery_mul(table[it - 1], table[1]);
+        value_type result = _one, power;
+        for (std::size_t position = (N2 + window - 1) / window * window; position > 0; position -= window) {
+            std::size_t digit = 0;
+            for (std::size_t it = position; it > position - window; --it) {
+                result = this->montgomery_mul(result, result);
+                digit  = (digit << 1) | ((it <= N2) ? static_cast<std::size_t>(exponent[it - 1]) : 0U);
+            }
+            for (std::size_t entry = 0; entry < (std::size_t(1) << window); ++entry) {
+                const Block mask = static_cast<Block>(0U - static_cast<Block>(entry == digit));
+                for (std::size_t it = 0; it < num_blocks; ++it)
+                    power.data[it] = static_cast<Block>((power.data[it] & static_cast<Block>(~mask)) | (table[entry].data[it] & mask));
+            }
+            result = this->montgomery_mul(result, power);
+        }
+        return this->from_montgomery(result);
+    }
+
+    /// @brief Computes the inverse of the value modulo the modulus, with the binary extended Euclid's algorithm.
+    /// @details The time depends on the value, see invmod_ct.
+    /// @throw std::domain_error if the value and the modulus are not coprime.
+    constexpr inline value_type invmod(const value_type &value) const
+    {
+        using wide_t = BitVector<N + 1, Block>;
+        const wide_t modulus(_modulus);
+        wide_t u(this->reduce(value)), v(modulus), x1(1U), x2(0U);
+        // Invariants: x1 * value = u and x2 * value = v, modulo the modulus.
+        while ((u != 1U) && (v != 1U)) {
+            if (u.none())
+                throw std::domain_error("the value is not invertible");
+            for (; !u[0]; u >>= 1)
+                x1 = (x1[0] ? (x1 + modulus) : x1) >> 1;
+            for (; !v[0]; v >>= 1)
+                x2 = (x2[0] ? (x2 + modulus) : x2) >> 1;
+            if (u >= v) {
+                u -= v;
+                x1 = (x1 >= x2) ? wide_t(x1 - x2) : wide_t(x1 + modulus - x2);
+            } else {
+                v -= u;
+                x2 = (x2 >= x1) ? wide_t(x2 - x1) : wide_t(x2 + modulus - x1);
+            }
+        }
+        return value_type((u == 1U) ? x1 : x2);
+    }
+
+    /// @brief Computes the inverse of the value modulo a prime modulus, in constant time.
+    /// @details It computes value^(m - 2) with powmod_ct, which is the inverse only when the modulus is prime.
+    constexpr inline value_type invmod_ct(const value_type &value) const
+    {
+        return this->powmod_ct(value, value_type(_modulus - 2U));
+    }
+
+private:
+    /// @brief Returns lhs if the condition holds, rhs otherwise, selecting the blocks with a mask.
+    template <std::size_t N2>
+    static constexpr inline BitVector<N2, Block> select(bool condition, const BitVector<N2, Block> &lhs, const BitVector<N2, Block> &rhs)
+    {
+        const Block mask = static_cast<Block>(0U - static_cast<Block>(condition));
+        BitVector<N2, Block> result;
+        for (std::size_t it = 0; it < result.num_blocks; ++it)
+            result.data[it] = static_cast<Block>((lhs.data[it] & mask) | (rhs.data[it] & static_cast<Block>(~mask)));
+        return result;
+    }
+
+    /// The modulus.
+    value_type _modulus;
+    /// The divider used to reduce the values.
+    Divider<N, Block> _divider;
+    /// The number of significant blocks of the modulus.
+    std::size_t _size;
+    /// The value -1 / modulus modulo the size of the blocks.
+    Block _inverse;
+    /// The value R^2 modulo the modulus.
+    value_type _r2;
+    /// The value R modulo the modulus, i.e., one in Montgomery form.
+    value_type _one;
+};
+
+} // namespace bvlib
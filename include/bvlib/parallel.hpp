@@ -0,0 +1,367 @@
+/// @file parallel.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Parallel batched operations on arrays of bitvectors.
+/// @details The indices of a BitVectorArray are divided into chunks, sized so
+/// that the blocks touched by a chunk fit inside the L2 cache, and the chunks
+/// are distributed among the threads of a ThreadPool. Each thread starts from
+/// its own contiguous share of chunks and, once done, steals half of what is
+/// left to another thread. Reductions compute one partial result per chunk,
+/// and combine them in the order of the chunks, so their result depends only
+/// on the chunk size, and not on the number of threads or on the scheduling.
+
+#pragma once
+
+#include "bitvector_array.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief The size of the L2 cache, in bytes, used to choose the size of the chunks.
+#ifndef BVLIB_L2_CACHE_SIZE
+#define BVLIB_L2_CACHE_SIZE (256 * 1024)
+#endif
+
+namespace bvlib
+{
+
+namespace parallel
+{
+
+/// @brief Pool of threads, which process the chunks of a job by stealing them from each other.
+class ThreadPool {
+public:
+    /// @brief Starts the threads of the pool.
+    /// @param threads the number of threads, including the one submitting the jobs.
+    explicit ThreadPool(std::size_t threads = std::max(1U, std::thread::hardware_concurrency()))
+        : _shares(std::max<std::size_t>(threads, 1U)),
+          _workers(),
+          _submit(),
+          _mutex(),
+          _wake(),
+          _done(),
+          _job(),
+          _generation(),
+          _running(),
+          _error(),
+          _stop()
+    {
+        for (std::size_t it = 1; it < _shares.size(); ++it)
+            _workers.emplace_back([this, it] { this->work(it); });
+    }
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// @brief Stops the threads of the pool.
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (auto &worker : _workers)
+            worker.join();
+    }
+
+    /// @brief Returns the number of threads, including the one submitting the jobs.
+    inline std::size_t size() const
+    {
+        return _shares.size();
+    }
+
+    /// @brief Calls the function on every chunk, using all the threads of the pool.
+    /// @param chunks the number of chunks.
+    /// @param function called with the index of each chunk, from any of the threads.
+    /// @details Blocks until all the chunks have been processed. If the function
+    /// throws, the remaining chunks are skipped, and the first exception is
+    /// rethrown here. Jobs submitted from different threads are run one at a time,
+    /// and a job must not submit other jobs to the same pool.
+    inline void run(std::size_t chunks, const std::function<void(std::size_t)> &function)
+    {
+        if (chunks == 0)
+            return;
+        std::lock_guard<std::mutex> submit(_submit);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            // Give each thread an equal, contiguous share of the chunks.
+            for (std::size_t it = 0; it < _shares.size(); ++it) {
+                std::lock_guard<std::mutex> share(_shares[it].mutex);
+                _shares[it].next = chunks * it / _shares.size();
+                _shares[it].end  = chunks * (it + 1) / _shares.size();
+            }
+            _job     = &function;
+            _running = _shares.size();
+            _error   = nullptr;
+            ++_generation;
+        }
+        _wake.notify_all();
+        this->process(0);
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _running == 0; });
+        _job = nullptr;
+        if (_error)
+            std::rethrow_exception(_error);
+    }
+
+private:
+    /// @brief The chunks which are left to a thread.
+    struct share_t {
+        /// Protects the range.
+        std::mutex mutex;
+        /// The next chunk.
+        std::size_t next = 0;
+        /// The chunk after the last one.
+        std::size_t end = 0;
+    };
+
+    /// @brief The loop of the threads of the pool.
+    inline void work(std::size_t index)
+    {
+        std::size_t generation = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this, generation] { return _stop || (_generation != generation); });
+                if (_stop)
+                    return;
+                generation = _generation;
+            }
+            this->process(index);
+        }
+    }
+
+    /// @brief Processes chunks until there are none left, then signals it.
+    inline void process(std::size_t index)
+    {
+        std::size_t chunk = 0;
+        while (this->take(index, chunk)) {
+            try {
+                (*_job)(chunk);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_error)
+                    _error = std::current_exception();
+                // Drop the chunks which are left.
+                for (auto &share : _shares) {
+                    std::lock_guard<std::mutex> lock_share(share.mutex);
+                    share.next = share.end;
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_running == 0)
+            _done.notify_all();
+    }
+
+    /// @brief Takes the next chunk of the given thread, stealing from the others when it has none.
+    /// @return true if a chunk was found.
+    inline bool take(std::size_t index, std::size_t &chunk)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_shares[index].mutex);
+            if (_shares[index].next < _shares[index].end) {
+                chunk = _shares[index].next++;
+                return true;
+            }
+        }
+        for (std::size_t offset = 1; offset < _shares.size(); ++offset) {
+            share_t &victim = _shares[(index + offset) % _shares.size()];
+            std::size_t first = 0, last = 0;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                const std::size_t left = victim.end - victim.next;
+                if (left == 0)
+                    continue;
+                if (left == 1) {
+                    chunk = victim.next++;
+                    return true;
+                }
+                // Steal the upper half of what is left to the victim.
+                first      = victim.end - left / 2;
+                last       = victim.end;
+                victim.end = first;
+            }
+            std::lock_guard<std::mutex> lock(_shares[index].mutex);
+            chunk               = first;
+            _shares[index].next = first + 1;
+            _shares[index].end  = last;
+            return true;
+        }
+        return false;
+    }
+
+    /// The chunks left to each thread, the first one is the thread submitting the job.
+    std::vector<share_t> _shares;
+    /// The threads, besides the one submitting the job.
+    std::vector<std::thread> _workers;
+    /// Serializes the jobs.
+    std::mutex _submit;
+    /// Protects the state of the job.
+    std::mutex _mutex;
+    /// Wakes up the threads when a job starts, or when the pool stops.
+    std::condition_variable _wake;
+    /// Wakes up the thread submitting the job when it is done.
+    std::condition_variable _done;
+    /// The function of the current job.
+    const std::function<void(std::size_t)> *_job;
+    /// Incremented for each job.
+    std::size_t _generation;
+    /// The number of threads still processing the current job.
+    std::size_t _running;
+    /// The first exception thrown by the current job.
+    std::exception_ptr _error;
+    /// Whether the threads must stop.
+    bool _stop;
+};
+
+/// @brief Returns the pool shared by the parallel operations, with one thread per core.
+inline ThreadPool &default_pool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+/// @brief Returns the number of bitvectors of a chunk, so that the blocks of
+/// the given number of arrays fit inside the L2 cache.
+/// @param streams the number of arrays touched by the operation.
+template <std::size_t N, typename Block>
+constexpr inline std::size_t chunk_size(std::size_t streams = 3)
+{
+    return std::max<std::size_t>(BVLIB_L2_CACHE_SIZE / (streams * sizeof(BitVector<N, Block>)), bvlib::detail::batch_tile);
+}
+
+/// @brief Sums the bitvectors of two arrays, element by element.
+struct plus {
+    template <std::size_t N, typename Block>
+    inline void operator()(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first, std::size_t last) const
+    {
+        bvlib::add(dst, lhs, rhs, first, last);
+    }
+};
+
+/// @brief Subtracts the bitvectors of two arrays, element by element.
+struct minus {
+    template <std::size_t N, typename Block>
+    inline void operator()(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first, std::size_t last) const
+    {
+        bvlib::sub(dst, lhs, rhs, first, last);
+    }
+};
+
+/// @brief Computes the bitwise and of the bitvectors of two arrays, element by element.
+struct bit_and {
+    template <std::size_t N, typename Block>
+    inline void operator()(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first, std::size_t last) const
+    {
+        bvlib::bitwise_and(dst, lhs, rhs, first, last);
+    }
+};
+
+/// @brief Computes the bitwise or of the bitvectors of two arrays, element by element.
+struct bit_or {
+    template <std::size_t N, typename Block>
+    inline void operator()(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first, std::size_t last) const
+    {
+        bvlib::bitwise_or(dst, lhs, rhs, first, last);
+    }
+};
+
+/// @brief Computes the bitwise xor of the bitvectors of two arrays, element by element.
+struct bit_xor {
+    template <std::size_t N, typename Block>
+    inline void operator()(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, std::size_t first, std::size_t last) const
+    {
+        bvlib::bitwise_xor(dst, lhs, rhs, first, last);
+    }
+};
+
+/// @brief Applies a batched kernel to two arrays, in parallel.
+/// @param dst where the results are stored, it can be one of the operands.
+/// @param lhs the first array.
+/// @param rhs the second array.
+/// @param kernel called as kernel(dst, lhs, rhs, first, last) on each chunk (e.g., bvlib::parallel::plus()).
+/// @param pool the threads.
+template <std::size_t N, typename Block, typename Kernel>
+inline void transform(bvlib::BitVectorArray<N, Block> &dst, const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, Kernel kernel, ThreadPool &pool = default_pool())
+{
+    bvlib::detail::batch_range(dst, lhs, 0, dst.size());
+    bvlib::detail::batch_range(lhs, rhs, 0, lhs.size());
+    const std::size_t size = bvlib::parallel::chunk_size<N, Block>(3), chunks = (dst.size() + size - 1) / size;
+    pool.run(chunks, [&](std::size_t chunk) {
+        kernel(dst, lhs, rhs, chunk * size, std::min(dst.size(), (chunk + 1) * size));
+    });
+}
+
+/// @brief Reduces the bitvectors of an array, in parallel, with a deterministic order.
+/// @param size the number of bitvectors.
+/// @param chunk the number of bitvectors of each chunk.
+/// @param init the initial value.
+/// @param map called as map(first, last) on each chunk, returning its partial result.
+/// @param combine called as combine(accumulated, partial), in the order of the chunks.
+/// @param pool the threads.
+/// @return the combination of init with the partial results of all the chunks.
+template <typename T, typename Map, typename Combine>
+inline T reduce(std::size_t size, std::size_t chunk, T init, Map map, Combine combine, ThreadPool &pool = default_pool())
+{
+    // Each chunk writes its own slot, which is why they are not packed like std::vector<bool>.
+    struct slot_t {
+        T value;
+    };
+    const std::size_t chunks = (size + chunk - 1) / chunk;
+    std::vector<slot_t> partials(chunks, slot_t{ init });
+    pool.run(chunks, [&](std::size_t index) {
+        partials[index].value = map(index * chunk, std::min(size, (index + 1) * chunk));
+    });
+    for (const auto &partial : partials)
+        init = combine(init, partial.value);
+    return init;
+}
+
+/// @brief Counts the bits which are set in all the bitvectors of an array, in parallel.
+template <std::size_t N, typename Block>
+inline std::size_t popcount(const bvlib::BitVectorArray<N, Block> &array, ThreadPool &pool = default_pool())
+{
+    return bvlib::parallel::reduce(
+        array.size(), bvlib::parallel::chunk_size<N, Block>(1), std::size_t(0),
+        [&](std::size_t first, std::size_t last) {
+            std::size_t result = 0;
+            for (std::size_t limb = 0; limb < array.num_blocks; ++limb)
+                for (std::size_t it = first; it < last; ++it)
+                    result += bvlib::detail::popcount(array.plane(limb)[it]);
+            return result;
+        },
+        std::plus<std::size_t>(), pool);
+}
+
+/// @brief Counts the elements which differ between two arrays, in parallel.
+template <std::size_t N, typename Block>
+inline std::size_t count_different(const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, ThreadPool &pool = default_pool())
+{
+    bvlib::detail::batch_range(lhs, rhs, 0, lhs.size());
+    return bvlib::parallel::reduce(
+        lhs.size(), bvlib::parallel::chunk_size<N, Block>(2), std::size_t(0),
+        [&](std::size_t first, std::size_t last) {
+            std::vector<int> order(last - first);
+            bvlib::compare(order.data(), lhs, rhs, first, last);
+            return static_cast<std::size_t>(std::count_if(order.begin(), order.end(), [](int value) { return value != 0; }));
+        },
+        std::plus<std::size_t>(), pool);
+}
+
+/// @brief Compares two arrays, in parallel.
+/// @return true if all their bitvectors are equal.
+template <std::size_t N, typename Block>
+inline bool equal(const bvlib::BitVectorArray<N, Block> &lhs, const bvlib::BitVectorArray<N, Block> &rhs, ThreadPool &pool = default_pool())
+{
+    return (lhs.size() == rhs.size()) && (bvlib::parallel::count_different(lhs, rhs, pool) == 0);
+}
+
+} // namespace parallel
+
+} // namespace bvlib
@@ -0,0 +1,338 @@
+/// @file polynomial.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Bitvectors as polynomials over GF(2), and linear feedback shift registers.
+/// @details Bit i is the coefficient of x^i, the addition is the xor, and the
+/// multiplication is carry-less, which is a single instruction for each pair
+/// of 64-bit blocks when PCLMULQDQ or PMULL are available. The LFSR advances
+/// by any number of steps with the powers of its transition matrix, which are
+/// obtained by repeated squaring and cached.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "dynamic_bitvector.hpp"
+#include "intrinsics.hpp"
+#include "math.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace bvlib
+{
+
+namespace detail
+{
+
+/// @brief Multiplies two polynomials, adding the product to the destination.
+/// @param dst the destination, of lhs_size + rhs_size blocks.
+/// @param lhs the first polynomial.
+/// @param lhs_size the number of blocks of the first polynomial.
+/// @param rhs the second polynomial.
+/// @param rhs_size the number of blocks of the second polynomial.
+template <typename Block>
+constexpr inline void clmul_blocks(Block *dst, const Block *lhs, std::size_t lhs_size, const Block *rhs, std::size_t rhs_size)
+{
+    for (std::size_t i = 0; i < lhs_size; ++i) {
+        if (lhs[i] == 0)
+            continue;
+        for (std::size_t j = 0; j < rhs_size; ++j) {
+            Block high      = 0;
+            const Block low = bvlib::detail::clmul_wide(lhs[i], rhs[j], high);
+            dst[i + j]      = static_cast<Block>(dst[i + j] ^ low);
+            dst[i + j + 1]  = static_cast<Block>(dst[i + j + 1] ^ high);
+        }
+    }
+}
+
+/// @brief Adds the shifted source to the destination, discarding the bits which do not fit.
+/// @param dst the destination.
+/// @param dst_size the number of blocks of the destination.
+/// @param src the source.
+/// @param src_size the number of blocks of the source.
+/// @param shift the number of bits of the shift.
+template <typename Block>
+constexpr inline void xor_shifted(Block *dst, std::size_t dst_size, const Block *src, std::size_t src_size, std::size_t shift)
+{
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    const std::size_t block_shift        = shift / bits_per_block;
+    const std::size_t bit_shift          = shift % bits_per_block;
+    for (std::size_t it = 0; (it < src_size) && (it + block_shift < dst_size); ++it) {
+        dst[it + block_shift] = static_cast<Block>(dst[it + block_shift] ^ static_cast<Block>(src[it] << bit_shift));
+        if ((bit_shift > 0) && (it + block_shift + 1 < dst_size))
+            dst[it + block_shift + 1] = static_cast<Block>(dst[it + block_shift + 1] ^ static_cast<Block>(src[it] >> (bits_per_block - bit_shift)));
+    }
+}
+
+} // namespace detail
+
+/// @brief Multiplies two polynomials over GF(2).
+/// @param lhs the first polynomial, of size N1.
+/// @param rhs the second polynomial, of size N2.
+/// @return the product, of size N1 + N2 - 1, which holds any product.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<N1 + N2 - 1, Block> clmul(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    Block product[bvlib::BitVector<N1, Block>::num_blocks + bvlib::BitVector<N2, Block>::num_blocks] = {};
+    bvlib::detail::clmul_blocks(product, lhs.data, lhs.num_blocks, rhs.data, rhs.num_blocks);
+    bvlib::BitVector<N1 + N2 - 1, Block> result;
+    for (std::size_t it = 0; it < result.num_blocks; ++it)
+        result.data[it] = product[it];
+    return result;
+}
+
+/// @brief Multiplies two polynomials over GF(2).
+/// @param lhs the first polynomial.
+/// @param rhs the second polynomial.
+/// @return the product, of size lhs.size() + rhs.size() - 1, or empty if one of them is empty.
+template <typename Block, typename Allocator>
+inline bvlib::DynamicBitVector<Block, Allocator> clmul(const bvlib::DynamicBitVector<Block, Allocator> &lhs, const bvlib::DynamicBitVector<Block, Allocator> &rhs)
+{
+    if (lhs.empty() || rhs.empty())
+        return bvlib::DynamicBitVector<Block, Allocator>(lhs.get_allocator());
+    std::vector<Block> product(lhs.num_blocks() + rhs.num_blocks());
+    bvlib::detail::clmul_blocks(product.data(), lhs.data(), lhs.num_blocks(), rhs.data(), rhs.num_blocks());
+    bvlib::DynamicBitVector<Block, Allocator> result(lhs.size() + rhs.size() - 1, lhs.get_allocator());
+    std::copy(product.begin(), product.begin() + static_cast<std::ptrdiff_t>(result.num_blocks()), result.data());
+    return result;
+}
+
+/// @brief Returns the degree of the polynomial, or npos for the zero polynomial.
+template <std::size_t N, typename Block>
+constexpr inline std::size_t poly_degree(const bvlib::BitVector<N, Block> &polynomial)
+{
+    return polynomial.find_last();
+}
+
+/// @brief Divides two polynomials over GF(2).
+/// @param lhs the dividend.
+/// @param rhs the divisor.
+/// @return a pair containing the quotient and the remainder.
+/// @throw std::domain_error if the divisor is zero.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline std::pair<bvlib::BitVector<N1, Block>, bvlib::BitVector<N2, Block>> poly_divmod(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    const std::size_t degree = rhs.find_last();
+    if (degree == rhs.npos)
+        throw std::domain_error("division by zero undefined");
+    bvlib::BitVector<N1, Block> quotient, remainder(lhs);
+    // Only the blocks of the divisor up to its degree are shifted and added.
+    const std::size_t size = degree / remainder.bits_per_block + 1;
+    for (std::size_t it = N1; it > degree; --it) {
+        if (remainder[it - 1]) {
+            quotient[it - 1 - degree] = true;
+            bvlib::detail::xor_shifted(remainder.data, remainder.num_blocks, rhs.data, size, it - 1 - degree);
+        }
+    }
+    return std::make_pair(quotient, bvlib::BitVector<N2, Block>(remainder));
+}
+
+/// @brief Computes the remainder of the division of two polynomials over GF(2).
+/// @throw std::domain_error if the divisor is zero.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<N2, Block> poly_mod(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    return bvlib::poly_divmod(lhs, rhs).second;
+}
+
+/// @brief Computes lhs * rhs modulo the given polynomial.
+/// @throw std::domain_error if the modulus is zero.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::BitVector<N, Block> poly_mulmod(const bvlib::BitVector<N, Block> &lhs, const bvlib::BitVector<N, Block> &rhs, const bvlib::BitVector<N, Block> &modulus)
+{
+    return bvlib::poly_mod(bvlib::clmul(lhs, rhs), modulus);
+}
+
+/// @brief Computes the greatest common divisor of two polynomials over GF(2), with Euclid's algorithm.
+/// @return the greatest common divisor, which is zero only if both polynomials are zero.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::BitVector<std::max(N1, N2), Block> poly_gcd(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    bvlib::BitVector<std::max(N1, N2), Block> a(lhs), b(rhs);
+    while (b.any()) {
+        const auto remainder = bvlib::poly_mod(a, b);
+        a                    = b;
+        b                    = remainder;
+    }
+    return a;
+}
+
+/// @brief A square matrix over GF(2), stored by columns.
+/// @tparam N the number of rows and of columns.
+/// @tparam Block the type used to store the bits.
+template <std::size_t N, typename Block = std::uint64_t>
+class GF2Matrix {
+public:
+    /// The type of the columns, and of the vectors the matrix is applied to.
+    using vector_type = BitVector<N, Block>;
+
+    /// @brief Constructs the zero matrix.
+    GF2Matrix()
+        : _columns(N)
+    {
+    }
+
+    /// @brief Returns the identity matrix.
+    static inline GF2Matrix<N, Block> identity()
+    {
+        GF2Matrix<N, Block> result;
+        for (std::size_t it = 0; it < N; ++it)
+            result._columns[it][it] = true;
+        return result;
+    }
+
+    /// @brief Returns the column with the given index.
+    inline vector_type &column(std::size_t index)
+    {
+        return _columns[index];
+    }
+
+    /// @brief Returns the column with the given index.
+    inline const vector_type &column(std::size_t index) const
+    {
+        return _columns[index];
+    }
+
+    /// @brief Multiplies the matrix by the vector.
+    /// @details It adds the columns selected by the bits set in the vector.
+    inline vector_type apply(const vector_type &vector) const
+    {
+        vector_type result;
+        for (std::size_t block = 0; block < vector.num_blocks; ++block) {
+            for (Block bits = vector.data[block]; bits != 0; bits = static_cast<Block>(bits & (bits - 1U)))
+                result ^= _columns[block * vector.bits_per_block + bvlib::detail::countr_zero(bits)];
+        }
+        return result;
+    }
+
+    /// @brief Multiplies two matrices.
+    inline GF2Matrix<N, Block> operator*(const GF2Matrix<N, Block> &rhs) const
+    {
+        GF2Matrix<N, Block> result;
+        for (std::size_t it = 0; it < N; ++it)
+            result._columns[it] = this->apply(rhs._columns[it]);
+        return result;
+    }
+
+    /// @brief Raises the matrix to the given power, with square-and-multiply.
+    inline GF2Matrix<N, Block> pow(std::uint64_t exponent) const
+    {
+        GF2Matrix<N, Block> result = GF2Matrix<N, Block>::identity(), power = *this;
+        for (; exponent > 0; exponent >>= 1) {
+            if (exponent & 1U)
+                result = result * power;
+            if (exponent > 1)
+                power = power * power;
+        }
+        return result;
+    }
+
+    /// @brief Checks if the two matrices are equal.
+    inline bool operator==(const GF2Matrix<N, Block> &rhs) const
+    {
+        return _columns == rhs._columns;
+    }
+
+    /// @brief Checks if the two matrices are different.
+    inline bool operator!=(const GF2Matrix<N, Block> &rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+private:
+    /// The columns of the matrix.
+    std::vector<vector_type> _columns;
+};
+
+/// @brief A Galois linear feedback shift register.
+/// @details Each step multiplies the state by x modulo the characteristic
+/// polynomial x^N + taps, and outputs the bit which leaves the register.
+/// @tparam N the number of bits of the register.
+/// @tparam Block the type used to store the bits.
+template <std::size_t N, typename Block = std::uint64_t>
+class Lfsr {
+public:
+    /// The type of the state, and of the taps.
+    using value_type = BitVector<N, Block>;
+
+    /// @brief Constructs the register.
+    /// @param taps the coefficients of the characteristic polynomial below x^N.
+    /// @param state the initial state.
+    Lfsr(const value_type &taps, const value_type &state)
+        : _taps(taps),
+          _state(state),
+          _powers()
+    {
+    }
+
+    /// @brief Returns the state.
+    inline const value_type &state() const
+    {
+        return _state;
+    }
+
+    /// @brief Returns the taps.
+    inline const value_type &taps() const
+    {
+        return _taps;
+    }
+
+    /// @brief Advances the register by one step.
+    /// @return the output bit.
+    inline bool step()
+    {
+        const bool output = _state[N - 1];
+        _state <<= 1;
+        if (output)
+            _state ^= _taps;
+        return output;
+    }
+
+    /// @brief Advances the register by the given number of steps.
+    /// @details It applies the transition matrix raised to the powers of two
+    /// which make up the number of steps, computing them the first time.
+    inline void step(std::uint64_t steps)
+    {
+        for (std::size_t it = 0; steps > 0; ++it, steps >>= 1) {
+            if (it == _powers.size())
+                _powers.push_back(it ? (_powers.back() * _powers.back()) : this->transition_matrix());
+            if (steps & 1U)
+                _state = _powers[it].apply(_state);
+        }
+    }
+
+    /// @brief Applies a precomputed matrix, e.g., the one returned by jump_matrix().
+    inline void jump(const GF2Matrix<N, Block> &matrix)
+    {
+        _state = matrix.apply(_state);
+    }
+
+    /// @brief Returns the matrix of a single step.
+    inline GF2Matrix<N, Block> transition_matrix() const
+    {
+        GF2Matrix<N, Block> result;
+        // x^j becomes x^(j + 1), and x^(N - 1) becomes the taps.
+        for (std::size_t it = 0; it + 1 < N; ++it)
+            result.column(it)[it + 1] = true;
+        result.column(N - 1) = _taps;
+        return result;
+    }
+
+    /// @brief Returns the matrix which advances the register by the given number of steps.
+    inline GF2Matrix<N, Block> jump_matrix(std::uint64_t steps) const
+    {
+        return this->transition_matrix().pow(steps);
+    }
+
+private:
+    /// The coefficients of the characteristic polynomial below x^N.
+    value_type _taps;
+    /// The state.
+    value_type _state;
+    /// The transition matrix raised to the powers of two.
+    std::vector<GF2Matrix<N, Block>> _powers;
+};
+
+} // namespace bvlib
@@ -0,0 +1,216 @@
+/// @file rank_select.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Succinct index answering rank and select queries over a bitvector.
+/// @details The index follows the layout of "Space-Efficient, High-Performance
+/// Rank & Select Structures on Uncompressed Bit Sequences", by D. Zhou, D. G.
+/// Andersen and M. Kaminsky. The bits are split into blocks of 2048 bits, and
+/// each block has one 64-bit entry holding the number of ones before it (in
+/// the low 32 bits, relative to the enclosing 2^32 bits), followed by the
+/// number of ones of its first three sub-blocks of 512 bits (10 bits each).
+/// A rank thus reads one entry and at most eight blocks of the bitvector,
+/// with an overhead of 3.125%. The select samples the position of one every
+/// 8192 ones, and searches the entries between two samples.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "dynamic_bitvector.hpp"
+#include "intrinsics.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace bvlib
+{
+
+/// @brief Rank and select index over a bitvector of 64-bit blocks.
+/// @details The index does not own the bits, which must outlive it and must
+/// not be modified after the index is built.
+class RankSelect {
+public:
+    /// The number of bits of a block of the bitvector.
+    static constexpr std::size_t bits_per_block = 64;
+
+    /// The number of bits covered by an entry of the index.
+    static constexpr std::size_t bits_per_entry = 2048;
+
+    /// The number of bits covered by a sub-block of an entry.
+    static constexpr std::size_t bits_per_subblock = 512;
+
+    /// The number of ones between two select samples.
+    static constexpr std::size_t ones_per_sample = 8192;
+
+    /// The value returned by select when there is no such bit.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// @brief Builds an empty index.
+    RankSelect()
+        : _data(nullptr),
+          _size(0),
+          _ones(0),
+          _upper(1, 0),
+          _lower(1, 0),
+          _samples()
+    {
+    }
+
+    /// @brief Builds the index over a fixed-size bitvector.
+    template <std::size_t N>
+    explicit RankSelect(const BitVector<N, std::uint64_t> &bitvector)
+        : RankSelect(bitvector.data, N)
+    {
+    }
+
+    /// @brief Builds the index over a dynamic bitvector.
+    template <typename Allocator>
+    explicit RankSelect(const DynamicBitVector<std::uint64_t, Allocator> &bitvector)
+        : RankSelect(bitvector.data(), bitvector.size())
+    {
+    }
+
+    /// @brief Builds the index over an array of blocks.
+    /// @param data the blocks, least significant first, with the bits above size set to zero.
+    /// @param size the number of bits.
+    RankSelect(const std::uint64_t *data, std::size_t size)
+        : _data(data),
+          _size(size),
+          _ones(0),
+          _upper(static_cast<std::size_t>(static_cast<std::uint64_t>(size) >> 32) + 1, 0),
+          _lower(size / bits_per_entry + 1, 0),
+          _samples()
+    {
+        std::uint64_t total = 0;
+        for (std::size_t entry = 0; entry < _lower.size(); ++entry) {
+            if ((entry % entries_per_upper) == 0)
+                _upper[entry / entries_per_upper] = total;
+            std::uint64_t value = total - _upper[entry / entries_per_upper];
+            for (std::size_t sub = 0; sub < bits_per_entry / bits_per_subblock; ++sub) {
+                const std::size_t count = this->popcount_subblock(entry * (bits_per_entry / bits_per_subblock) + sub);
+                // Samples the entries holding the 0th, 8192th, ... one.
+                while ((_samples.size() * ones_per_sample) < total + count)
+                    _samples.push_back(entry);
+                if (sub < 3)
+                    value |= static_cast<std::uint64_t>(count) << (32 + 10 * sub);
+                total += count;
+            }
+            _lower[entry] = value;
+        }
+        _ones = static_cast<std::size_t>(total);
+    }
+
+    /// @brief Returns the number of bits of the indexed bitvector.
+    inline std::size_t size() const
+    {
+        return _size;
+    }
+
+    /// @brief Returns the number of ones of the indexed bitvector.
+    inline std::size_t count() const
+    {
+        return _ones;
+    }
+
+    /// @brief Returns the number of bytes used by the index.
+    inline std::size_t memory_usage() const
+    {
+        return sizeof(std::uint64_t) * (_upper.size() + _lower.size()) + sizeof(std::size_t) * _samples.size();
+    }
+
+    /// @brief Counts the ones before the given position.
+    /// @param position the position, which must not be greater than size().
+    /// @return the number of ones in [0, position).
+    inline std::size_t rank1(std::size_t position) const
+    {
+        assert(position <= _size);
+        const std::size_t entry = position / bits_per_entry;
+        const std::size_t sub   = (position % bits_per_entry) / bits_per_subblock;
+        std::size_t result      = this->rank_entry(entry);
+        for (std::size_t it = 0; it < sub; ++it)
+            result += this->subblock_count(entry, it);
+        const std::size_t first = (position / bits_per_subblock) * (bits_per_subblock / bits_per_block);
+        const std::size_t last  = position / bits_per_block;
+        for (std::size_t it = first; it < last; ++it)
+            result += bvlib::detail::popcount(_data[it]);
+        if (position % bits_per_block)
+            result += bvlib::detail::popcount(static_cast<std::uint64_t>(_data[last] << (bits_per_block - position % bits_per_block)));
+        return result;
+    }
+
+    /// @brief Counts the zeros before the given position.
+    /// @param position the position, which must not be greater than size().
+    /// @return the number of zeros in [0, position).
+    inline std::size_t rank0(std::size_t position) const
+    {
+        return position - this->rank1(position);
+    }
+
+    /// @brief Finds the position of a one.
+    /// @param rank the number of ones preceding the one to find.
+    /// @return the position of the one, or npos if there are not enough ones.
+    inline std::size_t select1(std::size_t rank) const
+    {
+        if (rank >= _ones)
+            return npos;
+        // Find the last entry starting with at most rank ones.
+        const std::size_t sample = rank / ones_per_sample;
+        std::size_t low          = _samples[sample];
+        std::size_t high         = (sample + 1 < _samples.size()) ? _samples[sample + 1] : _lower.size() - 1;
+        while (low < high) {
+            const std::size_t middle = low + (high - low + 1) / 2;
+            if (this->rank_entry(middle) <= rank)
+                low = middle;
+            else
+                high = middle - 1;
+        }
+        rank -= this->rank_entry(low);
+        // Then the sub-block, and the block.
+        std::size_t sub = 0;
+        for (std::size_t count; (sub < 3) && (rank >= (count = this->subblock_count(low, sub))); ++sub)
+            rank -= count;
+        std::size_t block = (low * bits_per_entry + sub * bits_per_subblock) / bits_per_block;
+        for (std::size_t count; rank >= (count = bvlib::detail::popcount(_data[block])); ++block)
+            rank -= count;
+        return block * bits_per_block + bvlib::detail::select_one(_data[block], rank);
+    }
+
+private:
+    /// The number of entries covered by an upper entry.
+    static constexpr std::size_t entries_per_upper = static_cast<std::size_t>((std::uint64_t(1) << 32) / bits_per_entry);
+
+    /// @brief Returns the number of ones before the given entry.
+    inline std::size_t rank_entry(std::size_t entry) const
+    {
+        return static_cast<std::size_t>(_upper[entry / entries_per_upper] + (_lower[entry] & 0xFFFFFFFFULL));
+    }
+
+    /// @brief Returns the number of ones of one of the first three sub-blocks of an entry.
+    inline std::size_t subblock_count(std::size_t entry, std::size_t sub) const
+    {
+        return static_cast<std::size_t>((_lower[entry] >> (32 + 10 * sub)) & 0x3FFULL);
+    }
+
+    /// @brief Counts the ones of a sub-block, reading only the blocks inside the bitvector.
+    inline std::size_t popcount_subblock(std::size_t subblock) const
+    {
+        const std::size_t blocks = (_size + bits_per_block - 1) / bits_per_block;
+        std::size_t result       = 0;
+        for (std::size_t it = subblock * (bits_per_subblock / bits_per_block), end = it + bits_per_subblock / bits_per_block; (it < end) && (it < blocks); ++it)
+            result += bvlib::detail::popcount(_data[it]);
+        return result;
+    }
+
+    /// The indexed blocks.
+    const std::uint64_t *_data;
+    /// The number of indexed bits.
+    std::size_t _size;
+    /// The number of ones.
+    std::size_t _ones;
+    /// The number of ones before each group of 2^32 bits.
+    std::vector<std::uint64_t> _upper;
+    /// The entries, one every 2048 bits.
+    std::vector<std::uint64_t> _lower;
+    /// The entry holding the one at every multiple of 8192.
+    std::vector<std::size_t> _samples;
+};
+
+} // namespace bvlib
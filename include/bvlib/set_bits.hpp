@@ -0,0 +1,228 @@
+/// @file set_bits.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Traversal of the bits which are set.
+/// @details Instead of testing every bit, the traversal jumps from one set
+/// bit to the next one with a count of the trailing zeros of the block, and
+/// skips the blocks which are zero, so its cost grows with the number of ones.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "dynamic_bitvector.hpp"
+#include "intrinsics.hpp"
+#include "sparse_bitvector.hpp"
+
+#include <cstddef>
+#include <iterator>
+
+#if defined(__cpp_lib_ranges)
+#include <ranges>
+#endif
+
+namespace bvlib
+{
+
+/// @brief Forward iterator over the positions of the bits which are set.
+/// @tparam Block the type of the blocks.
+template <typename Block>
+class SetBitIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::size_t;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const std::size_t *;
+    using reference         = std::size_t;
+
+    /// The number of bits stored inside a block.
+    static constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+
+    /// @brief Builds an iterator which compares equal to any end iterator.
+    constexpr SetBitIterator()
+        : _data(nullptr),
+          _num_blocks(0),
+          _index(0),
+          _block(0)
+    {
+    }
+
+    /// @brief Builds an iterator pointing to the first bit set, starting from the given block.
+    /// @param data the blocks.
+    /// @param num_blocks the number of blocks.
+    /// @param index the block where to start, num_blocks for an end iterator.
+    constexpr SetBitIterator(const Block *data, std::size_t num_blocks, std::size_t index)
+        : _data(data),
+          _num_blocks(num_blocks),
+          _index(index),
+          _block((index < num_blocks) ? data[index] : Block(0))
+    {
+        this->skip_zeros();
+    }
+
+    /// @brief Returns the position of the bit.
+    constexpr inline std::size_t operator*() const
+    {
+        return _index * bits_per_block + bvlib::detail::countr_zero(_block);
+    }
+
+    /// @brief Moves to the next bit set.
+    constexpr inline SetBitIterator &operator++()
+    {
+        _block = static_cast<Block>(_block & (_block - 1U));
+        this->skip_zeros();
+        return *this;
+    }
+
+    /// @brief Moves to the next bit set.
+    constexpr inline SetBitIterator operator++(int)
+    {
+        SetBitIterator result = *this;
+        ++(*this);
+        return result;
+    }
+
+    /// @brief Compares two iterators, all the end iterators are equal.
+    friend constexpr inline bool operator==(const SetBitIterator &lhs, const SetBitIterator &rhs)
+    {
+        return (lhs._block == rhs._block) && ((lhs._block == 0) || (lhs._index == rhs._index));
+    }
+
+    /// @brief Compares two iterators, all the end iterators are equal.
+    friend constexpr inline bool operator!=(const SetBitIterator &lhs, const SetBitIterator &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    /// @brief Moves to the next block which is not zero, if the current one is.
+    constexpr inline void skip_zeros()
+    {
+        while ((_block == 0) && (_index < _num_blocks) && (++_index < _num_blocks))
+            _block = _data[_index];
+    }
+
+    /// The blocks.
+    const Block *_data;
+    /// The number of blocks.
+    std::size_t _num_blocks;
+    /// The index of the current block.
+    std::size_t _index;
+    /// The bits of the current block not yet visited.
+    Block _block;
+};
+
+/// @brief View over the positions of the bits which are set, in increasing order.
+/// @details The view does not own the bits, and it is invalidated when the
+/// bitvector is destroyed or resized.
+template <typename Block>
+class SetBitRange
+#if defined(__cpp_lib_ranges)
+    : public std::ranges::view_base
+#endif
+{
+public:
+    /// The type of the iterators.
+    using iterator = SetBitIterator<Block>;
+
+    /// @brief Builds an empty view.
+    constexpr SetBitRange()
+        : _data(nullptr),
+          _num_blocks(0)
+    {
+    }
+
+    /// @brief Builds a view over the given blocks.
+    constexpr SetBitRange(const Block *data, std::size_t num_blocks)
+        : _data(data),
+          _num_blocks(num_blocks)
+    {
+    }
+
+    /// @brief Returns an iterator to the first bit set.
+    constexpr inline iterator begin() const
+    {
+        return iterator(_data, _num_blocks, 0);
+    }
+
+    /// @brief Returns the end iterator.
+    constexpr inline iterator end() const
+    {
+        return iterator(_data, _num_blocks, _num_blocks);
+    }
+
+    /// @brief Tests whether there are no bits set.
+    constexpr inline bool empty() const
+    {
+        return this->begin() == this->end();
+    }
+
+private:
+    /// The blocks.
+    const Block *_data;
+    /// The number of blocks.
+    std::size_t _num_blocks;
+};
+
+/// @brief Returns a view over the positions of the bits which are set.
+template <std::size_t N, typename Block>
+constexpr inline SetBitRange<Block> set_bits(const BitVector<N, Block> &bitvector)
+{
+    return SetBitRange<Block>(bitvector.data, BitVector<N, Block>::num_blocks);
+}
+
+/// @brief Returns a view over the positions of the bits which are set.
+template <typename Block, typename Allocator>
+inline SetBitRange<Block> set_bits(const DynamicBitVector<Block, Allocator> &bitvector)
+{
+    return SetBitRange<Block>(bitvector.data(), bitvector.num_blocks());
+}
+
+namespace detail
+{
+
+/// @brief Calls the function with the position of each bit set, in increasing order.
+template <typename Block, typename Function>
+constexpr inline void for_each_set_bit(const Block *data, std::size_t num_blocks, Function &&function)
+{
+    for (std::size_t it = 0; it < num_blocks; ++it)
+        for (Block block = data[it]; block; block = static_cast<Block>(block & (block - 1U)))
+            function(it * bvlib::detail::digits<Block>() + bvlib::detail::countr_zero(block));
+}
+
+} // namespace detail
+
+/// @brief Calls the function with the position of each bit set, in increasing order.
+template <std::size_t N, typename Block, typename Function>
+constexpr inline void for_each_set_bit(const BitVector<N, Block> &bitvector, Function &&function)
+{
+    bvlib::detail::for_each_set_bit(bitvector.data, BitVector<N, Block>::num_blocks, function);
+}
+
+/// @brief Calls the function with the position of each bit set, in increasing order.
+template <typename Block, typename Allocator, typename Function>
+inline void for_each_set_bit(const DynamicBitVector<Block, Allocator> &bitvector, Function &&function)
+{
+    bvlib::detail::for_each_set_bit(bitvector.data(), bitvector.num_blocks(), function);
+}
+
+/// @brief Calls the function with the position of each bit set, in increasing order.
+template <std::size_t N, typename Function>
+inline void for_each_set_bit(const SparseBitVector<N> &bitvector, Function &&function)
+{
+    for (std::size_t it = 0; it < bitvector.keys().size(); ++it) {
+        const std::size_t base = bitvector.keys()[it] * SparseBitVector<N>::chunk_bits;
+        bitvector.containers()[it].for_each([&function, base](std::size_t value) { function(base + value); });
+    }
+}
+
+} // namespace bvlib
+
+#if defined(__cpp_lib_ranges)
+namespace std::ranges
+{
+
+/// @brief The view only refers to the bits, so its iterators outlive it.
+template <typename Block>
+inline constexpr bool enable_borrowed_range<bvlib::SetBitRange<Block>> = true;
+
+} // namespace std::ranges
+#endif
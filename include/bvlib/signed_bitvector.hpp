@@ -0,0 +1,429 @@
+/// @file signed_bitvector.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Bitvectors holding two's-complement signed values.
+/// @details A SignedBitVector stores the same bits of a BitVector, and only
+/// changes how they are read: the most significant bit is the sign. The
+/// addition, the subtraction, the wrapping multiplication and the bitwise
+/// operations are the unsigned ones, the comparison only looks at the signs
+/// before comparing the blocks, the right shift fills the vacated bits with
+/// the sign, and the division works on the magnitudes, truncating toward zero
+/// like the built-in integers.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "math.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace bvlib
+{
+
+namespace detail
+{
+
+/// @brief Sets all the bits from the given position upward to the given value.
+/// @param data the blocks.
+/// @param num_blocks the number of blocks.
+/// @param last_block_mask the mask of the valid bits of the last block.
+/// @param position the first bit to set.
+/// @param value the value of the bits.
+template <typename Block>
+constexpr inline void fill_from(Block *data, std::size_t num_blocks, Block last_block_mask, std::size_t position, bool value)
+{
+    constexpr std::size_t bits_per_block = bvlib::detail::digits<Block>();
+    std::size_t block                    = position / bits_per_block;
+    if (block >= num_blocks)
+        return;
+    const Block fill = value ? static_cast<Block>(~Block(0)) : Block(0);
+    const Block mask = static_cast<Block>(static_cast<Block>(~Block(0)) << (position % bits_per_block));
+    data[block]      = static_cast<Block>((data[block] & static_cast<Block>(~mask)) | (fill & mask));
+    for (++block; block < num_blocks; ++block)
+        data[block] = fill;
+    data[num_blocks - 1] &= last_block_mask;
+}
+
+} // namespace detail
+
+/// @brief A bitvector holding a two's-complement signed value.
+/// @tparam N the number of bits, including the sign.
+/// @tparam Block the type used to store the bits.
+template <std::size_t N, typename Block = std::uint64_t>
+class SignedBitVector {
+public:
+    static_assert(N > 0, "A signed bitvector needs at least the sign bit");
+
+    /// The type of the underlying bits.
+    using unsigned_type = BitVector<N, Block>;
+
+    /// The number of bits stored inside a block.
+    static constexpr std::size_t bits_per_block = unsigned_type::bits_per_block;
+
+    /// The number of blocks.
+    static constexpr std::size_t num_blocks = unsigned_type::num_blocks;
+
+    /// The bits of the value.
+    unsigned_type bits;
+
+    /// @brief Constructs a zero value.
+    constexpr SignedBitVector()
+        : bits()
+    {
+    }
+
+    /// @brief Reads the given bits as a signed value.
+    constexpr explicit SignedBitVector(const unsigned_type &value)
+        : bits(value)
+    {
+    }
+
+    /// @brief Constructs the value from an integer, extending its sign.
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    constexpr explicit SignedBitVector(T value)
+        : bits(value)
+    {
+        if constexpr (std::is_signed<T>::value) {
+            if (value < 0)
+                bvlib::detail::fill_from(bits.data, num_blocks, unsigned_type::last_block_mask, sizeof(T) * CHAR_BIT, true);
+        }
+    }
+
+    /// @brief Converts a signed bitvector of a different width.
+    /// @details A wider value is truncated, a narrower one is sign-extended.
+    template <std::size_t N2>
+    constexpr explicit SignedBitVector(const SignedBitVector<N2, Block> &other)
+        : bits(other.bits)
+    {
+        if constexpr (N > N2) {
+            if (other.is_negative())
+                bvlib::detail::fill_from(bits.data, num_blocks, unsigned_type::last_block_mask, N2, true);
+        }
+    }
+
+    /// @brief Returns the smallest value, i.e., -2^(N-1).
+    static constexpr inline SignedBitVector<N, Block> min()
+    {
+        SignedBitVector<N, Block> result;
+        result.bits[N - 1] = true;
+        return result;
+    }
+
+    /// @brief Returns the largest value, i.e., 2^(N-1) - 1.
+    static constexpr inline SignedBitVector<N, Block> max()
+    {
+        SignedBitVector<N, Block> result(unsigned_type::ones());
+        result.bits[N - 1] = false;
+        return result;
+    }
+
+    /// @brief Returns the number of bits.
+    constexpr inline auto size() const -> std::size_t
+    {
+        return N;
+    }
+
+    /// @brief Checks if the value is negative.
+    constexpr inline auto is_negative() const -> bool
+    {
+        return bits.sign();
+    }
+
+    /// @brief Checks if the value is zero.
+    constexpr inline auto is_zero() const -> bool
+    {
+        return bits.none();
+    }
+
+    /// @brief Returns the magnitude of the value.
+    /// @details The magnitude of min() is 2^(N-1), which fits the unsigned bits.
+    constexpr inline unsigned_type abs() const
+    {
+        unsigned_type result(bits);
+        if (this->is_negative())
+            result.two_complement();
+        return result;
+    }
+
+    /// @brief Negates the value, modifying it.
+    constexpr inline SignedBitVector<N, Block> &negate()
+    {
+        bits.two_complement();
+        return *this;
+    }
+
+    /// @brief Accesses the bit at the given position.
+    constexpr inline typename unsigned_type::reference operator[](std::size_t position)
+    {
+        return bits[position];
+    }
+
+    /// @brief Accesses the bit at the given position.
+    constexpr inline bool operator[](std::size_t position) const
+    {
+        return bits[position];
+    }
+
+    /// @brief Transforms the value to number.
+    /// @details Integral types receive the sign-extended bits, and the ones
+    /// which do not fit are discarded.
+    template <typename T>
+    constexpr inline T to_number() const
+    {
+        if constexpr (std::is_integral<T>::value) {
+            return SignedBitVector<sizeof(T) * CHAR_BIT, Block>(*this).bits.template to_number<T>();
+        } else {
+            const T magnitude = this->abs().template to_number<T>();
+            return this->is_negative() ? -magnitude : magnitude;
+        }
+    }
+};
+
+namespace detail
+{
+
+/// @brief Compares two signed values.
+/// @return -1 if lhs < rhs, 0 if they are equal, 1 if lhs > rhs.
+template <std::size_t N, typename Block>
+constexpr inline int compare_signed(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    // Values with the same sign are ordered like their bits.
+    if (lhs.is_negative() != rhs.is_negative())
+        return lhs.is_negative() ? -1 : 1;
+    return bvlib::detail::compare_blocks(lhs.bits.data, lhs.num_blocks, rhs.bits.data, rhs.num_blocks);
+}
+
+} // namespace detail
+
+// ============================================================================
+// ARITHMETIC
+// ============================================================================
+
+/// @brief Negates the value.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator-(const bvlib::SignedBitVector<N, Block> &value)
+{
+    bvlib::SignedBitVector<N, Block> result(value);
+    return result.negate();
+}
+
+/// @brief Adds two values, wrapping around on overflow.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator+(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::SignedBitVector<N, Block>(lhs.bits + rhs.bits);
+}
+
+/// @brief Subtracts two values, wrapping around on overflow.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator-(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::SignedBitVector<N, Block>(lhs.bits - rhs.bits);
+}
+
+/// @brief Adds two values, saving the result inside the first.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> &operator+=(bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    lhs.bits += rhs.bits;
+    return lhs;
+}
+
+/// @brief Subtracts two values, saving the result inside the first.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> &operator-=(bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    lhs.bits -= rhs.bits;
+    return lhs;
+}
+
+/// @brief Multiplies two values, returning the full signed product.
+/// @details The magnitudes are multiplied as unsigned values, and the product
+/// is negated when the signs differ.
+/// @return a signed bitvector of size (std::max(N1, N2)*2), which holds any product.
+template <std::size_t N1, std::size_t N2, typename Block>
+constexpr inline bvlib::SignedBitVector<std::max(N1, N2) * 2, Block> mul(const bvlib::SignedBitVector<N1, Block> &lhs, const bvlib::SignedBitVector<N2, Block> &rhs)
+{
+    bvlib::SignedBitVector<std::max(N1, N2) * 2, Block> result(bvlib::mul(lhs.abs(), rhs.abs()));
+    if (lhs.is_negative() != rhs.is_negative())
+        result.negate();
+    return result;
+}
+
+/// @brief Multiplies two values, wrapping around on overflow.
+/// @details The low bits of the two's-complement product do not depend on
+/// the signs, so they are the ones of the unsigned product.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator*(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::SignedBitVector<N, Block>(bvlib::BitVector<N, Block>(bvlib::mul(lhs.bits, rhs.bits)));
+}
+
+/// @brief Multiplies two values, saving the result inside the first.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> &operator*=(bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return (lhs = lhs * rhs);
+}
+
+/// @brief Divides two values, truncating toward zero.
+/// @details The remainder has the sign of the dividend, and min() / -1 wraps
+/// around to min(), like with the built-in integers.
+/// @return a pair containing the quotient and the remainder.
+/// @throw std::domain_error on a division by zero.
+template <std::size_t N, typename Block>
+constexpr inline std::pair<bvlib::SignedBitVector<N, Block>, bvlib::SignedBitVector<N, Block>> div(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    const auto result = bvlib::div(lhs.abs(), rhs.abs());
+    bvlib::SignedBitVector<N, Block> quotient(result.first), remainder(result.second);
+    if (lhs.is_negative() != rhs.is_negative())
+        quotient.negate();
+    if (lhs.is_negative())
+        remainder.negate();
+    return std::make_pair(quotient, remainder);
+}
+
+/// @brief Divides two values, truncating toward zero.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator/(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::div(lhs, rhs).first;
+}
+
+/// @brief Computes the remainder of the division, which has the sign of the dividend.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator%(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::div(lhs, rhs).second;
+}
+
+// ============================================================================
+// SHIFT
+// ============================================================================
+
+/// @brief Shifts the value to the right, filling the vacated bits with the sign.
+/// @param value the value.
+/// @param shift the amount to shift, shifting by N or more bits leaves only the sign.
+/// @return the shifted value.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> shift_right_arithmetic(const bvlib::SignedBitVector<N, Block> &value, std::size_t shift)
+{
+    bvlib::SignedBitVector<N, Block> result(bvlib::shift_right(value.bits, shift));
+    if (value.is_negative())
+        bvlib::detail::fill_from(result.bits.data, result.num_blocks, result.bits.last_block_mask, (shift < N) ? N - shift : 0, true);
+    return result;
+}
+
+/// @brief Shifts the value to the right, filling the vacated bits with the sign.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator>>(const bvlib::SignedBitVector<N, Block> &value, std::size_t shift)
+{
+    return bvlib::shift_right_arithmetic(value, shift);
+}
+
+/// @brief Shifts the value to the right, filling the vacated bits with the sign, modifying it.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> &operator>>=(bvlib::SignedBitVector<N, Block> &value, std::size_t shift)
+{
+    return (value = bvlib::shift_right_arithmetic(value, shift));
+}
+
+/// @brief Shifts the value to the left, which is the same for signed and unsigned values.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator<<(const bvlib::SignedBitVector<N, Block> &value, std::size_t shift)
+{
+    return bvlib::SignedBitVector<N, Block>(bvlib::shift_left(value.bits, shift));
+}
+
+/// @brief Shifts the value to the left, modifying it.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> &operator<<=(bvlib::SignedBitVector<N, Block> &value, std::size_t shift)
+{
+    value.bits <<= shift;
+    return value;
+}
+
+// ============================================================================
+// BITWISE
+// ============================================================================
+
+/// @brief Flips all the bits, i.e., computes -value - 1.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator~(const bvlib::SignedBitVector<N, Block> &value)
+{
+    return bvlib::SignedBitVector<N, Block>(~value.bits);
+}
+
+/// @brief Performs a bitwise and.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator&(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::SignedBitVector<N, Block>(lhs.bits & rhs.bits);
+}
+
+/// @brief Performs a bitwise or.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator|(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::SignedBitVector<N, Block>(lhs.bits | rhs.bits);
+}
+
+/// @brief Performs a bitwise xor.
+template <std::size_t N, typename Block>
+constexpr inline bvlib::SignedBitVector<N, Block> operator^(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::SignedBitVector<N, Block>(lhs.bits ^ rhs.bits);
+}
+
+// ============================================================================
+// COMPARISON
+// ============================================================================
+
+/// @brief Checks if the two values are equal.
+template <std::size_t N, typename Block>
+constexpr inline bool operator==(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return lhs.bits == rhs.bits;
+}
+
+/// @brief Checks if the two values are different.
+template <std::size_t N, typename Block>
+constexpr inline bool operator!=(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return lhs.bits != rhs.bits;
+}
+
+/// @brief Checks if the first value is smaller than the second.
+template <std::size_t N, typename Block>
+constexpr inline bool operator<(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::detail::compare_signed(lhs, rhs) < 0;
+}
+
+/// @brief Checks if the first value is smaller than or equal to the second.
+template <std::size_t N, typename Block>
+constexpr inline bool operator<=(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::detail::compare_signed(lhs, rhs) <= 0;
+}
+
+/// @brief Checks if the first value is greater than the second.
+template <std::size_t N, typename Block>
+constexpr inline bool operator>(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::detail::compare_signed(lhs, rhs) > 0;
+}
+
+/// @brief Checks if the first value is greater than or equal to the second.
+template <std::size_t N, typename Block>
+constexpr inline bool operator>=(const bvlib::SignedBitVector<N, Block> &lhs, const bvlib::SignedBitVector<N, Block> &rhs)
+{
+    return bvlib::detail::compare_signed(lhs, rhs) >= 0;
+}
+
+} // namespace bvlib
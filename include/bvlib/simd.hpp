@@ -0,0 +1,206 @@
+/// @file simd.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Vectorized kernels working on arrays of blocks.
+/// @details The instruction set is selected at compile time, depending on the
+/// flags used to compile the including translation unit (e.g., `-mavx2`,
+/// `-mavx512f`, or `-march=native`). When no vector extension is available,
+/// the kernels fall back to plain loops over the blocks, which are also used
+/// during constant evaluation.
+
+#pragma once
+
+#include "intrinsics.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define BVLIB_SIMD_X86
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BVLIB_SIMD_NEON
+#endif
+
+namespace bvlib
+{
+
+namespace simd
+{
+
+/// @brief The supported bitwise operations.
+enum class bitwise_op {
+    op_and, ///< Bitwise and.
+    op_or,  ///< Bitwise or.
+    op_xor, ///< Bitwise exclusive or.
+};
+
+/// @brief Returns the name of the instruction set used by the kernels.
+inline const char *instruction_set()
+{
+#if defined(__AVX512F__)
+    return "avx512";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(BVLIB_SIMD_X86)
+    return "sse2";
+#elif defined(BVLIB_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+namespace detail
+{
+
+/// @brief Applies the given operation to two scalar values.
+template <bitwise_op Op, typename T>
+constexpr inline T apply_scalar(T lhs, T rhs)
+{
+    if constexpr (Op == bitwise_op::op_and)
+        return static_cast<T>(lhs & rhs);
+    else if constexpr (Op == bitwise_op::op_or)
+        return static_cast<T>(lhs | rhs);
+    else
+        return static_cast<T>(lhs ^ rhs);
+}
+
+/// @brief Applies the bitwise operation with vector instructions, on the largest prefix possible.
+/// @param dst the output blocks (it can alias lhs or rhs).
+/// @param lhs the first operand.
+/// @param rhs the second operand.
+/// @param size the number of blocks.
+/// @return the number of blocks which have been processed.
+template <bitwise_op Op, typename Block>
+inline std::size_t bitwise_vector(Block *dst, const Block *lhs, const Block *rhs, std::size_t size)
+{
+    // The operations do not depend on the size of the blocks, so the vectors are loaded as bytes.
+    unsigned char *d       = reinterpret_cast<unsigned char *>(dst);
+    const unsigned char *a = reinterpret_cast<const unsigned char *>(lhs);
+    const unsigned char *b = reinterpret_cast<const unsigned char *>(rhs);
+    std::size_t it         = 0;
+#if defined(__AVX512F__)
+    for (; it + 64 / sizeof(Block) <= size; it += 64 / sizeof(Block)) {
+        __m512i va = _mm512_loadu_si512(a + it * sizeof(Block)), vb = _mm512_loadu_si512(b + it * sizeof(Block)), vr;
+        if constexpr (Op == bitwise_op::op_and)
+            vr = _mm512_and_si512(va, vb);
+        else if constexpr (Op == bitwise_op::op_or)
+            vr = _mm512_or_si512(va, vb);
+        else
+            vr = _mm512_xor_si512(va, vb);
+        _mm512_storeu_si512(d + it * sizeof(Block), vr);
+    }
+#endif
+#if defined(__AVX2__)
+    for (; it + 32 / sizeof(Block) <= size; it += 32 / sizeof(Block)) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + it * sizeof(Block)));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + it * sizeof(Block))), vr;
+        if constexpr (Op == bitwise_op::op_and)
+            vr = _mm256_and_si256(va, vb);
+        else if constexpr (Op == bitwise_op::op_or)
+            vr = _mm256_or_si256(va, vb);
+        else
+            vr = _mm256_xor_si256(va, vb);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(d + it * sizeof(Block)), vr);
+    }
+#endif
+#if defined(BVLIB_SIMD_X86)
+    for (; it + 16 / sizeof(Block) <= size; it += 16 / sizeof(Block)) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + it * sizeof(Block)));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + it * sizeof(Block))), vr;
+        if constexpr (Op == bitwise_op::op_and)
+            vr = _mm_and_si128(va, vb);
+        else if constexpr (Op == bitwise_op::op_or)
+            vr = _mm_or_si128(va, vb);
+        else
+            vr = _mm_xor_si128(va, vb);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + it * sizeof(Block)), vr);
+    }
+#elif defined(BVLIB_SIMD_NEON)
+    for (; it + 16 / sizeof(Block) <= size; it += 16 / sizeof(Block)) {
+        uint8x16_t va = vld1q_u8(a + it * sizeof(Block)), vb = vld1q_u8(b + it * sizeof(Block)), vr;
+        if constexpr (Op == bitwise_op::op_and)
+            vr = vandq_u8(va, vb);
+        else if constexpr (Op == bitwise_op::op_or)
+            vr = vorrq_u8(va, vb);
+        else
+            vr = veorq_u8(va, vb);
+        vst1q_u8(d + it * sizeof(Block), vr);
+    }
+#endif
+#if !defined(BVLIB_SIMD_X86) && !defined(BVLIB_SIMD_NEON)
+    static_cast<void>(d), static_cast<void>(a), static_cast<void>(b), static_cast<void>(size);
+#endif
+    return it;
+}
+
+/// @brief Computes the bitwise negation with vector instructions, on the largest prefix possible.
+/// @param dst the output blocks (it can alias src).
+/// @param src the operand.
+/// @param size the number of blocks.
+/// @return the number of blocks which have been processed.
+template <typename Block>
+inline std::size_t bitwise_not_vector(Block *dst, const Block *src, std::size_t size)
+{
+    unsigned char *d       = reinterpret_cast<unsigned char *>(dst);
+    const unsigned char *a = reinterpret_cast<const unsigned char *>(src);
+    std::size_t it         = 0;
+#if defined(__AVX512F__)
+    const __m512i ones512 = _mm512_set1_epi32(-1);
+    for (; it + 64 / sizeof(Block) <= size; it += 64 / sizeof(Block))
+        _mm512_storeu_si512(d + it * sizeof(Block), _mm512_xor_si512(_mm512_loadu_si512(a + it * sizeof(Block)), ones512));
+#endif
+#if defined(__AVX2__)
+    const __m256i ones256 = _mm256_set1_epi32(-1);
+    for (; it + 32 / sizeof(Block) <= size; it += 32 / sizeof(Block))
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(d + it * sizeof(Block)), _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + it * sizeof(Block))), ones256));
+#endif
+#if defined(BVLIB_SIMD_X86)
+    const __m128i ones128 = _mm_set1_epi32(-1);
+    for (; it + 16 / sizeof(Block) <= size; it += 16 / sizeof(Block))
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + it * sizeof(Block)), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + it * sizeof(Block))), ones128));
+#elif defined(BVLIB_SIMD_NEON)
+    for (; it + 16 / sizeof(Block) <= size; it += 16 / sizeof(Block))
+        vst1q_u8(d + it * sizeof(Block), vmvnq_u8(vld1q_u8(a + it * sizeof(Block))));
+#endif
+#if !defined(BVLIB_SIMD_X86) && !defined(BVLIB_SIMD_NEON)
+    static_cast<void>(d), static_cast<void>(a), static_cast<void>(size);
+#endif
+    return it;
+}
+
+} // namespace detail
+
+/// @brief Applies the bitwise operation between lhs and rhs, block by block.
+/// @param dst the output blocks (it can alias lhs or rhs).
+/// @param lhs the first operand.
+/// @param rhs the second operand.
+/// @param size the number of blocks.
+template <bitwise_op Op, typename Block>
+constexpr inline void bitwise(Block *dst, const Block *lhs, const Block *rhs, std::size_t size)
+{
+    std::size_t it = 0;
+    if (!BVLIB_IS_CONSTANT_EVALUATED())
+        it = detail::bitwise_vector<Op>(dst, lhs, rhs, size);
+    for (; it < size; ++it)
+        dst[it] = detail::apply_scalar<Op>(lhs[it], rhs[it]);
+}
+
+/// @brief Computes the bitwise negation of src, block by block.
+/// @param dst the output blocks (it can alias src).
+/// @param src the operand.
+/// @param size the number of blocks.
+template <typename Block>
+constexpr inline void bitwise_not(Block *dst, const Block *src, std::size_t size)
+{
+    std::size_t it = 0;
+    if (!BVLIB_IS_CONSTANT_EVALUATED())
+        it = detail::bitwise_not_vector(dst, src, size);
+    for (; it < size; ++it)
+        dst[it] = static_cast<Block>(~src[it]);
+}
+
+} // namespace simd
+
+} // namespace bvlib
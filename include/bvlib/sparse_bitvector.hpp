@@ -0,0 +1,822 @@
+/// @file sparse_bitvector.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Compressed bitvector, for bitvectors which are mostly zeros.
+/// @details The bits are split into chunks of 2^16 bits, as in Roaring bitmaps
+/// ("Better bitmap performance with Roaring bitmaps", by S. Chambi, D. Lemire,
+/// O. Kaser and R. Godin). Chunks without ones are not stored, while the other
+/// ones are stored as a sorted array of positions, as a dense bitmap, or as
+/// runs of ones, whichever is the smallest. Thus, the memory and the time of
+/// the operations scale with the number of ones, and not with N.
+
+#pragma once
+
+#include "bitvector.hpp"
+#include "intrinsics.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace bvlib
+{
+
+template <std::size_t N>
+class SparseBitVector;
+
+namespace detail
+{
+
+template <simd::bitwise_op Op, std::size_t N>
+inline SparseBitVector<N> sparse_bitwise(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs);
+
+/// @brief A chunk of 2^16 bits of a SparseBitVector.
+class sparse_container {
+public:
+    /// @brief How the bits of the chunk are stored.
+    enum class encoding : std::uint8_t {
+        array,  ///< The sorted positions of the ones.
+        bitmap, ///< All the bits of the chunk.
+        run     ///< The first and the last position of each run of ones.
+    };
+
+    /// The number of bits of a chunk.
+    static constexpr std::size_t chunk_bits = 65536;
+
+    /// The number of 64-bit words of a chunk, once decoded.
+    static constexpr std::size_t chunk_words = chunk_bits / 64;
+
+    /// The largest number of ones stored as an array.
+    static constexpr std::size_t max_array = 4096;
+
+    /// The largest number of runs, whose 4 bytes each take as much as a bitmap.
+    static constexpr std::size_t max_runs = 2048;
+
+    /// @brief Builds an empty chunk.
+    sparse_container()
+        : _type(encoding::array),
+          _cardinality(0),
+          _values(),
+          _words()
+    {
+    }
+
+    /// @brief Builds the smallest encoding of the given positions.
+    /// @param values the positions of the ones, sorted and without duplicates.
+    static inline sparse_container from_values(std::vector<std::uint16_t> values)
+    {
+        sparse_container result;
+        std::size_t runs = values.empty() ? 0 : 1;
+        for (std::size_t it = 1; it < values.size(); ++it)
+            runs += (values[it] != values[it - 1] + 1U);
+        result._cardinality = values.size();
+        result._type        = choose(values.size(), runs);
+        if (result._type == encoding::array) {
+            result._values = std::move(values);
+        } else if (result._type == encoding::run) {
+            result._values.reserve(2 * runs);
+            for (std::size_t it = 0; it < values.size(); ++it) {
+                if ((it == 0) || (values[it] != values[it - 1] + 1U))
+                    result._values.push_back(values[it]);
+                if ((it + 1 == values.size()) || (values[it + 1] != values[it] + 1U))
+                    result._values.push_back(values[it]);
+            }
+        } else {
+            result._words.assign(chunk_words, 0);
+            for (std::uint16_t value : values)
+                result._words[value / 64U] |= std::uint64_t(1) << (value % 64U);
+        }
+        return result;
+    }
+
+    /// @brief Builds the smallest encoding of the given bits.
+    /// @param words the chunk_words words holding the bits.
+    static inline sparse_container from_words(const std::uint64_t *words)
+    {
+        sparse_container result;
+        std::size_t runs = 0;
+        for (std::size_t it = 0; it < chunk_words; ++it) {
+            const std::uint64_t previous = it ? (words[it - 1] >> 63U) : 0;
+            result._cardinality += bvlib::detail::popcount(words[it]);
+            runs += bvlib::detail::popcount(static_cast<std::uint64_t>(words[it] & ~((words[it] << 1U) | previous)));
+        }
+        result._type = choose(result._cardinality, runs);
+        if (result._type == encoding::array) {
+            result._values.reserve(result._cardinality);
+            for (std::size_t it = 0; it < chunk_words; ++it)
+                for (std::uint64_t word = words[it]; word; word &= word - 1U)
+                    result._values.push_back(static_cast<std::uint16_t>(it * 64 + bvlib::detail::countr_zero(word)));
+        } else if (result._type == encoding::run) {
+            result._values.reserve(2 * runs);
+            for (std::size_t first = next(words, 0, true), last; first < chunk_bits; first = next(words, last, true)) {
+                last = next(words, first, false);
+                result._values.push_back(static_cast<std::uint16_t>(first));
+                result._values.push_back(static_cast<std::uint16_t>(last - 1));
+            }
+        } else {
+            result._words.assign(words, words + chunk_words);
+        }
+        return result;
+    }
+
+    /// @brief Builds a chunk with the given number of ones, all at the bottom.
+    static inline sparse_container full(std::size_t size)
+    {
+        sparse_container result;
+        if (size) {
+            result._type        = encoding::run;
+            result._cardinality = size;
+            result._values      = { 0, static_cast<std::uint16_t>(size - 1) };
+        }
+        return result;
+    }
+
+    /// @brief Returns the current encoding.
+    inline encoding type() const
+    {
+        return _type;
+    }
+
+    /// @brief Returns the number of ones.
+    inline std::size_t cardinality() const
+    {
+        return _cardinality;
+    }
+
+    /// @brief Tests whether there are no ones.
+    inline bool empty() const
+    {
+        return _cardinality == 0;
+    }
+
+    /// @brief Returns the number of bytes used by the chunk.
+    inline std::size_t memory_usage() const
+    {
+        return sizeof(sparse_container) + _values.capacity() * sizeof(std::uint16_t) + _words.capacity() * sizeof(std::uint64_t);
+    }
+
+    /// @brief Tests the bit at the given position.
+    inline bool contains(std::uint16_t value) const
+    {
+        if (_type == encoding::array)
+            return std::binary_search(_values.begin(), _values.end(), value);
+        if (_type == encoding::bitmap)
+            return (_words[value / 64U] >> (value % 64U)) & 1U;
+        const std::size_t run = this->runs_before(value);
+        return run && (value <= _values[2 * run - 1]);
+    }
+
+    /// @brief Sets the bit at the given position.
+    /// @return true if the bit was not set.
+    inline bool insert(std::uint16_t value)
+    {
+        if (this->contains(value))
+            return false;
+        if (_type == encoding::array) {
+            if (_cardinality == max_array) {
+                this->to_bitmap();
+                return this->insert(value);
+            }
+            _values.insert(std::lower_bound(_values.begin(), _values.end(), value), value);
+        } else if (_type == encoding::bitmap) {
+            _words[value / 64U] |= std::uint64_t(1) << (value % 64U);
+        } else {
+            // Extend the neighbouring runs, merging them if they become adjacent.
+            const std::size_t run = this->runs_before(value), runs = _values.size() / 2;
+            const bool after_previous = run && (_values[2 * run - 1] + 1U == value);
+            const bool before_next    = (run < runs) && (value + 1U == _values[2 * run]);
+            if (after_previous && before_next) {
+                _values[2 * run - 1] = _values[2 * run + 1];
+                _values.erase(_values.begin() + static_cast<std::ptrdiff_t>(2 * run), _values.begin() + static_cast<std::ptrdiff_t>(2 * run + 2));
+            } else if (after_previous) {
+                _values[2 * run - 1] = value;
+            } else if (before_next) {
+                _values[2 * run] = value;
+            } else {
+                const std::uint16_t pair[2] = { value, value };
+                _values.insert(_values.begin() + static_cast<std::ptrdiff_t>(2 * run), pair, pair + 2);
+            }
+        }
+        ++_cardinality;
+        this->limit_runs();
+        return true;
+    }
+
+    /// @brief Clears the bit at the given position.
+    /// @return true if the bit was set.
+    inline bool erase(std::uint16_t value)
+    {
+        if (!this->contains(value))
+            return false;
+        if (_type == encoding::array) {
+            _values.erase(std::lower_bound(_values.begin(), _values.end(), value));
+        } else if (_type == encoding::bitmap) {
+            _words[value / 64U] &= ~(std::uint64_t(1) << (value % 64U));
+            if (_cardinality - 1 == max_array) {
+                // Small enough to be an array again, which also recounts the ones.
+                *this = from_words(_words.data());
+                return true;
+            }
+        } else {
+            // Shrink the run holding the bit, or split it in two.
+            const std::size_t run = this->runs_before(value) - 1;
+            std::uint16_t &first = _values[2 * run], &last = _values[2 * run + 1];
+            if (first == last) {
+                _values.erase(_values.begin() + static_cast<std::ptrdiff_t>(2 * run), _values.begin() + static_cast<std::ptrdiff_t>(2 * run + 2));
+            } else if (first == value) {
+                first = static_cast<std::uint16_t>(value + 1U);
+            } else if (last == value) {
+                last = static_cast<std::uint16_t>(value - 1U);
+            } else {
+                const std::uint16_t pair[2] = { static_cast<std::uint16_t>(value + 1U), last };
+                last                        = static_cast<std::uint16_t>(value - 1U);
+                _values.insert(_values.begin() + static_cast<std::ptrdiff_t>(2 * run + 2), pair, pair + 2);
+            }
+        }
+        --_cardinality;
+        this->limit_runs();
+        return true;
+    }
+
+    /// @brief Returns the position of the first one, the chunk must not be empty.
+    inline std::uint16_t front() const
+    {
+        if (_type != encoding::bitmap)
+            return _values.front();
+        std::size_t it = 0;
+        for (; !_words[it]; ++it) {}
+        return static_cast<std::uint16_t>(it * 64 + bvlib::detail::countr_zero(_words[it]));
+    }
+
+    /// @brief Returns the position of the last one, the chunk must not be empty.
+    inline std::uint16_t back() const
+    {
+        if (_type != encoding::bitmap)
+            return _values.back();
+        std::size_t it = chunk_words - 1;
+        for (; !_words[it]; --it) {}
+        return static_cast<std::uint16_t>(it * 64 + 63 - bvlib::detail::countl_zero(_words[it]));
+    }
+
+    /// @brief Calls the function with the position of each one, in increasing order.
+    template <typename Function>
+    inline void for_each(Function function) const
+    {
+        if (_type == encoding::array) {
+            for (std::uint16_t value : _values)
+                function(std::size_t(value));
+        } else if (_type == encoding::bitmap) {
+            for (std::size_t it = 0; it < chunk_words; ++it)
+                for (std::uint64_t word = _words[it]; word; word &= word - 1U)
+                    function(it * 64 + bvlib::detail::countr_zero(word));
+        } else {
+            for (std::size_t it = 0; it < _values.size(); it += 2)
+                for (std::size_t value = _values[it]; value <= _values[it + 1]; ++value)
+                    function(value);
+        }
+    }
+
+    /// @brief Decodes the bits.
+    /// @param words the chunk_words words where the bits are written.
+    inline void to_words(std::uint64_t *words) const
+    {
+        if (_type == encoding::bitmap) {
+            std::copy(_words.begin(), _words.end(), words);
+            return;
+        }
+        std::fill(words, words + chunk_words, std::uint64_t(0));
+        if (_type == encoding::array) {
+            for (std::uint16_t value : _values)
+                words[value / 64U] |= std::uint64_t(1) << (value % 64U);
+            return;
+        }
+        for (std::size_t it = 0; it < _values.size(); it += 2) {
+            const std::size_t first = _values[it], last = _values[it + 1];
+            for (std::size_t word = first / 64; word <= last / 64; ++word) {
+                std::uint64_t mask = ~std::uint64_t(0);
+                if (word == first / 64)
+                    mask &= mask << (first % 64);
+                if (word == last / 64)
+                    mask &= ~std::uint64_t(0) >> (63 - last % 64);
+                words[word] |= mask;
+            }
+        }
+    }
+
+    /// @brief Re-encodes the chunk with the smallest encoding.
+    inline void optimize()
+    {
+        std::vector<std::uint64_t> words(chunk_words);
+        this->to_words(words.data());
+        *this = from_words(words.data());
+    }
+
+    /// @brief Combines two chunks with a bitwise operation.
+    /// @details The intersection with an array only probes the other chunk for
+    /// the positions of the array, and the operations between two arrays merge
+    /// them, so they take time proportional to the number of ones.
+    template <simd::bitwise_op Op>
+    static inline sparse_container combine(const sparse_container &lhs, const sparse_container &rhs)
+    {
+        if ((lhs._type == encoding::array) && (rhs._type == encoding::array)) {
+            std::vector<std::uint16_t> values;
+            values.reserve((Op == simd::bitwise_op::op_and) ? std::min(lhs._cardinality, rhs._cardinality) : lhs._cardinality + rhs._cardinality);
+            if (Op == simd::bitwise_op::op_and)
+                std::set_intersection(lhs._values.begin(), lhs._values.end(), rhs._values.begin(), rhs._values.end(), std::back_inserter(values));
+            else if (Op == simd::bitwise_op::op_or)
+                std::set_union(lhs._values.begin(), lhs._values.end(), rhs._values.begin(), rhs._values.end(), std::back_inserter(values));
+            else
+                std::set_symmetric_difference(lhs._values.begin(), lhs._values.end(), rhs._values.begin(), rhs._values.end(), std::back_inserter(values));
+            return from_values(std::move(values));
+        }
+        if ((Op == simd::bitwise_op::op_and) && ((lhs._type == encoding::array) || (rhs._type == encoding::array))) {
+            const sparse_container &array = (lhs._type == encoding::array) ? lhs : rhs;
+            const sparse_container &other = (lhs._type == encoding::array) ? rhs : lhs;
+            std::vector<std::uint16_t> values;
+            values.reserve(array._cardinality);
+            for (std::uint16_t value : array._values)
+                if (other.contains(value))
+                    values.push_back(value);
+            return from_values(std::move(values));
+        }
+        std::vector<std::uint64_t> words(2 * chunk_words);
+        lhs.to_words(words.data());
+        rhs.to_words(words.data() + chunk_words);
+        bvlib::simd::bitwise<Op>(words.data(), words.data(), words.data() + chunk_words, chunk_words);
+        return from_words(words.data());
+    }
+
+    /// @brief Returns the complement of the first bits of the chunk.
+    /// @param size the number of bits to complement, all the bits above are zero.
+    inline sparse_container complement(std::size_t size) const
+    {
+        std::vector<std::uint64_t> words(chunk_words);
+        this->to_words(words.data());
+        bvlib::simd::bitwise_not(words.data(), words.data(), chunk_words);
+        for (std::size_t it = size / 64; it < chunk_words; ++it)
+            words[it] &= (it == size / 64) ? ((std::uint64_t(1) << (size % 64)) - 1U) : 0;
+        return from_words(words.data());
+    }
+
+    /// @brief Compares two chunks, regardless of their encoding.
+    friend inline bool operator==(const sparse_container &lhs, const sparse_container &rhs)
+    {
+        if (lhs._cardinality != rhs._cardinality)
+            return false;
+        if (lhs._type == rhs._type)
+            return (lhs._type == encoding::bitmap) ? (lhs._words == rhs._words) : (lhs._values == rhs._values);
+        std::vector<std::uint64_t> words(2 * chunk_words);
+        lhs.to_words(words.data());
+        rhs.to_words(words.data() + chunk_words);
+        return std::equal(words.begin(), words.begin() + chunk_words, words.begin() + chunk_words);
+    }
+
+private:
+    /// @brief Chooses the smallest encoding, given the number of ones and of runs.
+    static inline encoding choose(std::size_t cardinality, std::size_t runs)
+    {
+        if (4 * runs < std::min<std::size_t>(2 * cardinality, 2 * max_array))
+            return encoding::run;
+        return (cardinality <= max_array) ? encoding::array : encoding::bitmap;
+    }
+
+    /// @brief Finds the first bit with the given value, starting from the given position.
+    /// @return the position of the bit, or chunk_bits if there is none.
+    static inline std::size_t next(const std::uint64_t *words, std::size_t position, bool value)
+    {
+        for (std::size_t it = position / 64; it < chunk_words; ++it) {
+            std::uint64_t word = value ? words[it] : ~words[it];
+            if (it == position / 64)
+                word &= ~std::uint64_t(0) << (position % 64);
+            if (word)
+                return it * 64 + bvlib::detail::countr_zero(word);
+        }
+        return chunk_bits;
+    }
+
+    /// @brief Counts the runs starting at, or before, the given position.
+    inline std::size_t runs_before(std::uint16_t value) const
+    {
+        std::size_t low = 0, high = _values.size() / 2;
+        while (low < high) {
+            const std::size_t middle = (low + high) / 2;
+            if (_values[2 * middle] <= value)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+
+    /// @brief Re-encodes the chunk once it has too many runs, as an array or a bitmap.
+    inline void limit_runs()
+    {
+        if ((_type == encoding::run) && (_values.size() / 2 > max_runs))
+            this->optimize();
+    }
+
+    /// @brief Turns an array into a bitmap.
+    inline void to_bitmap()
+    {
+        _words.assign(chunk_words, 0);
+        this->to_words(_words.data());
+        _values.clear();
+        _values.shrink_to_fit();
+        _type = encoding::bitmap;
+    }
+
+    /// The encoding.
+    encoding _type;
+    /// The number of ones.
+    std::size_t _cardinality;
+    /// The positions of the ones (array), or the first and last position of each run (run).
+    std::vector<std::uint16_t> _values;
+    /// The bits (bitmap).
+    std::vector<std::uint64_t> _words;
+};
+
+} // namespace detail
+
+/// @brief Compressed bitvector of N bits.
+/// @tparam N the number of bits.
+template <std::size_t N>
+class SparseBitVector {
+public:
+    /// The type of the chunks.
+    using container_type = detail::sparse_container;
+
+    /// The number of bits of a chunk.
+    static constexpr std::size_t chunk_bits = container_type::chunk_bits;
+
+    /// The number of chunks.
+    static constexpr std::size_t num_chunks = (N + chunk_bits - 1) / chunk_bits;
+
+    /// The value returned by the search functions when no bit is found.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// @brief Builds a bitvector with all bits set to zero.
+    SparseBitVector()
+        : _keys(),
+          _containers()
+    {
+    }
+
+    /// @brief Compresses a dense bitvector.
+    template <typename Block>
+    explicit SparseBitVector(const BitVector<N, Block> &bitvector)
+        : _keys(),
+          _containers()
+    {
+        std::vector<std::uint16_t> values;
+        std::size_t key = 0;
+        for (std::size_t it = 0; it < BitVector<N, Block>::num_blocks; ++it) {
+            for (Block block = bitvector.data[it]; block; block = static_cast<Block>(block & (block - 1U))) {
+                const std::size_t position = it * BitVector<N, Block>::bits_per_block + bvlib::detail::countr_zero(block);
+                if (position / chunk_bits != key) {
+                    this->append(key, values);
+                    key = position / chunk_bits;
+                }
+                values.push_back(static_cast<std::uint16_t>(position % chunk_bits));
+            }
+        }
+        this->append(key, values);
+    }
+
+    /// @brief Decompresses the bitvector.
+    template <typename Block = std::uint64_t>
+    inline BitVector<N, Block> to_bitvector() const
+    {
+        BitVector<N, Block> result;
+        for (std::size_t it = 0; it < _keys.size(); ++it) {
+            const std::size_t base = _keys[it] * chunk_bits;
+            _containers[it].for_each([&result, base](std::size_t value) {
+                const std::size_t position = base + value;
+                result.data[position / BitVector<N, Block>::bits_per_block] |= static_cast<Block>(Block(1) << (position % BitVector<N, Block>::bits_per_block));
+            });
+        }
+        return result;
+    }
+
+    /// @brief Decompresses the bitvector.
+    template <typename Block>
+    explicit inline operator BitVector<N, Block>() const
+    {
+        return this->to_bitvector<Block>();
+    }
+
+    /// @brief Returns the size of the bitvector.
+    constexpr inline auto size() const -> std::size_t
+    {
+        return N;
+    }
+
+    /// @brief Returns the number of bits which are set.
+    inline auto count() const -> std::size_t
+    {
+        std::size_t result = 0;
+        for (const auto &container : _containers)
+            result += container.cardinality();
+        return result;
+    }
+
+    /// @brief Tests whether all the bits are on.
+    inline auto all() const -> bool
+    {
+        return this->count() == N;
+    }
+
+    /// @brief Tests whether any of the bits are on.
+    inline auto any() const -> bool
+    {
+        return !_keys.empty();
+    }
+
+    /// @brief Tests whether none of the bits are on.
+    inline auto none() const -> bool
+    {
+        return _keys.empty();
+    }
+
+    /// @brief Returns the position of the least significant bit which is set.
+    /// @return the position of the bit, or npos if no bit is set.
+    inline auto find_first() const -> std::size_t
+    {
+        return _keys.empty() ? npos : (_keys.front() * chunk_bits + _containers.front().front());
+    }
+
+    /// @brief Returns the position of the most significant bit which is set.
+    /// @return the position of the bit, or npos if no bit is set.
+    inline auto find_last() const -> std::size_t
+    {
+        return _keys.empty() ? npos : (_keys.back() * chunk_bits + _containers.back().back());
+    }
+
+    /// @brief Returns the number of bytes used by the bitvector.
+    inline std::size_t memory_usage() const
+    {
+        std::size_t result = sizeof(*this) + _keys.capacity() * sizeof(std::size_t);
+        for (const auto &container : _containers)
+            result += container.memory_usage();
+        return result + (_containers.capacity() - _containers.size()) * sizeof(container_type);
+    }
+
+    /// @brief Returns the indices of the chunks which have at least a bit set.
+    inline const std::vector<std::size_t> &keys() const
+    {
+        return _keys;
+    }
+
+    /// @brief Returns the chunks which have at least a bit set, in the order of keys().
+    inline const std::vector<container_type> &containers() const
+    {
+        return _containers;
+    }
+
+    /// @brief Re-encodes every chunk with the smallest encoding.
+    /// @details Single bit modifications leave an encoding only when it grows
+    /// larger than a bitmap, to an array or a bitmap, so a chunk which became a
+    /// few long runs is compressed only here.
+    inline SparseBitVector &optimize()
+    {
+        for (auto &container : _containers)
+            container.optimize();
+        return *this;
+    }
+
+    /// @brief Returns the bit at the given position.
+    inline bool at(std::size_t position) const
+    {
+        if (position >= N)
+            throw std::out_of_range("accessing values outside bitvector");
+        return this->test(position);
+    }
+
+    /// @brief Returns the bit at the given position, without checking it.
+    /// @details The position is only asserted, unless BVLIB_CHECKED is defined,
+    /// in which case it throws like at().
+    inline bool operator[](std::size_t position) const
+    {
+#if defined(BVLIB_CHECKED)
+        if (position >= N)
+            throw std::out_of_range("accessing values outside bitvector");
+#else
+        assert(position < N);
+#endif
+        return this->test(position);
+    }
+
+    /// @brief Returns the bit at the given position.
+    inline bool test(std::size_t position) const
+    {
+        const std::size_t index = this->find(position / chunk_bits);
+        return (index < _keys.size()) && (_keys[index] == position / chunk_bits) && _containers[index].contains(static_cast<std::uint16_t>(position % chunk_bits));
+    }
+
+    /// @brief Sets the bit at the given position to the given value.
+    inline SparseBitVector &set(std::size_t position, bool value = true)
+    {
+        assert(position < N);
+        if (!value)
+            return this->reset(position);
+        const std::size_t index = this->find(position / chunk_bits);
+        if ((index == _keys.size()) || (_keys[index] != position / chunk_bits)) {
+            _keys.insert(_keys.begin() + static_cast<std::ptrdiff_t>(index), position / chunk_bits);
+            _containers.insert(_containers.begin() + static_cast<std::ptrdiff_t>(index), container_type());
+        }
+        _containers[index].insert(static_cast<std::uint16_t>(position % chunk_bits));
+        return *this;
+    }
+
+    /// @brief Sets every bit to false.
+    inline SparseBitVector &reset()
+    {
+        _keys.clear();
+        _containers.clear();
+        return *this;
+    }
+
+    /// @brief Sets the bit at the given position to false.
+    inline SparseBitVector &reset(std::size_t position)
+    {
+        assert(position < N);
+        const std::size_t index = this->find(position / chunk_bits);
+        if ((index < _keys.size()) && (_keys[index] == position / chunk_bits)) {
+            _containers[index].erase(static_cast<std::uint16_t>(position % chunk_bits));
+            if (_containers[index].empty()) {
+                _keys.erase(_keys.begin() + static_cast<std::ptrdiff_t>(index));
+                _containers.erase(_containers.begin() + static_cast<std::ptrdiff_t>(index));
+            }
+        }
+        return *this;
+    }
+
+    /// @brief Flips the bit at the given position.
+    inline SparseBitVector &flip(std::size_t position)
+    {
+        return this->set(position, !this->test(position));
+    }
+
+    /// @brief Computes the bitwise and with another bitvector.
+    inline SparseBitVector &operator&=(const SparseBitVector &rhs)
+    {
+        return *this = detail::sparse_bitwise<simd::bitwise_op::op_and>(*this, rhs);
+    }
+
+    /// @brief Computes the bitwise or with another bitvector.
+    inline SparseBitVector &operator|=(const SparseBitVector &rhs)
+    {
+        return *this = detail::sparse_bitwise<simd::bitwise_op::op_or>(*this, rhs);
+    }
+
+    /// @brief Computes the bitwise xor with another bitvector.
+    inline SparseBitVector &operator^=(const SparseBitVector &rhs)
+    {
+        return *this = detail::sparse_bitwise<simd::bitwise_op::op_xor>(*this, rhs);
+    }
+
+    /// @brief Computes the bitwise not, turning the missing chunks into runs of ones.
+    friend inline SparseBitVector operator~(const SparseBitVector &bitvector)
+    {
+        SparseBitVector result;
+        for (std::size_t key = 0, it = 0; key < num_chunks; ++key) {
+            const std::size_t size = std::min(chunk_bits, N - key * chunk_bits);
+            const bool present     = (it < bitvector._keys.size()) && (bitvector._keys[it] == key);
+            container_type container(present ? bitvector._containers[it++].complement(size) : container_type::full(size));
+            if (!container.empty()) {
+                result._keys.push_back(key);
+                result._containers.push_back(std::move(container));
+            }
+        }
+        return result;
+    }
+
+    /// @brief Compares two bitvectors for equality.
+    friend inline bool operator==(const SparseBitVector &lhs, const SparseBitVector &rhs)
+    {
+        return (lhs._keys == rhs._keys) && (lhs._containers == rhs._containers);
+    }
+
+private:
+    template <simd::bitwise_op Op, std::size_t M>
+    friend SparseBitVector<M> detail::sparse_bitwise(const SparseBitVector<M> &lhs, const SparseBitVector<M> &rhs);
+
+    /// @brief Returns the index of the first chunk whose key is not smaller than the given one.
+    inline std::size_t find(std::size_t key) const
+    {
+        return static_cast<std::size_t>(std::lower_bound(_keys.begin(), _keys.end(), key) - _keys.begin());
+    }
+
+    /// @brief Appends a chunk, if there are positions, and clears them.
+    inline void append(std::size_t key, std::vector<std::uint16_t> &values)
+    {
+        if (!values.empty()) {
+            _keys.push_back(key);
+            _containers.push_back(container_type::from_values(std::move(values)));
+            values.clear();
+        }
+    }
+
+    /// The indices of the chunks with at least a bit set, sorted.
+    std::vector<std::size_t> _keys;
+    /// The chunks with at least a bit set.
+    std::vector<container_type> _containers;
+};
+
+namespace detail
+{
+
+/// @brief Combines two sparse bitvectors chunk by chunk.
+template <simd::bitwise_op Op, std::size_t N>
+inline SparseBitVector<N> sparse_bitwise(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs)
+{
+    SparseBitVector<N> result;
+    const std::size_t lsize = lhs._keys.size(), rsize = rhs._keys.size();
+    for (std::size_t l = 0, r = 0; (l < lsize) || (r < rsize);) {
+        // A chunk missing from one side is all zeros, so it is copied, unless this is an and.
+        if ((r == rsize) || ((l < lsize) && (lhs._keys[l] < rhs._keys[r]))) {
+            if (Op != simd::bitwise_op::op_and) {
+                result._keys.push_back(lhs._keys[l]);
+                result._containers.push_back(lhs._containers[l]);
+            }
+            ++l;
+        } else if ((l == lsize) || (rhs._keys[r] < lhs._keys[l])) {
+            if (Op != simd::bitwise_op::op_and) {
+                result._keys.push_back(rhs._keys[r]);
+                result._containers.push_back(rhs._containers[r]);
+            }
+            ++r;
+        } else {
+            auto container = detail::sparse_container::combine<Op>(lhs._containers[l], rhs._containers[r]);
+            if (!container.empty()) {
+                result._keys.push_back(lhs._keys[l]);
+                result._containers.push_back(std::move(container));
+            }
+            ++l, ++r;
+        }
+    }
+    return result;
+}
+
+} // namespace detail
+
+/// @brief Computes the bitwise and of two bitvectors.
+template <std::size_t N>
+inline SparseBitVector<N> operator&(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs)
+{
+    return detail::sparse_bitwise<simd::bitwise_op::op_and>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise or of two bitvectors.
+template <std::size_t N>
+inline SparseBitVector<N> operator|(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs)
+{
+    return detail::sparse_bitwise<simd::bitwise_op::op_or>(lhs, rhs);
+}
+
+/// @brief Computes the bitwise xor of two bitvectors.
+template <std::size_t N>
+inline SparseBitVector<N> operator^(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs)
+{
+    return detail::sparse_bitwise<simd::bitwise_op::op_xor>(lhs, rhs);
+}
+
+/// @brief Compares two bitvectors for inequality.
+template <std::size_t N>
+inline bool operator!=(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs)
+{
+    return !(lhs == rhs);
+}
+
+/// @brief Compares two bitvectors as unsigned numbers.
+/// @details The result is decided by the most significant bit where they differ.
+template <std::size_t N>
+inline bool operator<(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs)
+{
+    const std::size_t position = (lhs ^ rhs).find_last();
+    return (position != SparseBitVector<N>::npos) && rhs.test(position);
+}
+
+/// @brief Compares two bitvectors as unsigned numbers.
+template <std::size_t N>
+inline bool operator>(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs)
+{
+    return rhs < lhs;
+}
+
+/// @brief Compares two bitvectors as unsigned numbers.
+template <std::size_t N>
+inline bool operator<=(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs)
+{
+    return !(rhs < lhs);
+}
+
+/// @brief Compares two bitvectors as unsigned numbers.
+template <std::size_t N>
+inline bool operator>=(const SparseBitVector<N> &lhs, const SparseBitVector<N> &rhs)
+{
+    return !(lhs < rhs);
+}
+
+} // namespace bvlib
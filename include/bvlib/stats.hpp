@@ -0,0 +1,447 @@
+/// @file stats.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Opt-in instrumentation of the operations of the bitvectors.
+/// @details When BVLIB_INSTRUMENT is defined before including the library,
+/// every operation counts its calls and the cycles it takes (with rdtsc on
+/// x86-64, in nanoseconds otherwise), for each width, together with the
+/// bitvectors it returns (the temporaries) and the operands which are
+/// promoted to a wider bitvector. The operations are the arithmetic, bitwise,
+/// shift and comparison operators of BitVector and DynamicBitVector, with
+/// their compound assignments, and the divisions of Divider; the ones of
+/// DynamicBitVector are named with a "dynamic_" prefix. The other modules are
+/// counted only through the operators they call, so the ones working directly
+/// on the blocks, like modular.hpp and polynomial.hpp, are not counted. Each
+/// thread has its own counters, which are merged when the thread exits, so
+/// the operations never share cache lines. The results are read with
+/// snapshot() and printed with dump(). Nothing is recorded during constant
+/// evaluation, nor with compilers which cannot tell when it happens (see
+/// BVLIB_IS_CONSTANT_EVALUATED). Without BVLIB_INSTRUMENT the macros expand to
+/// nothing, and the functions return empty results.
+
+#pragma once
+
+#include "intrinsics.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#if defined(BVLIB_INSTRUMENT)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <tuple>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BVLIB_INSTRUMENT_RDTSC
+#endif
+
+/// @brief The number of counters of each thread, i.e., of different pairs of
+/// operation and width. It can be tuned by defining it before including this
+/// header, and the pairs beyond it are counted together as "overflow".
+#ifndef BVLIB_INSTRUMENT_MAX_SITES
+#define BVLIB_INSTRUMENT_MAX_SITES 1024
+#endif
+#endif
+
+namespace bvlib
+{
+
+namespace stats
+{
+
+/// @brief What a counter counts.
+enum class kind {
+    operation, ///< The calls of an operation, and their cycles.
+    temporary, ///< The bitvectors returned by value.
+    promotion  ///< The operands extended to the width of the widest one.
+};
+
+/// @brief The counter of an operation, or of the temporaries or the promotions, of a given width.
+struct entry {
+    /// What the entry counts.
+    bvlib::stats::kind kind;
+    /// The name of the operation.
+    std::string name;
+    /// The width of the operation, of the temporaries, or of the promoted operands.
+    std::size_t width;
+    /// The width of the operands before the promotion, zero otherwise.
+    std::size_t from;
+    /// The number of calls, of temporaries, or of promotions.
+    std::uint64_t count;
+    /// The cycles (or nanoseconds) taken by the calls of an operation, zero otherwise.
+    std::uint64_t cycles;
+};
+
+#if defined(BVLIB_INSTRUMENT)
+
+namespace detail
+{
+
+/// @brief Returns the identifier of a name, with FNV-1a.
+constexpr inline std::uint64_t name_id(const char *name)
+{
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (; *name; ++name)
+        hash = (hash ^ static_cast<unsigned char>(*name)) * 0x100000001B3ULL;
+    return hash;
+}
+
+/// @brief Returns the current time, in cycles or in nanoseconds.
+inline std::uint64_t now()
+{
+#if defined(BVLIB_INSTRUMENT_RDTSC)
+    return static_cast<std::uint64_t>(__rdtsc());
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/// @brief A place where a counter is updated, with the index of its counter once it is known.
+struct site_t {
+    /// The index of the counter, or the capacity while unknown.
+    std::atomic<std::size_t> index;
+
+    constexpr site_t()
+        : index(BVLIB_INSTRUMENT_MAX_SITES)
+    {
+    }
+};
+
+/// @brief The site of each counter, identified by its name, width and original width.
+template <std::uint64_t Id, std::size_t Width, std::size_t From>
+inline site_t site_instance;
+
+/// @brief A counter, written only by its thread, and read by any thread.
+struct counter_t {
+    /// The number of calls.
+    std::atomic<std::uint64_t> count{ 0 };
+    /// The cycles of the calls.
+    std::atomic<std::uint64_t> cycles{ 0 };
+
+    /// @brief Adds to the counter, with plain loads and stores since there is only one writer.
+    inline void add(std::uint64_t calls, std::uint64_t time)
+    {
+        count.store(count.load(std::memory_order_relaxed) + calls, std::memory_order_relaxed);
+        cycles.store(cycles.load(std::memory_order_relaxed) + time, std::memory_order_relaxed);
+    }
+};
+
+/// @brief The counters of a thread.
+struct thread_counters_t;
+
+/// @brief The sites, the counters of the running threads, and the totals of the ones which exited.
+class registry_t {
+public:
+    registry_t()
+        : _mutex(),
+          _sites(),
+          _indices(),
+          _threads(),
+          _retired(BVLIB_INSTRUMENT_MAX_SITES)
+    {
+        // The first counter collects the sites which do not fit.
+        _sites.push_back(entry{ kind::operation, "overflow", 0, 0, 0, 0 });
+    }
+
+    /// @brief Returns the index of the counter of the site, adding it the first time.
+    inline std::size_t index(site_t &site, kind what, const char *name, std::size_t width, std::size_t from)
+    {
+        std::size_t index = site.index.load(std::memory_order_acquire);
+        if (index < BVLIB_INSTRUMENT_MAX_SITES)
+            return index;
+        std::lock_guard<std::mutex> lock(_mutex);
+        index = site.index.load(std::memory_order_relaxed);
+        if (index == BVLIB_INSTRUMENT_MAX_SITES) {
+            index = this->find(what, name, width, from);
+            site.index.store(index, std::memory_order_release);
+        }
+        return index;
+    }
+
+    /// @brief Returns the index of the counter with the given kind, name and widths, adding it the first time.
+    inline std::size_t index(kind what, const char *name, std::size_t width, std::size_t from)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return this->find(what, name, width, from);
+    }
+
+    /// @brief Adds the counters of a thread.
+    inline void attach(thread_counters_t *counters)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _threads.push_back(counters);
+    }
+
+    /// @brief Removes the counters of a thread, adding them to the totals.
+    inline void detach(thread_counters_t *counters);
+
+    /// @brief Returns the sum of the counters of all the threads.
+    inline std::vector<entry> snapshot();
+
+    /// @brief Clears the counters of all the threads.
+    inline void reset();
+
+private:
+    /// @brief Returns the index of the counter, adding it if there is room, with the mutex locked.
+    inline std::size_t find(kind what, const char *name, std::size_t width, std::size_t from)
+    {
+        const auto key = std::make_tuple(what, std::string(name), width, from);
+        const auto it  = _indices.find(key);
+        if (it != _indices.end())
+            return it->second;
+        if (_sites.size() == BVLIB_INSTRUMENT_MAX_SITES)
+            return 0;
+        _sites.push_back(entry{ what, name, width, from, 0, 0 });
+        return _indices[key] = _sites.size() - 1;
+    }
+
+    /// Protects the sites and the threads.
+    std::mutex _mutex;
+    /// The sites, with their names and widths.
+    std::vector<entry> _sites;
+    /// The index of each site, so that the same counter is found from any place.
+    std::map<std::tuple<kind, std::string, std::size_t, std::size_t>, std::size_t> _indices;
+    /// The counters of the running threads.
+    std::vector<thread_counters_t *> _threads;
+    /// The totals of the threads which exited.
+    std::vector<counter_t> _retired;
+};
+
+/// @brief Returns the registry.
+inline registry_t &registry()
+{
+    static registry_t instance;
+    return instance;
+}
+
+struct thread_counters_t {
+    /// The counters, indexed by site.
+    std::unique_ptr<counter_t[]> counters;
+    /// The index of the sites whose width is known only at runtime, already found by this thread.
+    std::map<std::tuple<const char *, kind, std::size_t, std::size_t>, std::size_t> dynamic_sites;
+
+    thread_counters_t()
+        : counters(new counter_t[BVLIB_INSTRUMENT_MAX_SITES]),
+          dynamic_sites()
+    {
+        bvlib::stats::detail::registry().attach(this);
+    }
+
+    ~thread_counters_t()
+    {
+        bvlib::stats::detail::registry().detach(this);
+    }
+};
+
+inline void registry_t::detach(thread_counters_t *counters)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _threads.erase(std::remove(_threads.begin(), _threads.end(), counters), _threads.end());
+    for (std::size_t it = 0; it < BVLIB_INSTRUMENT_MAX_SITES; ++it)
+        _retired[it].add(counters->counters[it].count.load(std::memory_order_relaxed), counters->counters[it].cycles.load(std::memory_order_relaxed));
+}
+
+inline std::vector<entry> registry_t::snapshot()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<entry> result(_sites);
+    for (std::size_t it = 0; it < result.size(); ++it) {
+        result[it].count  = _retired[it].count.load(std::memory_order_relaxed);
+        result[it].cycles = _retired[it].cycles.load(std::memory_order_relaxed);
+        for (const thread_counters_t *thread : _threads) {
+            result[it].count += thread->counters[it].count.load(std::memory_order_relaxed);
+            result[it].cycles += thread->counters[it].cycles.load(std::memory_order_relaxed);
+        }
+    }
+    // The sites which were never used, like the overflow, are left out.
+    result.erase(std::remove_if(result.begin(), result.end(), [](const entry &e) { return e.count == 0; }), result.end());
+    std::sort(result.begin(), result.end(), [](const entry &lhs, const entry &rhs) {
+        return std::tie(lhs.kind, lhs.name, lhs.width, lhs.from) < std::tie(rhs.kind, rhs.name, rhs.width, rhs.from);
+    });
+    return result;
+}
+
+inline void registry_t::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    // The other threads might be updating their counters, which is only a benign race.
+    for (std::size_t it = 0; it < BVLIB_INSTRUMENT_MAX_SITES; ++it) {
+        _retired[it].count.store(0, std::memory_order_relaxed);
+        _retired[it].cycles.store(0, std::memory_order_relaxed);
+        for (thread_counters_t *thread : _threads) {
+            thread->counters[it].count.store(0, std::memory_order_relaxed);
+            thread->counters[it].cycles.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+/// @brief Returns the counters of the calling thread.
+inline thread_counters_t &thread_counters()
+{
+    thread_local thread_counters_t counters;
+    return counters;
+}
+
+/// @brief Updates the counter of a site.
+inline void record(site_t &site, kind what, const char *name, std::size_t width, std::size_t from, std::uint64_t time)
+{
+    const std::size_t index = bvlib::stats::detail::registry().index(site, what, name, width, from);
+    bvlib::stats::detail::thread_counters().counters[index].add(1, time);
+}
+
+/// @brief Updates the counter of a site whose width is known only at runtime.
+inline void record_dynamic(kind what, const char *name, std::size_t width, std::size_t from, std::uint64_t time)
+{
+    thread_counters_t &counters = bvlib::stats::detail::thread_counters();
+    const auto key              = std::make_tuple(name, what, width, from);
+    auto it                     = counters.dynamic_sites.find(key);
+    if (it == counters.dynamic_sites.end())
+        it = counters.dynamic_sites.emplace(key, bvlib::stats::detail::registry().index(what, name, width, from)).first;
+    counters.counters[it->second].add(1, time);
+}
+
+/// @brief Records the given number of temporaries, whose width is known only at runtime.
+inline void record_dynamic_temporary(std::size_t width, std::size_t count)
+{
+    for (std::size_t it = 0; it < count; ++it)
+        bvlib::stats::detail::record_dynamic(kind::temporary, "dynamic_temporary", width, 0, 0);
+}
+
+/// @brief Records the promotion of the narrowest operand, if the two widths, known only at runtime, differ.
+inline void record_dynamic_promotion(std::size_t lhs, std::size_t rhs)
+{
+    if (lhs != rhs)
+        bvlib::stats::detail::record_dynamic(kind::promotion, "dynamic_promotion", std::max(lhs, rhs), std::min(lhs, rhs), 0);
+}
+
+/// @brief Returns the time at which an operation starts.
+constexpr inline std::uint64_t start()
+{
+    return BVLIB_IS_CONSTANT_EVALUATED() ? 0 : bvlib::stats::detail::now();
+}
+
+/// @brief Records a call of an operation, which started at the given time.
+template <std::uint64_t Id, std::size_t Width>
+constexpr inline void record_operation(const char *name, std::uint64_t start)
+{
+    if (!BVLIB_IS_CONSTANT_EVALUATED())
+        bvlib::stats::detail::record(site_instance<Id, Width, 0>, kind::operation, name, Width, 0, bvlib::stats::detail::now() - start);
+}
+
+/// @brief Records the given number of temporaries.
+template <std::size_t Width>
+constexpr inline void record_temporary(std::size_t count)
+{
+    if (!BVLIB_IS_CONSTANT_EVALUATED()) {
+        for (std::size_t it = 0; it < count; ++it)
+            bvlib::stats::detail::record(site_instance<bvlib::stats::detail::name_id("temporary"), Width, 0>, kind::temporary, "temporary", Width, 0, 0);
+    }
+}
+
+/// @brief Records the promotion of the narrowest operand, if the two widths differ.
+template <std::size_t N1, std::size_t N2>
+constexpr inline void record_promotion()
+{
+    if constexpr (N1 != N2) {
+        constexpr std::size_t from = (N1 < N2) ? N1 : N2, to = (N1 < N2) ? N2 : N1;
+        if (!BVLIB_IS_CONSTANT_EVALUATED())
+            bvlib::stats::detail::record(site_instance<bvlib::stats::detail::name_id("promotion"), to, from>, kind::promotion, "promotion", to, from, 0);
+    }
+}
+
+} // namespace detail
+
+/// @brief Returns the counters of all the threads, sorted by kind, name and width.
+/// @details The counters of the running threads are read while they might
+/// be changing, so they are only exact once the operations are over.
+inline std::vector<entry> snapshot()
+{
+    return bvlib::stats::detail::registry().snapshot();
+}
+
+/// @brief Clears the counters of all the threads.
+inline void reset()
+{
+    bvlib::stats::detail::registry().reset();
+}
+
+/// @brief Prints the counters of all the threads.
+inline void dump(std::ostream &stream)
+{
+#if defined(BVLIB_INSTRUMENT_RDTSC)
+    const char *unit = "cycles";
+#else
+    const char *unit = "ns";
+#endif
+    stream << std::left << std::setw(24) << "operation" << std::right << std::setw(12) << "width" << std::setw(16) << "calls" << std::setw(20) << unit << std::setw(14) << "per call" << "\n";
+    for (const entry &e : bvlib::stats::snapshot()) {
+        if (e.kind == kind::operation) {
+            stream << std::left << std::setw(24) << e.name << std::right << std::setw(12) << e.width << std::setw(16) << e.count << std::setw(20) << e.cycles << std::setw(14)
+                   << std::fixed << std::setprecision(1) << (static_cast<double>(e.cycles) / static_cast<double>(e.count)) << "\n";
+        } else if (e.kind == kind::temporary) {
+            stream << std::left << std::setw(24) << e.name << std::right << std::setw(12) << e.width << std::setw(16) << e.count << "\n";
+        } else {
+            stream << std::left << std::setw(24) << e.name << std::right << std::setw(12) << (std::to_string(e.from) + "->" + std::to_string(e.width)) << std::setw(16) << e.count << "\n";
+        }
+    }
+}
+
+#else
+
+/// @brief Returns the counters, which are all empty without BVLIB_INSTRUMENT.
+inline std::vector<entry> snapshot()
+{
+    return std::vector<entry>();
+}
+
+/// @brief Clears the counters, which does nothing without BVLIB_INSTRUMENT.
+inline void reset()
+{
+}
+
+/// @brief Prints the counters, which does nothing without BVLIB_INSTRUMENT.
+inline void dump(std::ostream &)
+{
+}
+
+#endif
+
+} // namespace stats
+
+} // namespace bvlib
+
+#if defined(BVLIB_INSTRUMENT)
+/// @brief Starts timing an operation, it must come before BVLIB_INSTRUMENT_END.
+/// @details The variable is not const, otherwise its initializer would be
+/// constant evaluated, and would not read the clock.
+#define BVLIB_INSTRUMENT_BEGIN() std::uint64_t bvlib_instrument_start = bvlib::stats::detail::start()
+/// @brief Records a call of the operation with the given name and width.
+#define BVLIB_INSTRUMENT_END(name, width) bvlib::stats::detail::record_operation<bvlib::stats::detail::name_id(name), (width)>(name, bvlib_instrument_start)
+/// @brief Records the given number of temporaries of the given width.
+#define BVLIB_INSTRUMENT_TEMPORARY(width, count) bvlib::stats::detail::record_temporary<(width)>(count)
+/// @brief Records a promotion, if the widths of the two operands differ.
+#define BVLIB_INSTRUMENT_PROMOTION(lhs_width, rhs_width) bvlib::stats::detail::record_promotion<(lhs_width), (rhs_width)>()
+/// @brief Records a call of the operation with the given name and the given width, known only at runtime.
+#define BVLIB_INSTRUMENT_DYNAMIC_END(name, width) \
+    bvlib::stats::detail::record_dynamic(bvlib::stats::kind::operation, name, (width), 0, bvlib::stats::detail::now() - bvlib_instrument_start)
+/// @brief Records the given number of temporaries of the given width, known only at runtime.
+#define BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(width, count) bvlib::stats::detail::record_dynamic_temporary((width), (count))
+/// @brief Records a promotion, if the widths of the two operands, known only at runtime, differ.
+#define BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs_width, rhs_width) bvlib::stats::detail::record_dynamic_promotion((lhs_width), (rhs_width))
+#else
+#define BVLIB_INSTRUMENT_BEGIN() static_cast<void>(0)
+#define BVLIB_INSTRUMENT_END(name, width) static_cast<void>(0)
+#define BVLIB_INSTRUMENT_TEMPORARY(width, count) static_cast<void>(0)
+#define BVLIB_INSTRUMENT_PROMOTION(lhs_width, rhs_width) static_cast<void>(0)
+#define BVLIB_INSTRUMENT_DYNAMIC_END(name, width) static_cast<void>(0)
+#define BVLIB_INSTRUMENT_DYNAMIC_TEMPORARY(width, count) static_cast<void>(0)
+#define BVLIB_INSTRUMENT_DYNAMIC_PROMOTION(lhs_width, rhs_width) static_cast<void>(0)
+#endif
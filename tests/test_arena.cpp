@@ -0,0 +1,98 @@
+#include "bvlib/dynamic_bitvector.hpp"
+#include "bvlib/arena.hpp"
+
+#include <iostream>
+
+int test_arena()
+{
+    bvlib::Arena arena(256);
+    if ((arena.capacity() != 0) || (arena.used() != 0)) {
+        std::cerr << "A new arena must be empty\n";
+        return 1;
+    }
+    auto *first = arena.allocate<std::uint64_t>(4);
+    auto mark   = arena.mark();
+    auto *bytes = arena.allocate<unsigned char>(3);
+    auto *last  = arena.allocate<std::uint64_t>(2);
+    if ((reinterpret_cast<std::uintptr_t>(last) % alignof(std::uint64_t)) || (last <= first + 3) || (static_cast<void *>(bytes) >= static_cast<void *>(last))) {
+        std::cerr << "Wrong layout of the allocations\n";
+        return 1;
+    }
+    // Going back to a mark gives back the same memory.
+    arena.release(mark);
+    if (arena.allocate<unsigned char>(3) != bytes) {
+        std::cerr << "The memory after the mark was not reused\n";
+        return 1;
+    }
+    // Allocations larger than a chunk get their own chunk.
+    arena.allocate(1000);
+    if ((arena.capacity() < 1256) || (arena.used() < 1000)) {
+        std::cerr << "Wrong growth: " << arena.capacity() << " bytes owned, " << arena.used() << " used\n";
+        return 1;
+    }
+    // Chunks are kept after a reset, and reused.
+    const std::size_t capacity = arena.capacity();
+    for (int run = 0; run < 10; ++run) {
+        arena.reset();
+        arena.allocate(200);
+        arena.allocate(1000);
+    }
+    if ((arena.capacity() != capacity) || (arena.allocate<std::uint64_t>(1) == nullptr)) {
+        std::cerr << "The chunks were not reused: " << arena.capacity() << " bytes owned instead of " << capacity << "\n";
+        return 1;
+    }
+    {
+        bvlib::ArenaScope scope(arena);
+        arena.allocate(100);
+    }
+    if (arena.used() > capacity) {
+        std::cerr << "The scope did not release its memory\n";
+        return 1;
+    }
+    return 0;
+}
+
+int test_temporaries()
+{
+    // The intermediate values of the arithmetic are released when it returns.
+    bvlib::Arena &arena = bvlib::thread_arena();
+    const bvlib::DynamicBitVector<> lhs(1000, 123456789), rhs(1000, 1234);
+    const std::size_t used = arena.used();
+    auto product           = lhs * rhs;
+    auto quotient          = product / rhs;
+    if ((quotient != lhs) || (arena.used() != used)) {
+        std::cerr << "Wrong arithmetic, or leaked " << (arena.used() - used) << " bytes of the arena\n";
+        return 1;
+    }
+    // Once the arena is large enough, a whole step runs without growing it.
+    std::size_t capacity = 0;
+    for (int step = 0; step < 4; ++step) {
+        bvlib::ArenaScope scope;
+        bvlib::ArenaBitVector<> a(1000, 123456789), b(1000, 1234);
+        auto c = (a * b + a) / b - a;
+        if (c != 100046U) {
+            std::cerr << "Wrong arithmetic on the arena: " << c.to_string() << "\n";
+            return 1;
+        }
+        if (step == 1)
+            capacity = arena.capacity();
+        else if ((step > 1) && (arena.capacity() != capacity)) {
+            std::cerr << "The arena grew at step " << step << "\n";
+            return 1;
+        }
+    }
+    if (arena.used() != used) {
+        std::cerr << "The scope did not release the bitvectors\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_arena())
+        return 1;
+    if (test_temporaries())
+        return 1;
+    return 0;
+}
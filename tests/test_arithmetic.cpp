@@ -0,0 +1,253 @@
+// Use a small threshold, so that Karatsuba recurses several times on the tested widths.
+#define BVLIB_KARATSUBA_THRESHOLD 4
+
+#include "bvlib/bitvector.hpp"
+#include "bvlib/math.hpp"
+#include "bvlib/io.hpp"
+
+#include <iomanip>
+#include <vector>
+#include <random>
+
+/// @brief Generates a random bitvector, with random runs of ones and zeros to stress the carries.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 3);
+    bvlib::BitVector<N, Block> result;
+    const int mode = distr(gen);
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = (mode == 0) ? true : (mode == 1) ? (it % 7) != 0 : (distr(gen) != 0);
+    return result;
+}
+
+/// @brief Bit-serial reference implementation of the sum.
+template <std::size_t N1, std::size_t N2, typename Block>
+bvlib::BitVector<std::max(N1, N2), Block> reference_sum(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    bvlib::BitVector<std::max(N1, N2), Block> result;
+    bool carry = false;
+    for (std::size_t it = 0; it < result.size(); ++it)
+        result[it] = bvlib::add_bits((it < N1) ? lhs[it] : false, (it < N2) ? rhs[it] : false, carry);
+    return result;
+}
+
+/// @brief Bit-serial reference implementation of the difference.
+template <std::size_t N1, std::size_t N2, typename Block>
+bvlib::BitVector<std::max(N1, N2), Block> reference_sub(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    bvlib::BitVector<std::max(N1, N2), Block> result;
+    bool borrow = false;
+    for (std::size_t it = 0; it < result.size(); ++it)
+        result[it] = bvlib::sub_bits((it < N1) ? lhs[it] : false, (it < N2) ? rhs[it] : false, borrow);
+    return result;
+}
+
+/// @brief Shift-and-add reference implementation of the product.
+template <std::size_t N1, std::size_t N2, typename Block>
+bvlib::BitVector<std::max(N1, N2) * 2, Block> reference_mul(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    bvlib::BitVector<std::max(N1, N2) * 2, Block> result, addend(lhs);
+    for (std::size_t it = 0; it < N2; ++it, addend <<= 1)
+        if (rhs[it])
+            result += addend;
+    return result;
+}
+
+template <std::size_t N1, std::size_t N2, typename Block, std::size_t QT>
+int test_add_sub()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    for (std::size_t run = 0; run < QT; ++run) {
+        auto lhs = random_bitvector<N1, Block>(gen);
+        auto rhs = random_bitvector<N2, Block>(gen);
+        if ((lhs + rhs) != reference_sum(lhs, rhs)) {
+            std::cerr << lhs.to_string() << " + " << rhs.to_string() << " = " << (lhs + rhs).to_string() << " (" << N1 << "&" << N2 << " bits) != \n";
+            std::cerr << reference_sum(lhs, rhs).to_string() << "\n\n";
+            return 1;
+        }
+        if ((lhs - rhs) != reference_sub(lhs, rhs)) {
+            std::cerr << lhs.to_string() << " - " << rhs.to_string() << " = " << (lhs - rhs).to_string() << " (" << N1 << "&" << N2 << " bits) != \n";
+            std::cerr << reference_sub(lhs, rhs).to_string() << "\n\n";
+            return 1;
+        }
+        // Compound operators must match the binary ones.
+        bvlib::BitVector<std::max(N1, N2), Block> acc(lhs);
+        acc += rhs;
+        if (acc != (lhs + rhs)) {
+            std::cerr << "Wrong += for " << lhs.to_string() << " and " << rhs.to_string() << "\n";
+            return 1;
+        }
+        acc -= rhs;
+        if (acc != lhs) {
+            std::cerr << "Wrong -= for " << lhs.to_string() << " and " << rhs.to_string() << "\n";
+            return 1;
+        }
+        // The two-complement is the additive inverse.
+        auto neg = lhs;
+        neg.two_complement();
+        if ((neg + lhs).any()) {
+            std::cerr << "Wrong two-complement for " << lhs.to_string() << ": " << neg.to_string() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template <std::size_t N1, std::size_t N2, typename Block, std::size_t QT>
+int test_mul()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    for (std::size_t run = 0; run < QT; ++run) {
+        auto lhs = random_bitvector<N1, Block>(gen);
+        auto rhs = random_bitvector<N2, Block>(gen);
+        // Also test operands with only a few significant blocks.
+        if (run % 4 == 3)
+            lhs = bvlib::BitVector<N1, Block>(bvlib::BitVector<N1 / 3 + 1, Block>(lhs));
+        if ((lhs * rhs) != reference_mul(lhs, rhs)) {
+            std::cerr << lhs.to_string() << " * " << rhs.to_string() << " = " << (lhs * rhs).to_string() << " (" << N1 << "&" << N2 << " bits) != \n";
+            std::cerr << reference_mul(lhs, rhs).to_string() << "\n\n";
+            return 1;
+        }
+        if ((rhs * lhs) != (lhs * rhs)) {
+            std::cerr << "The product is not commutative for " << lhs.to_string() << " and " << rhs.to_string() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template <std::size_t N1, std::size_t N2, typename Block, std::size_t QT>
+int test_div()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    for (std::size_t run = 0; run < QT; ++run) {
+        auto lhs = random_bitvector<N1, Block>(gen);
+        auto rhs = random_bitvector<N2, Block>(gen);
+        // Also test divisors with only a few significant blocks, down to a single bit.
+        if (run % 4 == 1)
+            rhs = bvlib::BitVector<N2, Block>(bvlib::BitVector<N2 / 3 + 1, Block>(rhs));
+        if (run % 4 == 2)
+            rhs = bvlib::BitVector<N2, Block>(bvlib::BitVector<(N2 > 70) ? 70 : N2, Block>(rhs));
+        if (run % 8 == 3)
+            rhs = bvlib::BitVector<N2, Block>(1U);
+        if (rhs.none())
+            rhs = bvlib::BitVector<N2, Block>(3U);
+        auto result = bvlib::div(lhs, rhs);
+        // The quotient and the remainder must satisfy lhs = q * rhs + r, with r < rhs.
+        if ((result.second >= rhs) || ((result.first * rhs + result.second) != lhs)) {
+            std::cerr << lhs.to_string() << " / " << rhs.to_string() << " = " << result.first.to_string() << " rem " << result.second.to_string() << " (" << N1 << "&" << N2 << " bits)\n";
+            return 1;
+        }
+        if (((lhs / rhs) != result.first) || ((lhs % rhs) != result.second)) {
+            std::cerr << "The operators differ from div() for " << lhs.to_string() << " and " << rhs.to_string() << "\n";
+            return 1;
+        }
+        // The divider must give the same results.
+        const bvlib::Divider<N2, Block> divider(rhs);
+        if ((divider.quotient(lhs) != result.first) || (divider.remainder(lhs) != result.second)) {
+            std::cerr << "The divider differs from div() for " << lhs.to_string() << " and " << rhs.to_string() << "\n";
+            return 1;
+        }
+    }
+    try {
+        bvlib::div(bvlib::BitVector<N1, Block>(1U), bvlib::BitVector<N2, Block>());
+        std::cerr << "Division by zero did not throw\n";
+        return 1;
+    } catch (const std::domain_error &) {
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_increment()
+{
+    // Incrementing all ones must wrap around to zero.
+    auto bv = bvlib::BitVector<N, Block>::ones();
+    ++bv;
+    if (bv.any()) {
+        std::cerr << "Wrong increment of all ones (" << N << " bits): " << bv.to_string() << "\n";
+        return 1;
+    }
+    // Decrementing zero must wrap around to all ones.
+    bv -= 1U;
+    if (!bv.all()) {
+        std::cerr << "Wrong decrement of zero (" << N << " bits): " << bv.to_string() << "\n";
+        return 1;
+    }
+    // Small counts must match a plain integer.
+    bv.reset();
+    std::size_t value = 0;
+    for (std::size_t it = 0; it < 300; ++it, ++value, bv++) {
+        if (bv != (value & ((N >= 64) ? ~std::size_t(0) : ((std::size_t(1) << N) - 1)))) {
+            std::cerr << "Wrong increment (" << N << " bits): " << bv << " != " << value << "\n";
+            return 1;
+        }
+    }
+    bv += std::size_t(1000);
+    bv -= std::size_t(1300);
+    if (bv.any()) {
+        std::cerr << "Wrong integer add/sub (" << N << " bits): " << bv.to_string() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_add_sub<8, 4, std::uint8_t, 256>())
+        return 1;
+    if (test_add_sub<13, 29, std::uint8_t, 256>())
+        return 1;
+    if (test_add_sub<100, 64, std::uint32_t, 256>())
+        return 1;
+    if (test_add_sub<64, 64, std::uint64_t, 256>())
+        return 1;
+    if (test_add_sub<256, 130, std::uint64_t, 256>())
+        return 1;
+    if (test_add_sub<1024, 1000, std::uint64_t, 64>())
+        return 1;
+    if (test_mul<8, 4, std::uint8_t, 256>())
+        return 1;
+    if (test_mul<50, 61, std::uint8_t, 64>())
+        return 1;
+    if (test_mul<100, 64, std::uint32_t, 64>())
+        return 1;
+    if (test_mul<64, 64, std::uint64_t, 256>())
+        return 1;
+    if (test_mul<300, 257, std::uint64_t, 64>())
+        return 1;
+    if (test_mul<1024, 700, std::uint64_t, 16>())
+        return 1;
+    if (test_mul<4096, 4096, std::uint64_t, 4>())
+        return 1;
+    if (test_div<8, 4, std::uint8_t, 256>())
+        return 1;
+    if (test_div<29, 13, std::uint8_t, 256>())
+        return 1;
+    if (test_div<100, 64, std::uint32_t, 256>())
+        return 1;
+    if (test_div<64, 64, std::uint64_t, 256>())
+        return 1;
+    if (test_div<64, 200, std::uint64_t, 64>())
+        return 1;
+    if (test_div<300, 257, std::uint16_t, 64>())
+        return 1;
+    if (test_div<1024, 700, std::uint64_t, 64>())
+        return 1;
+    if (test_div<4096, 1500, std::uint64_t, 16>())
+        return 1;
+    if (test_increment<5, std::uint8_t>())
+        return 1;
+    if (test_increment<64, std::uint16_t>())
+        return 1;
+    if (test_increment<200, std::uint64_t>())
+        return 1;
+    return 0;
+}
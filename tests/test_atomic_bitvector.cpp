@@ -0,0 +1,147 @@
+#include "bvlib/atomic_bitvector.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N>
+bvlib::BitVector<N> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+template <std::size_t N, bool Padded>
+int test_atomic_bitvector()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    const auto a = random_bitvector<N>(gen), b = random_bitvector<N>(gen);
+    bvlib::AtomicBitVector<N, std::uint64_t, Padded> atomic(a);
+    if ((atomic.load() != a) || (atomic.count() != a.count()) || (atomic.any() != a.any())) {
+        std::cerr << "Wrong initial value " << atomic.load() << ", expected " << a << "\n";
+        return 1;
+    }
+    // The fetch operations return the previous value.
+    if ((atomic.fetch_or(b) != a) || (atomic.load() != (a | b))) {
+        std::cerr << "Wrong fetch_or of " << a << " and " << b << "\n";
+        return 1;
+    }
+    if ((atomic.fetch_and(b) != (a | b)) || (atomic.load() != b)) {
+        std::cerr << "Wrong fetch_and of " << (a | b) << " and " << b << "\n";
+        return 1;
+    }
+    if ((atomic.fetch_xor(a) != b) || (atomic.load() != (a ^ b))) {
+        std::cerr << "Wrong fetch_xor of " << b << " and " << a << "\n";
+        return 1;
+    }
+    // The single bit operations.
+    atomic.store(a);
+    for (std::size_t it = 0; it < N; ++it) {
+        if ((atomic.test(it) != a[it]) || (atomic.test_and_flip(it) != a[it]) || (atomic.test_and_set(it) == a[it])) {
+            std::cerr << "Wrong bit " << it << " of " << a << "\n";
+            return 1;
+        }
+    }
+    if (!atomic.all()) {
+        std::cerr << "Wrong all() for " << atomic.load() << "\n";
+        return 1;
+    }
+    for (std::size_t it = 0; it < N; ++it) {
+        if (!atomic.test_and_reset(it) || atomic.test_and_reset(it)) {
+            std::cerr << "Wrong reset of bit " << it << "\n";
+            return 1;
+        }
+    }
+    if (!atomic.none()) {
+        std::cerr << "Wrong none() for " << atomic.load() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+template <std::size_t N, bool Padded>
+int test_concurrent_claims(std::size_t threads)
+{
+    bvlib::AtomicBitVector<N, std::uint64_t, Padded> atomic;
+    std::vector<std::vector<std::size_t>> claimed(threads);
+    std::vector<std::thread> workers;
+    for (std::size_t thread = 0; thread < threads; ++thread) {
+        workers.emplace_back([&atomic, &claimed, thread]() {
+            for (std::size_t position; (position = atomic.find_first_unset_and_claim()) != atomic.npos;)
+                claimed[thread].push_back(position);
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    // Every bit must have been claimed by exactly one thread.
+    std::vector<std::size_t> owners(N, 0);
+    for (const auto &positions : claimed) {
+        for (std::size_t position : positions) {
+            if (position >= N) {
+                std::cerr << "Claimed bit " << position << " outside of " << N << " bits\n";
+                return 1;
+            }
+            ++owners[position];
+        }
+    }
+    for (std::size_t it = 0; it < N; ++it) {
+        if (owners[it] != 1) {
+            std::cerr << "Bit " << it << " claimed " << owners[it] << " times\n";
+            return 1;
+        }
+    }
+    if (!atomic.all() || (atomic.find_first_unset_and_claim() != atomic.npos)) {
+        std::cerr << "Claimed a bit of the full bitvector " << atomic.load() << "\n";
+        return 1;
+    }
+    // Setting the same bits concurrently, each one is found unset only once.
+    atomic.reset();
+    std::vector<std::size_t> first(threads, 0);
+    workers.clear();
+    for (std::size_t thread = 0; thread < threads; ++thread) {
+        workers.emplace_back([&atomic, &first, thread]() {
+            for (std::size_t it = 0; it < N; ++it)
+                first[thread] += !atomic.test_and_set(it, std::memory_order_acq_rel);
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    std::size_t total = 0;
+    for (std::size_t count : first)
+        total += count;
+    if ((total != N) || (atomic.count() != N)) {
+        std::cerr << "Set " << total << " bits out of " << N << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_atomic_bitvector<5, false>())
+        return 1;
+    if (test_atomic_bitvector<64, false>())
+        return 1;
+    if (test_atomic_bitvector<130, false>())
+        return 1;
+    if (test_atomic_bitvector<130, true>())
+        return 1;
+    if (test_concurrent_claims<1, false>(4))
+        return 1;
+    if (test_concurrent_claims<100, false>(4))
+        return 1;
+    if (test_concurrent_claims<1000, false>(8))
+        return 1;
+    if (test_concurrent_claims<1000, true>(8))
+        return 1;
+    return 0;
+}
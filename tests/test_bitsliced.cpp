@@ -0,0 +1,114 @@
+#include "bvlib/bitsliced.hpp"
+#include "bvlib/io.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N>
+bvlib::BitVector<N> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+template <std::size_t N, std::size_t Lanes>
+int test_bitsliced()
+{
+    using bitsliced_t = bvlib::BitSliced<N, Lanes>;
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::vector<bvlib::BitVector<N>> a(Lanes), b(Lanes), out(Lanes);
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        a[lane] = random_bitvector<N>(gen);
+        b[lane] = (lane % 7 == 0) ? a[lane] : random_bitvector<N>(gen);
+    }
+    const auto sa = bitsliced_t::pack(a.data());
+    const auto sb = bitsliced_t::pack(b.data());
+    // The transposition must agree with the bit by bit access.
+    sa.unpack(out.data());
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        if ((out[lane] != a[lane]) || (sa.get(lane) != a[lane])) {
+            std::cerr << "Wrong transposition of lane " << lane << ": " << a[lane] << " became " << out[lane] << "\n";
+            return 1;
+        }
+        for (std::size_t it = 0; it < N; ++it) {
+            if (sa[it][lane] != a[lane][it]) {
+                std::cerr << "Wrong bit " << it << " of lane " << lane << "\n";
+                return 1;
+            }
+        }
+    }
+    const auto sum = sa + sb, difference = sa - sb, conjunction = sa & sb, exclusion = sa ^ sb, negation = ~sa;
+    const auto eq = bvlib::equal(sa, sb), lt = bvlib::less(sa, sb), gt = bvlib::greater(sa, sb);
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        if ((sum.get(lane) != (a[lane] + b[lane])) || (difference.get(lane) != (a[lane] - b[lane]))) {
+            std::cerr << "Wrong arithmetic on lane " << lane << " for " << a[lane] << " and " << b[lane] << "\n";
+            return 1;
+        }
+        if ((conjunction.get(lane) != (a[lane] & b[lane])) || (exclusion.get(lane) != (a[lane] ^ b[lane])) || (negation.get(lane) != ~a[lane])) {
+            std::cerr << "Wrong bitwise operators on lane " << lane << " for " << a[lane] << " and " << b[lane] << "\n";
+            return 1;
+        }
+        if ((eq[lane] != (a[lane] == b[lane])) || (lt[lane] != (a[lane] < b[lane])) || (gt[lane] != (a[lane] > b[lane]))) {
+            std::cerr << "Wrong comparison on lane " << lane << " for " << a[lane] << " and " << b[lane] << "\n";
+            return 1;
+        }
+    }
+    // Setting a lane leaves the others untouched.
+    auto sc = sa;
+    sc.set(Lanes / 2, b[Lanes / 2]);
+    sc.unpack(out.data());
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        if (out[lane] != ((lane == Lanes / 2) ? b[lane] : a[lane])) {
+            std::cerr << "Wrong lane " << lane << " after setting lane " << Lanes / 2 << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int test_full_adder()
+{
+    // The same adder works on single bits and on whole words.
+    for (unsigned it = 0; it < 8; ++it) {
+        bool carry = it & 4U, borrow = it & 4U;
+        const bool b1 = it & 1U, b2 = it & 2U;
+        const bool sum = bvlib::add_bits(b1, b2, carry), difference = bvlib::sub_bits(b1, b2, borrow);
+        const int expected_sum = b1 + b2 + ((it & 4U) ? 1 : 0), expected_difference = b1 - b2 - ((it & 4U) ? 1 : 0);
+        if ((sum != (expected_sum & 1)) || (carry != (expected_sum > 1)) || (difference != ((expected_difference & 1) != 0)) || (borrow != (expected_difference < 0))) {
+            std::cerr << "Wrong full adder for " << b1 << ", " << b2 << " and " << ((it & 4U) != 0) << "\n";
+            return 1;
+        }
+    }
+    std::uint8_t carry = 0xF0;
+    if ((bvlib::add_bits<std::uint8_t>(0xCC, 0xAA, carry) != 0x96) || (carry != 0xE8)) {
+        std::cerr << "Wrong word-parallel full adder\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_full_adder())
+        return 1;
+    if (test_bitsliced<5, 64>())
+        return 1;
+    if (test_bitsliced<64, 64>())
+        return 1;
+    if (test_bitsliced<100, 64>())
+        return 1;
+    if (test_bitsliced<13, 100>())
+        return 1;
+    if (test_bitsliced<70, 256>())
+        return 1;
+    if (test_bitsliced<130, 512>())
+        return 1;
+    return 0;
+}
@@ -0,0 +1,293 @@
+#include "bvlib/bitvector.hpp"
+#include "bvlib/math.hpp"
+#include "bvlib/io.hpp"
+
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <cstring>
+
+template <std::size_t N, typename Block>
+int test_storage()
+{
+    static_assert(bvlib::BitVector<N, Block>::num_blocks * bvlib::BitVector<N, Block>::bits_per_block >= N, "Not enough blocks");
+    static_assert((bvlib::BitVector<N, Block>::num_blocks - 1) * bvlib::BitVector<N, Block>::bits_per_block < N, "Too many blocks");
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> distr(0, 1);
+
+    for (std::size_t run = 0; run < 64; ++run) {
+        // Generate a random string, and use it to build the bitvector.
+        std::string str;
+        for (std::size_t it = 0; it < N; ++it)
+            str.push_back(distr(gen) ? '1' : '0');
+        bvlib::BitVector<N, Block> bv(str);
+        if (bv.to_string() != str) {
+            std::cerr << "String round-trip failed (" << N << " bits): " << bv.to_string() << " != " << str << "\n";
+            return 1;
+        }
+        // Check the bits one by one, and count them.
+        std::size_t count = 0;
+        for (std::size_t it = 0; it < N; ++it) {
+            if (bv[it] != (str[N - 1 - it] == '1')) {
+                std::cerr << "Wrong bit " << it << " of " << str << " (" << N << " bits)\n";
+                return 1;
+            }
+            count += bv[it];
+        }
+        if (bv.count() != count) {
+            std::cerr << "Wrong count for " << str << ": " << bv.count() << " != " << count << "\n";
+            return 1;
+        }
+        // Flipping must not touch the unused bits of the last block.
+        bvlib::BitVector<N, Block> flipped(bv);
+        flipped.flip();
+        if ((flipped.count() + count) != N) {
+            std::cerr << "Wrong flip for " << str << " (" << N << " bits)\n";
+            return 1;
+        }
+        if ((flipped.data[flipped.num_blocks - 1] & ~flipped.last_block_mask) != 0) {
+            std::cerr << "Flip has set the unused bits (" << N << " bits)\n";
+            return 1;
+        }
+        // Modify the bits through the reference proxy.
+        for (std::size_t it = 0; it < N; ++it) {
+            flipped[it] = bv[it];
+        }
+        if (flipped != bv) {
+            std::cerr << "Assignment through proxy failed for " << str << " (" << N << " bits)\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_scan()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<std::size_t> distr(0, N - 1);
+
+    bvlib::BitVector<N, Block> bv;
+    if ((bv.find_first() != bv.npos) || (bv.find_last() != bv.npos) || (bv.countl_zero() != N) || (bv.countr_zero() != N) || bv.any() || !bv.none()) {
+        std::cerr << "Wrong scan of an empty bitvector (" << N << " bits)\n";
+        return 1;
+    }
+    for (std::size_t run = 0; run < 64; ++run) {
+        bv.reset();
+        // Set a few random bits, and compute the expected results.
+        std::size_t first = N, last = 0, count = (run % 4) + 1;
+        for (std::size_t it = 0; it < count; ++it) {
+            std::size_t position = distr(gen);
+            bv[position]         = true;
+            first                = std::min(first, position);
+            last                 = std::max(last, position);
+        }
+        if ((bv.find_first() != first) || (bv.countr_zero() != first) ||
+            (bv.find_last() != last) || (bv.countl_zero() != (N - 1 - last)) ||
+            (bvlib::most_significant_bit(bv) != last) || !bv.any() || bv.none()) {
+            std::cerr << "Wrong scan of " << bv.to_string() << " (" << N << " bits): first " << bv.find_first() << " != " << first << ", last " << bv.find_last() << " != " << last << "\n";
+            return 1;
+        }
+    }
+    if (!bvlib::BitVector<N, Block>::ones().all() || (bvlib::BitVector<N, Block>::ones().count() != N) || (bv.all() != (bv.count() == N))) {
+        std::cerr << "Wrong all() (" << N << " bits)\n";
+        return 1;
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_integer()
+{
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    const std::uint64_t mask = (N >= 64) ? ~std::uint64_t(0) : ((std::uint64_t(1) << N) - 1);
+
+    for (std::size_t run = 0; run < 64; ++run) {
+        const std::uint64_t value = gen() >> (run % 64);
+        bvlib::BitVector<N, Block> bv(value), assigned;
+        assigned = static_cast<std::size_t>(value);
+        if ((bv.template to_number<std::uint64_t>() != (value & mask)) || (assigned != bv)) {
+            std::cerr << "Wrong conversion of " << value << " (" << N << " bits): " << bv.to_string() << "\n";
+            return 1;
+        }
+    }
+    // Conversions of the blocks as words.
+    std::uint64_t words[3];
+    for (auto &word : words)
+        word = gen();
+    const auto from_words = bvlib::BitVector<N, Block>::from_words(words, 3);
+    if ((from_words.to_uint64() != (words[0] & mask)) || (from_words.count() > N) || (bvlib::BitVector<N, Block>::from_words(words, 1) != (words[0] & mask))) {
+        std::cerr << "Wrong conversion from words (" << N << " bits): " << from_words.to_string() << "\n";
+        return 1;
+    }
+    for (std::size_t it = 0; it < N; ++it) {
+        if (from_words[it] != (((words[it / 64] >> (it % 64)) & 1U) != 0)) {
+            std::cerr << "Wrong bit " << it << " after the conversion from words (" << N << " bits)\n";
+            return 1;
+        }
+    }
+#if defined(BVLIB_HAS_INT128)
+    const std::uint64_t high = (N <= 64) ? 0 : ((N >= 128) ? words[1] : (words[1] & ((std::uint64_t(1) << (N % 64)) - 1)));
+    if ((static_cast<std::uint64_t>(from_words.to_u128()) != from_words.to_uint64()) || (static_cast<std::uint64_t>(from_words.to_u128() >> 64) != high)) {
+        std::cerr << "Wrong 128-bit conversion (" << N << " bits): " << from_words.to_string() << "\n";
+        return 1;
+    }
+#endif
+    // The checked conversion fails when the bits do not fit.
+    try {
+        const auto low = bvlib::BitVector<N, Block>(from_words.template to_number<std::uint32_t>());
+        if (low.template to_number_checked<std::uint32_t>() != from_words.template to_number<std::uint32_t>()) {
+            std::cerr << "Wrong checked conversion (" << N << " bits): " << low.to_string() << "\n";
+            return 1;
+        }
+    } catch (const std::overflow_error &) {
+        std::cerr << "Unexpected overflow (" << N << " bits)\n";
+        return 1;
+    }
+    if (N > 8) {
+        try {
+            bvlib::BitVector<N, Block>::ones().template to_number_checked<std::uint8_t>();
+            std::cerr << "Missing overflow (" << N << " bits)\n";
+            return 1;
+        } catch (const std::overflow_error &) {
+        }
+    }
+    // Negative values are stored in two-complement.
+    const std::size_t expected = std::min<std::size_t>(N, std::numeric_limits<unsigned int>::digits);
+    if (bvlib::BitVector<N, Block>(-1).count() != expected) {
+        std::cerr << "Wrong conversion of -1 (" << N << " bits): " << bvlib::BitVector<N, Block>(-1).to_string() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+template <typename Block>
+int test_proxy()
+{
+    bvlib::BitVector<10, Block> bv;
+    bv[3] = true;
+    bv.at(9) = bv[3];
+    bv.flip(0);
+    if (bv.to_string() != "1000001001") {
+        std::cerr << "Wrong proxy assignment: " << bv.to_string() << "\n";
+        return 1;
+    }
+    bv[3].flip();
+    bv.reset(9);
+    if (bv.to_string() != "0000000001") {
+        std::cerr << "Wrong proxy flip/reset: " << bv.to_string() << "\n";
+        return 1;
+    }
+    if (!bv.swap().sign() || bv.to_string() != "1000000000") {
+        std::cerr << "Wrong swap: " << bv.to_string() << "\n";
+        return 1;
+    }
+    try {
+        bv.at(10) = true;
+        std::cerr << "Out of range access did not throw\n";
+        return 1;
+    } catch (const std::out_of_range &) {
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_layout()
+{
+    using bitvector_t = bvlib::BitVector<N, Block>;
+    static_assert(std::is_trivially_copyable<bitvector_t>::value, "BitVector must be trivially copyable");
+    static_assert(std::is_standard_layout<bitvector_t>::value, "BitVector must have a standard layout");
+    static_assert(std::has_unique_object_representations<bitvector_t>::value, "BitVector must not contain padding");
+    static_assert(sizeof(bitvector_t) == bitvector_t::num_blocks * sizeof(Block), "BitVector must only contain its blocks");
+    static_assert(alignof(bitvector_t) == alignof(Block), "BitVector must be aligned as its blocks");
+
+    // Arrays of bitvectors can be copied as raw memory.
+    bitvector_t source[4], destination[4];
+    for (std::size_t it = 0; it < 4; ++it)
+        source[it] = bitvector_t::ones() >> it;
+    std::memcpy(destination, source, sizeof(source));
+    for (std::size_t it = 0; it < 4; ++it) {
+        if (destination[it] != source[it]) {
+            std::cerr << "Wrong memcpy of " << source[it].to_string() << " (" << N << " bits)\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int test_constexpr()
+{
+    using namespace bvlib::literals;
+    // Literals.
+    constexpr auto bin = 0b1011_bv;
+    static_assert((bin.size() == 4) && (bin.count() == 3) && bin[0] && !bin[2], "Wrong binary literal");
+    static_assert((1011_bv == bin) && (0b10'11_bv == bin), "Wrong binary literal without prefix");
+    static_assert(((0xF0_bv).size() == 8) && ((0xF0_bv).to_number<unsigned>() == 0xF0U), "Wrong hexadecimal literal");
+    static_assert(((0x1234'5678'9ABC'DEF0'1234_bv).to_number<std::uint64_t>() == 0x56789ABCDEF01234U), "Wrong wide literal");
+    // Bit manipulation.
+    static_assert(bvlib::BitVector<100>::ones().count() == 100, "Wrong constexpr ones()");
+    static_assert(bvlib::BitVector<100>(0xF0U).find_first() == 4, "Wrong constexpr find_first()");
+    static_assert((~bin == 0b0100_bv) && ((bin & 0b0110_bv) == 0b0010_bv) && ((bin ^ bin).none()), "Wrong constexpr bitwise operators");
+    static_assert(((bin << 1) == 0b0110_bv) && ((bin >> 3) == 0b0001_bv), "Wrong constexpr shifts");
+    // Arithmetic, on more than one block.
+    constexpr bvlib::BitVector<130> value(1000000007U), divisor(97U);
+    static_assert((value + divisor) == 1000000104U, "Wrong constexpr sum");
+    static_assert((value - divisor) == 1000000007U - 97U, "Wrong constexpr difference");
+    static_assert((value * value) == bvlib::BitVector<260>(std::size_t(1000000007U) * 1000000007U), "Wrong constexpr product");
+    static_assert(((value / divisor) == 1000000007U / 97U) && ((value % divisor) == 1000000007U % 97U), "Wrong constexpr division");
+    static_assert(bvlib::Divider<130>(divisor).remainder(value) == 1000000007U % 97U, "Wrong constexpr divider");
+    static_assert(bvlib::BitVector<130>(0xDEADBEEFU).to_number<std::uint64_t>() == 0xDEADBEEFU, "Wrong constexpr to_number()");
+    static_assert(bvlib::BitVector<64>(0xDEADBEEFU).to_uint64() == 0xDEADBEEFU, "Wrong constexpr to_uint64()");
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_storage<1, std::uint8_t>())
+        return 1;
+    if (test_storage<13, std::uint8_t>())
+        return 1;
+    if (test_storage<64, std::uint16_t>())
+        return 1;
+    if (test_storage<100, std::uint32_t>())
+        return 1;
+    if (test_storage<64, std::uint64_t>())
+        return 1;
+    if (test_storage<257, std::uint64_t>())
+        return 1;
+    if (test_scan<1, std::uint8_t>())
+        return 1;
+    if (test_scan<13, std::uint8_t>())
+        return 1;
+    if (test_scan<100, std::uint32_t>())
+        return 1;
+    if (test_scan<64, std::uint64_t>())
+        return 1;
+    if (test_scan<257, std::uint64_t>())
+        return 1;
+    if (test_integer<5, std::uint8_t>())
+        return 1;
+    if (test_integer<40, std::uint16_t>())
+        return 1;
+    if (test_integer<64, std::uint32_t>())
+        return 1;
+    if (test_integer<130, std::uint64_t>())
+        return 1;
+    if (test_proxy<std::uint8_t>())
+        return 1;
+    if (test_proxy<std::uint64_t>())
+        return 1;
+    if (test_layout<13, std::uint8_t>())
+        return 1;
+    if (test_layout<100, std::uint32_t>())
+        return 1;
+    if (test_layout<257, std::uint64_t>())
+        return 1;
+    if (test_constexpr())
+        return 1;
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "bvlib/bitvector_array.hpp"
+#include "bvlib/math.hpp"
+#include "bvlib/io.hpp"
+
+#include <iostream>
+#include <random>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 3);
+    bvlib::BitVector<N, Block> result;
+    const int mode = distr(gen);
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = (mode == 0) ? true : (distr(gen) != 0);
+    return result;
+}
+
+template <std::size_t N, typename Block, std::size_t QT>
+int test_batch()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    bvlib::BitVectorArray<N, Block> lhs(QT), rhs(QT), dst(QT);
+    for (std::size_t it = 0; it < QT; ++it) {
+        lhs[it] = random_bitvector<N, Block>(gen);
+        // Make some of the values equal, to test the comparison.
+        rhs[it] = (it % 5 == 0) ? lhs.get(it) : random_bitvector<N, Block>(gen);
+    }
+    for (std::size_t limb = 0; limb < lhs.num_blocks; ++limb) {
+        if (reinterpret_cast<std::uintptr_t>(lhs.plane(limb)) % lhs.alignment) {
+            std::cerr << "The plane " << limb << " is not aligned\n";
+            return 1;
+        }
+    }
+    bvlib::add(dst, lhs, rhs);
+    for (std::size_t it = 0; it < QT; ++it) {
+        if (dst.get(it) != (lhs.get(it) + rhs.get(it))) {
+            std::cerr << "Wrong sum " << lhs.get(it) << " + " << rhs.get(it) << " = " << dst.get(it) << "\n";
+            return 1;
+        }
+    }
+    bvlib::sub(dst, lhs, rhs);
+    for (std::size_t it = 0; it < QT; ++it) {
+        if (dst.get(it) != (lhs.get(it) - rhs.get(it))) {
+            std::cerr << "Wrong difference " << lhs.get(it) << " - " << rhs.get(it) << " = " << dst.get(it) << "\n";
+            return 1;
+        }
+    }
+    bvlib::bitwise_and(dst, lhs, rhs);
+    for (std::size_t it = 0; it < QT; ++it) {
+        if (dst.get(it) != (lhs.get(it) & rhs.get(it))) {
+            std::cerr << "Wrong and of " << lhs.get(it) << " and " << rhs.get(it) << "\n";
+            return 1;
+        }
+    }
+    bvlib::bitwise_xor(dst, lhs, rhs);
+    for (std::size_t it = 0; it < QT; ++it) {
+        if (dst.get(it) != (lhs.get(it) ^ rhs.get(it))) {
+            std::cerr << "Wrong xor of " << lhs.get(it) << " and " << rhs.get(it) << "\n";
+            return 1;
+        }
+    }
+    std::vector<int> order(QT);
+    std::vector<std::size_t> counts(QT);
+    bvlib::compare(order.data(), lhs, rhs);
+    bvlib::popcount(counts.data(), lhs);
+    for (std::size_t it = 0; it < QT; ++it) {
+        const int expected = (lhs.get(it) < rhs.get(it)) ? -1 : (lhs.get(it) > rhs.get(it)) ? 1 : 0;
+        if (order[it] != expected) {
+            std::cerr << "Wrong comparison of " << lhs.get(it) << " and " << rhs.get(it) << ": " << order[it] << "\n";
+            return 1;
+        }
+        if (counts[it] != lhs.get(it).count()) {
+            std::cerr << "Wrong popcount of " << lhs.get(it) << ": " << counts[it] << "\n";
+            return 1;
+        }
+    }
+    // A range only touches its own bitvectors.
+    dst.reset();
+    bvlib::add(dst, lhs, rhs, QT / 3, QT / 2);
+    for (std::size_t it = 0; it < QT; ++it) {
+        if (dst.get(it) != (((it >= QT / 3) && (it < QT / 2)) ? (lhs.get(it) + rhs.get(it)) : bvlib::BitVector<N, Block>())) {
+            std::cerr << "Wrong sum inside the range, at " << it << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int test_array()
+{
+    bvlib::BitVectorArray<70, std::uint32_t> array(10, bvlib::BitVector<70, std::uint32_t>(5U));
+    // The views act like references to the bitvectors.
+    array[3][69] = true;
+    array[4]     = array[3];
+    if (!array[4].test(69) || !array[4].test(0) || array[4].test(1) || (array.get(4) != array.get(3))) {
+        std::cerr << "Wrong view: " << array.get(4) << "\n";
+        return 1;
+    }
+    array.resize(100);
+    if ((array.size() != 100) || (array.get(4) != array.get(3)) || (array.get(9) != 5U) || array.get(10).any()) {
+        std::cerr << "Wrong resize\n";
+        return 1;
+    }
+    try {
+        array.at(100);
+        std::cerr << "Access outside the array did not throw\n";
+        return 1;
+    } catch (const std::out_of_range &) {
+    }
+    try {
+        bvlib::BitVectorArray<70, std::uint32_t> other(99);
+        bvlib::add(other, array, array);
+        std::cerr << "Arrays of different sizes were accepted\n";
+        return 1;
+    } catch (const std::invalid_argument &) {
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_batch<5, std::uint8_t, 1000>())
+        return 1;
+    if (test_batch<13, std::uint8_t, 1000>())
+        return 1;
+    if (test_batch<64, std::uint64_t, 1000>())
+        return 1;
+    if (test_batch<100, std::uint32_t, 777>())
+        return 1;
+    if (test_batch<300, std::uint64_t, 513>())
+        return 1;
+    if (test_array())
+        return 1;
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include "bvlib/bitvector.hpp"
+#include "bvlib/math.hpp"
+#include "bvlib/io.hpp"
+
+#include <iomanip>
+#include <vector>
+#include <random>
+
+template <std::size_t N>
+struct test_bv_pair_t {
+    bvlib::BitVector<N> bitvector;
+    std::size_t original;
+    test_bv_pair_t(std::size_t _original = 0)
+        : bitvector(_original),
+          original(_original)
+    {
+    }
+};
+
+template <std::size_t N1, std::size_t N2, std::size_t QT>
+int test_operators()
+{
+    test_bv_pair_t<N1> inputs1[QT];
+    test_bv_pair_t<N2> inputs2[QT];
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<std::size_t> distr1(std::size_t(0), (N1 >= 64) ? ~std::size_t(0) : ((std::size_t(1) << N1) - 1));
+    std::uniform_int_distribution<std::size_t> distr2(std::size_t(0), (N2 >= 64) ? ~std::size_t(0) : ((std::size_t(1) << N2) - 1));
+
+    for (std::size_t i = 0; i < QT; ++i) {
+        inputs1[i] = test_bv_pair_t<N1>(distr1(gen));
+        inputs2[i] = test_bv_pair_t<N2>(distr2(gen));
+    }
+
+    for (std::size_t i = 0; i < QT; ++i) {
+        for (std::size_t j = 0; j < QT; ++j) {
+            auto bv_result = inputs1[i].bitvector & inputs2[j].bitvector;
+            auto nm_result = inputs1[i].original & inputs2[j].original;
+            if (bv_result != nm_result) {
+                std::cerr << inputs1[i].bitvector << " & " << inputs2[j].bitvector << " = " << bv_result << " (" << N1 << "&" << N2 << " bits)!= \n";
+                std::cerr << inputs1[i].original << " & " << inputs2[j].original << " = " << nm_result << "\n\n";
+                return 1;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < QT; ++i) {
+        for (std::size_t j = 0; j < QT; ++j) {
+            auto bv_result = inputs1[i].bitvector | inputs2[j].bitvector;
+            auto nm_result = inputs1[i].original | inputs2[j].original;
+            if (bv_result != nm_result) {
+                std::cerr << inputs1[i].bitvector << " | " << inputs2[j].bitvector << " = " << bv_result << " (" << N1 << "&" << N2 << " bits)!= \n";
+                std::cerr << inputs1[i].original << " | " << inputs2[j].original << " = " << nm_result << "\n\n";
+                return 1;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < QT; ++i) {
+        for (std::size_t j = 0; j < QT; ++j) {
+            auto bv_result = inputs1[i].bitvector ^ inputs2[j].bitvector;
+            auto nm_result = inputs1[i].original ^ inputs2[j].original;
+            if (bv_result != nm_result) {
+                std::cerr << inputs1[i].bitvector << " ^ " << inputs2[j].bitvector << " = " << bv_result << " (" << N1 << "&" << N2 << " bits)!= \n";
+                std::cerr << inputs1[i].original << " ^ " << inputs2[j].original << " = " << nm_result << "\n\n";
+                return 1;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < QT; ++i) {
+        auto bv_result = ~inputs1[i].bitvector;
+        auto nm_result = ~inputs1[i].original & ((N1 >= 64) ? ~std::size_t(0) : ((std::size_t(1) << N1) - 1));
+        if (((N1 <= 64) && (bv_result != nm_result)) || ((bv_result.count() + inputs1[i].bitvector.count()) != N1)) {
+            std::cerr << "~" << inputs1[i].bitvector << " = " << bv_result << " (" << N1 << " bits)!= \n";
+            std::cerr << "~" << inputs1[i].original << " = " << nm_result << "\n\n";
+            return 1;
+        }
+    }
+    for (std::size_t i = 0; i < QT; ++i) {
+        for (std::size_t j = 0; j < QT; ++j) {
+            auto bv_and = inputs1[i].bitvector, bv_or = inputs1[i].bitvector, bv_xor = inputs1[i].bitvector;
+            bv_and &= inputs2[j].bitvector;
+            bv_or |= inputs2[j].bitvector;
+            bv_xor ^= inputs2[j].bitvector;
+            if ((bv_and != (inputs1[i].bitvector & inputs2[j].bitvector)) ||
+                (bv_or != (inputs1[i].bitvector | inputs2[j].bitvector)) ||
+                (bv_xor != (inputs1[i].bitvector ^ inputs2[j].bitvector))) {
+                std::cerr << "Compound assignment differs from the binary operators for " << inputs1[i].bitvector << " and " << inputs2[j].bitvector << " (" << N1 << "&" << N2 << " bits)\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+template <std::size_t N>
+int test_wide()
+{
+    // Exercise the vectorized path with operands spanning several vector registers.
+    bvlib::BitVector<N> a, b;
+    for (std::size_t it = 0; it < N; it += 3)
+        a[it] = true;
+    for (std::size_t it = 0; it < N; it += 2)
+        b[it] = true;
+    for (std::size_t it = 0; it < N; ++it) {
+        if (((a & b)[it] != (((it % 6) == 0))) ||
+            ((a | b)[it] != (((it % 3) == 0) || ((it % 2) == 0))) ||
+            ((a ^ b)[it] != (((it % 3) == 0) != ((it % 2) == 0))) ||
+            ((~a)[it] != ((it % 3) != 0))) {
+            std::cerr << "Wrong bitwise result for bit " << it << " (" << N << " bits)\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_shift()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> distr(0, 1);
+
+    bvlib::BitVector<N, Block> bv;
+    for (std::size_t it = 0; it < N; ++it)
+        bv[it] = distr(gen) != 0;
+    for (std::size_t shift = 0; shift <= N + 1; ++shift) {
+        auto left = bv << shift, right = bv >> shift;
+        auto left_assign = bv, right_assign = bv, rotate_left = bv, rotate_right = bv;
+        left_assign <<= shift;
+        right_assign >>= shift;
+        bvlib::rotl(rotate_left, shift);
+        bvlib::rotr(rotate_right, shift);
+        for (std::size_t it = 0; it < N; ++it) {
+            if ((left[it] != ((it >= shift) && bv[it - shift])) ||
+                (right[it] != ((it + shift < N) && bv[it + shift])) ||
+                (rotate_left[it] != bv[(it + N - (shift % N)) % N]) ||
+                (rotate_right[it] != bv[(it + shift) % N])) {
+                std::cerr << "Wrong shift by " << shift << " of " << bv.to_string() << " at bit " << it << " (" << N << " bits)\n";
+                return 1;
+            }
+        }
+        if ((left_assign != left) || (right_assign != right)) {
+            std::cerr << "Compound shift by " << shift << " differs from the binary operators (" << N << " bits)\n";
+            return 1;
+        }
+        // The unused bits of the last block must stay clear.
+        if ((left.data[left.num_blocks - 1] & ~left.last_block_mask) || (rotate_left.data[rotate_left.num_blocks - 1] & ~rotate_left.last_block_mask)) {
+            std::cerr << "Shift by " << shift << " has set the unused bits (" << N << " bits)\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_operators<8, 4, 128>())
+        return 1;
+    if (test_operators<16, 8, 128>())
+        return 1;
+    if (test_operators<32, 16, 128>())
+        return 1;
+    if (test_operators<64, 32, 128>())
+        return 1;
+    if (test_operators<128, 64, 128>())
+        return 1;
+    if (test_operators<256, 64, 128>())
+        return 1;
+    if (test_wide<1000>())
+        return 1;
+    if (test_wide<4099>())
+        return 1;
+    if (test_shift<1, std::uint8_t>())
+        return 1;
+    if (test_shift<13, std::uint8_t>())
+        return 1;
+    if (test_shift<64, std::uint16_t>())
+        return 1;
+    if (test_shift<100, std::uint32_t>())
+        return 1;
+    if (test_shift<64, std::uint64_t>())
+        return 1;
+    if (test_shift<257, std::uint64_t>())
+        return 1;
+    return 0;
+}
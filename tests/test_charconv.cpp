@@ -0,0 +1,152 @@
+#include "bvlib/charconv.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+
+#include <iostream>
+#include <random>
+#include <string>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1), length(0, N);
+    bvlib::BitVector<N, Block> result;
+    // Random lengths, so that values with few digits are tested too.
+    for (std::size_t it = 0, end = static_cast<std::size_t>(length(gen)); it < end; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+/// @brief Converts a bitvector to a string, in the given base, with repeated divisions.
+template <std::size_t N, typename Block>
+std::string reference_string(const bvlib::BitVector<N, Block> &bitvector, unsigned base)
+{
+    const char *digits = "0123456789abcdef";
+    std::string result;
+    // Wide enough to hold the base.
+    bvlib::BitVector<N + 8, Block> value(bitvector);
+    const bvlib::BitVector<N + 8, Block> divisor(base);
+    do {
+        const auto remainder = value % divisor;
+        result.insert(result.begin(), digits[remainder.template to_number<unsigned>()]);
+        value = value / divisor;
+    } while (value.any());
+    return result;
+}
+
+template <std::size_t N, typename Block>
+int test_charconv()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    char buffer[bvlib::max_chars(N, 2) + 1];
+    for (std::size_t round = 0; round < 20; ++round) {
+        const auto value = random_bitvector<N, Block>(gen);
+        for (int base : { 2, 8, 10, 16 }) {
+            const std::string expected = reference_string(value, static_cast<unsigned>(base));
+            const auto written         = bvlib::to_chars(buffer, buffer + sizeof(buffer), value, base);
+            if ((written.ec != std::errc()) || (std::string(buffer, written.ptr) != expected)) {
+                std::cerr << "Wrong to_chars in base " << base << ": " << std::string(buffer, written.ptr) << ", expected " << expected << "\n";
+                return 1;
+            }
+            if (expected.size() > bvlib::max_chars(N, base)) {
+                std::cerr << "Wrong max_chars in base " << base << " for " << expected << "\n";
+                return 1;
+            }
+            bvlib::BitVector<N, Block> parsed;
+            const auto read = bvlib::from_chars(expected.data(), expected.data() + expected.size(), parsed, base);
+            if ((read.ec != std::errc()) || (read.ptr != expected.data() + expected.size()) || (parsed != value)) {
+                std::cerr << "Wrong from_chars in base " << base << " of " << expected << "\n";
+                return 1;
+            }
+            // The buffer is too small.
+            const auto small = bvlib::to_chars(buffer, buffer + expected.size() - 1, value, base);
+            if ((small.ec != std::errc::value_too_large) || (small.ptr != buffer + expected.size() - 1)) {
+                std::cerr << "Did not detect a small buffer in base " << base << "\n";
+                return 1;
+            }
+        }
+    }
+    // Leading zeros and uppercase digits are accepted, and the parsing stops at the first character which is not a digit.
+    const std::string text = "000FfA5 tail";
+    bvlib::BitVector<N, Block> parsed;
+    const auto read = bvlib::from_chars(text.data(), text.data() + text.size(), parsed, 16);
+    if ((N >= 16) && ((read.ec != std::errc()) || (read.ptr != text.data() + 7) || (parsed != bvlib::BitVector<N, Block>(0xFFA5)))) {
+        std::cerr << "Wrong parsing of " << text << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int test_errors()
+{
+    bvlib::BitVector<8> value(42);
+    const std::string overflow = "256", invalid = "x1", binary = "111111111";
+    auto read = bvlib::from_chars(overflow.data(), overflow.data() + overflow.size(), value);
+    if ((read.ec != std::errc::result_out_of_range) || (read.ptr != overflow.data() + 3) || (value != bvlib::BitVector<8>(42))) {
+        std::cerr << "Did not detect a decimal value which does not fit\n";
+        return 1;
+    }
+    read = bvlib::from_chars(binary.data(), binary.data() + binary.size(), value, 2);
+    if ((read.ec != std::errc::result_out_of_range) || (value != bvlib::BitVector<8>(42))) {
+        std::cerr << "Did not detect a binary value which does not fit\n";
+        return 1;
+    }
+    read = bvlib::from_chars(invalid.data(), invalid.data() + invalid.size(), value);
+    if ((read.ec != std::errc::invalid_argument) || (read.ptr != invalid.data())) {
+        std::cerr << "Did not detect a missing number\n";
+        return 1;
+    }
+    char buffer[16];
+    if (bvlib::to_chars(buffer, buffer + sizeof(buffer), value, 7).ec != std::errc::invalid_argument) {
+        std::cerr << "Did not detect an unsupported base\n";
+        return 1;
+    }
+    // Dynamic bitvectors keep their size.
+    bvlib::DynamicBitVector<> dynamic(200);
+    const std::string wide = "123456789012345678901234567890123456789012345678901234567890";
+    read                   = bvlib::from_chars(wide.data(), wide.data() + wide.size(), dynamic);
+    char out[128];
+    const auto written = bvlib::to_chars(out, out + sizeof(out), dynamic);
+    if ((read.ec != std::errc()) || (dynamic.size() != 200) || (std::string(out, written.ptr) != wide)) {
+        std::cerr << "Wrong conversion of a dynamic bitvector: " << std::string(out, written.ptr) << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int test_strings()
+{
+    const std::string text = "1011001110001111000011111";
+    const bvlib::BitVector<25> fixed(text);
+    const bvlib::DynamicBitVector<std::uint8_t> dynamic(text);
+    bvlib::BitVector<25> assigned;
+    assigned = text;
+    if ((fixed.to_string() != text) || (dynamic.to_string() != text) || (assigned != fixed) || (fixed.to_number<unsigned>() != 0x1671E1FU)) {
+        std::cerr << "Wrong string conversion of " << text << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_errors())
+        return 1;
+    if (test_strings())
+        return 1;
+    if (test_charconv<1, std::uint64_t>())
+        return 1;
+    if (test_charconv<64, std::uint64_t>())
+        return 1;
+    if (test_charconv<100, std::uint8_t>())
+        return 1;
+    if (test_charconv<333, std::uint32_t>())
+        return 1;
+    if (test_charconv<2000, std::uint64_t>())
+        return 1;
+    if (test_charconv<4096, std::uint16_t>())
+        return 1;
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "bvlib/crc.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+#include "bvlib/polynomial.hpp"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+int test_check()
+{
+    // The check values of the catalogue, i.e., the CRCs of "123456789".
+    struct entry_t {
+        bvlib::Crc crc;
+        std::uint64_t check;
+    };
+    const entry_t entries[] = {
+        { bvlib::Crc::crc32(), 0xCBF43926U },
+        { bvlib::Crc::crc32c(), 0xE3069283U },
+        { bvlib::Crc::crc64_xz(), 0x995DC9BBDF1939FAULL },
+        { bvlib::Crc(64, 0x42F0E1EBA9EA3693ULL, 0, false, 0), 0x6C40DF5F0B497347ULL },
+        { bvlib::Crc(16, 0x1021U, 0xFFFFU, false, 0), 0x29B1U },
+        { bvlib::Crc(8, 0x07U, 0, false, 0), 0xF4U },
+        { bvlib::Crc(5, 0x05U, 0x1FU, true, 0x1FU), 0x19U },
+        { bvlib::Crc(3, 0x03U, 0, false, 0x07U), 0x04U },
+    };
+    for (const auto &entry : entries) {
+        if (entry.crc.compute("123456789", 9) != entry.check) {
+            std::cerr << "Wrong check value of the CRC of " << entry.crc.width() << " bits: " << entry.crc.compute("123456789", 9) << "\n";
+            return 1;
+        }
+    }
+    try {
+        bvlib::Crc(65, 0, 0, false, 0);
+        std::cerr << "Accepted a CRC of 65 bits\n";
+        return 1;
+    } catch (const std::invalid_argument &) {
+    }
+    return 0;
+}
+
+template <std::size_t W>
+int test_crc(const bvlib::Crc &crc, std::uint64_t polynomial)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> distr(0, 255);
+
+    for (std::size_t run = 0; run < 20; ++run) {
+        std::vector<unsigned char> bytes(37);
+        for (auto &byte : bytes)
+            byte = static_cast<unsigned char>(distr(gen));
+        // The bytes of a bitvector, least significant first.
+        bvlib::BitVector<8 * 37, std::uint16_t> bitvector;
+        for (std::size_t it = 0; it < bitvector.size(); ++it)
+            bitvector[it] = (bytes[it / 8] >> (it % 8)) & 1U;
+        const std::uint64_t value = crc.compute(bytes.data(), bytes.size());
+        if ((crc.compute(bitvector) != value) || (crc.compute(bvlib::DynamicBitVector<std::uint8_t>(bitvector.to_string())) != value) ||
+            (crc.update(crc.compute(bytes.data(), run), bytes.data() + run, bytes.size() - run) != value)) {
+            std::cerr << "Wrong CRC of the bitvector " << bitvector << "\n";
+            return 1;
+        }
+        // Without initial value and final xor, the CRC is M(x) * x^W modulo the polynomial.
+        if (polynomial) {
+            bvlib::BitVector<8 * 37 + W> message;
+            for (std::size_t it = 0; it < 8 * 37; ++it)
+                message[W + 8 * 37 - 1 - it] = (bytes[it / 8] >> (7 - it % 8)) & 1U;
+            bvlib::BitVector<W + 1> modulus(polynomial);
+            modulus[W] = true;
+            if (bvlib::poly_mod(message, modulus).template to_number<std::uint64_t>() != value) {
+                std::cerr << "Wrong CRC of the message " << message << "\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_check())
+        return 1;
+    if (test_crc<32>(bvlib::Crc::crc32(), 0))
+        return 1;
+    if (test_crc<64>(bvlib::Crc::crc64_xz(), 0))
+        return 1;
+    if (test_crc<64>(bvlib::Crc(64, 0x42F0E1EBA9EA3693ULL, 0, false, 0), 0x42F0E1EBA9EA3693ULL))
+        return 1;
+    if (test_crc<16>(bvlib::Crc(16, 0x1021U, 0, false, 0), 0x1021U))
+        return 1;
+    if (test_crc<5>(bvlib::Crc(5, 0x05U, 0, false, 0), 0x05U))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,273 @@
+#include "bvlib/dynamic_bitvector.hpp"
+#include "bvlib/io.hpp"
+
+#include <iostream>
+#include <random>
+
+/// @brief Allocator which counts the blocks it has allocated and not yet released.
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    static long allocated;
+
+    counting_allocator() = default;
+
+    template <typename U>
+    counting_allocator(const counting_allocator<U> &)
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        allocated += static_cast<long>(n);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *ptr, std::size_t n)
+    {
+        allocated -= static_cast<long>(n);
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    bool operator==(const counting_allocator &) const
+    {
+        return true;
+    }
+
+    bool operator!=(const counting_allocator &) const
+    {
+        return false;
+    }
+};
+
+template <typename T>
+long counting_allocator<T>::allocated = 0;
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N, Block> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+/// @brief Checks that the dynamic bitvector holds the same bits of the fixed one.
+template <std::size_t N, typename Block, typename Allocator>
+bool same(const bvlib::DynamicBitVector<Block, Allocator> &dynamic, const bvlib::BitVector<N, Block> &fixed)
+{
+    return (dynamic.size() == N) && (dynamic.to_string() == fixed.to_string()) && (static_cast<bvlib::BitVector<N, Block>>(dynamic) == fixed);
+}
+
+template <std::size_t N1, std::size_t N2, typename Block, std::size_t QT>
+int test_operators()
+{
+    using dynamic_t = bvlib::DynamicBitVector<Block>;
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    for (std::size_t run = 0; run < QT; ++run) {
+        auto a = random_bitvector<N1, Block>(gen);
+        auto b = random_bitvector<N2, Block>(gen);
+        if (b.none())
+            b = bvlib::BitVector<N2, Block>(3U);
+        const dynamic_t da(a), db(b);
+        const std::size_t shift = static_cast<std::size_t>(gen()) % (N1 + 2);
+        if (!same(da & db, a & b) || !same(da | db, a | b) || !same(da ^ db, a ^ b) || !same(~da, ~a)) {
+            std::cerr << "Wrong bitwise operators for " << a << " and " << b << "\n";
+            return 1;
+        }
+        if (!same(da << shift, a << shift) || !same(da >> shift, a >> shift)) {
+            std::cerr << "Wrong shift by " << shift << " of " << a << "\n";
+            return 1;
+        }
+        dynamic_t rotated(da);
+        auto fixed_rotated = a;
+        if (!same(bvlib::rotl(rotated, shift), bvlib::rotl(fixed_rotated, shift)) || !same(bvlib::rotr(rotated, shift + 1), bvlib::rotr(fixed_rotated, shift + 1))) {
+            std::cerr << "Wrong rotation by " << shift << " of " << a << "\n";
+            return 1;
+        }
+        if (((da == db) != (a == b)) || ((da < db) != (a < b)) || ((da <= db) != (a <= b)) || ((da > db) != (a > b)) || ((da >= db) != (a >= b))) {
+            std::cerr << "Wrong comparison between " << a << " and " << b << "\n";
+            return 1;
+        }
+        if (!same(da + db, a + b) || !same(da - db, a - b) || !same(da * db, a * b)) {
+            std::cerr << "Wrong arithmetic between " << a << " and " << b << "\n";
+            return 1;
+        }
+        if (!same(da / db, a / b) || !same(da % db, a % b)) {
+            std::cerr << "Wrong division between " << a << " and " << b << "\n";
+            return 1;
+        }
+        if (!same(da + 5U, a + 5U) || !same(da - 5U, a - 5U) || !same(da * 3U, a * 3U) || !same(da / 3U, a / 3U) || !same(da % 3U, a % 3U) || !same(da & 0xF0U, a & 0xF0U)) {
+            std::cerr << "Wrong integer arithmetic with " << a << "\n";
+            return 1;
+        }
+        // Compound operators, wider rhs are rejected.
+        dynamic_t acc(std::max(N1, N2));
+        acc.assign(a);
+        acc += db;
+        acc ^= da;
+        acc -= db;
+        acc <<= shift;
+        acc >>= shift;
+        bvlib::BitVector<std::max(N1, N2), Block> expected(a);
+        expected += b;
+        expected ^= a;
+        expected -= b;
+        expected <<= shift;
+        expected >>= shift;
+        if (!same(acc, expected)) {
+            std::cerr << "Wrong compound operators with " << a << " and " << b << "\n";
+            return 1;
+        }
+        if (N1 < N2) {
+            try {
+                dynamic_t narrow(da);
+                narrow += db;
+                std::cerr << "A wider rhs was accepted\n";
+                return 1;
+            } catch (const std::invalid_argument &) {
+            }
+        }
+    }
+    try {
+        bvlib::div(dynamic_t(N1, 1), dynamic_t(N2));
+        std::cerr << "Division by zero did not throw\n";
+        return 1;
+    } catch (const std::domain_error &) {
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_members()
+{
+    using dynamic_t = bvlib::DynamicBitVector<Block>;
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    const auto a = random_bitvector<N, Block>(gen);
+    dynamic_t da(a);
+    if ((da.count() != a.count()) || (da.all() != a.all()) || (da.any() != a.any()) || (da.countl_zero() != a.countl_zero()) || (da.countr_zero() != a.countr_zero()) ||
+        (da.find_first() != a.find_first()) || (da.find_last() != a.find_last()) || (da.sign() != a.sign())) {
+        std::cerr << "Wrong queries on " << a << "\n";
+        return 1;
+    }
+    if (!same(dynamic_t::ones(N), bvlib::BitVector<N, Block>::ones()) || !same(dynamic_t(a.to_string()), a) || !same(dynamic_t(N, 1234567), bvlib::BitVector<N, Block>(1234567))) {
+        std::cerr << "Wrong construction (" << N << " bits)\n";
+        return 1;
+    }
+    if (da.template to_number<std::uint32_t>() != a.template to_number<std::uint32_t>() || da.template to_number<double>() != a.template to_number<double>()) {
+        std::cerr << "Wrong conversion to number of " << a << "\n";
+        return 1;
+    }
+    auto fixed = a;
+    if (!same(dynamic_t(da).two_complement(), fixed.two_complement()) || !same(dynamic_t(da).swap(), bvlib::BitVector<N, Block>(a).swap())) {
+        std::cerr << "Wrong two-complement or swap of " << a << "\n";
+        return 1;
+    }
+    // Growing keeps the value, shrinking truncates it.
+    da.resize(N + 100);
+    if ((da.size() != N + 100) || !same(dynamic_t(da).resize(N), a) || (da != dynamic_t(a))) {
+        std::cerr << "Wrong resize of " << a << "\n";
+        return 1;
+    }
+    da.resize(N / 2 + 1);
+    if (!same(da, bvlib::BitVector<N / 2 + 1, Block>(a))) {
+        std::cerr << "Wrong truncation of " << a << "\n";
+        return 1;
+    }
+    // Moving leaves the source empty.
+    dynamic_t moved(std::move(da));
+    if (!da.empty() || !same(moved, bvlib::BitVector<N / 2 + 1, Block>(a))) {
+        std::cerr << "Wrong move of " << a << "\n";
+        return 1;
+    }
+    da = moved;
+    if (da != moved) {
+        std::cerr << "Wrong copy of " << a << "\n";
+        return 1;
+    }
+    try {
+        da.at(da.size());
+        std::cerr << "Access outside the bitvector did not throw\n";
+        return 1;
+    } catch (const std::out_of_range &) {
+    }
+    return 0;
+}
+
+int test_allocation()
+{
+    using allocator_t = counting_allocator<std::uint64_t>;
+    using dynamic_t   = bvlib::DynamicBitVector<std::uint64_t, allocator_t>;
+    {
+        // Up to 128 bits are stored inline.
+        dynamic_t small(128, 7), other(small), half(64, 7);
+        small = small + other;
+        small -= half;
+        if ((half * half) != 49U) {
+            std::cerr << "Wrong small product\n";
+            return 1;
+        }
+        if (allocator_t::allocated != 0) {
+            std::cerr << "Small bitvectors allocated " << allocator_t::allocated << " blocks\n";
+            return 1;
+        }
+        dynamic_t large(129, 7);
+        if (allocator_t::allocated != 3) {
+            std::cerr << "Large bitvectors allocated " << allocator_t::allocated << " blocks instead of 3\n";
+            return 1;
+        }
+        large = large * large;
+        large = large / dynamic_t(129, 3);
+        if (large != dynamic_t(129, 16)) {
+            std::cerr << "Wrong allocated arithmetic: " << large.to_string() << "\n";
+            return 1;
+        }
+    }
+    if (allocator_t::allocated != 0) {
+        std::cerr << "Leaked " << allocator_t::allocated << " blocks\n";
+        return 1;
+    }
+#if defined(__cpp_lib_memory_resource)
+    // The bitvectors can be allocated from a memory resource.
+    unsigned char buffer[4096];
+    std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    bvlib::pmr::DynamicBitVector<> lhs(300, 5, &resource), rhs(300, 3, &resource);
+    if (((lhs * rhs) != 15U) || ((lhs * rhs).get_allocator().resource() != &resource)) {
+        std::cerr << "Wrong arithmetic using a memory resource\n";
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_operators<8, 4, std::uint8_t, 256>())
+        return 1;
+    if (test_operators<13, 29, std::uint8_t, 256>())
+        return 1;
+    if (test_operators<100, 64, std::uint32_t, 256>())
+        return 1;
+    if (test_operators<128, 128, std::uint64_t, 256>())
+        return 1;
+    if (test_operators<300, 257, std::uint64_t, 64>())
+        return 1;
+    if (test_operators<1024, 700, std::uint64_t, 16>())
+        return 1;
+    if (test_members<5, std::uint8_t>())
+        return 1;
+    if (test_members<64, std::uint16_t>())
+        return 1;
+    if (test_members<200, std::uint64_t>())
+        return 1;
+    if (test_allocation())
+        return 1;
+    return 0;
+}
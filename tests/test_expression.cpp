@@ -0,0 +1,96 @@
+#include "bvlib/bitvector.hpp"
+#include "bvlib/expression.hpp"
+#include "bvlib/math.hpp"
+#include "bvlib/io.hpp"
+
+#include <iostream>
+#include <random>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N, Block> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+template <std::size_t N1, std::size_t N2, std::size_t N3, typename Block, std::size_t QT>
+int test_expression()
+{
+    using bvlib::expr::lazy;
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    for (std::size_t run = 0; run < QT; ++run) {
+        const auto a            = random_bitvector<N1, Block>(gen);
+        const auto b            = random_bitvector<N2, Block>(gen);
+        const auto c            = random_bitvector<N3, Block>(gen);
+        const std::size_t shift = static_cast<std::size_t>(gen()) % (N1 + N2 + 2);
+        // The fused results must match the eager ones, including their width.
+        if (bvlib::expr::evaluate(lazy(a) + b - c) != (a + b - c)) {
+            std::cerr << "Wrong a + b - c for " << a << ", " << b << ", " << c << "\n";
+            return 1;
+        }
+        if (bvlib::expr::evaluate((lazy(a) << shift) + b) != ((a << shift) + b)) {
+            std::cerr << "Wrong (a << " << shift << ") + b for " << a << ", " << b << "\n";
+            return 1;
+        }
+        if (bvlib::expr::evaluate(~(lazy(a) ^ b) & c) != (~(a ^ b) & c)) {
+            std::cerr << "Wrong ~(a ^ b) & c for " << a << ", " << b << ", " << c << "\n";
+            return 1;
+        }
+        // Shifting a sum needs its blocks out of order.
+        if (bvlib::expr::evaluate(((lazy(a) + b) >> shift) - (c | lazy(a))) != (((a + b) >> shift) - (c | a))) {
+            std::cerr << "Wrong ((a + b) >> " << shift << ") - (c | a) for " << a << ", " << b << ", " << c << "\n";
+            return 1;
+        }
+        if (bvlib::expr::evaluate(((lazy(c) - a) << shift) ^ (b >> (shift / 2))) != (((c - a) << shift) ^ (b >> (shift / 2)))) {
+            std::cerr << "Wrong ((c - a) << " << shift << ") ^ (b >> " << shift / 2 << ") for " << a << ", " << b << ", " << c << "\n";
+            return 1;
+        }
+        // Assigning truncates to the destination, even when it is an operand.
+        bvlib::BitVector<N1, Block> dst(a);
+        bvlib::expr::assign(dst, (lazy(dst) << 1) + b + c);
+        if (dst != bvlib::BitVector<N1, Block>((a << 1) + b + c)) {
+            std::cerr << "Wrong assignment for " << a << ", " << b << ", " << c << "\n";
+            return 1;
+        }
+        bvlib::BitVector<std::max(N2, N3), Block> converted = lazy(b) | c;
+        if (converted != (b | c)) {
+            std::cerr << "Wrong conversion for " << b << ", " << c << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int test_constexpr()
+{
+    using namespace bvlib::literals;
+    using bvlib::expr::lazy;
+    constexpr auto a = 0xF0F0_bv;
+    constexpr auto b = 0x0FFF_bv;
+    static_assert(bvlib::expr::evaluate(lazy(a) + b - a) == b, "Wrong constant sum");
+    static_assert(bvlib::expr::evaluate((lazy(a) << 4) ^ (lazy(b) >> 4)) == ((a << 4) ^ (b >> 4)), "Wrong constant shifts");
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_expression<8, 4, 6, std::uint8_t, 256>())
+        return 1;
+    if (test_expression<13, 29, 17, std::uint8_t, 256>())
+        return 1;
+    if (test_expression<100, 64, 33, std::uint32_t, 256>())
+        return 1;
+    if (test_expression<64, 64, 64, std::uint64_t, 256>())
+        return 1;
+    if (test_expression<300, 257, 500, std::uint64_t, 64>())
+        return 1;
+    if (test_constexpr())
+        return 1;
+    return 0;
+}
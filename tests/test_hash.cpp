@@ -0,0 +1,127 @@
+#include "bvlib/hash.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N, Block> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+template <std::size_t N, typename Block>
+int test_hash()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    const auto value = random_bitvector<N, Block>(gen);
+    // The hash does not depend on the blocks, and it is also the one of the dynamic bitvectors.
+    const bvlib::BitVector<N, std::uint8_t> bytes(value.to_string());
+    const bvlib::DynamicBitVector<Block> dynamic(value.to_string());
+    if ((bvlib::hash(value) != bvlib::hash(bytes)) || (bvlib::hash(value) != bvlib::hash(dynamic)) ||
+        (std::hash<bvlib::BitVector<N, Block>>()(value) != std::hash<bvlib::DynamicBitVector<Block>>()(dynamic))) {
+        std::cerr << "Different hashes for the same bits " << value << "\n";
+        return 1;
+    }
+    // Every bit changes the hash, and so do the seed and the size.
+    std::unordered_set<std::uint64_t> hashes{ bvlib::hash(value), bvlib::hash(value, 1), bvlib::hash(bvlib::BitVector<N + 1, Block>(value)) };
+    for (std::size_t it = 0; it < N; ++it) {
+        auto other = value;
+        other.flip(it);
+        hashes.insert(bvlib::hash(other));
+    }
+    if (hashes.size() != N + 3) {
+        std::cerr << "Colliding hashes around " << value << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_incremental()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<std::size_t> position(0, N - 1);
+
+    auto value = random_bitvector<N, Block>(gen);
+    bvlib::IncrementalHash<N, Block> hash(value, 42);
+    for (std::size_t run = 0; run < 1000; ++run) {
+        const auto previous = value;
+        switch (run % 3) {
+        case 0:
+            hash.flip(value, position(gen));
+            break;
+        case 1:
+            hash.set(value, position(gen), (run % 2) != 0);
+            break;
+        default:
+            value[position(gen)].flip();
+            value[position(gen)].flip();
+            hash.update(previous, value);
+            break;
+        }
+        if (hash.value() != bvlib::hash(value, 42)) {
+            std::cerr << "Wrong incremental hash of " << value << " after " << run << " updates\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template <std::size_t N>
+int test_unordered()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::unordered_map<bvlib::BitVector<N>, std::size_t> map;
+    std::vector<bvlib::BitVector<N>> keys;
+    for (std::size_t it = 0; it < 1000; ++it) {
+        keys.push_back(random_bitvector<N, std::uint64_t>(gen));
+        map[keys.back()] = it;
+    }
+    for (std::size_t it = 0; it < keys.size(); ++it) {
+        if ((map.count(keys[it]) != 1) || (keys[map[keys[it]]] != keys[it])) {
+            std::cerr << "Missing key " << keys[it] << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    static_assert(bvlib::hash(bvlib::BitVector<100>(5U)) == bvlib::hash(bvlib::BitVector<100, std::uint8_t>(5U)), "Wrong constexpr hash");
+    if (test_hash<1, std::uint8_t>())
+        return 1;
+    if (test_hash<13, std::uint16_t>())
+        return 1;
+    if (test_hash<64, std::uint64_t>())
+        return 1;
+    if (test_hash<100, std::uint32_t>())
+        return 1;
+    if (test_hash<1000, std::uint64_t>())
+        return 1;
+    if (test_incremental<1, std::uint64_t>())
+        return 1;
+    if (test_incremental<100, std::uint8_t>())
+        return 1;
+    if (test_incremental<1000, std::uint64_t>())
+        return 1;
+    if (test_unordered<10>())
+        return 1;
+    if (test_unordered<300>())
+        return 1;
+    return 0;
+}
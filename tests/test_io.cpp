@@ -0,0 +1,235 @@
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N, Block> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+template <std::size_t N, typename Block>
+int test_text()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    for (std::size_t run = 0; run < 50; ++run) {
+        const auto value = random_bitvector<N, Block>(gen);
+        std::stringstream stream;
+        stream << value << " " << ~value;
+        bvlib::BitVector<N, Block> first, second;
+        stream >> first >> second;
+        if (!stream || (first != value) || (second != ~value)) {
+            std::cerr << "Wrong text round trip of " << value.to_string() << ": " << first.to_string() << "\n";
+            return 1;
+        }
+    }
+    // Values which do not fit set the failbit.
+    std::stringstream stream("-1");
+    bvlib::BitVector<N, Block> value;
+    if (stream >> value) {
+        std::cerr << "Parsed a negative value into " << value << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_binary(std::size_t count)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::vector<bvlib::BitVector<N, Block>> values(count);
+    bvlib::BitVectorArray<N, Block> array(count);
+    for (std::size_t it = 0; it < count; ++it)
+        array.set(it, values[it] = random_bitvector<N, Block>(gen));
+
+    // The size of the stream does not depend on the type of the blocks.
+    std::stringstream stream;
+    bvlib::write_binary(stream, values);
+    if (stream.str().size() != 24 + count * ((N + 7) / 8)) {
+        std::cerr << "Wrong size " << stream.str().size() << " of " << count << " bitvectors of " << N << " bits\n";
+        return 1;
+    }
+    if (count && (static_cast<unsigned char>(stream.str()[24]) != values[0].data[0] % 256)) {
+        std::cerr << "Wrong first byte of " << values[0] << "\n";
+        return 1;
+    }
+    // Written as a vector and as an array, the streams are the same.
+    std::stringstream from_array;
+    bvlib::write_binary(from_array, array);
+    if (from_array.str() != stream.str()) {
+        std::cerr << "Different streams for the vector and the array of " << N << " bits\n";
+        return 1;
+    }
+    std::vector<bvlib::BitVector<N, Block>> read_values;
+    bvlib::read_binary(stream, read_values);
+    bvlib::BitVectorArray<N, Block> read_array;
+    bvlib::read_binary(from_array, read_array);
+    if ((read_values != values) || (read_array.size() != count)) {
+        std::cerr << "Wrong binary round trip of " << count << " bitvectors of " << N << " bits\n";
+        return 1;
+    }
+    for (std::size_t it = 0; it < count; ++it) {
+        if (read_array.get(it) != values[it]) {
+            std::cerr << "Wrong bitvector " << it << " of the array: " << read_array.get(it) << ", expected " << values[it] << "\n";
+            return 1;
+        }
+    }
+    // The blocks are converted when reading.
+    std::stringstream other;
+    bvlib::write_binary(other, values);
+    std::vector<bvlib::BitVector<N, std::uint8_t>> bytes;
+    bvlib::read_binary(other, bytes);
+    for (std::size_t it = 0; it < count; ++it) {
+        if (bytes[it].to_string() != values[it].to_string()) {
+            std::cerr << "Wrong conversion of " << values[it] << " to bytes: " << bytes[it] << "\n";
+            return 1;
+        }
+    }
+    // Through a C file.
+    std::FILE *file = std::tmpfile();
+    if (!file) {
+        std::cerr << "Cannot open a temporary file\n";
+        return 1;
+    }
+    bvlib::write_binary(file, values.data(), values.size());
+    bvlib::write_binary(file, array);
+    std::rewind(file);
+    std::vector<bvlib::BitVector<N, Block>> from_file(count);
+    bvlib::read_binary(file, from_file.data(), from_file.size());
+    read_array = bvlib::BitVectorArray<N, Block>();
+    bvlib::read_binary(file, read_array);
+#if defined(BVLIB_IO_POSIX)
+    // And through its file descriptor.
+    const bvlib::file_descriptor descriptor{ fileno(file) };
+    ::lseek(descriptor.fd, 0, SEEK_SET);
+    std::vector<bvlib::BitVector<N, Block>> from_descriptor;
+    bvlib::read_binary(descriptor, from_descriptor);
+    if (from_descriptor != values) {
+        std::cerr << "Wrong round trip through a file descriptor of " << N << " bits\n";
+        return 1;
+    }
+#endif
+    std::fclose(file);
+    if ((from_file != values) || (read_array.size() != count)) {
+        std::cerr << "Wrong round trip through a file of " << N << " bits\n";
+        return 1;
+    }
+    for (std::size_t it = 0; it < count; ++it) {
+        if (read_array.get(it) != values[it]) {
+            std::cerr << "Wrong bitvector " << it << " of the array read from a file\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template <std::size_t N>
+int test_errors()
+{
+    bvlib::BitVector<N> value;
+    value.flip();
+    std::stringstream stream;
+    bvlib::write_binary(stream, value);
+    const std::string data = stream.str();
+    // A different width.
+    try {
+        std::stringstream input(data);
+        bvlib::BitVector<N + 1> wider;
+        bvlib::read_binary(input, wider);
+        std::cerr << "Read " << N << " bits into " << N + 1 << " bits\n";
+        return 1;
+    } catch (const std::invalid_argument &) {
+    }
+    // A wrong header.
+    try {
+        std::stringstream input("BVLA" + data.substr(4));
+        bvlib::read_binary(input, value);
+        std::cerr << "Read a stream with a wrong header\n";
+        return 1;
+    } catch (const std::runtime_error &) {
+    }
+    // A truncated stream.
+    try {
+        std::stringstream input(data.substr(0, data.size() - 1));
+        bvlib::read_binary(input, value);
+        std::cerr << "Read a truncated stream\n";
+        return 1;
+    } catch (const std::runtime_error &) {
+    }
+    // A corrupt number of bitvectors, which must not be allocated before reading them.
+    std::string huge = data;
+    huge[16 + 5]     = 1;
+    try {
+        std::stringstream input(huge);
+        std::vector<bvlib::BitVector<N>> values;
+        bvlib::read_binary(input, values);
+        std::cerr << "Read a stream with a corrupt count into a vector\n";
+        return 1;
+    } catch (const std::runtime_error &) {
+    }
+    try {
+        std::stringstream input(huge);
+        bvlib::BitVectorArray<N> array;
+        bvlib::read_binary(input, array);
+        std::cerr << "Read a stream with a corrupt count into an array\n";
+        return 1;
+    } catch (const std::runtime_error &) {
+    }
+    // The bits above the width are ignored.
+    std::string padded = data;
+    padded.back()      = static_cast<char>(0xFF);
+    std::stringstream input(padded);
+    bvlib::BitVector<N> result;
+    bvlib::read_binary(input, result);
+    if ((result != value) || (result.count() != N)) {
+        std::cerr << "Wrong padding bits after reading " << result.to_string() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_text<5, std::uint8_t>())
+        return 1;
+    if (test_text<64, std::uint64_t>())
+        return 1;
+    if (test_text<200, std::uint32_t>())
+        return 1;
+    if (test_text<1000, std::uint64_t>())
+        return 1;
+    if (test_binary<1, std::uint64_t>(10))
+        return 1;
+    if (test_binary<13, std::uint8_t>(100))
+        return 1;
+    if (test_binary<64, std::uint64_t>(0))
+        return 1;
+    if (test_binary<64, std::uint64_t>(1000))
+        return 1;
+    if (test_binary<100, std::uint32_t>(1000))
+        return 1;
+    if (test_binary<130, std::uint64_t>(10000))
+        return 1;
+    if (test_binary<512, std::uint16_t>(100))
+        return 1;
+    if (test_errors<5>())
+        return 1;
+    if (test_errors<130>())
+        return 1;
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include "bvlib/mapped_bitvector_array.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N, Block> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+/// @brief Writes random bitvectors to the given file.
+template <std::size_t N, typename Block>
+std::vector<bvlib::BitVector<N, Block>> write_file(const std::string &path, std::size_t count)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::vector<bvlib::BitVector<N, Block>> values(count);
+    for (auto &value : values)
+        value = random_bitvector<N, Block>(gen);
+    std::ofstream stream(path, std::ios::binary);
+    bvlib::write_binary(stream, values);
+    return values;
+}
+
+template <std::size_t N, typename Block>
+int test_mapped(std::size_t count)
+{
+    const std::string path = "test_mapped_bitvector_array_" + std::to_string(N) + ".bin";
+    const auto values      = write_file<N, Block>(path, count);
+    bvlib::MappedBitVectorArray<N, Block> array(path, bvlib::map_advice::sequential);
+    std::remove(path.c_str());
+    if (!array.is_open() || (array.size() != count)) {
+        std::cerr << "Wrong size " << array.size() << " of the mapping, expected " << count << "\n";
+        return 1;
+    }
+    for (std::size_t it = 0; it < count; ++it) {
+        if (array.get(it) != values[it]) {
+            std::cerr << "Wrong bitvector " << it << " " << array.get(it) << ", expected " << values[it] << "\n";
+            return 1;
+        }
+    }
+    array.advise(bvlib::map_advice::random, count / 2);
+    array.advise(bvlib::map_advice::will_need, 0, 1);
+    // The mapping can be moved.
+    bvlib::MappedBitVectorArray<N, Block> other(std::move(array));
+    if (array.is_open() || (other.size() != count) || (count && (other.get(count - 1) != values.back()))) {
+        std::cerr << "Wrong move of the mapping of " << count << " bitvectors\n";
+        return 1;
+    }
+    other.close();
+    if (other.is_open() || !other.empty()) {
+        std::cerr << "The mapping is still open after closing it\n";
+        return 1;
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_zero_copy(std::size_t count)
+{
+    static_assert(bvlib::MappedBitVectorArray<N, Block>::zero_copy, "Expected an in place access");
+    const std::string path = "test_mapped_bitvector_array_" + std::to_string(N) + ".bin";
+    const auto values      = write_file<N, Block>(path, count);
+    const bvlib::MappedBitVectorArray<N, Block> array(path, bvlib::map_advice::random);
+    std::remove(path.c_str());
+    std::size_t index = 0;
+    for (const auto &value : array) {
+        if ((value != values[index]) || (&value != &array[index]) || (&array.at(index) != &array[index])) {
+            std::cerr << "Wrong bitvector " << index << " " << value << ", expected " << values[index] << "\n";
+            return 1;
+        }
+        ++index;
+    }
+    if (index != count) {
+        std::cerr << "Visited " << index << " bitvectors out of " << count << "\n";
+        return 1;
+    }
+    try {
+        array.at(count);
+        std::cerr << "Accessed a bitvector outside of the mapping\n";
+        return 1;
+    } catch (const std::out_of_range &) {
+    }
+    return 0;
+}
+
+int test_errors()
+{
+    const std::string path = "test_mapped_bitvector_array_errors.bin";
+    write_file<64, std::uint64_t>(path, 10);
+    // A different width.
+    try {
+        bvlib::MappedBitVectorArray<32> array(path);
+        std::cerr << "Mapped bitvectors of 64 bits as 32 bits\n";
+        return 1;
+    } catch (const std::invalid_argument &) {
+    }
+    // A truncated file.
+    {
+        std::ifstream input(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        input.close();
+        std::ofstream output(path, std::ios::binary);
+        output.write(data.data(), static_cast<std::streamsize>(data.size() - 1));
+    }
+    try {
+        bvlib::MappedBitVectorArray<64> array(path);
+        std::cerr << "Mapped a truncated file\n";
+        return 1;
+    } catch (const std::runtime_error &) {
+    }
+    std::remove(path.c_str());
+    // A missing file.
+    try {
+        bvlib::MappedBitVectorArray<64> array(path);
+        std::cerr << "Mapped a missing file\n";
+        return 1;
+    } catch (const std::system_error &) {
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_mapped<1, std::uint8_t>(100))
+        return 1;
+    if (test_mapped<64, std::uint64_t>(0))
+        return 1;
+    if (test_mapped<100, std::uint64_t>(1000))
+        return 1;
+    if (test_mapped<256, std::uint64_t>(100000))
+        return 1;
+    if (test_zero_copy<8, std::uint8_t>(100))
+        return 1;
+    if (test_zero_copy<64, std::uint64_t>(1000))
+        return 1;
+    if (test_zero_copy<192, std::uint32_t>(10000))
+        return 1;
+    if (test_errors())
+        return 1;
+    return 0;
+}
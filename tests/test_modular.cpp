@@ -0,0 +1,167 @@
+#include "bvlib/modular.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N, Block> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+/// @brief Computes lhs * rhs % modulus, with the generic multiplication and division.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> reference_mulmod(const bvlib::BitVector<N, Block> &lhs, const bvlib::BitVector<N, Block> &rhs, const bvlib::BitVector<N, Block> &modulus)
+{
+    return bvlib::BitVector<N, Block>((lhs * rhs) % bvlib::BitVector<2 * N, Block>(modulus));
+}
+
+/// @brief Computes base^exponent % modulus, with square-and-multiply.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> reference_powmod(const bvlib::BitVector<N, Block> &base, const bvlib::BitVector<N, Block> &exponent, const bvlib::BitVector<N, Block> &modulus)
+{
+    bvlib::BitVector<N, Block> result = bvlib::BitVector<N, Block>(1U) % modulus;
+    for (std::size_t it = N; it > 0; --it) {
+        result = reference_mulmod(result, result, modulus);
+        if (exponent[it - 1])
+            result = reference_mulmod(result, base, modulus);
+    }
+    return result;
+}
+
+template <std::size_t N, typename Block>
+int test_modular(std::size_t modulus_bits)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    for (std::size_t run = 0; run < 20; ++run) {
+        // A random odd modulus, with the given number of bits.
+        auto modulus = random_bitvector<N, Block>(gen);
+        for (std::size_t it = modulus_bits; it < N; ++it)
+            modulus[it] = false;
+        modulus[0]                = true;
+        modulus[modulus_bits - 1] = true;
+        const bvlib::ModContext<N, Block> context(modulus);
+        const auto a = random_bitvector<N, Block>(gen), b = random_bitvector<N, Block>(gen), e = random_bitvector<N, Block>(gen);
+        const auto ra = a % modulus, rb = b % modulus;
+        if (context.mulmod(a, b) != reference_mulmod(ra, rb, modulus)) {
+            std::cerr << "Wrong mulmod " << a << " * " << b << " % " << modulus << ": " << context.mulmod(a, b) << "\n";
+            return 1;
+        }
+        if ((context.from_montgomery(context.montgomery_mul(context.to_montgomery(a), context.to_montgomery(b))) != context.mulmod(a, b)) ||
+            (context.from_montgomery(context.to_montgomery(a)) != ra)) {
+            std::cerr << "Wrong Montgomery form of " << a << " % " << modulus << "\n";
+            return 1;
+        }
+        if ((context.addmod(ra, rb) != (bvlib::BitVector<N + 1, Block>(ra) + rb) % modulus) || (context.addmod(context.submod(ra, rb), rb) != ra)) {
+            std::cerr << "Wrong addmod/submod of " << ra << " and " << rb << " % " << modulus << "\n";
+            return 1;
+        }
+        // The values equal to the modulus minus one, or the same value, are the edge cases of the masked selections.
+        const auto top = bvlib::BitVector<N, Block>(modulus - 1U);
+        if ((context.reduce(a) != ra) || (context.reduce(ra) != ra) || (context.reduce(modulus).any()) || (context.submod(ra, ra).any()) ||
+            (context.submod(bvlib::BitVector<N, Block>(), top) != 1U) || (context.addmod(top, top) != (top - 1U))) {
+            std::cerr << "Wrong reduce/addmod/submod edge cases % " << modulus << "\n";
+            return 1;
+        }
+        const auto power = reference_powmod(ra, e, modulus);
+        if ((context.powmod(a, e) != power) || (context.powmod_ct(a, e) != power)) {
+            std::cerr << "Wrong powmod " << a << " ^ " << e << " % " << modulus << ": " << context.powmod(a, e) << ", expected " << power << "\n";
+            return 1;
+        }
+        if ((context.powmod(a, bvlib::BitVector<8, Block>()) != bvlib::BitVector<N, Block>(1U) % modulus) || (context.powmod(a, bvlib::BitVector<8, Block>(1U)) != ra)) {
+            std::cerr << "Wrong trivial powers of " << a << " % " << modulus << "\n";
+            return 1;
+        }
+        try {
+            const auto inverse = context.invmod(a);
+            if (context.mulmod(inverse, a) != 1U) {
+                std::cerr << "Wrong inverse " << inverse << " of " << a << " % " << modulus << "\n";
+                return 1;
+            }
+        } catch (const std::domain_error &) {
+            // Only when the value and the modulus are not coprime.
+            auto x = bvlib::BitVector<N, Block>(modulus), y = ra;
+            while (y.any()) {
+                const auto r = x % y;
+                x            = y;
+                y            = r;
+            }
+            if (x == 1U) {
+                std::cerr << "Missing inverse of " << a << " % " << modulus << "\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_prime(const bvlib::BitVector<N, Block> &prime)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    const bvlib::ModContext<N, Block> context(prime);
+    for (std::size_t run = 0; run < 20; ++run) {
+        const auto a = random_bitvector<N, Block>(gen) % prime;
+        if (a.none())
+            continue;
+        const auto inverse = context.invmod(a);
+        if ((context.invmod_ct(a) != inverse) || (context.mulmod(a, inverse) != 1U)) {
+            std::cerr << "Wrong inverse of " << a << " % " << prime << "\n";
+            return 1;
+        }
+        // Fermat's little theorem.
+        if (context.powmod(a, prime - 1U) != 1U) {
+            std::cerr << "Wrong Fermat test of " << a << " % " << prime << "\n";
+            return 1;
+        }
+    }
+    try {
+        context.invmod(prime);
+        std::cerr << "Inverted zero modulo " << prime << "\n";
+        return 1;
+    } catch (const std::domain_error &) {
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    try {
+        bvlib::ModContext<64> context(bvlib::BitVector<64>(10U));
+        std::cerr << "Accepted an even modulus\n";
+        return 1;
+    } catch (const std::domain_error &) {
+    }
+    if (test_modular<8, std::uint8_t>(8))
+        return 1;
+    if (test_modular<64, std::uint64_t>(64))
+        return 1;
+    if (test_modular<100, std::uint32_t>(77))
+        return 1;
+    if (test_modular<256, std::uint64_t>(256))
+        return 1;
+    if (test_modular<256, std::uint64_t>(130))
+        return 1;
+    if (test_modular<130, std::uint16_t>(129))
+        return 1;
+    // The primes 2^61 - 1, 2^127 - 1 and 2^255 - 19.
+    if (test_prime(bvlib::BitVector<64>(bvlib::BitVector<61>::ones())))
+        return 1;
+    if (test_prime(bvlib::BitVector<128, std::uint32_t>(bvlib::BitVector<127, std::uint32_t>::ones())))
+        return 1;
+    if (test_prime(bvlib::BitVector<256>(bvlib::BitVector<256>(bvlib::BitVector<255>::ones()) - 18U)))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "bvlib/parallel.hpp"
+#include "bvlib/math.hpp"
+#include "bvlib/io.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N, Block> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+template <std::size_t N, typename Block, std::size_t QT>
+int test_parallel(bvlib::parallel::ThreadPool &pool)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    bvlib::BitVectorArray<N, Block> lhs(QT), rhs(QT), dst(QT);
+    std::size_t expected_count = 0, expected_different = 0;
+    for (std::size_t it = 0; it < QT; ++it) {
+        lhs[it] = random_bitvector<N, Block>(gen);
+        rhs[it] = (it % 3 == 0) ? lhs.get(it) : random_bitvector<N, Block>(gen);
+        expected_count += lhs.get(it).count();
+        expected_different += (lhs.get(it) != rhs.get(it));
+    }
+    bvlib::parallel::transform(dst, lhs, rhs, bvlib::parallel::plus(), pool);
+    for (std::size_t it = 0; it < QT; ++it) {
+        if (dst.get(it) != (lhs.get(it) + rhs.get(it))) {
+            std::cerr << "Wrong parallel sum at " << it << " (" << pool.size() << " threads)\n";
+            return 1;
+        }
+    }
+    bvlib::parallel::transform(dst, dst, rhs, bvlib::parallel::minus(), pool);
+    bvlib::parallel::transform(dst, dst, lhs, bvlib::parallel::bit_xor(), pool);
+    if (bvlib::parallel::popcount(dst, pool) != 0) {
+        std::cerr << "Wrong parallel difference or xor (" << pool.size() << " threads)\n";
+        return 1;
+    }
+    if (bvlib::parallel::popcount(lhs, pool) != expected_count) {
+        std::cerr << "Wrong parallel popcount (" << pool.size() << " threads)\n";
+        return 1;
+    }
+    if ((bvlib::parallel::count_different(lhs, rhs, pool) != expected_different) || !bvlib::parallel::equal(lhs, lhs, pool) || bvlib::parallel::equal(lhs, rhs, pool)) {
+        std::cerr << "Wrong parallel comparison (" << pool.size() << " threads)\n";
+        return 1;
+    }
+    return 0;
+}
+
+int test_pool()
+{
+    bvlib::parallel::ThreadPool single(1), many(4);
+    // The reduction order depends only on the chunks, even for non-associative operations.
+    auto map     = [](std::size_t first, std::size_t last) { return std::to_string(first) + "-" + std::to_string(last) + ","; };
+    auto combine = [](const std::string &lhs, const std::string &rhs) { return lhs + rhs; };
+    const std::string expected = bvlib::parallel::reduce(1000, 7, std::string(), map, combine, single);
+    for (int run = 0; run < 20; ++run) {
+        if (bvlib::parallel::reduce(1000, 7, std::string(), map, combine, many) != expected) {
+            std::cerr << "The reduction is not deterministic\n";
+            return 1;
+        }
+    }
+    // Exceptions reach the thread submitting the job, and the pool can be reused.
+    try {
+        many.run(100, [](std::size_t chunk) {
+            if (chunk == 42)
+                throw std::runtime_error("chunk failed");
+        });
+        std::cerr << "The exception was lost\n";
+        return 1;
+    } catch (const std::runtime_error &) {
+    }
+    std::vector<int> visited(10000, 0);
+    many.run(visited.size(), [&](std::size_t chunk) { ++visited[chunk]; });
+    if (std::count(visited.begin(), visited.end(), 1) != static_cast<std::ptrdiff_t>(visited.size())) {
+        std::cerr << "A chunk was not processed exactly once\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    bvlib::parallel::ThreadPool pool(4);
+    if (test_pool())
+        return 1;
+    if (test_parallel<5, std::uint8_t, 100000>(pool))
+        return 1;
+    if (test_parallel<64, std::uint64_t, 50000>(pool))
+        return 1;
+    if (test_parallel<300, std::uint64_t, 10000>(pool))
+        return 1;
+    if (test_parallel<100, std::uint32_t, 1000>(bvlib::parallel::default_pool()))
+        return 1;
+    return 0;
+}
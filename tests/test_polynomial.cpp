@@ -0,0 +1,150 @@
+#include "bvlib/polynomial.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+/// @brief Generates a random bitvector.
+template <std::size_t N, typename Block>
+bvlib::BitVector<N, Block> random_bitvector(std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> distr(0, 1);
+    bvlib::BitVector<N, Block> result;
+    for (std::size_t it = 0; it < N; ++it)
+        result[it] = distr(gen);
+    return result;
+}
+
+/// @brief Multiplies two polynomials one bit at a time.
+template <std::size_t N1, std::size_t N2, typename Block>
+bvlib::BitVector<N1 + N2 - 1, Block> reference_clmul(const bvlib::BitVector<N1, Block> &lhs, const bvlib::BitVector<N2, Block> &rhs)
+{
+    bvlib::BitVector<N1 + N2 - 1, Block> result;
+    for (std::size_t it = 0; it < N2; ++it)
+        if (rhs[it])
+            result ^= bvlib::BitVector<N1 + N2 - 1, Block>(lhs) << it;
+    return result;
+}
+
+template <std::size_t N1, std::size_t N2, typename Block>
+int test_polynomial()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    for (std::size_t run = 0; run < 20; ++run) {
+        const auto a = random_bitvector<N1, Block>(gen);
+        auto b       = random_bitvector<N2, Block>(gen);
+        if (bvlib::clmul(a, b) != reference_clmul(a, b)) {
+            std::cerr << "Wrong carry-less product of " << a << " and " << b << ": " << bvlib::clmul(a, b) << "\n";
+            return 1;
+        }
+        const auto dynamic = bvlib::clmul(bvlib::DynamicBitVector<Block>(a), bvlib::DynamicBitVector<Block>(b));
+        if ((dynamic.size() != N1 + N2 - 1) || (bvlib::BitVector<N1 + N2 - 1, Block>(dynamic) != bvlib::clmul(a, b))) {
+            std::cerr << "Wrong dynamic carry-less product of " << a << " and " << b << "\n";
+            return 1;
+        }
+        if (b.none())
+            b[0] = true;
+        // The quotient and the remainder give back the dividend.
+        const auto result = bvlib::poly_divmod(a, b);
+        if ((bvlib::BitVector<N1, Block>(bvlib::clmul(result.first, b)) ^ result.second) != a ||
+            (result.second.any() && (bvlib::poly_degree(result.second) >= bvlib::poly_degree(b)))) {
+            std::cerr << "Wrong division of " << a << " by " << b << ": " << result.first << ", " << result.second << "\n";
+            return 1;
+        }
+        // The common factor divides the greatest common divisor.
+        const auto c   = random_bitvector<N1, Block>(gen) | bvlib::BitVector<N1, Block>(1U);
+        const auto gcd = bvlib::poly_gcd(bvlib::clmul(a, c), bvlib::clmul(b, c));
+        if (bvlib::poly_mod(gcd, c).any() || (a.any() && bvlib::poly_mod(bvlib::clmul(a, c), gcd).any())) {
+            std::cerr << "Wrong greatest common divisor of " << a << " and " << b << " times " << c << ": " << gcd << "\n";
+            return 1;
+        }
+    }
+    try {
+        bvlib::poly_mod(bvlib::BitVector<N1, Block>(1U), bvlib::BitVector<N2, Block>());
+        std::cerr << "Divided by the zero polynomial\n";
+        return 1;
+    } catch (const std::domain_error &) {
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_lfsr()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    const auto taps = random_bitvector<N, Block>(gen) | bvlib::BitVector<N, Block>(1U);
+    bvlib::BitVector<N + 1, Block> modulus(taps);
+    modulus[N] = true;
+    for (std::size_t run = 0; run < 10; ++run) {
+        const auto state = random_bitvector<N, Block>(gen);
+        const std::size_t steps = run * 37;
+        bvlib::Lfsr<N, Block> serial(taps, state), jumped(taps, state), matrix(taps, state);
+        for (std::size_t it = 0; it < steps; ++it)
+            serial.step();
+        jumped.step(steps);
+        matrix.jump(matrix.jump_matrix(steps));
+        // Each step multiplies the state by x.
+        bvlib::BitVector<400, Block> power;
+        power[steps] = true;
+        const auto expected = bvlib::BitVector<N, Block>(bvlib::poly_mod(bvlib::clmul(bvlib::BitVector<N + 1, Block>(state), power), modulus));
+        if ((serial.state() != expected) || (jumped.state() != expected) || (matrix.state() != expected)) {
+            std::cerr << "Wrong state after " << steps << " steps from " << state << ": " << serial.state() << ", " << jumped.state() << ", " << matrix.state() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int test_period()
+{
+    // x^16 + x^14 + x^13 + x^11 + 1 is primitive, so the period is 2^16 - 1.
+    bvlib::BitVector<16> taps;
+    taps[14] = taps[13] = taps[11] = taps[0] = true;
+    bvlib::Lfsr<16> lfsr(taps, bvlib::BitVector<16>(1U));
+    const auto matrix = lfsr.transition_matrix();
+    if ((matrix.pow(65535) != bvlib::GF2Matrix<16>::identity()) || (matrix.pow(65535 / 3) == bvlib::GF2Matrix<16>::identity())) {
+        std::cerr << "Wrong period of the transition matrix\n";
+        return 1;
+    }
+    std::size_t period = 0;
+    do {
+        lfsr.step();
+        ++period;
+    } while (lfsr.state() != bvlib::BitVector<16>(1U));
+    lfsr.step(65535);
+    if ((period != 65535) || (lfsr.state() != bvlib::BitVector<16>(1U))) {
+        std::cerr << "Wrong period " << period << " of the register\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    static_assert(bvlib::clmul(bvlib::BitVector<8>(3U), bvlib::BitVector<8>(3U)) == 5U, "Wrong constexpr carry-less product");
+    if (test_polynomial<1, 1, std::uint8_t>())
+        return 1;
+    if (test_polynomial<13, 70, std::uint8_t>())
+        return 1;
+    if (test_polynomial<64, 64, std::uint64_t>())
+        return 1;
+    if (test_polynomial<200, 130, std::uint32_t>())
+        return 1;
+    if (test_polynomial<1000, 1000, std::uint64_t>())
+        return 1;
+    if (test_lfsr<7, std::uint8_t>())
+        return 1;
+    if (test_lfsr<64, std::uint64_t>())
+        return 1;
+    if (test_lfsr<150, std::uint32_t>())
+        return 1;
+    if (test_period())
+        return 1;
+    return 0;
+}
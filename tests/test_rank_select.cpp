@@ -0,0 +1,104 @@
+#include "bvlib/rank_select.hpp"
+#include "bvlib/io.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+/// @brief Checks the index against a scan of the bits.
+template <typename BitVector>
+int check_rank_select(const BitVector &bitvector, std::size_t size)
+{
+    const bvlib::RankSelect index(bitvector);
+    std::vector<std::size_t> ones;
+    for (std::size_t it = 0; it <= size; ++it) {
+        if (index.rank1(it) != ones.size()) {
+            std::cerr << "Wrong rank1(" << it << ") " << index.rank1(it) << ", expected " << ones.size() << "\n";
+            return 1;
+        }
+        if (index.rank0(it) != it - ones.size()) {
+            std::cerr << "Wrong rank0(" << it << ") " << index.rank0(it) << ", expected " << it - ones.size() << "\n";
+            return 1;
+        }
+        if ((it < size) && bitvector[it])
+            ones.push_back(it);
+    }
+    if (index.count() != ones.size()) {
+        std::cerr << "Wrong count " << index.count() << ", expected " << ones.size() << "\n";
+        return 1;
+    }
+    for (std::size_t it = 0; it < ones.size(); ++it) {
+        if (index.select1(it) != ones[it]) {
+            std::cerr << "Wrong select1(" << it << ") " << index.select1(it) << ", expected " << ones[it] << "\n";
+            return 1;
+        }
+    }
+    if (index.select1(ones.size()) != index.npos) {
+        std::cerr << "Found a one after the last one\n";
+        return 1;
+    }
+    return 0;
+}
+
+template <std::size_t N>
+int test_rank_select(double density)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::bernoulli_distribution distr(density);
+    bvlib::BitVector<N> bitvector;
+    for (std::size_t it = 0; it < N; ++it)
+        bitvector[it] = distr(gen);
+    return check_rank_select(bitvector, N);
+}
+
+int test_dynamic_rank_select(std::size_t size, double density)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::bernoulli_distribution distr(density);
+    bvlib::DynamicBitVector<> bitvector(size);
+    for (std::size_t it = 0; it < size; ++it)
+        bitvector[it] = distr(gen);
+    return check_rank_select(bitvector, size);
+}
+
+int test_select_one()
+{
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    for (std::size_t round = 0; round < 1000; ++round) {
+        const std::uint64_t value = gen() & gen();
+        for (std::size_t it = 0, rank = 0; it < 64; ++it) {
+            if (((value >> it) & 1U) && (bvlib::detail::select_one(value, rank++) != it)) {
+                std::cerr << "Wrong select_one(" << value << ", " << rank - 1 << ")\n";
+                return 1;
+            }
+        }
+    }
+    static_assert(bvlib::detail::select_one<std::uint8_t>(0xA4, 2) == 7, "Wrong constexpr select_one");
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_select_one())
+        return 1;
+    if (test_rank_select<1>(0.5))
+        return 1;
+    if (test_rank_select<100>(0.5))
+        return 1;
+    if (test_rank_select<2048>(1.0))
+        return 1;
+    if (test_rank_select<5000>(0.3))
+        return 1;
+    if (test_dynamic_rank_select(0, 0.5))
+        return 1;
+    if (test_dynamic_rank_select(100000, 0.5))
+        return 1;
+    if (test_dynamic_rank_select(100000, 0.001))
+        return 1;
+    if (test_dynamic_rank_select(40960, 0.99))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "bvlib/set_bits.hpp"
+#include "bvlib/io.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+/// @brief Sums the positions of the bits set, at compile time.
+template <std::size_t N, typename Block>
+constexpr std::size_t sum_positions(const bvlib::BitVector<N, Block> &bitvector)
+{
+    std::size_t result = 0;
+    for (std::size_t position : bvlib::set_bits(bitvector))
+        result += position;
+    return result;
+}
+
+/// @brief Returns the positions of the bits set, scanning all of them.
+template <typename BitVector>
+std::vector<std::size_t> scan(const BitVector &bitvector, std::size_t size)
+{
+    std::vector<std::size_t> result;
+    for (std::size_t it = 0; it < size; ++it)
+        if (bitvector[it])
+            result.push_back(it);
+    return result;
+}
+
+/// @brief Checks for_each_set_bit against a scan of the bits.
+template <typename BitVector>
+int check_for_each(const BitVector &bitvector, const std::vector<std::size_t> &expected)
+{
+    std::vector<std::size_t> visited;
+    bvlib::for_each_set_bit(bitvector, [&visited](std::size_t position) { visited.push_back(position); });
+    if (visited != expected) {
+        std::cerr << "Wrong traversal of " << expected.size() << " bits set, visited " << visited.size() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+/// @brief Checks the iterators against a scan of the bits.
+template <typename BitVector>
+int check_set_bits(const BitVector &bitvector, const std::vector<std::size_t> &expected)
+{
+    std::vector<std::size_t> iterated;
+    for (auto it = bvlib::set_bits(bitvector).begin(), end = bvlib::set_bits(bitvector).end(); it != end; it++)
+        iterated.push_back(*it);
+    if (iterated != expected) {
+        std::cerr << "Wrong iteration over " << expected.size() << " bits set, iterated " << iterated.size() << "\n";
+        return 1;
+    }
+    if (bvlib::set_bits(bitvector).empty() != expected.empty()) {
+        std::cerr << "Wrong empty() with " << expected.size() << " bits set\n";
+        return 1;
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_set_bits(double density)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::bernoulli_distribution distr(density);
+    bvlib::BitVector<N, Block> bitvector;
+    bvlib::DynamicBitVector<Block> dynamic(N);
+    for (std::size_t it = 0; it < N; ++it)
+        dynamic[it] = bitvector[it] = distr(gen);
+    const auto expected = scan(bitvector, N);
+    if (check_for_each(bitvector, expected) || check_set_bits(bitvector, expected))
+        return 1;
+    if (check_for_each(dynamic, expected) || check_set_bits(dynamic, expected))
+        return 1;
+    if constexpr (std::is_same<Block, std::uint64_t>::value) {
+        if (check_for_each(bvlib::SparseBitVector<N>(bitvector), expected))
+            return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    using namespace bvlib::literals;
+#if defined(__cpp_lib_ranges)
+    static_assert(std::ranges::forward_range<bvlib::SetBitRange<std::uint64_t>>, "The view is not a forward range");
+    static_assert(std::ranges::view<bvlib::SetBitRange<std::uint64_t>> && std::ranges::borrowed_range<bvlib::SetBitRange<std::uint64_t>>, "The view is not a borrowed view");
+#endif
+    static_assert(sum_positions(0b1011'0000'0000'0000'0000'0000'0000'0000'0000'0001_bv) == 0 + 36 + 37 + 39, "Wrong constexpr traversal");
+    if (test_set_bits<1, std::uint64_t>(0.5))
+        return 1;
+    if (test_set_bits<100, std::uint64_t>(0.0))
+        return 1;
+    if (test_set_bits<100, std::uint64_t>(1.0))
+        return 1;
+    if (test_set_bits<1000, std::uint64_t>(0.01))
+        return 1;
+    if (test_set_bits<1000, std::uint8_t>(0.3))
+        return 1;
+    if (test_set_bits<200000, std::uint64_t>(0.001))
+        return 1;
+    if (test_set_bits<333, std::uint16_t>(0.9))
+        return 1;
+    return 0;
+}
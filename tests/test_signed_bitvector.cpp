@@ -0,0 +1,182 @@
+#include "bvlib/signed_bitvector.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+/// @brief Wraps the value around N bits, as a two's-complement value.
+template <std::size_t N>
+std::int64_t wrap(std::int64_t value)
+{
+    if constexpr (N >= 64) {
+        return value;
+    } else {
+        const std::uint64_t bits = static_cast<std::uint64_t>(value) & ((std::uint64_t(1) << N) - 1U);
+        return (bits >> (N - 1)) ? static_cast<std::int64_t>(bits | ~((std::uint64_t(1) << N) - 1U)) : static_cast<std::int64_t>(bits);
+    }
+}
+
+template <std::size_t N, typename Block>
+int test_signed()
+{
+    using value_t = bvlib::SignedBitVector<N, Block>;
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+
+    for (std::size_t run = 0; run < 10000; ++run) {
+        const std::int64_t a = wrap<N>(static_cast<std::int64_t>(gen())), b = wrap<N>(static_cast<std::int64_t>(gen() >> (run % 64)));
+        const value_t sa(a), sb(b);
+        if ((sa.template to_number<std::int64_t>() != a) || (sa.is_negative() != (a < 0)) || (sa.abs().template to_number<std::uint64_t>() != (a < 0 ? 0U - static_cast<std::uint64_t>(a) : static_cast<std::uint64_t>(a)))) {
+            std::cerr << "Wrong conversion of " << a << ": " << sa << "\n";
+            return 1;
+        }
+        // The additions and the multiplications use unsigned integers, to wrap around without overflows.
+        const auto ua = static_cast<std::uint64_t>(a), ub = static_cast<std::uint64_t>(b);
+        if (((sa + sb).template to_number<std::int64_t>() != wrap<N>(static_cast<std::int64_t>(ua + ub))) ||
+            ((sa - sb).template to_number<std::int64_t>() != wrap<N>(static_cast<std::int64_t>(ua - ub))) ||
+            ((sa * sb).template to_number<std::int64_t>() != wrap<N>(static_cast<std::int64_t>(ua * ub))) ||
+            ((-sa).template to_number<std::int64_t>() != wrap<N>(static_cast<std::int64_t>(0U - ua)))) {
+            std::cerr << "Wrong arithmetic of " << a << " and " << b << "\n";
+            return 1;
+        }
+        if (((sa < sb) != (a < b)) || ((sa <= sb) != (a <= b)) || ((sa > sb) != (a > b)) || ((sa >= sb) != (a >= b)) || ((sa == sb) != (a == b))) {
+            std::cerr << "Wrong comparison of " << a << " and " << b << "\n";
+            return 1;
+        }
+        const std::size_t shift = run % (N + 2);
+        if ((sa >> shift).template to_number<std::int64_t>() != (a >> std::min<std::size_t>(shift, 63))) {
+            std::cerr << "Wrong shift of " << a << " by " << shift << ": " << (sa >> shift) << "\n";
+            return 1;
+        }
+        // The only overflow of the built-in division is skipped.
+        if ((b != 0) && !((a == value_t::min().template to_number<std::int64_t>()) && (b == -1))) {
+            if (((sa / sb).template to_number<std::int64_t>() != a / b) || ((sa % sb).template to_number<std::int64_t>() != a % b)) {
+                std::cerr << "Wrong division of " << a << " by " << b << ": " << (sa / sb) << ", " << (sa % sb) << "\n";
+                return 1;
+            }
+        }
+        // The sign extension to a wider value, and the full product.
+        const bvlib::SignedBitVector<N + 70, Block> wide(sa);
+        if ((value_t(wide) != sa) || (wide.template to_number<std::int64_t>() != a) || (wide.is_negative() != sa.is_negative())) {
+            std::cerr << "Wrong sign extension of " << a << ": " << wide << "\n";
+            return 1;
+        }
+        const auto product = bvlib::mul(sa, sb);
+        if ((b != 0) && (product / bvlib::SignedBitVector<2 * N, Block>(sb) != bvlib::SignedBitVector<2 * N, Block>(sa))) {
+            std::cerr << "Wrong full product of " << a << " and " << b << ": " << product << "\n";
+            return 1;
+        }
+#ifdef BVLIB_HAS_INT128
+        if constexpr (N <= 64) {
+            using uint128_t = bvlib::detail::uint128_t;
+            uint128_t expected = uint128_t(sa.abs().to_uint64()) * uint128_t(sb.abs().to_uint64());
+            if ((a < 0) != (b < 0))
+                expected = uint128_t(0U) - expected;
+            if (bvlib::SignedBitVector<128, Block>(product).bits.to_u128() != expected) {
+                std::cerr << "Wrong full product of " << a << " and " << b << ": " << product << "\n";
+                return 1;
+            }
+        }
+#endif
+    }
+    // The value which cannot be negated, and the division by zero.
+    if ((-value_t::min() != value_t::min()) || (value_t::min() / value_t(-1) != value_t::min()) || (value_t::max() + value_t(1) != value_t::min()) ||
+        !(value_t::min() < value_t::max()) || (value_t::min().abs() != bvlib::BitVector<N, Block>(value_t::min().bits))) {
+        std::cerr << "Wrong limits of " << N << " bits\n";
+        return 1;
+    }
+    try {
+        value_t(1) / value_t();
+        std::cerr << "Divided by zero\n";
+        return 1;
+    } catch (const std::domain_error &) {
+    }
+    return 0;
+}
+
+template <std::size_t N, typename Block>
+int test_wide()
+{
+    using value_t = bvlib::SignedBitVector<N, Block>;
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> distr(0, 1);
+
+    for (std::size_t run = 0; run < 200; ++run) {
+        value_t a, b;
+        for (std::size_t it = 0; it < N; ++it) {
+            a[it] = distr(gen);
+            b[it] = (it < N / 2 + run % (N / 2)) ? distr(gen) : a[N - 1];
+        }
+        if (b.is_zero())
+            continue;
+        const auto result = bvlib::div(a, b);
+        if ((result.first * b + result.second != a) || (!result.second.is_zero() && (result.second.is_negative() != a.is_negative())) || !(result.second.abs() < b.abs())) {
+            std::cerr << "Wrong division of " << a << " by " << b << ": " << result.first << ", " << result.second << "\n";
+            return 1;
+        }
+        // The comparison is the one of the difference, when it does not overflow.
+        const bvlib::SignedBitVector<N + 1, Block> wa(a), wb(b);
+        if ((a < b) != (wa - wb).is_negative()) {
+            std::cerr << "Wrong comparison of " << a << " and " << b << "\n";
+            return 1;
+        }
+        // The arithmetic shift divides by a power of two, rounding toward minus infinity.
+        const std::size_t shift = run % N;
+        value_t power;
+        power[shift]         = true;
+        const auto quotient  = bvlib::div(a, power);
+        const value_t rounded = (quotient.second.is_negative()) ? quotient.first - value_t(1) : quotient.first;
+        if ((shift < N - 1) && ((a >> shift) != rounded)) {
+            std::cerr << "Wrong shift of " << a << " by " << shift << ": " << (a >> shift) << "\n";
+            return 1;
+        }
+        if ((a >> (N + 10)) != (a.is_negative() ? value_t(-1) : value_t())) {
+            std::cerr << "Wrong full shift of " << a << "\n";
+            return 1;
+        }
+        // The stream operators.
+        std::stringstream ss;
+        ss << a;
+        value_t read;
+        if (!(ss >> read) || (read != a)) {
+            std::cerr << "Wrong stream round trip of " << a << ": " << read << "\n";
+            return 1;
+        }
+    }
+    std::stringstream ss;
+    ss << "-" << value_t::min().abs() << " " << value_t::min().abs();
+    value_t read;
+    if (!(ss >> read) || (read != value_t::min()) || (ss >> read)) {
+        std::cerr << "Wrong range of the stream operators of " << N << " bits\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    static_assert(bvlib::SignedBitVector<100>(-5) < bvlib::SignedBitVector<100>(3), "Wrong constexpr comparison");
+    static_assert((bvlib::SignedBitVector<100>(-5) >> 1).to_number<int>() == -3, "Wrong constexpr shift");
+    if (test_signed<8, std::uint8_t>())
+        return 1;
+    if (test_signed<13, std::uint16_t>())
+        return 1;
+    if (test_signed<33, std::uint32_t>())
+        return 1;
+    if (test_signed<64, std::uint64_t>())
+        return 1;
+    if (test_signed<64, std::uint16_t>())
+        return 1;
+    if (test_wide<100, std::uint32_t>())
+        return 1;
+    if (test_wide<130, std::uint64_t>())
+        return 1;
+    if (test_wide<512, std::uint64_t>())
+        return 1;
+    return 0;
+}
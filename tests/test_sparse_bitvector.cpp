@@ -0,0 +1,160 @@
+#include "bvlib/sparse_bitvector.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+
+#include <iostream>
+#include <random>
+
+/// @brief Generates a random bitvector, made of zeros, random bits and runs of ones.
+template <std::size_t N>
+bvlib::BitVector<N> random_bitvector(std::mt19937 &gen, double density)
+{
+    std::bernoulli_distribution distr(density), run(0.0005);
+    std::uniform_int_distribution<std::size_t> length(1, 10000);
+    bvlib::BitVector<N> result;
+    for (std::size_t it = 0; it < N; ++it) {
+        if (run(gen))
+            for (std::size_t end = std::min(N, it + length(gen)); it < end; ++it)
+                result[it] = true;
+        else
+            result[it] = distr(gen);
+    }
+    return result;
+}
+
+template <std::size_t N>
+int test_sparse_bitvector(double density)
+{
+    using sparse_t = bvlib::SparseBitVector<N>;
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    const auto a = random_bitvector<N>(gen, density), b = random_bitvector<N>(gen, density);
+    const sparse_t sa(a), sb(b);
+    if ((sa.to_bitvector() != a) || (sa.count() != a.count()) || (sa.any() != a.any()) || (sa.find_first() != a.find_first()) || (sa.find_last() != a.find_last())) {
+        std::cerr << "Wrong compression of " << a << "\n";
+        return 1;
+    }
+    for (std::size_t it = 0; it < N; ++it) {
+        if (sa[it] != a[it]) {
+            std::cerr << "Wrong bit " << it << " of " << a << "\n";
+            return 1;
+        }
+    }
+    if (((sa & sb).to_bitvector() != (a & b)) || ((sa | sb).to_bitvector() != (a | b)) || ((sa ^ sb).to_bitvector() != (a ^ b)) || ((~sa).to_bitvector() != ~a)) {
+        std::cerr << "Wrong bitwise operators for " << a << " and " << b << "\n";
+        return 1;
+    }
+    auto sc = sa;
+    sc &= sb, sc |= sa, sc ^= sb;
+    if (static_cast<bvlib::BitVector<N>>(sc) != (((a & b) | a) ^ b)) {
+        std::cerr << "Wrong bitwise assignment operators for " << a << " and " << b << "\n";
+        return 1;
+    }
+    if (((sa == sb) != (a == b)) || ((sa != sb) != (a != b)) || ((sa < sb) != (a < b)) || ((sa <= sb) != (a <= b)) || ((sa > sb) != (a > b)) || ((sa >= sb) != (a >= b))) {
+        std::cerr << "Wrong comparison of " << a << " and " << b << "\n";
+        return 1;
+    }
+    if ((sa != sparse_t(a)) || (sa < sparse_t(a)) || !(sa <= sparse_t(a))) {
+        std::cerr << "Wrong comparison of " << a << " with itself\n";
+        return 1;
+    }
+    // Single bit modifications, which move the chunks across the encodings.
+    auto dense = a;
+    sc         = sa;
+    std::uniform_int_distribution<std::size_t> position(0, N - 1);
+    for (std::size_t it = 0; it < 20000; ++it) {
+        const std::size_t bit = (it % 2) ? position(gen) : (it % (N < 10000 ? N : 10000));
+        const bool value      = (it % 3) != 0;
+        dense[bit]            = value;
+        sc.set(bit, value);
+        if (sc.test(bit) != value) {
+            std::cerr << "Wrong bit " << bit << " after setting it to " << value << "\n";
+            return 1;
+        }
+    }
+    if ((sc.to_bitvector() != dense) || (sc.count() != dense.count())) {
+        std::cerr << "Wrong bits after setting them\n";
+        return 1;
+    }
+    if (sparse_t(dense) != sc.optimize()) {
+        std::cerr << "Wrong equality, after optimizing\n";
+        return 1;
+    }
+    return 0;
+}
+
+int test_encodings()
+{
+    using sparse_t    = bvlib::SparseBitVector<1000000>;
+    using encoding_t  = sparse_t::container_type::encoding;
+    sparse_t sparse;
+    for (std::size_t it = 0; it < 100; ++it)
+        sparse.set(it * 13);
+    if ((sparse.containers().size() != 1) || (sparse.containers()[0].type() != encoding_t::array)) {
+        std::cerr << "Few positions are not stored as an array\n";
+        return 1;
+    }
+    for (std::size_t it = 0; it < 5000; ++it)
+        sparse.set(it * 13);
+    if ((sparse.containers().size() != 1) || (sparse.containers()[0].type() != encoding_t::bitmap)) {
+        std::cerr << "Many positions are not stored as a bitmap\n";
+        return 1;
+    }
+    for (std::size_t it = 0; it < 5000; ++it)
+        sparse.reset(it * 13);
+    if (!sparse.none() || !sparse.keys().empty()) {
+        std::cerr << "Empty chunks are not removed\n";
+        return 1;
+    }
+    // The complement of few bits is made of runs, and stays small.
+    sparse.set(123456);
+    const sparse_t full = ~sparse;
+    if ((full.count() != 999999) || (full.containers()[1].type() != encoding_t::run) || (full.memory_usage() > 2048)) {
+        std::cerr << "Wrong complement encoding, using " << full.memory_usage() << " bytes\n";
+        return 1;
+    }
+    for (std::size_t it = 1000; it < 3000; ++it)
+        sparse.set(it);
+    if ((sparse.containers()[0].type() != encoding_t::array) || (sparse.optimize().containers()[0].type() != encoding_t::run) || (sparse.count() != 2001)) {
+        std::cerr << "A long run is not stored as a run, after optimizing\n";
+        return 1;
+    }
+    // Clearing every other bit of a run re-encodes it once the runs take more than a bitmap.
+    sparse_t runs = ~sparse_t();
+    for (std::size_t it = 0; it < 65536; it += 2) {
+        runs.reset(it);
+        if (runs.containers()[0].memory_usage() > 9000) {
+            std::cerr << "Clearing bit " << it << " of a run uses " << runs.containers()[0].memory_usage() << " bytes\n";
+            return 1;
+        }
+    }
+    if ((runs.count() != 1000000 - 32768) || (runs.containers()[0].type() != encoding_t::bitmap)) {
+        std::cerr << "Wrong encoding of alternating bits\n";
+        return 1;
+    }
+    try {
+        (void)sparse.at(1000000);
+        std::cerr << "Accessing outside the bitvector did not throw\n";
+        return 1;
+    } catch (const std::out_of_range &) {
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    if (test_encodings())
+        return 1;
+    if (test_sparse_bitvector<1>(0.5))
+        return 1;
+    if (test_sparse_bitvector<100>(0.5))
+        return 1;
+    if (test_sparse_bitvector<70000>(0.5))
+        return 1;
+    if (test_sparse_bitvector<300000>(0.01))
+        return 1;
+    if (test_sparse_bitvector<300000>(0.0001))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,188 @@
+#define BVLIB_INSTRUMENT
+
+#include "bvlib/dynamic_bitvector.hpp"
+#include "bvlib/io.hpp"
+#include "bvlib/math.hpp"
+#include "bvlib/stats.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+/// @brief Returns the counter of the given kind, name and widths, or zero.
+std::uint64_t count(bvlib::stats::kind kind, const std::string &name, std::size_t width, std::size_t from = 0)
+{
+    for (const auto &entry : bvlib::stats::snapshot())
+        if ((entry.kind == kind) && (entry.name == name) && (entry.width == width) && (entry.from == from))
+            return entry.count;
+    return 0;
+}
+
+int test_operations()
+{
+    bvlib::stats::reset();
+    bvlib::BitVector<64> a(12345U), b(678U);
+    for (std::size_t it = 0; it < 10; ++it) {
+        a = a + b;
+        a = a - b;
+    }
+    const auto product             = a * b;
+    const auto quotient            = a / b;
+    const auto shifted             = (a << 3) >> 1;
+    const bool less                = a < b;
+    const bvlib::BitVector<64> all = (a & b) | (a ^ b);
+    if ((count(bvlib::stats::kind::operation, "sum", 64) != 10) || (count(bvlib::stats::kind::operation, "sub", 64) != 10) ||
+        (count(bvlib::stats::kind::operation, "mul", 64) != 1) || (count(bvlib::stats::kind::operation, "div", 64) != 1) ||
+        (count(bvlib::stats::kind::operation, "shift_left", 64) != 1) || (count(bvlib::stats::kind::operation, "shift_right", 64) != 1) ||
+        (count(bvlib::stats::kind::operation, "compare", 64) != 1) || (count(bvlib::stats::kind::operation, "and", 64) != 1) ||
+        (count(bvlib::stats::kind::operation, "or", 64) != 1) || (count(bvlib::stats::kind::operation, "xor", 64) != 1)) {
+        std::cerr << "Wrong number of operations\n";
+        bvlib::stats::dump(std::cerr);
+        return 1;
+    }
+    // Each operation returns one bitvector, the product is twice as wide, and the division returns two.
+    if ((count(bvlib::stats::kind::temporary, "temporary", 64) != 27) || (count(bvlib::stats::kind::temporary, "temporary", 128) != 1)) {
+        std::cerr << "Wrong number of temporaries\n";
+        bvlib::stats::dump(std::cerr);
+        return 1;
+    }
+    // The bitvectors of the same width are never promoted.
+    if (count(bvlib::stats::kind::promotion, "promotion", 64, 64) || count(bvlib::stats::kind::promotion, "promotion", 128, 64)) {
+        std::cerr << "Wrong promotion\n";
+        return 1;
+    }
+    bvlib::stats::reset();
+    if (!bvlib::stats::snapshot().empty()) {
+        std::cerr << "The counters were not cleared\n";
+        return 1;
+    }
+    return (product.none() || quotient.none() || shifted.none() || less || all.none()) ? 1 : 0;
+}
+
+int test_promotions()
+{
+    bvlib::stats::reset();
+    bvlib::BitVector<128> a(1U);
+    const bvlib::BitVector<64> b(2U);
+    a = a + b;
+    a = b + a;
+    const bool equal = (a == b);
+    if ((count(bvlib::stats::kind::promotion, "promotion", 128, 64) != 3) || (count(bvlib::stats::kind::operation, "sum", 128) != 2) ||
+        (count(bvlib::stats::kind::operation, "compare", 128) != 1)) {
+        std::cerr << "Wrong number of promotions\n";
+        bvlib::stats::dump(std::cerr);
+        return 1;
+    }
+    return equal ? 1 : 0;
+}
+
+int test_assignments()
+{
+    bvlib::stats::reset();
+    bvlib::BitVector<64> a(12345U);
+    const bvlib::BitVector<32> b(678U);
+    a += b;
+    a -= 3U;
+    a <<= 2;
+    a >>= 1;
+    a &= b;
+    a |= b;
+    a ^= b;
+    const auto flipped = ~a;
+    const bvlib::Divider<32> divider(b);
+    const auto quotient = divider.divide(a).first;
+    if ((count(bvlib::stats::kind::operation, "sum_assign", 64) != 1) || (count(bvlib::stats::kind::operation, "sub_assign", 64) != 1) ||
+        (count(bvlib::stats::kind::operation, "shift_left_assign", 64) != 1) ||
+        (count(bvlib::stats::kind::operation, "shift_right_assign", 64) != 1) ||
+        (count(bvlib::stats::kind::operation, "and_assign", 64) != 1) || (count(bvlib::stats::kind::operation, "or_assign", 64) != 1) ||
+        (count(bvlib::stats::kind::operation, "xor_assign", 64) != 1) || (count(bvlib::stats::kind::operation, "not", 64) != 1) ||
+        (count(bvlib::stats::kind::operation, "divider", 64) != 1)) {
+        std::cerr << "Wrong number of assignments\n";
+        bvlib::stats::dump(std::cerr);
+        return 1;
+    }
+    // The assignments work in place, the not returns one bitvector and the divider two.
+    if ((count(bvlib::stats::kind::temporary, "temporary", 64) != 3) || (count(bvlib::stats::kind::promotion, "promotion", 64, 32) != 5)) {
+        std::cerr << "Wrong number of temporaries or promotions\n";
+        bvlib::stats::dump(std::cerr);
+        return 1;
+    }
+    return (flipped.none() || quotient.any()) ? 1 : 0;
+}
+
+int test_dynamic()
+{
+    bvlib::stats::reset();
+    bvlib::DynamicBitVector<> a(100, 12345U);
+    const bvlib::DynamicBitVector<> b(64, 678U);
+    const auto sum = a + b;
+    a += b;
+    a <<= 3;
+    const auto product = a * b;
+    const auto flipped = ~a;
+    const bool less    = a < b;
+    if ((count(bvlib::stats::kind::operation, "dynamic_sum", 100) != 1) ||
+        (count(bvlib::stats::kind::operation, "dynamic_sum_assign", 100) != 1) ||
+        (count(bvlib::stats::kind::operation, "dynamic_shift_left_assign", 100) != 1) ||
+        (count(bvlib::stats::kind::operation, "dynamic_mul", 100) != 1) || (count(bvlib::stats::kind::operation, "dynamic_not", 100) != 1) ||
+        (count(bvlib::stats::kind::operation, "dynamic_compare", 100) != 1)) {
+        std::cerr << "Wrong number of dynamic operations\n";
+        bvlib::stats::dump(std::cerr);
+        return 1;
+    }
+    // The sum, the product and the not return one bitvector each.
+    if ((count(bvlib::stats::kind::temporary, "dynamic_temporary", 100) != 2) ||
+        (count(bvlib::stats::kind::temporary, "dynamic_temporary", 200) != 1) ||
+        (count(bvlib::stats::kind::promotion, "dynamic_promotion", 100, 64) != 4)) {
+        std::cerr << "Wrong number of dynamic temporaries or promotions\n";
+        bvlib::stats::dump(std::cerr);
+        return 1;
+    }
+    return (sum.none() || product.none() || flipped.none() || less) ? 1 : 0;
+}
+
+int test_threads()
+{
+    bvlib::stats::reset();
+    std::thread worker([]() {
+        bvlib::BitVector<256> a(1U);
+        for (std::size_t it = 0; it < 100; ++it)
+            a = a + a;
+        std::cout << a << "\n";
+    });
+    worker.join();
+    // The counters of the worker are merged when it exits.
+    bvlib::BitVector<256> b(1U);
+    b = b + b;
+    if (count(bvlib::stats::kind::operation, "sum", 256) != 101) {
+        std::cerr << "The counters of the threads were not merged\n";
+        bvlib::stats::dump(std::cerr);
+        return 1;
+    }
+    std::ostringstream stream;
+    bvlib::stats::dump(stream);
+    if (stream.str().find("sum") == std::string::npos) {
+        std::cerr << "Wrong report:\n"
+                  << stream.str();
+        return 1;
+    }
+    return 0;
+}
+
+int main(int, char *[])
+{
+    // The operations can still be evaluated at compile time.
+    static_assert(bvlib::BitVector<64>(2U) + bvlib::BitVector<64>(3U) == 5U, "Wrong constexpr sum");
+    static_assert(bvlib::BitVector<64>(7U) * bvlib::BitVector<64>(3U) == 21U, "Wrong constexpr product");
+    if (test_operations())
+        return 1;
+    if (test_promotions())
+        return 1;
+    if (test_assignments())
+        return 1;
+    if (test_dynamic())
+        return 1;
+    if (test_threads())
+        return 1;
+    return 0;
+}